@@ -0,0 +1,630 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <print>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <rubberduck/ASTContext.h>
+#include <rubberduck/Batch.h>
+#include <rubberduck/Benchmark.h>
+#include <rubberduck/CompiledScript.h>
+#include <rubberduck/ErrorHandling.h>
+#include <rubberduck/Input.h>
+#include <rubberduck/Interpreter.h>
+#include <rubberduck/Lexer.h>
+#include <rubberduck/Parser.h>
+#include <rubberduck/SourceFile.h>
+#include <rubberduck/VM.h>
+
+// rd_bench: the performance regression suite. Every script of the
+// corpus is lexed, parsed and run on each engine a number of times;
+// every phase is timed on its own and summarized like a `benchmark`
+// block, then compared against a baseline saved by an earlier run.
+//
+//     rd_bench --save=bench/baseline.json    # on the old tree
+//     rd_bench                               # on the new one
+
+// Set by CMake to the source directory of the suite
+#ifndef RD_BENCH_DIR
+#define RD_BENCH_DIR "bench"
+#endif
+
+enum class e_Engine
+{
+    VM,
+    AST,
+    CLOSURE
+};
+
+struct t_BenchOptions
+{
+    uint32_t runs = 10;
+    uint32_t warmup = 2;
+    std::vector<e_Engine> engines =
+    {
+        e_Engine::VM, e_Engine::AST, e_Engine::CLOSURE
+    };
+    std::string corpus = RD_BENCH_DIR "/corpus"; // directory or manifest
+    std::string baseline = RD_BENCH_DIR "/baseline.json";
+    bool is_baseline_given = false; // a missing one is then an error
+    std::string save; // where to write the results, if anywhere
+    double threshold = 10.0; // percent slower that counts as a regression
+};
+
+// One phase of one workload: "lex", "parse" or "run-<engine>"
+struct t_Measurement
+{
+    std::string workload;
+    std::string phase;
+    t_BenchmarkStats stats;
+};
+
+// Discards what the scripts display, so that runs time formatting the
+// output and not writing it
+class NullBuffer : public std::streambuf
+{
+protected:
+    int_type overflow(int_type ch) override
+    {
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize count) override
+    {
+        return count;
+    }
+};
+
+static void PrintUsage()
+{
+    std::println("Usage: rd_bench [options] [<corpus dir|manifest>]");
+    std::println("Options:");
+    std::println("  --runs=<n>      Timed runs of every phase (10)");
+    std::println("  --warmup=<n>    Untimed runs before them (2)");
+    std::println("  --engine=<name> Run on vm, ast or closure only");
+    std::println("  --baseline=<file>");
+    std::println("                  Compare with these results (default");
+    std::println("                  bench/baseline.json, when present)");
+    std::println("  --save=<file>   Write the results as JSON");
+    std::println("  --threshold=<percent>");
+    std::println("                  How much slower a median may get (10)");
+    std::println("The exit status is 1 if a script failed or a phase got");
+    std::println("slower than the threshold.");
+}
+
+static const char* EngineName(e_Engine engine)
+{
+    switch (engine)
+    {
+    case e_Engine::VM:
+        return "vm";
+    case e_Engine::AST:
+        return "ast";
+    case e_Engine::CLOSURE:
+        return "closure";
+    }
+    return "";
+}
+
+static bool ParseCount(std::string_view text, uint32_t& count)
+{
+    std::from_chars_result result = std::from_chars
+    (
+        text.data(),
+        text.data() + text.size(),
+        count
+    );
+    return result.ec == std::errc() &&
+           result.ptr == text.data() + text.size();
+}
+
+static bool ParseOptions(int argc, char* argv[], t_BenchOptions& options)
+{
+    bool is_corpus_given = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("--runs="))
+        {
+            if (!ParseCount(arg.substr(7), options.runs) || options.runs == 0)
+            {
+                std::println(stderr, "Error: Invalid run count '{}'", arg);
+                return false;
+            }
+        }
+        else if (arg.starts_with("--warmup="))
+        {
+            if (!ParseCount(arg.substr(9), options.warmup))
+            {
+                std::println(stderr, "Error: Invalid warmup '{}'", arg);
+                return false;
+            }
+        }
+        else if (arg == "--engine=vm")
+        {
+            options.engines = {e_Engine::VM};
+        }
+        else if (arg == "--engine=ast")
+        {
+            options.engines = {e_Engine::AST};
+        }
+        else if (arg == "--engine=closure")
+        {
+            options.engines = {e_Engine::CLOSURE};
+        }
+        else if (arg.starts_with("--baseline="))
+        {
+            options.baseline = arg.substr(11);
+            options.is_baseline_given = true;
+        }
+        else if (arg.starts_with("--save="))
+        {
+            options.save = arg.substr(7);
+        }
+        else if (arg.starts_with("--threshold="))
+        {
+            std::string_view percent = arg.substr(12);
+            std::from_chars_result result = std::from_chars
+            (
+                percent.data(),
+                percent.data() + percent.size(),
+                options.threshold
+            );
+            if
+            (
+                result.ec != std::errc() ||
+                result.ptr != percent.data() + percent.size() ||
+                options.threshold < 0.0
+            )
+            {
+                std::println(stderr, "Error: Invalid threshold '{}'", arg);
+                return false;
+            }
+        }
+        else if (arg.starts_with("-"))
+        {
+            std::println(stderr, "Error: Unknown option '{}'", arg);
+            return false;
+        }
+        else if (!is_corpus_given)
+        {
+            options.corpus = arg;
+            is_corpus_given = true;
+        }
+        else
+        {
+            std::println(stderr, "Error: Only one corpus can be run");
+            return false;
+        }
+    }
+    return true;
+}
+
+static int64_t NanosecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+    (
+        std::chrono::steady_clock::now() - start
+    ).count();
+}
+
+// A sample of a short phase times this long a series of calls, so
+// that it is not all timer and cache noise
+constexpr int64_t MIN_SAMPLE_NS = 1000000;
+
+// Runs `phase` warmup + runs times, timing the runs. Each of those is
+// as many calls as it takes to last MIN_SAMPLE_NS, found by one extra
+// call first, and its sample is the time per call. The first error
+// stops it.
+template <typename Phase>
+static Expected<t_BenchmarkStats, t_ErrorInfo> Measure
+(
+    const t_BenchOptions& options,
+    Phase&& phase
+)
+{
+    std::chrono::steady_clock::time_point start =
+    std::chrono::steady_clock::now();
+    Expected<int, t_ErrorInfo> result = phase();
+    if (!result)
+    {
+        return result.Error();
+    }
+    int64_t elapsed = std::max<int64_t>(NanosecondsSince(start), 1);
+    int64_t calls = std::max<int64_t>(MIN_SAMPLE_NS / elapsed, 1);
+
+    std::vector<int64_t> samples;
+    samples.reserve(options.runs);
+    for (uint32_t i = 0; i < options.warmup + options.runs; ++i)
+    {
+        start = std::chrono::steady_clock::now();
+        for (int64_t call = 0; call < calls; ++call)
+        {
+            result = phase();
+            if (!result)
+            {
+                return result.Error();
+            }
+        }
+        elapsed = NanosecondsSince(start);
+        if (i >= options.warmup)
+        {
+            samples.push_back(elapsed / calls);
+        }
+    }
+    return ComputeBenchmarkStats(samples, 0, options.warmup);
+}
+
+// Times every phase of one script; false if any of them failed
+static bool MeasureWorkload
+(
+    const t_BenchOptions& options,
+    const std::string& path,
+    std::vector<t_Measurement>& measurements
+)
+{
+    std::string workload = std::filesystem::path(path).stem().string();
+    SourceFile file;
+    if (!file.Open(path))
+    {
+        std::println(stderr, "Error: Could not open file {}", path);
+        return false;
+    }
+    std::string_view source = file.Text();
+
+    auto fail = [&](const char* phase, const t_ErrorInfo& error)
+    {
+        std::println(stderr, "{} failed to {}:", path, phase);
+        ReportError(error, std::cerr);
+        return false;
+    };
+
+    // Names are interned by the first run and found by the others
+    std::vector<t_Token> tokens;
+    SymbolTable symbols;
+    Expected<t_BenchmarkStats, t_ErrorInfo> lex_stats = Measure
+    (
+        options,
+        [&]() -> Expected<int, t_ErrorInfo>
+        {
+            Lexer lexer(source, symbols);
+            ParsingResult result = lexer.ScanTokens();
+            if (!result)
+            {
+                return result.Error();
+            }
+            tokens = std::move(result.Value());
+            return 0;
+        }
+    );
+    if (!lex_stats)
+    {
+        return fail("lex", lex_stats.Error());
+    }
+    measurements.push_back({workload, "lex", lex_stats.Value()});
+
+    // A new context every run, as every compile makes one. Identifiers
+    // keep the symbols of the lexing table; nothing looks them up in
+    // a tree that is thrown away.
+    Expected<t_BenchmarkStats, t_ErrorInfo> parse_stats = Measure
+    (
+        options,
+        [&]() -> Expected<int, t_ErrorInfo>
+        {
+            ASTContext context;
+            Parser parser(source, tokens, context);
+            Expected<StmtList, t_ErrorInfo> result = parser.Parse();
+            if (!result)
+            {
+                return result.Error();
+            }
+            return 0;
+        }
+    );
+    if (!parse_stats)
+    {
+        return fail("parse", parse_stats.Error());
+    }
+    measurements.push_back({workload, "parse", parse_stats.Value()});
+
+    for (e_Engine engine : options.engines)
+    {
+        // Compiled once; only running it is timed
+        t_CompileOptions compile_options;
+        compile_options.bytecode = engine == e_Engine::VM;
+        Expected<std::shared_ptr<const CompiledScript>, t_ErrorInfo>
+        compile_result = CompiledScript::Compile(source, compile_options);
+        if (!compile_result)
+        {
+            return fail("compile", compile_result.Error());
+        }
+        const CompiledScript& compiled = *compile_result.Value();
+
+        Expected<t_BenchmarkStats, t_ErrorInfo> run_stats = Measure
+        (
+            options,
+            [&]() -> Expected<int, t_ErrorInfo>
+            {
+                NullBuffer discard;
+                std::ostream output(&discard);
+                std::istringstream no_input;
+                InputReader input(no_input);
+                if (engine == e_Engine::VM)
+                {
+                    VM vm;
+                    vm.SetOutput(output);
+                    vm.SetInput(input);
+                    return vm.Run(*compiled.Program());
+                }
+                Interpreter interpreter;
+                interpreter.SetOutput(output);
+                interpreter.SetInput(input);
+                interpreter.SetClosures(engine == e_Engine::CLOSURE);
+                return interpreter.Interpret(compiled);
+            }
+        );
+        if (!run_stats)
+        {
+            return fail("run", run_stats.Error());
+        }
+        measurements.push_back
+        (
+            {
+                workload,
+                std::string("run-") + EngineName(engine),
+                run_stats.Value()
+            }
+        );
+    }
+    return true;
+}
+
+// Medians by "workload/phase", from a file written by --save. Only
+// what that writes is understood: one result object per line.
+static Expected<std::unordered_map<std::string, double>, std::string>
+ReadBaseline(const std::string& path)
+{
+    std::ifstream stream(path);
+    if (!stream)
+    {
+        return "Could not open baseline " + path;
+    }
+
+    auto find_string = [](std::string_view line, std::string_view key)
+    {
+        std::string pattern = "\"" + std::string(key) + "\": \"";
+        size_t begin = line.find(pattern);
+        if (begin == std::string_view::npos)
+        {
+            return std::string_view();
+        }
+        begin += pattern.size();
+        size_t end = line.find('"', begin);
+        if (end == std::string_view::npos)
+        {
+            return std::string_view();
+        }
+        return line.substr(begin, end - begin);
+    };
+
+    std::unordered_map<std::string, double> medians;
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        std::string_view workload = find_string(line, "workload");
+        std::string_view phase = find_string(line, "phase");
+        const std::string_view pattern = "\"median_ns\": ";
+        size_t begin = line.find(pattern);
+        if (workload.empty() || phase.empty() || begin == std::string::npos)
+        {
+            continue;
+        }
+        begin += pattern.size();
+        double median = 0.0;
+        std::from_chars_result result = std::from_chars
+        (
+            line.data() + begin,
+            line.data() + line.size(),
+            median
+        );
+        if (result.ec != std::errc())
+        {
+            return "Invalid median in " + path + ": " + line;
+        }
+        medians[std::string(workload) + "/" + std::string(phase)] = median;
+    }
+    if (medians.empty())
+    {
+        return "No results in baseline " + path;
+    }
+    return medians;
+}
+
+static bool SaveResults
+(
+    const t_BenchOptions& options,
+    const std::vector<t_Measurement>& measurements
+)
+{
+    std::ofstream stream(options.save);
+    if (!stream)
+    {
+        std::println(stderr, "Error: Could not write {}", options.save);
+        return false;
+    }
+    stream << "{\n"
+           << "  \"runs\": " << options.runs << ",\n"
+           << "  \"warmup\": " << options.warmup << ",\n"
+           << "  \"results\": [\n";
+    char buffer[512];
+    for (size_t i = 0; i < measurements.size(); ++i)
+    {
+        const t_Measurement& measurement = measurements[i];
+        const t_BenchmarkStats& stats = measurement.stats;
+        std::snprintf
+        (
+            buffer, sizeof(buffer),
+            "    {\"workload\": \"%s\", \"phase\": \"%s\", "
+            "\"median_ns\": %.0f, \"min_ns\": %.0f, "
+            "\"mean_ns\": %.0f, \"stddev_ns\": %.0f}%s\n",
+            measurement.workload.c_str(),
+            measurement.phase.c_str(),
+            stats.median,
+            stats.min,
+            stats.mean,
+            stats.stddev,
+            i + 1 < measurements.size() ? "," : ""
+        );
+        stream << buffer;
+    }
+    stream << "  ]\n"
+           << "}\n";
+    return static_cast<bool>(stream);
+}
+
+// Prints every measurement, against the baseline when there is one;
+// returns how many got slower than the threshold
+static size_t Report
+(
+    const t_BenchOptions& options,
+    const std::vector<t_Measurement>& measurements,
+    const std::unordered_map<std::string, double>* baseline
+)
+{
+    char buffer[256];
+    std::cout << "workload             phase           median us"
+              << "       min us    stddev   baseline\n";
+
+    size_t regressions = 0;
+    for (const t_Measurement& measurement : measurements)
+    {
+        const t_BenchmarkStats& stats = measurement.stats;
+        double deviation =
+            stats.median > 0.0 ? stats.stddev / stats.median * 100.0 : 0.0;
+        std::string comparison;
+        if (baseline)
+        {
+            auto it = baseline->find
+            (
+                measurement.workload + "/" + measurement.phase
+            );
+            if (it == baseline->end() || it->second <= 0.0)
+            {
+                comparison = "new";
+            }
+            else
+            {
+                double change = (stats.median / it->second - 1.0) * 100.0;
+                std::snprintf(buffer, sizeof(buffer), "%+.1f%%", change);
+                comparison = buffer;
+
+                // Slower by more than the run-to-run noise, too, so
+                // that phases of a few microseconds do not flap
+                bool is_regression =
+                    change > options.threshold &&
+                    stats.median - it->second > 2.0 * stats.stddev;
+                if (is_regression)
+                {
+                    comparison += " slower";
+                    regressions++;
+                }
+            }
+        }
+        std::snprintf
+        (
+            buffer, sizeof(buffer),
+            "%-20s %-12s %12.1f %12.1f %8.1f%%   %s\n",
+            measurement.workload.c_str(),
+            measurement.phase.c_str(),
+            stats.median / 1e3,
+            stats.min / 1e3,
+            deviation,
+            comparison.c_str()
+        );
+        std::cout << buffer;
+    }
+
+    if (baseline)
+    {
+        std::snprintf
+        (
+            buffer, sizeof(buffer),
+            "\n%zu of %zu phases slower than %s by more than %.1f%%\n",
+            regressions,
+            measurements.size(),
+            options.baseline.c_str(),
+            options.threshold
+        );
+        std::cout << buffer;
+    }
+    return regressions;
+}
+
+int main(int argc, char* argv[])
+{
+    t_BenchOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    Expected<std::vector<std::string>, std::string> paths =
+    CollectBatchScripts(options.corpus);
+    if (!paths)
+    {
+        std::println(stderr, "Error: {}", paths.Error());
+        return 1;
+    }
+    if (paths.Value().empty())
+    {
+        std::println(stderr, "Error: No scripts in {}", options.corpus);
+        return 1;
+    }
+
+    std::unordered_map<std::string, double> baseline;
+    bool has_baseline = false;
+    if (options.is_baseline_given || std::filesystem::exists(options.baseline))
+    {
+        Expected<std::unordered_map<std::string, double>, std::string>
+        read_result = ReadBaseline(options.baseline);
+        if (!read_result)
+        {
+            std::println(stderr, "Error: {}", read_result.Error());
+            return 1;
+        }
+        baseline = std::move(read_result.Value());
+        has_baseline = true;
+    }
+
+    bool failed = false;
+    std::vector<t_Measurement> measurements;
+    for (const std::string& path : paths.Value())
+    {
+        if (!MeasureWorkload(options, path, measurements))
+        {
+            failed = true;
+        }
+    }
+
+    size_t regressions = Report
+    (
+        options,
+        measurements,
+        has_baseline ? &baseline : nullptr
+    );
+    if (!options.save.empty() && !SaveResults(options, measurements))
+    {
+        failed = true;
+    }
+    return failed || regressions > 0 ? 1 : 0;
+}
@@ -1,9 +1,15 @@
 #pragma once
 
 #include <variant>
+#include <rubberduck/Arena.h>
+#include <rubberduck/Builtins.h>
+#include <rubberduck/Symbol.h>
 #include <rubberduck/Token.h>
+#include <rubberduck/Value.h>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <type_traits>
 
@@ -25,6 +31,25 @@ using PoolPtr = std::unique_ptr<T, t_PoolDeleter<T>>;
 struct t_Expr;
 struct t_Stmt;
 
+// Child lists of nodes keep their storage in the ASTContext arena
+using StmtList = ArenaVector<PoolPtr<t_Stmt>>;
+using ExprList = ArenaVector<PoolPtr<t_Expr>>;
+
+enum class e_BindingKind
+{
+    UNRESOLVED,
+    LOCAL,  // slot in the frame of the enclosing function (or script)
+    GLOBAL  // slot in the global table
+};
+
+// Storage location of a variable, filled in by the Resolver
+struct t_Binding
+{
+    e_BindingKind kind = e_BindingKind::UNRESOLVED;
+    uint32_t slot = 0;
+    bool is_const = false;
+};
+
 struct t_BinaryExpr;
 struct t_LiteralExpr;
 struct t_UnaryExpr;
@@ -35,6 +60,10 @@ struct t_PostfixExpr;
 struct t_CallExpr;
 struct t_TypeofExpr;
 struct t_SizeofExpr;
+struct t_FormatStringExpr;
+struct t_ArrayExpr;
+struct t_IndexExpr;
+struct t_IndexAssignExpr;
 
 struct t_BlockStmt;
 struct t_IfStmt;
@@ -50,73 +79,98 @@ struct t_EmptyStmt;
 struct t_ExpressionStmt;
 struct t_ReturnStmt;
 
+struct t_ParallelLoop;
+
+// Every node records its kind when it is constructed, so As<T>() is a
+// single compare and the engines dispatch with one switch. The values
+// follow the order of ExprVariant and StmtVariant below.
+enum class e_ExprKind : uint8_t
+{
+    BINARY,
+    LITERAL,
+    UNARY,
+    GROUPING,
+    VARIABLE,
+    PREFIX,
+    POSTFIX,
+    CALL,
+    TYPEOF,
+    SIZEOF,
+    FORMAT_STRING,
+    ARRAY,
+    INDEX,
+    INDEX_ASSIGN
+};
+
+enum class e_StmtKind : uint8_t
+{
+    BLOCK,
+    IF,
+    FOR,
+    BREAK,
+    CONTINUE,
+    VAR,
+    DISPLAY,
+    GETIN,
+    FUNCTION,
+    BENCHMARK,
+    EMPTY,
+    EXPRESSION,
+    RETURN
+};
+
+// What the TypeChecker knows about the values of an expression:
+// either nothing, or the one type every evaluation yields
+enum class e_StaticType : uint8_t
+{
+    UNKNOWN,
+    NIL,
+    NUMBER,
+    STRING,
+    BOOLEAN,
+    ARRAY,
+    STRING_ARRAY
+};
+
+// How the engines evaluate a t_BinaryExpr, chosen by the TypeChecker
+enum class e_BinaryForm : uint8_t
+{
+    GENERIC, // operand types are tested while running
+    NUMBER   // both operands are numbers, and so is an assigned variable
+};
+
 struct t_Expr
 {
 public:
+    const e_ExprKind kind;
+    e_StaticType static_type = e_StaticType::UNKNOWN;
+
     virtual ~t_Expr() = default;
-    
-    virtual bool IsBinary() const { return false; }
-    virtual bool IsLiteral() const { return false; }
-    virtual bool IsUnary() const { return false; }
-    virtual bool IsGrouping() const { return false; }
-    virtual bool IsVariable() const { return false; }
-    virtual bool IsPrefix() const { return false; }
-    virtual bool IsPostfix() const { return false; }
-    virtual bool IsCall() const { return false; }
-    virtual bool IsTypeof() const { return false; }
-    virtual bool IsSizeof() const { return false; }  
-    
-    virtual t_BinaryExpr* AsBinary() { return nullptr; }
-    virtual t_LiteralExpr* AsLiteral() { return nullptr; }
-    virtual t_UnaryExpr* AsUnary() { return nullptr; }
-    virtual t_GroupingExpr* AsGrouping() { return nullptr; }
-    virtual t_VariableExpr* AsVariable() { return nullptr; }
-    virtual t_PrefixExpr* AsPrefix() { return nullptr; }
-    virtual t_PostfixExpr* AsPostfix() { return nullptr; }
-    virtual t_CallExpr* AsCall() { return nullptr; }
-    virtual t_TypeofExpr* AsTypeof() { return nullptr; }
-    virtual t_SizeofExpr* AsSizeof() { return nullptr; }  
+
+protected:
+    explicit t_Expr(e_ExprKind kind) : kind(kind) {}
 };
 
 struct t_Stmt
 {
 public:
+    const e_StmtKind kind;
+    int line = 0; // where the statement starts
+
     virtual ~t_Stmt() = default;
-    
-    virtual bool IsBlock() const { return false; }
-    virtual bool IsIf() const { return false; }
-    virtual bool IsFor() const { return false; }
-    virtual bool IsBreak() const { return false; }
-    virtual bool IsContinue() const { return false; }
-    virtual bool IsVar() const { return false; }
-    virtual bool IsDisplay() const { return false; }
-    virtual bool IsGetin() const { return false; }
-    virtual bool IsFunction() const { return false; }
-    virtual bool IsBenchmark() const { return false; }
-    virtual bool IsEmpty() const { return false; }
-    virtual bool IsExpression() const { return false; }
-    virtual bool IsReturn() const { return false; }
-    
-    virtual t_BlockStmt* AsBlock() { return nullptr; }
-    virtual t_IfStmt* AsIf() { return nullptr; }
-    virtual t_ForStmt* AsFor() { return nullptr; }
-    virtual t_BreakStmt* AsBreak() { return nullptr; }
-    virtual t_ContinueStmt* AsContinue() { return nullptr; }
-    virtual t_VarStmt* AsVar() { return nullptr; }
-    virtual t_DisplayStmt* AsDisplay() { return nullptr; }
-    virtual t_GetinStmt* AsGetin() { return nullptr; }
-    virtual t_FunStmt* AsFunction() { return nullptr; }
-    virtual t_BenchmarkStmt* AsBenchmark() { return nullptr; }
-    virtual t_EmptyStmt* AsEmpty() { return nullptr; }
-    virtual t_ExpressionStmt* AsExpression() { return nullptr; }
-    virtual t_ReturnStmt* AsReturn() { return nullptr; }
+
+protected:
+    explicit t_Stmt(e_StmtKind kind) : kind(kind) {}
 };
 
 struct t_BinaryExpr : public t_Expr
 {
+    static constexpr e_ExprKind KIND = e_ExprKind::BINARY;
+
     PoolPtr<t_Expr> left;
     t_Token op;
     PoolPtr<t_Expr> right;
+    e_BinaryForm form = e_BinaryForm::GENERIC;
 
     t_BinaryExpr
     (
@@ -124,229 +178,339 @@ struct t_BinaryExpr : public t_Expr
         t_Token op, 
         PoolPtr<t_Expr> right
     )
-        : left(std::move(left)), 
+        : t_Expr(KIND),
+          left(std::move(left)), 
           op(op), 
           right(std::move(right)) {}
-    
-    bool IsBinary() const override { return true; }
-    t_BinaryExpr* AsBinary() override { return this; }
 };
 
 struct t_LiteralExpr : public t_Expr
 {
-    std::string value;
+    static constexpr e_ExprKind KIND = e_ExprKind::LITERAL;
+
+    // Not owned: points into the ASTContext arena (see CopyString()),
+    // into the symbol table or at static text
+    std::string_view value;
     e_TokenType token_type;
+    t_Symbol symbol; // the interned value of a STRING, else NO_SYMBOL
+
+    // A NUMBER is converted once, here, instead of by every engine
+    // each time the literal is evaluated. `is_number` is false if the
+    // text is not a valid number.
+    double number = 0.0;
+    bool is_number = false;
     
     t_LiteralExpr
     (
-        const std::string &value, 
-        e_TokenType type = e_TokenType::STRING
-    ) : value(value), token_type(type) {}
-    
-    bool IsLiteral() const override { return true; }
-    t_LiteralExpr* AsLiteral() override { return this; }
+        std::string_view value, 
+        e_TokenType type = e_TokenType::STRING,
+        t_Symbol symbol = NO_SYMBOL
+    )
+        : t_Expr(KIND), value(value), token_type(type), symbol(symbol)
+    {
+        if (type == e_TokenType::NUMBER)
+        {
+            is_number = ParseNumber(value, number);
+        }
+    }
 };
 
 struct t_UnaryExpr : public t_Expr
 {
+    static constexpr e_ExprKind KIND = e_ExprKind::UNARY;
+
     t_Token op;
     PoolPtr<t_Expr> right;
 
     t_UnaryExpr(t_Token op, PoolPtr<t_Expr> right)
-        : op(op), right(std::move(right)) {}
-    
-    bool IsUnary() const override { return true; }
-    t_UnaryExpr* AsUnary() override { return this; }
+        : t_Expr(KIND), op(op), right(std::move(right)) {}
 };
 
 struct t_GroupingExpr : public t_Expr
 {
+    static constexpr e_ExprKind KIND = e_ExprKind::GROUPING;
+
     PoolPtr<t_Expr> expression;
 
     t_GroupingExpr(PoolPtr<t_Expr> expression)
-        : expression(std::move(expression)) {}
-    
-    bool IsGrouping() const override { return true; }
-    t_GroupingExpr* AsGrouping() override { return this; }
+        : t_Expr(KIND), expression(std::move(expression)) {}
 };
 
 struct t_VariableExpr : public t_Expr
 {
-    std::string name;
-    t_VariableExpr(const std::string &name) : name(name) {}
-    
-    bool IsVariable() const override { return true; }
-    t_VariableExpr* AsVariable() override { return this; }
+    static constexpr e_ExprKind KIND = e_ExprKind::VARIABLE;
+
+    t_Symbol name;
+    t_Binding binding;
+    t_VariableExpr(t_Symbol name)
+        : t_Expr(KIND), name(name) {}
 };
 
 struct t_PrefixExpr : public t_Expr
 {
+    static constexpr e_ExprKind KIND = e_ExprKind::PREFIX;
+
     t_Token op;
     PoolPtr<t_Expr> operand;
 
     t_PrefixExpr(t_Token op, PoolPtr<t_Expr> operand)
-        : op(op), operand(std::move(operand)) {}
-    
-    bool IsPrefix() const override { return true; }
-    t_PrefixExpr* AsPrefix() override { return this; }
+        : t_Expr(KIND), op(op), operand(std::move(operand)) {}
 };
 
 struct t_PostfixExpr : public t_Expr
 {
+    static constexpr e_ExprKind KIND = e_ExprKind::POSTFIX;
+
     PoolPtr<t_Expr> operand;
     t_Token op;
 
     t_PostfixExpr(PoolPtr<t_Expr> operand, t_Token op)
-        : operand(std::move(operand)), op(op) {}
-    
-    bool IsPostfix() const override { return true; }
-    t_PostfixExpr* AsPostfix() override { return this; }
+        : t_Expr(KIND), operand(std::move(operand)), op(op) {}
 };
 
 struct t_CallExpr : public t_Expr
 {
-    std::string callee;
-    std::vector<PoolPtr<t_Expr>> arguments;
+    static constexpr e_ExprKind KIND = e_ExprKind::CALL;
+
+    t_Symbol callee;
+    ExprList arguments;
     int line;
+    // Set by the Linker: the function the script declares under this
+    // name, else the builtin of that name, else neither
+    t_FunStmt* target = nullptr;
+    e_Builtin builtin = e_Builtin::NONE;
 
     t_CallExpr
     (
-        const std::string &callee,
-        std::vector<PoolPtr<t_Expr>> arguments,
+        t_Symbol callee,
+        ExprList arguments,
         int line = 0
     )
-        : callee(callee),
+        : t_Expr(KIND),
+          callee(callee),
           arguments(std::move(arguments)),
           line(line) {}
-    
-    bool IsCall() const override { return true; }
-    t_CallExpr* AsCall() override { return this; }
 };
 
 struct t_TypeofExpr : public t_Expr
 {
+    static constexpr e_ExprKind KIND = e_ExprKind::TYPEOF;
+
     PoolPtr<t_Expr> operand;
 
     t_TypeofExpr(PoolPtr<t_Expr> operand)
-        : operand(std::move(operand)) {}
-
-    bool IsTypeof() const override { return true; }
-    t_TypeofExpr* AsTypeof() override { return this; }
+        : t_Expr(KIND), operand(std::move(operand)) {}
 };
 
 struct t_SizeofExpr : public t_Expr  
 {
+    static constexpr e_ExprKind KIND = e_ExprKind::SIZEOF;
+
     PoolPtr<t_Expr> operand;
+    int line;
+
+    t_SizeofExpr(PoolPtr<t_Expr> operand, int line = 0)
+        : t_Expr(KIND), operand(std::move(operand)), line(line) {}
+};
+
+// One piece of a format string: literal text, or an expression from
+// between braces when `expression` is set
+struct t_FormatSegment
+{
+    std::string_view text; // in the ASTContext arena
+    PoolPtr<t_Expr> expression;
+};
+
+// `$"..."` split by the parser into literal text and parsed `{expr}`
+// pieces, so nothing is scanned while the script runs
+struct t_FormatStringExpr : public t_Expr
+{
+    static constexpr e_ExprKind KIND = e_ExprKind::FORMAT_STRING;
+
+    ArenaVector<t_FormatSegment> segments;
+    size_t text_size; // total length of the literal segments
+
+    t_FormatStringExpr
+    (
+        ArenaVector<t_FormatSegment> segments,
+        size_t text_size
+    )
+        : t_Expr(KIND),
+          segments(std::move(segments)),
+          text_size(text_size) {}
+};
+
+// `[a, b, ...]`; builds a new array each time it is evaluated
+struct t_ArrayExpr : public t_Expr
+{
+    static constexpr e_ExprKind KIND = e_ExprKind::ARRAY;
+
+    ExprList elements;
+    int line;
+
+    t_ArrayExpr(ExprList elements, int line = 0)
+        : t_Expr(KIND), elements(std::move(elements)), line(line) {}
+};
+
+// `object[index]`
+struct t_IndexExpr : public t_Expr
+{
+    static constexpr e_ExprKind KIND = e_ExprKind::INDEX;
+
+    PoolPtr<t_Expr> object;
+    PoolPtr<t_Expr> index;
+    int line;
+
+    t_IndexExpr
+    (
+        PoolPtr<t_Expr> object,
+        PoolPtr<t_Expr> index,
+        int line = 0
+    )
+        : t_Expr(KIND),
+          object(std::move(object)),
+          index(std::move(index)),
+          line(line) {}
+};
+
+// `object[index] = value`, or a compound assignment such as `+=`.
+// Changes the element in place; the variable holding the array is
+// not assigned, so this works on a `const` array too.
+struct t_IndexAssignExpr : public t_Expr
+{
+    static constexpr e_ExprKind KIND = e_ExprKind::INDEX_ASSIGN;
 
-    t_SizeofExpr(PoolPtr<t_Expr> operand)
-        : operand(std::move(operand)) {}
+    PoolPtr<t_IndexExpr> target;
+    t_Token op;
+    PoolPtr<t_Expr> value;
 
-    bool IsSizeof() const override { return true; }
-    t_SizeofExpr* AsSizeof() override { return this; }
+    t_IndexAssignExpr
+    (
+        PoolPtr<t_IndexExpr> target,
+        t_Token op,
+        PoolPtr<t_Expr> value
+    )
+        : t_Expr(KIND),
+          target(std::move(target)),
+          op(op),
+          value(std::move(value)) {}
 };
 
 struct t_ExpressionStmt : public t_Stmt
 {
+    static constexpr e_StmtKind KIND = e_StmtKind::EXPRESSION;
+
     PoolPtr<t_Expr> expression;
     t_ExpressionStmt(PoolPtr<t_Expr> expression)
-        : expression(std::move(expression)) {}
-    
-    bool IsExpression() const override { return true; }
-    t_ExpressionStmt* AsExpression() override { return this; }
+        : t_Stmt(KIND), expression(std::move(expression)) {}
 };
 
 struct t_EmptyStmt : public t_Stmt
 {
+    static constexpr e_StmtKind KIND = e_StmtKind::EMPTY;
+
     t_Token semicolon;
 
     t_EmptyStmt(t_Token semicolon)
-        : semicolon(semicolon) {}
-    
-    bool IsEmpty() const override { return true; }
-    t_EmptyStmt* AsEmpty() override { return this; }
+        : t_Stmt(KIND), semicolon(semicolon) {}
 };
 
 struct t_DisplayStmt : public t_Stmt
 {
-    std::vector<PoolPtr<t_Expr>> expressions;
+    static constexpr e_StmtKind KIND = e_StmtKind::DISPLAY;
 
-    t_DisplayStmt(std::vector<PoolPtr<t_Expr>> expressions)
-        : expressions(std::move(expressions)) {}
-    
-    bool IsDisplay() const override { return true; }
-    t_DisplayStmt* AsDisplay() override { return this; }
+    ExprList expressions;
+
+    t_DisplayStmt(ExprList expressions)
+        : t_Stmt(KIND), expressions(std::move(expressions)) {}
 };
 
+// One variable of getin(a, b, ...)
+struct t_GetinTarget
+{
+    t_Symbol name;
+    t_Binding binding;
+};
+
+// Reads one line. A single target receives the whole line; with more
+// the line is split into fields (see SplitInputFields()).
 struct t_GetinStmt : public t_Stmt
 {
+    static constexpr e_StmtKind KIND = e_StmtKind::GETIN;
+
     t_Token keyword;
-    std::string variable_name;
+    ArenaVector<t_GetinTarget> targets;
 
     t_GetinStmt
     (
         t_Token keyword,
-        const std::string &variable_name
+        ArenaVector<t_GetinTarget> targets
     )
-        : keyword(keyword),
-          variable_name(variable_name) {}
-    
-    bool IsGetin() const override { return true; }
-    t_GetinStmt* AsGetin() override { return this; }
+        : t_Stmt(KIND),
+          keyword(keyword),
+          targets(std::move(targets)) {}
 };
 
 struct t_FunStmt : public t_Stmt
 {
-    std::string name;
-    std::vector<std::string> parameters;
+    static constexpr e_StmtKind KIND = e_StmtKind::FUNCTION;
+
+    t_Symbol name;
+    ArenaVector<t_Symbol> parameters;
     PoolPtr<t_Stmt> body;
+    uint32_t frame_size = 0; // parameters plus locals
+    // Set by the PurityChecker: where a MemoCache counts the calls of
+    // a pure function, -1 for any other
+    int32_t memo_slot = -1;
 
     t_FunStmt
     (
-        const std::string &name,
-        std::vector<std::string> parameters,
+        t_Symbol name,
+        ArenaVector<t_Symbol> parameters,
         PoolPtr<t_Stmt> body
     )
-        : name(name),
+        : t_Stmt(KIND),
+          name(name),
           parameters(std::move(parameters)),
           body(std::move(body)) {}
-    
-    bool IsFunction() const override { return true; }
-    t_FunStmt* AsFunction() override { return this; }
 };
 
 struct t_VarStmt : public t_Stmt
 {
-    std::string name;
+    static constexpr e_StmtKind KIND = e_StmtKind::VAR;
+
+    t_Symbol name;
     PoolPtr<t_Expr> initializer;
     bool is_const;
+    t_Binding binding;
+    bool is_redeclaration = false;
     
     t_VarStmt
     (
-        const std::string &name,
+        t_Symbol name,
         PoolPtr<t_Expr> initializer,
         bool is_const = false
     )
-        : name(name), 
+        : t_Stmt(KIND),
+          name(name), 
           initializer(std::move(initializer)),
           is_const(is_const) {}
-          
-    bool IsVar() const override { return true; }
-    t_VarStmt* AsVar() override { return this; }
 };
 
 struct t_BlockStmt : public t_Stmt
 {
-    std::vector<PoolPtr<t_Stmt>> statements;
+    static constexpr e_StmtKind KIND = e_StmtKind::BLOCK;
 
-    t_BlockStmt(std::vector<PoolPtr<t_Stmt>> statements)
-        : statements(std::move(statements)) {}
-    
-    bool IsBlock() const override { return true; }
-    t_BlockStmt* AsBlock() override { return this; }
+    StmtList statements;
+
+    t_BlockStmt(StmtList statements)
+        : t_Stmt(KIND), statements(std::move(statements)) {}
 };
 
 struct t_IfStmt : public t_Stmt
 {
+    static constexpr e_StmtKind KIND = e_StmtKind::IF;
+
     PoolPtr<t_Expr> condition;
     PoolPtr<t_Stmt> then_branch;
     PoolPtr<t_Stmt> else_branch;
@@ -357,21 +521,25 @@ struct t_IfStmt : public t_Stmt
         PoolPtr<t_Stmt> then_branch,
         PoolPtr<t_Stmt> else_branch
     )
-        : condition(std::move(condition)), 
+        : t_Stmt(KIND),
+          condition(std::move(condition)), 
           then_branch(std::move(then_branch)),
           else_branch(std::move(else_branch)) {}
-    
-    bool IsIf() const override { return true; }
-    t_IfStmt* AsIf() override { return this; }
 };
 
 struct t_ForStmt : public t_Stmt
 {
+    static constexpr e_StmtKind KIND = e_StmtKind::FOR;
+
     PoolPtr<t_Stmt> initializer;
     PoolPtr<t_Expr> condition;
     PoolPtr<t_Expr> increment;
     PoolPtr<t_Stmt> body;
 
+    // `parallel for`; the kernel is attached by PrepareParallelLoops()
+    bool is_parallel = false;
+    std::shared_ptr<const t_ParallelLoop> parallel;
+
     t_ForStmt
     (   
         PoolPtr<t_Stmt> initializer,
@@ -379,57 +547,67 @@ struct t_ForStmt : public t_Stmt
         PoolPtr<t_Expr> increment,
         PoolPtr<t_Stmt> body
     )
-        : initializer(std::move(initializer)),
+        : t_Stmt(KIND),
+          initializer(std::move(initializer)),
           condition(std::move(condition)),
           increment(std::move(increment)),
           body(std::move(body)) {}
-    
-    bool IsFor() const override { return true; }
-    t_ForStmt* AsFor() override { return this; }
 };
 
 struct t_BreakStmt : public t_Stmt
 {
+    static constexpr e_StmtKind KIND = e_StmtKind::BREAK;
+
     t_Token keyword;
 
     t_BreakStmt(t_Token keyword)
-        : keyword(keyword) {}
-     
-    bool IsBreak() const override { return true; }
-    t_BreakStmt* AsBreak() override { return this; }
+        : t_Stmt(KIND), keyword(keyword) {}
 };
 
 struct t_ContinueStmt : public t_Stmt
 {
+    static constexpr e_StmtKind KIND = e_StmtKind::CONTINUE;
+
     t_Token keyword;
 
     t_ContinueStmt(t_Token keyword)
-        : keyword(keyword) {}
-    
-    bool IsContinue() const override { return true; }
-    t_ContinueStmt* AsContinue() override { return this; }
+        : t_Stmt(KIND), keyword(keyword) {}
 };
 
 struct t_BenchmarkStmt : public t_Stmt
 {
+    static constexpr e_StmtKind KIND = e_StmtKind::BENCHMARK;
+
     PoolPtr<t_Stmt> body;
+    uint32_t iterations; // measured runs
+    uint32_t warmup;     // unmeasured runs before them
+    int line;
 
-    t_BenchmarkStmt(PoolPtr<t_Stmt> body)
-        : body(std::move(body)) {}
-    
-    bool IsBenchmark() const override { return true; }
-    t_BenchmarkStmt* AsBenchmark() override { return this; }
+    t_BenchmarkStmt
+    (
+        PoolPtr<t_Stmt> body,
+        uint32_t iterations = 1,
+        uint32_t warmup = 0,
+        int line = 0
+    )
+        : t_Stmt(KIND),
+          body(std::move(body)),
+          iterations(iterations),
+          warmup(warmup),
+          line(line) {}
 };
 
 struct t_ReturnStmt : public t_Stmt
 {
+    static constexpr e_StmtKind KIND = e_StmtKind::RETURN;
+
     PoolPtr<t_Expr> value;
+    // Set by the Resolver: `value` calls a function of the script and
+    // the engines may run that call in place of the returning frame
+    bool is_tail_call = false;
     
     t_ReturnStmt(PoolPtr<t_Expr> value)
-        : value(std::move(value)) {}
-    
-    bool IsReturn() const override { return true; }
-    t_ReturnStmt* AsReturn() override { return this; }
+        : t_Stmt(KIND), value(std::move(value)) {}
 };
 
 using StmtVariant = std::variant
@@ -460,139 +638,34 @@ using ExprVariant = std::variant
     t_PostfixExpr,
     t_CallExpr,
     t_TypeofExpr,
-    t_SizeofExpr  
+    t_SizeofExpr,
+    t_FormatStringExpr,
+    t_ArrayExpr,
+    t_IndexExpr,
+    t_IndexAssignExpr
 >; 
 
-namespace ast_internal 
-{
-    template<typename T> T* AsStmt(t_Stmt* stmt);
-    template<typename T> T* AsExpr(t_Expr* expr);
-}
-
-template<typename T>
-T* As(t_Expr* expr);
-
-template<typename T>
-T* As(t_Stmt* stmt);
-
-namespace ast_internal 
+namespace ast_internal
 {
-    template<typename T>
-    T* AsStmt(t_Stmt* stmt) 
+    // True when the KIND of every alternative is its index
+    template<typename... T>
+    constexpr bool KindsFollowOrder(const std::variant<T...>*)
     {
-        if (!stmt) return nullptr;
-        
-        if constexpr (std::is_same_v<T, t_BlockStmt>) 
-        {
-            return stmt->IsBlock() ? stmt->AsBlock() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_IfStmt>) 
-        {
-            return stmt->IsIf() ? stmt->AsIf() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_ForStmt>) 
-        {
-            return stmt->IsFor() ? stmt->AsFor() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_BreakStmt>) 
-        {
-            return stmt->IsBreak() ? stmt->AsBreak() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_ContinueStmt>) 
-        {
-            return stmt->IsContinue() ? stmt->AsContinue() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_VarStmt>) 
-        {
-            return stmt->IsVar() ? stmt->AsVar() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_DisplayStmt>) 
-        {
-            return stmt->IsDisplay() ? stmt->AsDisplay() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_GetinStmt>) 
-        {
-            return stmt->IsGetin() ? stmt->AsGetin() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_FunStmt>) 
-        {
-            return stmt->IsFunction() ? stmt->AsFunction() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_BenchmarkStmt>) 
-        {
-            return stmt->IsBenchmark() ? stmt->AsBenchmark() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_EmptyStmt>) 
-        {
-            return stmt->IsEmpty() ? stmt->AsEmpty() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_ExpressionStmt>) 
-        {
-            return stmt->IsExpression() ? stmt->AsExpression() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_ReturnStmt>) 
-        {
-            return stmt->IsReturn() ? stmt->AsReturn() : nullptr;
-        } 
-        else 
-        {
-            static_assert(sizeof(T) == 0, "Unsupported statement type");
-            return nullptr;
-        }
+        size_t index = 0;
+        return ((static_cast<size_t>(T::KIND) == index++) && ...);
     }
+}
 
-    template<typename T>
-    T* AsExpr(t_Expr* expr) 
-    {
-        if (!expr) return nullptr;
-        
-        if constexpr (std::is_same_v<T, t_BinaryExpr>) 
-        {
-            return expr->IsBinary() ? expr->AsBinary() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_LiteralExpr>) 
-        {
-            return expr->IsLiteral() ? expr->AsLiteral() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_UnaryExpr>) 
-        {
-            return expr->IsUnary() ? expr->AsUnary() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_GroupingExpr>) 
-        {
-            return expr->IsGrouping() ? expr->AsGrouping() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_VariableExpr>) 
-        {
-            return expr->IsVariable() ? expr->AsVariable() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_PrefixExpr>) 
-        {
-            return expr->IsPrefix() ? expr->AsPrefix() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_PostfixExpr>) 
-        {
-            return expr->IsPostfix() ? expr->AsPostfix() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_CallExpr>) 
-        {
-            return expr->IsCall() ? expr->AsCall() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_TypeofExpr>) 
-        {
-            return expr->IsTypeof() ? expr->AsTypeof() : nullptr;
-        } 
-        else if constexpr (std::is_same_v<T, t_SizeofExpr>)
-        {
-            return expr->IsSizeof() ? expr->AsSizeof() : nullptr;
-        } 
-        else 
-        {
-            static_assert(sizeof(T) == 0, "Unsupported expression type");
-            return nullptr;
-        }
-    }
-} 
+static_assert
+(
+    ast_internal::KindsFollowOrder(static_cast<const StmtVariant*>(nullptr)),
+    "e_StmtKind must list statements in StmtVariant order"
+);
+static_assert
+(
+    ast_internal::KindsFollowOrder(static_cast<const ExprVariant*>(nullptr)),
+    "e_ExprKind must list expressions in ExprVariant order"
+);
 
 template<typename T>
 T* As(t_Expr* expr) 
@@ -602,7 +675,7 @@ T* As(t_Expr* expr)
         std::is_base_of_v<t_Expr, T>, 
         "As<T>(t_Expr*) requires T derived from t_Expr"
     );
-    return ast_internal::AsExpr<T>(expr);
+    return expr && expr->kind == T::KIND ? static_cast<T*>(expr) : nullptr;
 }
 
 template<typename T>
@@ -613,5 +686,5 @@ T* As(t_Stmt* stmt)
         std::is_base_of_v<t_Stmt, T>, 
         "As<T>(t_Stmt*) requires T derived from t_Stmt"
     );
-    return ast_internal::AsStmt<T>(stmt);
+    return stmt && stmt->kind == T::KIND ? static_cast<T*>(stmt) : nullptr;
 }
\ No newline at end of file
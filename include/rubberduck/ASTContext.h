@@ -1,15 +1,22 @@
 #pragma once
 
-#include <rubberduck/MemoryPool.h>
+#include <rubberduck/Arena.h>
 #include <rubberduck/AST.h>
+#include <cstring>
+#include <cstdlib>
 #include <memory>
+#include <string_view>
+#include <vector>
 
-// RAII wrapper for managing the lifecycle of memory pools
+// Owns the arena the whole tree lives in: nodes, their child lists and
+// the text of literals, and the symbols of its names and strings. Must
+// outlive every PoolPtr created from it.
 class ASTContext
 {
 private:
-    std::unique_ptr<MemoryPool> m_StmtPool;
-    std::unique_ptr<MemoryPool> m_ExprPool;
+    std::unique_ptr<Arena> m_Arena;
+    SymbolTable m_Symbols;
+    size_t m_NodeCount = 0;
 
 public:
     ASTContext();
@@ -25,22 +32,72 @@ public:
     template<typename T, typename... Args>
     T* CreateStmt(Args&&... args)
     {
-        void* mem = m_StmtPool->Allocate();
+        static_assert(std::is_base_of_v<t_Stmt, T>);
+        void* mem = m_Arena->Allocate(sizeof(T), alignof(T));
         if (!mem)
         {
             return nullptr;
         }
+        m_NodeCount++;
         return new (mem) T(std::forward<Args>(args)...);
     }
 
     template<typename T, typename... Args>
     T* CreateExpr(Args&&... args)
     {
-        void* mem = m_ExprPool->Allocate();
+        static_assert(std::is_base_of_v<t_Expr, T>);
+        void* mem = m_Arena->Allocate(sizeof(T), alignof(T));
         if (!mem)
         {
             return nullptr;
         }
+        m_NodeCount++;
         return new (mem) T(std::forward<Args>(args)...);
     }
-};
\ No newline at end of file
+
+    // Empty list whose storage comes from the arena
+    template<typename T>
+    ArenaVector<T> CreateList()
+    {
+        return ArenaVector<T>(ArenaAllocator<T>(m_Arena.get()));
+    }
+
+    // Moves items[first...] into an arena list of exactly that size and
+    // removes them from `items`, so one scratch vector can collect the
+    // children of nested lists
+    template<typename T>
+    ArenaVector<T> CreateList(std::vector<T>& items, size_t first = 0)
+    {
+        ArenaVector<T> list = CreateList<T>();
+        list.reserve(items.size() - first);
+        for (size_t i = first; i < items.size(); i++)
+        {
+            list.push_back(std::move(items[i]));
+        }
+        items.resize(first);
+        return list;
+    }
+
+    // Copy of `text` that lives as long as the tree
+    std::string_view CopyString(std::string_view text)
+    {
+        if (text.empty())
+        {
+            return std::string_view();
+        }
+        char* mem = static_cast<char*>(m_Arena->Allocate(text.size(), 1));
+        if (!mem)
+        {
+            // Same as a container running out of memory in the arena
+            std::abort();
+        }
+        std::memcpy(mem, text.data(), text.size());
+        return std::string_view(mem, text.size());
+    }
+
+    const Arena& GetArena() const { return *m_Arena; }
+    SymbolTable& Symbols() { return m_Symbols; }
+    const SymbolTable& Symbols() const { return m_Symbols; }
+    // Statements and expressions created since the last Reset()
+    size_t NodeCount() const { return m_NodeCount; }
+};
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Bump-pointer arena for everything the parser builds: nodes, their
+// child arrays and their string data.
+//
+// Each allocation takes exactly the bytes (and alignment) it asks
+// for from the current chunk. When a chunk runs out, the next one is
+// twice as large, up to MAX_CHUNK_SIZE, so a big script needs only a
+// handful of mallocs. Requests larger than a chunk get a chunk of
+// their own.
+//
+// Memory is only reclaimed all at once by Reset() or the destructor.
+// Deallocate() can return the most recent allocation, which lets a
+// vector that grows at the top of the arena reuse its own space;
+// anything else it is given is counted as wasted.
+class Arena
+{
+private:
+    struct t_Chunk
+    {
+        t_Chunk* next;
+        size_t size; // usable bytes after the header
+    };
+
+    static constexpr size_t FIRST_CHUNK_SIZE = 4 * 1024;
+    static constexpr size_t MAX_CHUNK_SIZE = 1024 * 1024;
+
+    t_Chunk* m_Chunks;
+    char* m_Cursor;
+    char* m_End;
+    size_t m_NextChunkSize;
+
+    size_t m_BytesUsed;
+    size_t m_BytesWasted;
+    size_t m_BytesReserved;
+    size_t m_ChunkCount;
+
+    void* AllocateSlow(size_t size, size_t alignment);
+    bool AddChunk(size_t min_size);
+
+public:
+    Arena();
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // nullptr when the system is out of memory
+    void* Allocate(size_t size, size_t alignment)
+    {
+        uintptr_t cursor = reinterpret_cast<uintptr_t>(m_Cursor);
+        uintptr_t aligned = (cursor + alignment - 1) & ~(alignment - 1);
+        if 
+        (
+            m_Cursor                                     && 
+            aligned + size <= reinterpret_cast<uintptr_t>(m_End)
+        )
+        {
+            m_BytesWasted += aligned - cursor;
+            m_BytesUsed += size;
+            m_Cursor = reinterpret_cast<char*>(aligned + size);
+            return reinterpret_cast<void*>(aligned);
+        }
+        return AllocateSlow(size, alignment);
+    }
+
+    void Deallocate(void* ptr, size_t size)
+    {
+        if (!ptr)
+        {
+            return;
+        }
+        if (static_cast<char*>(ptr) + size == m_Cursor)
+        {
+            m_Cursor = static_cast<char*>(ptr);
+            m_BytesUsed -= size;
+            return;
+        }
+        m_BytesUsed -= size;
+        m_BytesWasted += size;
+    }
+
+    // Frees every chunk but the newest one, which is kept for reuse.
+    // Invalidates all pointers handed out before.
+    void Reset();
+
+    // Bytes handed out and still in use
+    size_t BytesUsed() const { return m_BytesUsed; }
+    // Alignment padding, unusable chunk tails and released allocations
+    size_t BytesWasted() const { return m_BytesWasted; }
+    // Bytes obtained from malloc, not counting chunk headers
+    size_t BytesReserved() const { return m_BytesReserved; }
+    size_t ChunkCount() const { return m_ChunkCount; }
+};
+
+// Standard allocator over an Arena, so containers inside AST nodes
+// keep their storage next to the nodes. A default-constructed
+// allocator has no arena and uses the global heap, which keeps such
+// containers usable outside the parser.
+template<typename T>
+class ArenaAllocator
+{
+private:
+    Arena* m_Arena;
+
+    template<typename U>
+    friend class ArenaAllocator;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() noexcept : m_Arena(nullptr) {}
+
+    explicit ArenaAllocator(Arena* arena) noexcept : m_Arena(arena) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : m_Arena(other.m_Arena) {}
+
+    T* allocate(size_t count)
+    {
+        if (!m_Arena)
+        {
+            return std::allocator<T>().allocate(count);
+        }
+
+        void* mem = m_Arena->Allocate(count * sizeof(T), alignof(T));
+        if (!mem)
+        {
+            // Containers have no way to report this; std::allocator
+            // would end the program as well
+            std::abort();
+        }
+        return static_cast<T*>(mem);
+    }
+
+    void deallocate(T* ptr, size_t count) noexcept
+    {
+        if (!m_Arena)
+        {
+            std::allocator<T>().deallocate(ptr, count);
+            return;
+        }
+        m_Arena->Deallocate(ptr, count * sizeof(T));
+    }
+
+    Arena* GetArena() const noexcept { return m_Arena; }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept
+    {
+        return m_Arena == other.m_Arena;
+    }
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <rubberduck/ErrorHandling.h>
+#include <rubberduck/Token.h>
+#include <rubberduck/Value.h>
+
+// What both engines do with array values, so that they agree on every
+// result and every error message. None of these set a line number.
+
+// `[a, b, ...]`: all numbers or all strings; `[]` is a number array
+Expected<t_Value, t_ErrorInfo> MakeArray
+(
+    const t_Value *elements,
+    size_t count,
+    ArrayPool& arrays
+);
+
+// `array[index]`
+Expected<t_Value, t_ErrorInfo> GetElement
+(
+    const t_Value& array,
+    const t_Value& index
+);
+
+// `array[index] = value`; yields the value
+Expected<t_Value, t_ErrorInfo> SetElement
+(
+    const t_Value& array,
+    const t_Value& index,
+    const t_Value& value
+);
+
+// `sizeof(value)`: elements of an array, characters of a string
+Expected<t_Value, t_ErrorInfo> SizeOf(const t_Value& value);
+
+// `+ - * / %` with an array on either side or both: the operation is
+// applied to every element (and its partner, for two arrays of the
+// same size) and yields a new array. Anything else is the usual
+// "Cannot perform arithmetic operation".
+Expected<t_Value, t_ErrorInfo> ArrayArithmetic
+(
+    const t_Value& left,
+    e_TokenType op,
+    const t_Value& right,
+    ArrayPool& arrays
+);
+
+// The vectorized kernels behind the builtins. Sums run over several
+// lanes at once and combine them in a fixed order, so the result is
+// the same on every machine but may differ in the last bits from
+// adding the elements one by one.
+double SumNumbers(const double *values, size_t count);
+double DotNumbers(const double *left, const double *right, size_t count);
+
+// NaN elements are skipped; false if there are only NaNs, or none
+bool MinNumber(const double *values, size_t count, double& result);
+bool MaxNumber(const double *values, size_t count, double& result);
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <rubberduck/Benchmark.h>
+#include <rubberduck/CompiledScript.h>
+#include <rubberduck/ErrorHandling.h>
+
+// How every script of a batch is run (--batch)
+struct t_BatchOptions
+{
+    t_CompileOptions compile;
+    bool use_vm = true;
+    bool use_closures = false; // for the interpreter, --engine=closure
+    bool cache = false; // --cache, for the VM only
+    e_BenchmarkFormat benchmark_format = e_BenchmarkFormat::TEXT;
+    size_t threads = 0; // 0 uses every core
+    size_t max_call_depth = DEFAULT_MAX_CALL_DEPTH;
+};
+
+// What one script of a batch did. Times are in nanoseconds; compiling
+// includes reading the file, or loading it from the cache on a hit.
+struct t_BatchResult
+{
+    std::string path;
+    std::string output; // empty once written by RunBatch()
+    bool failed = false;
+    t_ErrorInfo error;
+    int64_t compile_ns = 0;
+    int64_t run_ns = 0;
+};
+
+// The scripts of a batch: every .rd file below `target` in path order
+// when it is a directory, otherwise the lines of a manifest file, one
+// path per line relative to the manifest. Blank lines and lines
+// starting with '#' are skipped.
+Expected<std::vector<std::string>, std::string> CollectBatchScripts
+(
+    const std::string& target
+);
+
+// Runs every script in its own process-like sandbox: its own compiled
+// script, engine and output stream, and no input, so `getin` fails.
+// Scripts are scheduled on a thread pool of their own, separate from
+// the one `parallel for` runs on.
+//
+// The output of each script is written to `output` under a
+// "=== path ===" header, in the order of `paths`, as soon as it and
+// every script before it have finished.
+std::vector<t_BatchResult> RunBatch
+(
+    const std::vector<std::string>& paths,
+    const t_BatchOptions& options,
+    std::ostream& output
+);
+
+// One line per script with its times, the error of every failed one,
+// and the totals
+void WriteBatchSummary
+(
+    const std::vector<t_BatchResult>& results,
+    int64_t wall_ns,
+    std::ostream& stream
+);
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+// How `benchmark` statements report their results (--bench-format)
+enum class e_BenchmarkFormat
+{
+    TEXT, // readable summary with a unit per value
+    JSON, // one object per line, times in nanoseconds
+    CSV   // a header before the first row, times in nanoseconds
+};
+
+// Timings of the measured runs of one benchmark, in nanoseconds
+struct t_BenchmarkStats
+{
+    int line = 0;
+    uint32_t runs = 0;
+    uint32_t warmup = 0;
+    double min = 0.0;
+    double mean = 0.0;
+    double median = 0.0;
+    double p99 = 0.0;   // nearest rank
+    double stddev = 0.0; // sample standard deviation, 0 for one run
+};
+
+// Sorts `samples` in place
+t_BenchmarkStats ComputeBenchmarkStats
+(
+    std::vector<int64_t>& samples,
+    int line,
+    uint32_t warmup
+);
+
+// Shared by both engines so they report in exactly the same format.
+// Writes to the engine's output stream, after the engine has flushed
+// its own output.
+class BenchmarkReporter
+{
+private:
+    e_BenchmarkFormat m_Format = e_BenchmarkFormat::TEXT;
+    bool m_HeaderWritten = false;
+
+public:
+    void SetFormat(e_BenchmarkFormat format);
+    void Report(const t_BenchmarkStats& stats, std::ostream& stream);
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <rubberduck/ErrorHandling.h>
+#include <rubberduck/Symbol.h>
+#include <rubberduck/Value.h>
+
+// Functions every script can call without declaring them. The Linker
+// binds a call to one when the script declares no function of that
+// name, so a script that has its own `sum` keeps calling it.
+enum class e_Builtin : uint8_t
+{
+    NONE,
+    SUM,   // sum(a): the sum of a number array
+    MIN,   // min(a), max(a): its smallest or largest element, NaN
+    MAX,   //   elements skipped
+    DOT,   // dot(a, b): the sum of a[i] * b[i], equal sizes
+    SORT,  // sort(a): sorts a in place, NaN last, and yields it
+    ARRAY, // array(n, fill): n copies of a number or a string
+    PUSH   // push(a, x): appends x to a and yields a
+};
+
+constexpr uint32_t MAX_BUILTIN_ARITY = 2;
+
+// NONE when `name` is not a builtin
+e_Builtin FindBuiltin(std::string_view name);
+
+uint32_t BuiltinArity(e_Builtin builtin);
+
+// Runs a builtin on BuiltinArity() arguments. New arrays come from
+// `arrays`. Errors carry no line; the caller knows where the call is.
+Expected<t_Value, t_ErrorInfo> CallBuiltin
+(
+    e_Builtin builtin,
+    const t_Value *arguments,
+    ArrayPool& arrays
+);
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <rubberduck/Value.h>
+
+// Every instruction is one 32-bit word: the opcode lives in the low
+// 8 bits and a single unsigned operand in the remaining 24 bits.
+#define RD_OPCODES(X)                                                   \
+    X(CONSTANT)         /* push constants[arg]                    */   \
+    X(NIL)              /* push nil                               */   \
+    X(TRUE)             /* push true                              */   \
+    X(FALSE)            /* push false                             */   \
+    X(POP)              /* drop top                               */   \
+    X(POPN)             /* drop arg values                        */   \
+    X(DUP)              /* duplicate top                          */   \
+    X(GET_LOCAL)        /* push frame slot arg                    */   \
+    X(SET_LOCAL)        /* store top into slot arg, keep top      */   \
+    X(GET_GLOBAL)       /* push global arg                        */   \
+    X(SET_GLOBAL)       /* store top into global arg, keep top    */   \
+    X(DEFINE_GLOBAL)    /* pop into global arg, marking it live   */   \
+    X(INC_LOCAL)        /* slot arg += 1                          */   \
+    X(DEC_LOCAL)        /* slot arg -= 1                          */   \
+    X(INC_GLOBAL)       /* global arg += 1                        */   \
+    X(DEC_GLOBAL)       /* global arg -= 1                        */   \
+    X(INCREMENT)        /* top += 1                               */   \
+    X(DECREMENT)        /* top -= 1                               */   \
+    X(ADD)                                                             \
+    X(SUBTRACT)                                                        \
+    X(MULTIPLY)                                                        \
+    X(DIVIDE)                                                          \
+    X(MODULO)                                                          \
+    X(EQUAL)                                                           \
+    X(NOT_EQUAL)                                                       \
+    X(GREATER)                                                         \
+    X(GREATER_EQUAL)                                                   \
+    X(LESS)                                                            \
+    X(LESS_EQUAL)                                                      \
+    X(NEGATE)                                                          \
+    X(NOT)                                                             \
+    X(TO_BOOL)          /* replace top with its truthiness        */   \
+    X(MAKE_ARRAY)       /* pop arg values, push an array of them  */   \
+    X(GET_INDEX)        /* pop index and array, push the element  */   \
+    X(PEEK_INDEX)       /* push the element, keep array and index */   \
+    X(SET_INDEX)        /* pop value, index, array; store; push   */   \
+                        /* the value                              */   \
+    X(SIZEOF)           /* replace top with its sizeof()          */   \
+    X(JUMP)             /* ip = arg                               */   \
+    X(JUMP_IF_FALSE)    /* pop, ip = arg if falsey                */   \
+    X(JUMP_IF_TRUE)     /* pop, ip = arg if truthy                */   \
+    X(PARALLEL_FOR)     /* run parallel_loops[arg], then skip the */   \
+                        /* JUMP after it if a guard failed        */   \
+    X(LOOP_KERNEL)      /* run loop_kernels[arg], then skip the   */   \
+                        /* JUMP after it if it did not finish     */   \
+    X(CALL)             /* call function arg                      */   \
+    X(TAIL_CALL)        /* call function arg in place of the      */   \
+                        /* running frame                          */   \
+    X(CALL_BUILTIN)     /* pop the arguments of e_Builtin arg,    */   \
+                        /* push its result                        */   \
+    X(RETURN)           /* pop result, leave frame                */   \
+    X(OUTPUT)           /* pop and write display form             */   \
+    X(OUTPUT_TEXT)      /* write constants[arg]                   */   \
+    X(FORMAT)           /* pop arg values, push concatenation     */   \
+    X(READ_INPUT)       /* read a line, split it into arg fields  */   \
+    X(GETIN_LOCAL)      /* next input field into slot arg         */   \
+    X(GETIN_GLOBAL)     /* next input field into global arg       */   \
+    X(BENCHMARK_BEGIN)  /* start benchmarks[arg]                  */   \
+    X(BENCHMARK_END)    /* end a run, repeat the body if any left */   \
+    X(BENCHMARK_EXIT)   /* end a run and the benchmark around it  */   \
+    X(RUNTIME_ERROR)    /* raise constants[arg] as runtime error  */
+
+enum class e_OpCode : uint8_t
+{
+#define RD_OPCODE_ENUM(name) name,
+    RD_OPCODES(RD_OPCODE_ENUM)
+#undef RD_OPCODE_ENUM
+    COUNT
+};
+
+constexpr uint32_t MAX_OPERAND = (1u << 24) - 1;
+
+inline uint32_t EncodeInstruction(e_OpCode op, uint32_t arg)
+{
+    return static_cast<uint32_t>(op) | (arg << 8);
+}
+
+inline e_OpCode DecodeOp(uint32_t instruction)
+{
+    return static_cast<e_OpCode>(instruction & 0xFF);
+}
+
+inline uint32_t DecodeArg(uint32_t instruction)
+{
+    return instruction >> 8;
+}
+
+const char* OpCodeName(e_OpCode op);
+
+// Maps an instruction offset to the variable it names, so that
+// runtime errors can mention the variable without a lookup table
+// on the hot path.
+struct t_DebugName
+{
+    uint32_t offset;
+    const std::string* name;
+};
+
+struct t_Chunk
+{
+    std::vector<uint32_t> code;
+    std::vector<int> lines;
+    std::vector<t_Value> constants;
+    std::vector<t_DebugName> debug_names;
+};
+
+struct t_FunctionProto
+{
+    std::string name;
+    uint32_t arity = 0;
+    uint32_t max_stack = 0;
+    int32_t memo_slot = -1; // of a pure function, see PurityChecker
+    t_Chunk chunk;
+};
+
+// Repetition counts of one `benchmark` statement
+struct t_BenchmarkInfo
+{
+    uint32_t iterations;
+    uint32_t warmup;
+    int line;
+};
+
+struct t_LoopKernel;
+struct t_ParallelLoop;
+
+// Where an outside variable of a parallel loop lives in the VM
+struct t_VariableSlot
+{
+    bool is_local;
+    uint32_t index; // frame slot or global
+};
+
+// A `parallel for`, compiled by PrepareParallelLoops(). Each variable
+// of the kernel has the slot at the same position.
+struct t_ParallelFor
+{
+    std::shared_ptr<const t_ParallelLoop> loop;
+    std::vector<t_VariableSlot> slots;
+};
+
+// A sequential for-loop that LoopCompiler lowered to a kernel, with
+// the slots of its variables like a t_ParallelFor
+struct t_KernelFor
+{
+    std::shared_ptr<const t_LoopKernel> kernel;
+    std::vector<t_VariableSlot> slots;
+};
+
+// Output of the Compiler: a main function plus the hoisted top-level
+// functions. String constants are interned into the program's pool.
+struct t_Program
+{
+    t_FunctionProto main;
+    std::vector<t_FunctionProto> functions;
+    std::vector<t_BenchmarkInfo> benchmarks;
+    std::vector<t_ParallelFor> parallel_loops;
+    std::vector<t_KernelFor> loop_kernels;
+    std::vector<const std::string*> global_names;
+    StringPool strings;
+};
+
+// Writes a human readable listing of the program to stdout
+void Disassemble(const t_Program& program);
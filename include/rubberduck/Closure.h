@@ -0,0 +1,293 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <rubberduck/AST.h>
+#include <rubberduck/Arena.h>
+#include <rubberduck/ErrorHandling.h>
+#include <rubberduck/Value.h>
+
+class Interpreter;
+struct t_ExprClosure;
+struct t_StmtClosure;
+
+using ExprFunction = Expected<t_Value, t_ErrorInfo> (*)
+(
+    Interpreter& interpreter,
+    const t_ExprClosure& closure
+);
+using StmtFunction = Expected<int, t_ErrorInfo> (*)
+(
+    Interpreter& interpreter,
+    const t_StmtClosure& closure
+);
+
+// An expression lowered for `--engine=closure`: the function that
+// evaluates exactly this kind of node, with its children and operands
+// bound in advance. Which operands are set depends on `run`.
+struct t_ExprClosure
+{
+    ExprFunction run;
+    t_Expr* node;                // for error messages
+    const t_ExprClosure* left;   // first operand
+    const t_ExprClosure* right;  // second operand
+    const t_ExprClosure* value;  // stored by an index assignment
+    const t_ExprClosure* const* operands; // arguments, elements, segments
+    uint32_t operand_count;
+    t_Binding binding;           // of the variable read or written
+    e_TokenType op;              // arithmetic of a compound assignment
+    t_Value constant;            // of a literal
+    const t_StmtClosure* body;   // of the function a call runs
+};
+
+// A statement lowered the same way
+struct t_StmtClosure
+{
+    StmtFunction run;
+    t_Stmt* node;
+    const t_ExprClosure* expr;      // condition, value or initializer
+    const t_ExprClosure* increment; // of a for-loop
+    const t_StmtClosure* first;     // then branch, loop initializer
+    const t_StmtClosure* second;    // else branch, loop or bench body
+    const t_StmtClosure* const* statements; // of a block
+    uint32_t count;
+    const t_ExprClosure* const* expressions; // of a display
+};
+
+// Lowers a resolved script to closures, once per script, so that
+// running it never switches on a node kind again: every closure calls
+// the functions of its children directly. Literals are converted and
+// interned, variables bound to their slot, calls to the body of their
+// function, and binary expressions of the NUMBER form get a function
+// per operator.
+//
+// The closures live in an arena owned by the compiler and point into
+// the tree, which must outlive them. They run on the state of the
+// Interpreter: frames, globals, output, loop kernels and benchmarks
+// all behave exactly as in the tree-walker.
+class ClosureCompiler
+{
+private:
+    Arena m_Arena;
+    const SymbolTable* m_Symbols = nullptr;
+    // Text of literals that have no symbol. Kept apart from the pool
+    // of the Interpreter, which is cleared on every run.
+    StringPool m_Strings;
+    uint64_t m_Script = 0; // id of the script lowered last, 0 if none
+    std::unordered_map<const t_FunStmt*, t_StmtClosure*> m_Bodies;
+    const t_StmtClosure* const* m_Main = nullptr;
+
+    // Aborts when the arena cannot grow
+    void* Allocate(size_t size, size_t alignment);
+    template<typename T>
+    T* New();
+    const t_ExprClosure** NewList(uint32_t count);
+
+    const t_ExprClosure* LowerExpression(t_Expr* expr);
+    const t_ExprClosure* LowerBinary(t_BinaryExpr* binary);
+    const t_ExprClosure* LowerCall(t_CallExpr* call);
+    const t_StmtClosure* LowerStatement(t_Stmt* stmt);
+    const t_ExprClosure* const* LowerList
+    (
+        const ExprList& expressions,
+        uint32_t& count
+    );
+
+    // One function per closure kind, defined next to each other in
+    // Closure.cpp; they reach into the Interpreter as its friend
+    static Expected<t_Value, t_ErrorInfo> Constant
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> ReadLocal
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> ReadGlobal
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> FormatString
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> Negate
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> Not
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> Increment
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    template<e_TokenType OP>
+    static Expected<t_Value, t_ErrorInfo> NumberBinary
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    template<e_TokenType OP>
+    static Expected<t_Value, t_ErrorInfo> NumberAssign
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> Arithmetic
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> Compare
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> And
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> Or
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> Assign
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> Call
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> Builtin
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> Array
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> Index
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> IndexAssign
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    static Expected<t_Value, t_ErrorInfo> Sizeof
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+    // Kinds without a closure of their own go through the tree-walker
+    static Expected<t_Value, t_ErrorInfo> Walk
+    (
+        Interpreter& in,
+        const t_ExprClosure& c
+    );
+
+    static Expected<int, t_ErrorInfo> Block
+    (
+        Interpreter& in,
+        const t_StmtClosure& c
+    );
+    static Expected<int, t_ErrorInfo> If
+    (
+        Interpreter& in,
+        const t_StmtClosure& c
+    );
+    static Expected<int, t_ErrorInfo> For
+    (
+        Interpreter& in,
+        const t_StmtClosure& c
+    );
+    static Expected<int, t_ErrorInfo> Var
+    (
+        Interpreter& in,
+        const t_StmtClosure& c
+    );
+    static Expected<int, t_ErrorInfo> Display
+    (
+        Interpreter& in,
+        const t_StmtClosure& c
+    );
+    static Expected<int, t_ErrorInfo> Benchmark
+    (
+        Interpreter& in,
+        const t_StmtClosure& c
+    );
+    static Expected<int, t_ErrorInfo> Expression
+    (
+        Interpreter& in,
+        const t_StmtClosure& c
+    );
+    static Expected<int, t_ErrorInfo> Return
+    (
+        Interpreter& in,
+        const t_StmtClosure& c
+    );
+    // A `return f(...)` the Resolver marked as a tail call
+    static Expected<int, t_ErrorInfo> TailCall
+    (
+        Interpreter& in,
+        const t_StmtClosure& c
+    );
+    static Expected<int, t_ErrorInfo> Nothing
+    (
+        Interpreter& in,
+        const t_StmtClosure& c
+    );
+    static Expected<int, t_ErrorInfo> WalkStatement
+    (
+        Interpreter& in,
+        const t_StmtClosure& c
+    );
+
+public:
+    ClosureCompiler() = default;
+    ClosureCompiler(const ClosureCompiler&) = delete;
+    ClosureCompiler& operator=(const ClosureCompiler&) = delete;
+
+    // Drops whatever was lowered before, unless `script` is the id of
+    // the CompiledScript lowered last; the tree is then not read
+    // again. A `script` of 0 has no id and is always lowered.
+    void Lower
+    (
+        const StmtList& statements,
+        const SymbolTable& symbols,
+        uint64_t script
+    );
+
+    // One per top-level statement of the script, in order
+    const t_StmtClosure* const* Main() const { return m_Main; }
+
+    // nullptr for a function declared below the top level
+    const t_StmtClosure* Body(const t_FunStmt* fun_stmt) const;
+
+    static Expected<int, t_ErrorInfo> Run
+    (
+        Interpreter& in,
+        const t_StmtClosure& closure
+    )
+    {
+        return closure.run(in, closure);
+    }
+};
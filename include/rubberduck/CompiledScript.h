@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <rubberduck/AST.h>
+#include <rubberduck/ASTContext.h>
+#include <rubberduck/Bytecode.h>
+#include <rubberduck/ErrorHandling.h>
+#include <rubberduck/Resolver.h>
+#include <rubberduck/Stats.h>
+
+// How a script is compiled; the command line equivalents are -O0/-O1,
+// --strict-fp and --engine
+struct t_CompileOptions
+{
+    bool optimize = true;
+    bool strict_fp = false;
+    bool bytecode = true; // also lower the tree to a t_Program
+};
+
+// Entry point of the library for embedders: a script taken through
+// every static pass once (lexing, parsing, linking, optimizing,
+// resolving, compiling `parallel for` and, with `bytecode`, lowering
+// to a t_Program), ready to be run any number of times.
+//
+// A compiled script is never modified after Compile(). Any number of
+// Interpreter or VM instances may run it at the same time, on any
+// threads; each instance keeps all of its run state to itself and
+// writes to the streams it was given.
+//
+//     auto compiled = CompiledScript::Compile(source);
+//     Interpreter interpreter;
+//     interpreter.SetOutput(stream);
+//     interpreter.Interpret(*compiled.Value());
+class CompiledScript
+{
+private:
+    // Declared first so that it is destroyed after the tree
+    ASTContext m_Context;
+    StmtList m_Statements;
+    t_ResolvedScript m_Resolved;
+    t_Program m_Program;
+    t_CompileOptions m_Options;
+    t_CompileStats m_Stats;
+    uint64_t m_Id = 0;
+
+public:
+    CompiledScript() = default;
+
+    // Non-copyable: the tree points into the context
+    CompiledScript(const CompiledScript&) = delete;
+    CompiledScript& operator=(const CompiledScript&) = delete;
+
+    // `source` is only read during the call. The first error of any
+    // pass is returned; nothing is written to stdout or stderr.
+    static Expected<std::shared_ptr<const CompiledScript>, t_ErrorInfo>
+    Compile
+    (
+        std::string_view source,
+        const t_CompileOptions& options = t_CompileOptions()
+    );
+
+    const StmtList& Statements() const { return m_Statements; }
+    const t_ResolvedScript& Resolved() const { return m_Resolved; }
+    const t_CompileOptions& Options() const { return m_Options; }
+    // Names of the tree's symbols, and the text of its string literals
+    const SymbolTable& Symbols() const { return m_Context.Symbols(); }
+    // Times and sizes of the compile, for --stats
+    const t_CompileStats& Stats() const { return m_Stats; }
+    // Never 0 and never the same for two scripts compiled by the
+    // process, even when one takes the address of another that was
+    // freed. Keys what an engine derives from the script and reuses.
+    uint64_t Id() const { return m_Id; }
+
+    // For the VM; nullptr unless compiled with `bytecode`
+    const t_Program* Program() const
+    {
+        return m_Options.bytecode ? &m_Program : nullptr;
+    }
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <rubberduck/AST.h>
+#include <rubberduck/Bytecode.h>
+#include <rubberduck/ErrorHandling.h>
+#include <rubberduck/LoopKernel.h>
+
+// Lowers the statements produced by Parser::Parse() into bytecode.
+//
+// Scoping rules of the compiled program:
+//   - `auto` at the top level of the script declares a global
+//   - every other declaration is a local in the enclosing block
+//   - functions see their parameters, their own locals and globals;
+//     locals of the caller are never visible inside a callee
+class Compiler
+{
+private:
+    struct t_Local
+    {
+        t_Symbol name;
+        int depth;
+        bool is_const;
+    };
+
+    struct t_LoopContext
+    {
+        size_t local_count;
+        size_t benchmark_depth;
+        std::vector<size_t> break_jumps;
+        std::vector<size_t> continue_jumps;
+    };
+
+    struct t_FunctionState
+    {
+        t_FunctionProto* proto;
+        std::vector<t_Local> locals;
+        std::vector<t_LoopContext> loops;
+        int scope_depth = 0;
+        size_t benchmark_depth = 0;
+        uint32_t stack_depth = 0;
+        bool is_main = false;
+    };
+
+    struct t_GlobalInfo
+    {
+        uint32_t slot;
+        bool is_const;
+    };
+
+    // Where a name resolved to
+    struct t_Resolution
+    {
+        bool is_local;
+        uint32_t index;
+        bool is_const;
+    };
+
+    const SymbolTable& m_Symbols; // of the script
+    t_Program* m_Program;
+    t_FunctionState* m_State;
+    std::unordered_map<t_Symbol, t_GlobalInfo> m_Globals;
+    std::unordered_map<t_Symbol, uint32_t> m_FunctionIndex;
+    std::vector<t_FunStmt*> m_FunctionDecls;
+    LoopCompiler m_LoopCompiler; // for LOOP_KERNEL
+    int m_Line;
+    bool m_Failed;
+    t_ErrorInfo m_Error;
+
+    // Emission helpers
+    size_t Emit(e_OpCode op, uint32_t arg = 0);
+    size_t EmitJump(e_OpCode op);
+    void PatchJump(size_t offset);
+    void PatchJumpTo(size_t offset, size_t target);
+    void EmitLoop(size_t target);
+    void EmitConstant(const t_Value& value);
+    void EmitError(const std::string& message);
+    uint32_t AddConstant(const t_Value& value);
+    uint32_t AddStringConstant(std::string_view text);
+    void AddDebugName(std::string_view name);
+    void Fail(const std::string& message);
+    size_t CurrentOffset() const;
+
+    // Scope helpers
+    void BeginScope();
+    void EndScope();
+    void PopLocalsAbove(size_t local_count);
+    t_Resolution Resolve(t_Symbol name);
+    uint32_t GlobalSlot(t_Symbol name);
+    bool IsDeclaredInCurrentScope(t_Symbol name) const;
+    // Where each variable of `kernel` lives at the current point
+    std::vector<t_VariableSlot> KernelSlots(const t_LoopKernel& kernel);
+
+    // Statements
+    void CompileStatement(t_Stmt *stmt);
+    void CompileScopedStatement(t_Stmt *stmt);
+    void CompileBlock(t_BlockStmt *block);
+    void CompileIf(t_IfStmt *if_stmt);
+    void CompileFor(t_ForStmt *for_stmt);
+    void CompileVar(t_VarStmt *var_stmt);
+    void CompileDisplay(t_DisplayStmt *display_stmt);
+    void CompileGetin(t_GetinStmt *getin_stmt);
+    void CompileBenchmark(t_BenchmarkStmt *benchmark_stmt);
+    void CompileReturn(t_ReturnStmt *return_stmt);
+    void CompileBreak();
+    void CompileContinue();
+    void CompileFunction(t_FunStmt *fun_stmt, t_FunctionProto& proto);
+
+    // Expressions
+    void CompileExpression(t_Expr *expr);
+    void CompileDiscarded(t_Expr *expr);
+    void CompileLiteral(t_LiteralExpr *literal);
+    void CompileFormatString(t_FormatStringExpr *format, bool to_output);
+    void CompileBinary(t_BinaryExpr *binary);
+    void CompileAssignment(t_BinaryExpr *binary);
+    void CompileIndexAssignment(t_IndexAssignExpr *assign);
+    void CompileLogical(t_BinaryExpr *binary);
+    void CompileUnary(t_UnaryExpr *unary);
+    void CompileIncrement
+    (
+        t_Expr *operand,
+        e_TokenType op,
+        bool is_prefix,
+        bool discard
+    );
+    // A tail call reuses the frame of the function that returns it
+    void CompileCall(t_CallExpr *call, bool is_tail_call = false);
+    void EmitGet(const t_Resolution& resolution);
+    void EmitSet(const t_Resolution& resolution, t_Symbol name);
+
+public:
+    explicit Compiler(const SymbolTable& symbols);
+
+    // Keeps every loop kernel in its exact order of operations: no
+    // vector loops, no closed forms (--strict-fp)
+    void SetStrictFloatingPoint(bool strict)
+    {
+        m_LoopCompiler.SetStrictFloatingPoint(strict);
+    }
+
+    Expected<int, t_ErrorInfo> Compile
+    (
+        const StmtList &statements,
+        t_Program& program
+    );
+};
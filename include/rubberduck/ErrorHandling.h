@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <iosfwd>
 #include <string>
 #include <variant>
 #include <vector>
@@ -11,7 +13,8 @@ enum class e_ErrorType
     LEXING_ERROR,
     PARSING_ERROR,
     RUNTIME_ERROR,
-    TYPE_ERROR
+    TYPE_ERROR,
+    COMPILE_ERROR
 };
 
 // Error information structure
@@ -88,4 +91,22 @@ public:
 // Convenience type aliases
 using ParsingResult = Expected<std::vector<t_Token>, t_ErrorInfo>;
 using InterpretationResult = Expected<int, t_ErrorInfo>; 
-void ReportError(const t_ErrorInfo& error);
\ No newline at end of file
+
+// Calls the engines let a script nest before reporting a stack
+// overflow, unless told otherwise (--max-depth)
+constexpr size_t DEFAULT_MAX_CALL_DEPTH = 1 << 14;
+
+// Gives an error raised without a line of its own, such as a type
+// mismatch from PerformArithmetic(), the line of the operator or the
+// statement it stopped, as the VM reports it
+inline void AddLine(t_ErrorInfo& error, int line)
+{
+    if (error.line == 0)
+    {
+        error.line = line;
+    }
+}
+
+// Writes "[Type] message at line L, column C" to std::cerr or `stream`
+void ReportError(const t_ErrorInfo& error);
+void ReportError(const t_ErrorInfo& error, std::ostream& stream);
\ No newline at end of file
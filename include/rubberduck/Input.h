@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Block-buffered reader for standard input, shared by every `getin`
+// of both engines. Input is read in BLOCK_SIZE chunks straight from
+// the file descriptor, so a pipe or a redirected file costs one
+// system call per block instead of a stream extraction per line, and
+// lines are handed out as views into the buffer without copying.
+//
+// A read returns as soon as some input is available, which keeps
+// interactive use working: a prompt never waits for a full block.
+//
+// An embedder can give a script its own input by reading from a
+// std::istream instead; the stream is then drained through readsome()
+// in whatever pieces it has buffered.
+class InputReader
+{
+private:
+    std::vector<char> m_Buffer;
+    std::istream *m_Stream; // nullptr reads the stdin descriptor
+    size_t m_Begin = 0; // first byte not handed out yet
+    size_t m_End = 0;   // one past the last byte read
+    bool m_AtEnd = false;
+    std::string m_Error; // why input ended, if it was not its end
+
+    // Reads at least one more byte unless input is exhausted
+    bool Fill();
+
+public:
+    static constexpr size_t BLOCK_SIZE = 1 << 16;
+
+    InputReader();
+    // Not owned; must outlive the reader
+    explicit InputReader(std::istream &stream);
+
+    InputReader(const InputReader&) = delete;
+    InputReader& operator=(const InputReader&) = delete;
+
+    // The next line without its "\n" or "\r\n". The view stays valid
+    // until the next call. False once the input is exhausted, or a
+    // read failed, in which case Error() says why.
+    bool ReadLine(std::string_view& line);
+    // Empty unless a read failed
+    const std::string& Error() const { return m_Error; }
+};
+
+// The message of a `getin` into `name` that found no line to read
+std::string ReadFailureMessage
+(
+    const InputReader& input,
+    const std::string& name
+);
+
+// The reader of the process' stdin; there is only one stdin, so every
+// engine has to read through the same buffer
+InputReader& StandardInput();
+
+// Splits a line read by `getin(a, b, c)` into `count` fields the way
+// a shell `read` does: fields are separated by spaces and tabs, and
+// the last one keeps the rest of the line. With a single field the
+// line is taken as it is. Yields fewer fields if the line is short.
+void SplitInputFields
+(
+    std::string_view line,
+    size_t count,
+    std::vector<std::string_view>& fields
+);
@@ -1,170 +1,323 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 #include <unordered_map>
-#include <unordered_set>
 #include <string>
+#include <string_view>
 #include <chrono>
+#include <memory>
 #include <rubberduck/AST.h>
+#include <rubberduck/Benchmark.h>
+#include <rubberduck/Closure.h>
+#include <rubberduck/CompiledScript.h>
 #include <rubberduck/ErrorHandling.h>
+#include <rubberduck/Input.h>
+#include <rubberduck/LoopKernel.h>
+#include <rubberduck/Memo.h>
+#include <rubberduck/Output.h>
+#include <rubberduck/Profiler.h>
+#include <rubberduck/Resolver.h>
+#include <rubberduck/Stats.h>
+#include <rubberduck/Value.h>
 
-// Type enumeration for RD Script values
-enum class e_ValueType
-{
-    NIL,
-    NUMBER,
-    STRING,
-    BOOLEAN
-};
-
-// Struct to hold typed values with direct numeric storage
-struct t_TypedValue
+// Tree-walking interpreter. Runs statements that went through the
+// Resolver: variables are read from the global table or from the
+// frame of the running function by slot, never by name.
+//
+// Every call gets a frame on one preallocated value stack: its
+// parameters followed by its locals. A function captures nothing from
+// its caller; the only outer variables it can reach are globals.
+class Interpreter
 {
-    std::string value;
-    e_ValueType type;
-    double numeric_value;  
-    bool has_numeric_value;
-
-    explicit t_TypedValue() 
-        : value("nil"), 
-          type(e_ValueType::NIL), 
-          numeric_value(0.0), 
-          has_numeric_value(false) {}
-    
-    explicit t_TypedValue(const std::string& val, e_ValueType typ) 
-        : value(val), 
-          type(typ), 
-          numeric_value(0.0), 
-          has_numeric_value(false) 
+private:
+    // Runs the script lowered to closures, on the state below
+    friend class ClosureCompiler;
+
+    struct t_CallFrame
+    {
+        t_FunStmt *function; // nullptr for the script itself
+        size_t base;         // first slot of the frame in m_Stack
+        int loop_depth;      // loop depth of the caller
+        t_Value return_value;
+        // Strings and arrays made before the call. Its callers may
+        // hold them in the middle of an expression, outside any
+        // frame, so only later ones are collected until it returns.
+        size_t strings_made;
+        ArrayPool::t_Made arrays_made;
+    };
+
+    static constexpr size_t STACK_SIZE = 1 << 18;
+    static constexpr size_t SLOTS_PER_CALL = 8; // to size m_Stack
+    // Each call also recurses through Execute/Evaluate on the native
+    // stack. Interpret() budgets what is left of the thread's stack
+    // (see NativeStackLeft()), less a reserve for what runs between
+    // two calls, and a call past the budget fails instead of crashing.
+    // The reserve is an eighth of the stack, and at least this much.
+    static constexpr size_t NATIVE_STACK_RESERVE = 64 << 10;
+    // Budget when the platform cannot tell the stack size, small
+    // enough for the 1 MB stack of a Windows main thread
+    static constexpr size_t NATIVE_STACK_FALLBACK = 512 << 10;
+
+    const SymbolTable* m_Symbols = nullptr; // of the running script
+    std::vector<t_Value> m_Globals;
+    std::vector<uint8_t> m_GlobalDefined;
+    std::vector<t_Value> m_Stack;
+    size_t m_StackTop = 0;
+    std::vector<t_CallFrame> m_Frames;
+    size_t m_MaxCallDepth = DEFAULT_MAX_CALL_DEPTH;
+    uintptr_t m_NativeStackBase = 0; // where Interpret() started
+    size_t m_NativeStackBudget = 0;  // bytes calls may use below it
+    t_Value *m_Frame = nullptr; // slots of the running frame
+    int m_LoopDepth = 0; 
+    std::string m_ControlSignal; // "break" | "continue" | ""
+
+    // Compiled once per loop; nullptr marks a loop that does not qualify
+    LoopCompiler m_LoopCompiler;
+    std::unordered_map
+    <
+        const t_ForStmt*,
+        std::unique_ptr<t_LoopKernel>
+    > m_LoopKernels;
+    std::vector<double> m_KernelRegisters;
+
+    bool m_IsReturning = false;
+    // A tail call the returning function left to its caller: the
+    // arguments wait right above its frame
+    t_CallExpr *m_TailCall = nullptr;
+    const t_StmtClosure *m_TailBody = nullptr; // under closures
+    OutputBuffer m_Output;
+    InputReader* m_Input; // not owned
+    BenchmarkReporter m_Benchmarks;
+    Profiler* m_Profiler = nullptr; // only set with --profile
+    MemoCache* m_Memo = nullptr; // only set with --memoize
+    t_RunStats* m_Stats = nullptr; // only set with --stats
+    std::unique_ptr<ClosureCompiler> m_Closures; // --engine=closure
+    uint64_t m_ScriptId = 0; // of the CompiledScript run, 0 if none
+
+    // Own every string and array value created while interpreting
+    StringPool m_Strings;
+    ArrayPool m_Arrays;
+    std::vector<std::string_view> m_InputFields; // of the last getin
+
+    // Strings and arrays are collected, once enough were made, where
+    // a loop starts an iteration (or a benchmark a run, or a function
+    // a tail call) and where a call returns. At the first kind of
+    // point the running function holds no value outside its frame; at
+    // the second its caller holds none made during the call, but the
+    // result.
+    void CollectAtLoop()
     {
-        // Pre-compute numeric value if possible
-        if (typ == e_ValueType::NUMBER) 
+        const t_CallFrame &frame = m_Frames.back();
+        if
+        (
+            m_Strings.ShouldCollect(frame.strings_made) ||
+            m_Arrays.ShouldCollect(frame.arrays_made)
+        )
         {
-            try 
-            {
-                numeric_value = std::stod(val);
-                has_numeric_value = true;
-            } 
-            catch (...) 
-            {
-                has_numeric_value = false;
-            }
+            Collect(frame.strings_made, frame.arrays_made, t_Value());
         }
     }
-    
-    // Constructor for direct numeric values
-    explicit t_TypedValue(double num_val) 
-        : type(e_ValueType::NUMBER), 
-          numeric_value(num_val), 
-          has_numeric_value(true) 
-    {
-        // Format the string representation properly
-        value = std::to_string(num_val);
-
-        // Remove trailing zeros and decimal point if not needed
-        value.erase(value.find_last_not_of('0') + 1, std::string::npos);
-        value.erase(value.find_last_not_of('.') + 1, std::string::npos);
-    }
-    
-    // Copy constructor
-    explicit t_TypedValue(const t_TypedValue& other) 
-        : value(other.value), 
-          type(other.type), 
-          numeric_value(other.numeric_value), 
-          has_numeric_value(other.has_numeric_value) {}
-    
-    // Assignment operator
-    t_TypedValue& operator=(const t_TypedValue& other) 
+    void CollectAtReturn
+    (
+        const t_Value &result,
+        size_t strings_made,
+        const ArrayPool::t_Made &arrays_made
+    )
     {
-        if (this != &other)
+        if
+        (
+            m_Strings.ShouldCollect(strings_made) ||
+            m_Arrays.ShouldCollect(arrays_made)
+        )
         {
-            value = other.value;
-            type = other.type;
-            numeric_value = other.numeric_value;
-            has_numeric_value = other.has_numeric_value;
+            Collect(strings_made, arrays_made, result);
         }
-        return *this;
     }
-};
+    // Takes back the strings and arrays made from the given ones on
+    // that neither `result` nor a value the interpreter keeps holds
+    void Collect
+    (
+        size_t strings_made,
+        const ArrayPool::t_Made &arrays_made,
+        const t_Value &result
+    );
 
-class Interpreter
-{
-private:
-    std::unordered_map<std::string, t_TypedValue> m_Environment;
-    std::vector<std::unordered_map<std::string, t_TypedValue>> m_ScopeStack; 
-    int m_LoopDepth = 0; 
-    std::string m_ControlSignal; // "break" | "continue" | ""
-    std::unordered_map<std::string, t_FunStmt*> m_Functions;
+    Expected<t_Value, t_ErrorInfo> Evaluate(t_Expr *expr);
+    Expected<int, t_ErrorInfo> Execute(t_Stmt *stmt);
+    Expected<int, t_ErrorInfo> Dispatch(t_Stmt *stmt);
+    Expected<int, t_ErrorInfo> ExecuteProfiled(t_Stmt *stmt);
 
-    std::string m_ReturnValue; 
-    bool m_IsReturning = false;
-    bool m_BufferOutput = false;
-    
-    // Track constant variables to prevent reassignment
-    std::unordered_set<std::string> m_Constants;
-    std::string m_OutputBuffer;
+    // One handler per node kind, dispatched by Evaluate() and Execute()
+    Expected<int, t_ErrorInfo> ExecuteBlock(t_BlockStmt *block_stmt);
+    Expected<int, t_ErrorInfo> ExecuteIf(t_IfStmt *if_stmt);
+    Expected<int, t_ErrorInfo> ExecuteFor(t_ForStmt *for_stmt);
+    Expected<int, t_ErrorInfo> ExecuteVar(t_VarStmt *var_stmt);
+    Expected<int, t_ErrorInfo> ExecuteDisplay(t_DisplayStmt *display_stmt);
+    Expected<int, t_ErrorInfo> ExecuteGetin(t_GetinStmt *getin_stmt);
+    // The body runs as `body` when given, else through Execute()
+    Expected<int, t_ErrorInfo> ExecuteBenchmark
+    (
+        t_BenchmarkStmt *benchmark_stmt,
+        const t_StmtClosure *body = nullptr
+    );
+    Expected<int, t_ErrorInfo> ExecuteExpression(t_ExpressionStmt *expr_stmt);
+    Expected<int, t_ErrorInfo> ExecuteReturn(t_ReturnStmt *return_stmt);
 
-    Expected<std::string, t_ErrorInfo> Evaluate(t_Expr *expr);
-    Expected<int, t_ErrorInfo> Execute(t_Stmt *stmt);
-    bool IsTruthy(const std::string &value);
-    std::string Stringify(const std::string &value);
-    Expected<std::string, t_ErrorInfo> EvaluateFormatExpression
+    Expected<t_Value, t_ErrorInfo> EvaluateLiteral(t_LiteralExpr *literal);
+    Expected<t_Value, t_ErrorInfo> EvaluateFormatString
     (
-        const std::string &expr_str
+        t_FormatStringExpr *format
     );
-    
-    e_ValueType DetectType(const std::string& value);
+    Expected<t_Value, t_ErrorInfo> EvaluateCall(t_CallExpr *call_expr);
+    Expected<t_Value, t_ErrorInfo> EvaluateUnary(t_UnaryExpr *unary);
+    Expected<t_Value, t_ErrorInfo> EvaluatePrefix(t_PrefixExpr *prefix);
+    Expected<t_Value, t_ErrorInfo> EvaluatePostfix(t_PostfixExpr *postfix);
+    Expected<t_Value, t_ErrorInfo> EvaluateBinary(t_BinaryExpr *binary);
+    Expected<t_Value, t_ErrorInfo> EvaluateNumberBinary
+    (
+        t_BinaryExpr *binary
+    );
+    Expected<t_Value, t_ErrorInfo> EvaluateVariable(t_VariableExpr *variable);
+    Expected<t_Value, t_ErrorInfo> EvaluateArray(t_ArrayExpr *array);
+    Expected<t_Value, t_ErrorInfo> EvaluateIndex(t_IndexExpr *index);
+    Expected<t_Value, t_ErrorInfo> EvaluateIndexAssign
+    (
+        t_IndexAssignExpr *assign
+    );
+    Expected<t_Value, t_ErrorInfo> EvaluateSizeof(t_SizeofExpr *size_of);
 
-    // Helper functions for number formatting and type checking
-    static std::string FormatNumber(double value);
-    bool IsInteger(const std::string& value);
-    bool IsFloat(const std::string& value);
-    
-    // Optimized loop execution methods
-    bool IsSimpleNumericLoop(t_ForStmt* for_stmt);
-    Expected<int, t_ErrorInfo> ExecuteSimpleNumericLoop
+    Expected<t_Value, t_ErrorInfo> CallFunction
     (
-        t_ForStmt* for_stmt
-    ); 
-    
-    // Ultra-fast native loop optimization for simple accumulation patterns
-    bool IsSimpleAccumulationLoop(t_ForStmt* for_stmt);
-    Expected<int, t_ErrorInfo> ExecuteAccumulationLoop
+        t_FunStmt *fun_stmt,
+        t_CallExpr *call_expr
+    );
+    // Runs `fun_stmt` in a new frame at `base`, which holds its
+    // arguments, as `body` when given, else through Execute()
+    Expected<t_Value, t_ErrorInfo> RunFunction
     (
-        t_ForStmt* for_stmt
+        t_FunStmt *fun_stmt,
+        size_t base,
+        const t_StmtClosure *body = nullptr
     );
-    
-    // Ultra-fast native optimization for nested loops with arithmetic expressions
-    bool IsNestedArithmeticLoop(t_ForStmt* for_stmt);
-    Expected<int, t_ErrorInfo> ExecuteNestedArithmeticLoop
+    // The same for a pure function with --memoize: a call with the
+    // arguments of an earlier one yields its result instead
+    Expected<t_Value, t_ErrorInfo> RunMemoized
     (
-        t_ForStmt* for_stmt
-    ); 
+        t_FunStmt *fun_stmt,
+        size_t base,
+        const t_StmtClosure *body = nullptr
+    );
+    // Fails with "Stack overflow" when one more frame of `fun_stmt`
+    // at `base` would exceed the call depth, the value stack or the
+    // native stack
+    Expected<int, t_ErrorInfo> CheckCall
+    (
+        const t_FunStmt *fun_stmt,
+        size_t base,
+        int line
+    ) const;
+    // For --stats: one more call, `depth` calls deep, whose frame
+    // ends at slot `top`
+    void CountCall(size_t depth, size_t top)
+    {
+        m_Stats->calls++;
+        m_Stats->max_call_depth = std::max(m_Stats->max_call_depth, depth);
+        m_Stats->max_stack_slots = std::max(m_Stats->max_stack_slots, top);
+    }
+    // Evaluates the arguments of a tail call above the running frame
+    // and leaves the call to CallFunction(), which runs it in place
+    Expected<int, t_ErrorInfo> ExecuteTailCall(t_CallExpr *call_expr);
+    // Moves the arguments of m_TailCall into the frame at `base`
+    Expected<t_FunStmt*, t_ErrorInfo> EnterTailCall(size_t base);
 
-    // Optimized arithmetic operations
-    Expected<bool, t_ErrorInfo> PerformComparison
+    // Storage of a bound variable, or nullptr for a global that has
+    // not been declared yet
+    t_Value* FindVariable(const t_Binding &binding);
+    // Shared by the walker and the closures, so that both fail with
+    // the same messages
+    t_ErrorInfo UndeclaredError(t_Symbol name) const;
+    // Storage an assignment to `name` writes; fails when the variable
+    // is undeclared or constant
+    Expected<t_Value*, t_ErrorInfo> AssignmentTarget
     (
-        const t_TypedValue& left, 
-        const e_TokenType op, 
-        const t_TypedValue& right
+        const t_Binding &binding,
+        t_Symbol name
     );
+    // Fails when `value` would change the type of a variable holding
+    // `old_value`; one holding nil takes any type
+    Expected<int, t_ErrorInfo> CheckAssignedType
+    (
+        const t_Value &old_value,
+        const t_Value &value,
+        t_Symbol name
+    ) const;
     
-    // Scope management
-    void PushScope();
-    void PopScope();
+    // Runs a qualifying for-loop as a t_LoopKernel. Yields false when
+    // the loop does not qualify or a type guard fails, in which case
+    // nothing has been executed yet.
+    Expected<bool, t_ErrorInfo> ExecuteLoopKernel(t_ForStmt* for_stmt);
 
-    void WriteOutput(const std::string& text);
-    void FlushOutput();
-    Expected<int, t_ErrorInfo> DeclareVariable
+    // The same for a `parallel for`, on the thread pool
+    Expected<bool, t_ErrorInfo> ExecuteParallelLoop(t_ForStmt* for_stmt);
+
+    // Optimized arithmetic operations. Errors report `line`, that of
+    // the operator.
+    Expected<t_Value, t_ErrorInfo> PerformArithmetic
+    (
+        const t_Value& left, 
+        const e_TokenType op, 
+        const t_Value& right,
+        int line
+    );
+    Expected<bool, t_ErrorInfo> PerformComparison
     (
-        const std::string& name, 
+        const t_Value& left, 
+        const e_TokenType op, 
+        const t_Value& right,
         int line
-    ); 
+    );
+
+    const std::string& SymbolName(t_Symbol symbol) const
+    {
+        return m_Symbols->Name(symbol);
+    }
 
 public:
     explicit Interpreter();
+    void SetBenchmarkFormat(e_BenchmarkFormat format);
+    void SetFlushPolicy(e_FlushPolicy policy);
+    void SetStrictFloatingPoint(bool strict);
+    // Not owned; must outlive Interpret()
+    void SetProfiler(Profiler* profiler);
+    // Not owned; must outlive Interpret(). Calls of pure functions
+    // reuse the results it holds.
+    void SetMemoCache(MemoCache* memo);
+    // Not owned; must outlive Interpret(). Counts calls and loops.
+    void SetStats(t_RunStats* stats);
+    // Not owned; display output and benchmark results go here
+    void SetOutput(std::ostream& stream);
+    // Not owned; read by `getin`
+    void SetInput(InputReader& input);
+    // Lower the script to closures before running it, instead of
+    // walking the tree. Ignored while profiling, which instruments
+    // the walker.
+    void SetClosures(bool enabled);
+    // Calls that may be nested at once; one more is a runtime error.
+    // A tail call replaces its caller and does not count.
+    void SetMaxCallDepth(size_t depth);
+    // Bytes of display output written since construction
+    uint64_t OutputBytes() const { return m_Output.BytesWritten(); }
+
+    // The error is returned, not reported; output up to it is flushed.
+    // `symbols` are those the tree was parsed with.
     InterpretationResult Interpret
     (
-        const std::vector<PoolPtr<t_Stmt>> &statements
+        const StmtList &statements,
+        const t_ResolvedScript &script,
+        const SymbolTable &symbols
     );
+    // With the floating-point mode the script was compiled with
+    InterpretationResult Interpret(const CompiledScript &script);
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <rubberduck/Token.h>
 #include <rubberduck/ErrorHandling.h>
@@ -8,24 +9,23 @@
 class Lexer
 {
 private:
-    std::string m_Source;
+    std::string_view m_Source;
+    SymbolTable& m_Symbols;
     std::vector<t_Token> m_Tokens;
     int m_Start;
     int m_Current;
     int m_Line;
 
     bool IsAtEnd();
-    ParsingResult ScanToken();
+    Expected<int, t_ErrorInfo> ScanToken();
     char Advance();
     void AddToken(e_TokenType type);
-    void AddToken(e_TokenType type, const std::string &literal);
     bool Match(char expected);
     char Peek();
     char PeekNext();
 
     // Helpers for literals
-    Expected<std::string, t_ErrorInfo> String();
-    Expected<std::string, t_ErrorInfo> FormatString(); 
+    Expected<int, t_ErrorInfo> String(const char *unterminated_message);
     void Number();
     void Identifier();
 
@@ -33,6 +33,12 @@ private:
     e_TokenType IdentifierType();
 
 public:
-    explicit Lexer(const std::string &source);
+    // `source` is not copied and must outlive the tokens. Identifiers
+    // are interned into `symbols`, normally those of the ASTContext the
+    // tokens are parsed into.
+    Lexer(std::string_view source, SymbolTable& symbols);
     ParsingResult ScanTokens();
-};
\ No newline at end of file
+
+    // Decodes the escape sequences of a string literal's contents
+    static std::string Unescape(std::string_view raw);
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <unordered_map>
+#include <rubberduck/AST.h>
+#include <rubberduck/ErrorHandling.h>
+
+// Static pass run right after Parser::Parse(), before the Optimizer
+// and either engine. Every t_CallExpr gets its t_FunStmt stored in
+// `target`, so no call looks a function up by name while the script
+// runs.
+//
+// Functions are hoisted: a call may name a function declared further
+// down, and when a name is declared twice the last declaration wins.
+// A call with the wrong number of arguments is reported here, before
+// anything runs. A name the script does not declare may still be a
+// builtin (see Builtins.h), which is recorded in `builtin`. A call to
+// an undefined function keeps a null target and stays a runtime
+// error, since it might never be reached.
+class Linker
+{
+private:
+    const SymbolTable& m_Symbols; // of the script, for builtins and errors
+    std::unordered_map<t_Symbol, t_FunStmt*> m_Functions;
+
+    Expected<int, t_ErrorInfo> LinkStatement(t_Stmt *stmt);
+    Expected<int, t_ErrorInfo> LinkExpression(t_Expr *expr);
+    Expected<int, t_ErrorInfo> LinkCall(t_CallExpr *call);
+
+public:
+    explicit Linker(const SymbolTable& symbols) : m_Symbols(symbols) {}
+
+    Expected<int, t_ErrorInfo> Link(const StmtList &statements);
+};
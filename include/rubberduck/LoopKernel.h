@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <rubberduck/AST.h>
+#include <rubberduck/ErrorHandling.h>
+
+enum class e_KernelOp : uint8_t
+{
+    MOVE,      // a = b
+    ADD,       // a = b + c
+    SUBTRACT,  // a = b - c
+    MULTIPLY,  // a = b * c
+    DIVIDE,    // a = b / c, error when c == 0
+    MODULO,    // a = fmod(b, c), error when c == 0
+    NEGATE,    // a = -b
+    JUMP,      // goto a
+    JUMP_LT,   // if (b < c) goto a
+    JUMP_LE,
+    JUMP_GT,
+    JUMP_GE,
+    JUMP_EQ,
+    JUMP_NE,
+    JUMP_NLT,  // if (!(b < c)) goto a, differs from JUMP_GE for NaN
+    JUMP_NLE,
+    JUMP_NGT,
+    JUMP_NGE,
+    VECTOR_LOOP, // vector_loops[a]: b = c, then all but the last
+                 // iteration of the loop that starts next
+    HALT
+};
+
+struct t_KernelInstr
+{
+    e_KernelOp op;
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+};
+
+// A variable the kernel reads from or writes back to the interpreter
+struct t_KernelVariable
+{
+    t_Binding binding;
+    t_Symbol name;
+    uint32_t reg;
+    bool is_written;
+};
+
+// A register of a vector loop that sums or multiplies up its lanes
+struct t_VectorReduction
+{
+    uint32_t lane; // index into t_VectorLoop::lane_regs
+    e_KernelOp op; // ADD (`-=` included) or MULTIPLY
+};
+
+// An innermost counted loop whose body is straight-line code:
+//
+//     MOVE i, first          <- replaced by VECTOR_LOOP
+//     JUMP_NLT exit, i, bound   (or NLE, NGT, NGE)
+//     body
+//     ADD i, i, step            (or SUBTRACT)
+//     JUMP back to the compare
+//
+// VECTOR_LOOP runs all but the last iteration at once and leaves the
+// loop to finish the last one as usual, which also leaves every
+// variable of the body with the value of that last iteration.
+//
+// If every sum and product of the body only adds a linear function of
+// the loop variable (or multiplies by an invariant), the iterations
+// are replaced by their closed form. Otherwise the body runs on
+// VECTOR_WIDTH iterations at a time, over its own copy of the
+// registers it uses ("lanes"), with a partial result per lane.
+struct t_VectorLoop
+{
+    static constexpr uint32_t VECTOR_WIDTH = 4;
+    static constexpr uint32_t MAX_LANES = 64;
+
+    e_KernelOp exit_op;
+    uint32_t counter;   // scalar registers of the loop variable,
+    uint32_t bound;     // the bound
+    uint32_t step;      // and what the increment adds
+    bool step_negated;  // ... or subtracts
+    bool is_closed_form;
+    bool has_division;  // lanes stop at a zero divisor
+    std::vector<t_KernelInstr> body; // operands are lane numbers
+    std::vector<uint32_t> lane_regs; // the scalar register of a lane
+    uint32_t counter_lane;
+    std::vector<t_VectorReduction> reductions;
+};
+
+// A for-loop lowered to straight-line code over double registers.
+// Variables declared inside the loop live only in registers; the
+// ones declared outside are loaded on entry and stored on exit.
+struct t_LoopKernel
+{
+    std::vector<t_KernelInstr> code;
+    std::vector<double> registers; // constants filled in, rest zero
+    std::vector<t_KernelVariable> variables;
+    std::vector<t_VectorLoop> vector_loops;
+};
+
+// How the chunks of a parallel loop combine an outside variable
+struct t_KernelReduction
+{
+    uint32_t variable; // index into t_LoopKernel::variables
+    e_KernelOp op;     // ADD for sums (`-=` included) or MULTIPLY
+};
+
+// A `parallel for` lowered to a kernel that runs one chunk of its
+// iterations: the loop variable starts at registers[start_reg] and
+// the chunk ends once it reaches registers[end_reg]. Every outside
+// variable the loop writes is a reduction; the others are read-only.
+struct t_ParallelLoop
+{
+    t_LoopKernel kernel;
+    uint32_t start_reg = 0;
+    uint32_t end_reg = 0;
+    double first = 0.0;      // the loop variable in the first iteration
+    double step = 0.0;       // what the increment adds
+    uint64_t trip_count = 0;
+    std::vector<t_KernelReduction> reductions;
+};
+
+// Decides whether a for-loop can run as a t_LoopKernel and builds it.
+//
+// A loop qualifies when everything it does is arithmetic on numbers:
+// numeric declarations, assignments and increments, `if`/`else` on
+// comparisons, `break`/`continue` and nested `for` loops of the same
+// kind, to any depth. Calls, output, input, strings, arrays, booleans
+// stored in variables and writes to constants keep the loop on the
+// regular path.
+//
+// Types are only known at runtime, so the kernel is guarded: it runs
+// only if every outside variable it touches holds a number on entry.
+// Inside the kernel no value can change type.
+class LoopCompiler
+{
+private:
+    struct t_LoopLabels
+    {
+        std::vector<size_t> break_jumps;
+        std::vector<size_t> continue_jumps;
+    };
+
+    t_LoopKernel* m_Kernel;
+    std::unordered_map<uint64_t, uint32_t> m_VariableRegs;
+    std::unordered_map<uint64_t, uint32_t> m_ConstantRegs;
+    std::vector<uint64_t> m_Declared;
+    std::vector<uint8_t> m_IsTemporary;
+    std::vector<t_LoopLabels> m_Loops;
+    bool m_Failed;
+    const char *m_FailureReason;
+    bool m_StrictFloatingPoint = false;
+
+    void Reset(t_LoopKernel *kernel);
+    void CheckIndependence
+    (
+        t_ParallelLoop &loop,
+        uint32_t counter,
+        size_t body_start,
+        size_t body_end
+    );
+    uint32_t NewRegister();
+    uint32_t ConstantRegister(double value);
+    uint32_t VariableRegister(const t_VariableExpr *variable);
+    uint32_t DeclaredRegister(const t_VarStmt *var_stmt);
+    size_t Emit(e_KernelOp op, uint32_t a, uint32_t b = 0, uint32_t c = 0);
+    void PatchJumps(const std::vector<size_t>& jumps, size_t target);
+    void Vectorize(size_t loop_start, size_t loop_end);
+
+    void CompileStatement(t_Stmt *stmt);
+    void CompileLoop(t_ForStmt *for_stmt);
+    void CompileEffect(t_Expr *expr);
+    void CompileStore(t_VariableExpr *target, uint32_t value);
+    void MoveInto(uint32_t target, uint32_t value);
+    void Fail(const char *reason);
+    uint32_t CompileNumber(t_Expr *expr);
+    void CompileCondition
+    (
+        t_Expr *expr,
+        bool jump_when,
+        std::vector<size_t>& jumps
+    );
+    bool IsCondition(t_Expr *expr) const;
+
+public:
+    LoopCompiler();
+
+    // Keeps every loop in its exact order of operations: no vector
+    // loops, no closed forms (--strict-fp)
+    void SetStrictFloatingPoint(bool strict)
+    {
+        m_StrictFloatingPoint = strict;
+    }
+
+    // nullptr when the loop does not qualify
+    std::unique_ptr<t_LoopKernel> Compile(t_ForStmt *for_stmt);
+
+    // For a `parallel for`. Also nullptr when one iteration depends on
+    // another: it writes the loop variable, breaks out of the loop or
+    // uses an outside variable it writes as anything but a sum or a
+    // product of the iterations.
+    std::unique_ptr<t_ParallelLoop> CompileParallel(t_ForStmt *for_stmt);
+
+    // Why the last Compile() returned nullptr, e.g. "calls a function"
+    const char* FailureReason() const;
+};
+
+// Runs a kernel whose outside variables were already loaded into
+// `registers`
+Expected<int, t_ErrorInfo> RunLoopKernel
+(
+    const t_LoopKernel& kernel,
+    double *registers
+);
+
+// The part of VECTOR_LOOP after its MOVE; in VectorLoop.cpp
+void RunVectorLoop(const t_VectorLoop& loop, double *registers);
+
+// How often `for (i = first; i < bound; i += step)` runs, with `<=`
+// when inclusive and `>` or `>=` unless counting up. False when it
+// never stops. Exact as long as every value is a whole number.
+bool LoopTripCount
+(
+    double first,
+    double bound,
+    double step,
+    bool counts_up,
+    bool inclusive,
+    uint64_t &trip_count
+);
+
+// fmod() with a fast path for whole numbers, for both of the above
+double KernelModulo(double left, double right);
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <rubberduck/Value.h>
+
+// Pure functions of more parameters are never memoized
+constexpr uint32_t MAX_MEMO_ARITY = 4;
+
+// A call of a pure function: its memo slot and argument values
+struct t_MemoKey
+{
+    int32_t function;
+    uint32_t count;
+    uint64_t hash;
+    t_Value arguments[MAX_MEMO_ARITY];
+};
+
+// Results of calls to pure functions (see PurityChecker), for
+// `--memoize`. The engines look a call up once its arguments are
+// evaluated and store the result when it returns without an error.
+//
+// The cache is bounded: every key has one place in a fixed table, and
+// a later call that hashes to the same place replaces the entry. Keys
+// compare numbers bit for bit and strings by their text. Arrays are
+// neither keys nor results, since the caller or the callee could
+// change them later.
+class MemoCache
+{
+private:
+    struct t_Entry
+    {
+        t_MemoKey key;
+        t_Value result;
+        bool is_used;
+    };
+
+    struct t_Counters
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    std::vector<t_Entry> m_Entries; // a power of two of them
+    std::vector<std::string> m_Names; // of the functions, by memo slot
+    std::vector<t_Counters> m_Counters;
+
+    static bool IsSameKey(const t_MemoKey& left, const t_MemoKey& right);
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+    explicit MemoCache(size_t capacity = DEFAULT_CAPACITY);
+
+    // Forgets every entry and counter before a run. `names` are those
+    // of the pure functions of the script, by memo slot.
+    void Reset(std::vector<std::string> names);
+
+    // Fills `key` for a call; false when an argument is an array
+    static bool MakeKey
+    (
+        int32_t function,
+        const t_Value* arguments,
+        uint32_t count,
+        t_MemoKey& key
+    );
+
+    // The result of an earlier call with `key`, or nullptr. Counts a
+    // hit or a miss.
+    const t_Value* Find(const t_MemoKey& key);
+    void Store(const t_MemoKey& key, const t_Value& result);
+
+    // Marks the strings the entries hold, for a collection of the
+    // engine's StringPool
+    void Mark(StringPool& strings) const;
+
+    // Hits and misses per function that was called
+    void WriteReport(std::ostream& stream) const;
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Bytes of the calling thread's stack left below `address`, the
+// address of one of the caller's locals, or 0 if the platform has no
+// way to tell. Stacks grow down on every supported platform.
+//
+// The size is whatever the thread got: 1 MB for the main thread on
+// Windows, `ulimit -s` for it on Linux, and the default of the thread
+// library for a thread of --batch or `parallel for`.
+size_t NativeStackLeft(uintptr_t address);
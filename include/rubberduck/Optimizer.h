@@ -0,0 +1,80 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <rubberduck/AST.h>
+#include <rubberduck/ASTContext.h>
+#include <rubberduck/Value.h>
+
+// Optional pass run between Parser::Parse() and either engine (-O1).
+// Rewrites the tree in place without changing what the script does:
+//   - folds arithmetic, comparisons and logic on literal operands,
+//     including through parentheses and into format strings
+//   - replaces reads of a `const` that was initialized with a literal
+//     by that literal
+//   - drops `if` branches whose condition is a literal, and empty
+//     statements
+//   - inlines calls to functions whose body is a single
+//     `return expr;` over their parameters, when every argument is a
+//     literal or a variable that is known to be defined
+// Anything that would fail at runtime (division by zero, arithmetic
+// on strings, ...) is left alone so the error is still reported when
+// and where it is reached.
+//
+// Names are scoped like in the Resolver. A global constant is only
+// propagated into functions if no call can run before it is declared.
+class Optimizer
+{
+private:
+    struct t_Name
+    {
+        t_Symbol name;
+        int depth;
+        const t_LiteralExpr* value; // nullptr unless a literal const
+    };
+
+    struct t_GlobalName
+    {
+        const t_LiteralExpr* value;
+        bool is_visible_in_functions;
+    };
+
+    ASTContext& m_Context;
+    StringPool m_Strings;
+    std::vector<t_Name> m_Locals;
+    std::unordered_map<t_Symbol, t_GlobalName> m_Globals;
+    int m_ScopeDepth = 0;
+    bool m_InMain = true;
+    bool m_CallSeen = false;
+
+    void BeginScope();
+    void EndScope();
+    void Declare(const t_VarStmt *var_stmt);
+    const t_LiteralExpr* FindConstant(t_Symbol name) const;
+    bool IsDefined(t_Symbol name) const;
+
+    bool ToValue(t_Expr *expr, t_Value& value);
+    PoolPtr<t_Expr> MakeLiteral(const t_Value& value);
+    PoolPtr<t_Stmt> MakeEmptyBlock();
+
+    void OptimizeStatements(StmtList &statements);
+    void OptimizeStatement(PoolPtr<t_Stmt> &stmt);
+    void OptimizeScopedStatement(PoolPtr<t_Stmt> &stmt);
+    void OptimizeFunction(t_FunStmt *fun_stmt);
+    void OptimizeExpression(PoolPtr<t_Expr> &expr);
+    void FoldBinary(PoolPtr<t_Expr> &expr, t_BinaryExpr *binary);
+    void FoldFormatString(PoolPtr<t_Expr> &expr, t_FormatStringExpr *format);
+
+    bool TryInline(PoolPtr<t_Expr> &expr, t_CallExpr *call);
+    PoolPtr<t_Expr> CloneInlined
+    (
+        t_Expr *expr,
+        const t_FunStmt *fun_stmt,
+        const ExprList &arguments
+    );
+
+public:
+    explicit Optimizer(ASTContext& context);
+
+    void Optimize(StmtList &statements);
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+// When buffered `display` output is handed to its stream (--flush)
+enum class e_FlushPolicy
+{
+    SIZE, // once FLUSH_THRESHOLD bytes are waiting (default)
+    LINE  // after every complete line, for watching a script live
+};
+
+// The output buffer both engines display into. Text is appended to
+// one reusable string and written to the stream (std::cout unless an
+// embedder set another) with a single write when the policy says so,
+// on Flush(), and when the buffer is destroyed.
+//
+// Engines flush before anything else can observe stdout: before
+// blocking on `getin`, before reporting an error and before printing
+// benchmark results. While a benchmark holds the buffer nothing is
+// written, so the timed runs never include I/O.
+//
+// Writes happen on the engine's thread, not on a writer thread. Each
+// of those flush points needs the text on the stream before it goes
+// on, so it would have to wait for a writer anyway; and at 64 KB a
+// single write is short next to the script that produced it.
+class OutputBuffer
+{
+private:
+    std::string m_Text;
+    std::ostream* m_Stream;
+    e_FlushPolicy m_Policy = e_FlushPolicy::SIZE;
+    bool m_Held = false;
+    uint64_t m_BytesWritten = 0;
+
+public:
+    static constexpr size_t FLUSH_THRESHOLD = 1 << 16;
+
+    OutputBuffer();
+    ~OutputBuffer();
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void SetPolicy(e_FlushPolicy policy) { m_Policy = policy; }
+
+    // Not owned; must outlive the buffer. Flushes what the previous
+    // stream has not received yet.
+    void SetStream(std::ostream& stream);
+    std::ostream& Stream() const { return *m_Stream; }
+
+    // For appending in place (AppendValue); call Commit() afterwards
+    std::string& Text() { return m_Text; }
+
+    // Applies the flush policy to what was appended since
+    void Commit()
+    {
+        if (m_Held || m_Text.empty())
+        {
+            return;
+        }
+        if
+        (
+            m_Text.size() >= FLUSH_THRESHOLD ||
+            (m_Policy == e_FlushPolicy::LINE && m_Text.back() == '\n')
+        )
+        {
+            Flush();
+        }
+    }
+
+    void Write(std::string_view text)
+    {
+        m_Text.append(text);
+        Commit();
+    }
+
+    // Writes everything waiting and flushes the stream
+    void Flush();
+
+    // Bytes handed to the streams so far, for --stats
+    uint64_t BytesWritten() const { return m_BytesWritten; }
+
+    // Releasing does not flush; a benchmark flushes between its runs
+    void SetHeld(bool held) { m_Held = held; }
+    bool IsHeld() const { return m_Held; }
+};
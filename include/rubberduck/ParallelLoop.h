@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+#include <rubberduck/AST.h>
+#include <rubberduck/ErrorHandling.h>
+#include <rubberduck/LoopKernel.h>
+
+// Compiles every `parallel for` of a resolved script and attaches the
+// result to its node. A loop whose iterations are not independent is
+// a compile error rather than a silent fallback: the script asked for
+// parallel execution and would only get it by chance otherwise.
+// `strict_fp` is LoopCompiler::SetStrictFloatingPoint().
+Expected<int, t_ErrorInfo> PrepareParallelLoops
+(
+    const std::vector<t_ForStmt*>& loops,
+    bool strict_fp
+);
+
+// Runs every iteration of `loop` on the shared thread pool.
+// `registers` is a copy of the kernel's registers with the outside
+// variables loaded; afterwards the reduction registers hold the
+// results.
+//
+// The iterations are split into a number of chunks that depends only
+// on the trip count. Each chunk starts its sums at 0 and its products
+// at 1, and the partial results are combined pairwise in a fixed
+// order, so a loop gives the same result on every run and with any
+// number of threads. That result may differ in the last digits from
+// adding up the iterations in sequence.
+Expected<int, t_ErrorInfo> RunParallelLoop
+(
+    const t_ParallelLoop& loop,
+    double *registers
+);
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <rubberduck/Token.h>
 #include <rubberduck/AST.h>
 #include <rubberduck/ASTContext.h>
@@ -10,15 +13,25 @@
 class Parser
 {
 private:
-    std::vector<t_Token> m_Tokens;
+    // Every measured run of a benchmark keeps its sample in memory
+    static constexpr uint32_t MAX_BENCHMARK_RUNS = 10000000;
+
+    std::string_view m_Source;
+    const std::vector<t_Token>& m_Tokens;
     int m_Current;
     ASTContext& m_Context;
 
+    // Children of the lists being parsed, innermost last. A finished
+    // list moves its tail into an exact-size array in the arena.
+    std::vector<PoolPtr<t_Stmt>> m_StmtStack;
+    std::vector<PoolPtr<t_Expr>> m_ExprStack;
+
     bool IsAtEnd();
-    t_Token Advance();
+    const t_Token& Advance();
     bool Check(e_TokenType type);
-    t_Token Peek();
-    t_Token Previous();
+    const t_Token& Peek();
+    const t_Token& Previous();
+    std::string_view Text(const t_Token &token) const;
     bool Match(std::initializer_list<e_TokenType> types);
     
     Expected<t_Token, t_ErrorInfo> Consume
@@ -26,14 +39,16 @@ private:
         e_TokenType type, 
         const std::string &message
     );
-    t_ErrorInfo Error(t_Token token, const std::string &message);
+    t_ErrorInfo Error(const t_Token &token, const std::string &message);
 
     Expected<t_Stmt*, t_ErrorInfo> Statement();
+    Expected<t_Stmt*, t_ErrorInfo> DispatchStatement();
     Expected<t_Stmt*, t_ErrorInfo> BlockStatement();
     Expected<t_Stmt*, t_ErrorInfo> BreakStatement();
     Expected<t_Stmt*, t_ErrorInfo> ContinueStatement();
     Expected<t_Stmt*, t_ErrorInfo> IfStatement();
     Expected<t_Stmt*, t_ErrorInfo> ForStatement();
+    Expected<t_Stmt*, t_ErrorInfo> ParallelForStatement();
     Expected<t_Stmt*, t_ErrorInfo> VarDeclaration();
     Expected<t_Stmt*, t_ErrorInfo> DisplayStatement();
     Expected<t_Stmt*, t_ErrorInfo> GetinStatement();
@@ -41,6 +56,11 @@ private:
     Expected<t_Stmt*, t_ErrorInfo> ExpressionStatement();
     Expected<t_Stmt*, t_ErrorInfo> EmptyStatement();
     Expected<t_Stmt*, t_ErrorInfo> BenchmarkStatement();
+    Expected<uint32_t, t_ErrorInfo> BenchmarkCount
+    (
+        const std::string &what,
+        uint32_t minimum
+    );
     Expected<t_Stmt*, t_ErrorInfo> ReturnStatement();
 
     Expected<t_Expr*, t_ErrorInfo> Assignment();
@@ -53,13 +73,20 @@ private:
     Expected<t_Expr*, t_ErrorInfo> Unary();
     Expected<t_Expr*, t_ErrorInfo> FinishUnary();
     Expected<t_Expr*, t_ErrorInfo> Primary();
+    Expected<t_Expr*, t_ErrorInfo> FormatString(const t_Token &token);
 
 public:
     Expected<t_Expr*, t_ErrorInfo> Expression();
+
+    // Parses a single expression that must span all tokens
+    Expected<t_Expr*, t_ErrorInfo> StandaloneExpression();
+    // Neither `source` nor `tokens` is copied; both must outlive the
+    // parser. The tree only keeps copies of the text it needs.
     explicit Parser
     (
+        std::string_view source,
         const std::vector<t_Token> &tokens, 
         ASTContext& context
     );
-    Expected<std::vector<PoolPtr<t_Stmt>>, t_ErrorInfo> Parse();
+    Expected<StmtList, t_ErrorInfo> Parse();
 };
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <rubberduck/AST.h>
+
+// Instrumenting profiler for the tree-walking interpreter (--profile).
+// The interpreter reports every statement it executes and every call
+// it makes; time is measured with steady_clock around each of them.
+//
+// Time is split the usual way: the self time of a statement or a
+// function excludes the statements and calls nested inside it, so
+// self times add up to the whole run. For loops it also records
+// whether each run went through the loop kernel or the general path,
+// and why a loop could not use the kernel.
+class Profiler
+{
+private:
+    struct t_FunctionProfile
+    {
+        const t_FunStmt* function; // nullptr for the script itself
+        uint64_t calls = 0;
+        int64_t total_ns = 0;      // outermost activations only
+        int64_t self_ns = 0;
+        uint32_t active = 0;       // recursion depth right now
+    };
+
+    struct t_LineProfile
+    {
+        uint64_t count = 0;
+        int64_t self_ns = 0;
+    };
+
+    struct t_LoopProfile
+    {
+        int line = 0;
+        uint64_t runs = 0;
+        uint64_t kernel_runs = 0;
+        int64_t total_ns = 0;
+        std::string fallback_reason; // empty while every run used it
+    };
+
+    // A node of the call tree, for the collapsed stacks
+    struct t_StackNode
+    {
+        uint32_t parent;
+        uint32_t function;
+        int64_t self_ns;
+    };
+
+    struct t_StatementTimer
+    {
+        int64_t start;
+        int64_t child_ns;
+    };
+
+    struct t_FunctionTimer
+    {
+        uint32_t function;
+        uint32_t node;
+        int64_t start;
+        int64_t callee_ns;
+    };
+
+    const SymbolTable* m_Symbols = nullptr;
+    std::vector<t_FunctionProfile> m_Functions;
+    std::unordered_map<const t_FunStmt*, uint32_t> m_FunctionIds;
+    std::map<int, t_LineProfile> m_Lines;
+    std::unordered_map<const t_ForStmt*, t_LoopProfile> m_Loops;
+    std::vector<t_StackNode> m_Nodes;
+    std::map<uint64_t, uint32_t> m_NodeIds; // (parent, function)
+    std::vector<t_StatementTimer> m_Statements;
+    std::vector<t_FunctionTimer> m_Calls;
+    int64_t m_Start = 0;
+    int64_t m_Elapsed = 0;
+
+    static int64_t Now();
+    uint32_t FunctionId(const t_FunStmt *function);
+    uint32_t StackNode(uint32_t parent, uint32_t function);
+    std::string FunctionName(uint32_t function) const;
+    std::string StackName(uint32_t node) const;
+
+public:
+    Profiler();
+
+    // Around the whole script; Stop() also closes whatever an error
+    // left open. Functions are named from `symbols`, which must outlive
+    // the reports.
+    void Start(const SymbolTable& symbols);
+    void Stop();
+
+    void BeginStatement();
+    void EndStatement(const t_Stmt *stmt);
+
+    void BeginCall(const t_FunStmt *function);
+    void EndCall();
+
+    void LoopUsedKernel(const t_ForStmt *loop);
+    void LoopFellBack(const t_ForStmt *loop, const std::string &reason);
+
+    // Functions, lines and loops sorted by self or total time
+    void WriteFlatProfile(std::ostream &out) const;
+    // One "script;caller;callee <self ns>" line per call path, the
+    // input format of flamegraph.pl and speedscope
+    void WriteCollapsedStacks(std::ostream &out) const;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <rubberduck/Bytecode.h>
+#include <rubberduck/CompiledScript.h>
+
+// On-disk cache of compiled programs (--cache). `script.rd` is cached
+// as `script.rdc`: the t_Program the Compiler produced for it, after
+// every static pass, so a hit goes straight from reading the source to
+// running the VM.
+//
+// An entry is keyed by a hash and the size of the source text, by the
+// options that change the program (`flags`) and by CACHE_VERSION and
+// the opcode set of this build; anything else reads as a miss. All
+// numbers are stored in host byte order with fixed widths, and strings
+// as a length followed by the bytes, so nothing in the file is a
+// pointer and it is read straight from a memory mapping.
+//
+// Bump CACHE_VERSION whenever the Compiler or the VM changes what a
+// piece of bytecode means without changing the opcode list.
+constexpr uint32_t CACHE_VERSION = 6;
+
+// The options that change the compiled program, as `flags`
+uint32_t CacheFlags(const t_CompileOptions& options);
+
+// "script.rd" -> "script.rdc"
+std::string CachePath(const std::string& script_path);
+
+// False on a miss or a damaged file, including one whose instructions
+// name a constant, slot, jump target or table entry the program does
+// not have; `program` may then be partly filled and should be thrown
+// away
+bool LoadCachedProgram
+(
+    const std::string& path,
+    std::string_view source,
+    uint32_t flags,
+    t_Program& program
+);
+
+// Written to a temporary file of its own first and renamed over the
+// old entry, so a concurrent run never reads half a cache file and two
+// concurrent saves never write into the same one
+bool SaveCachedProgram
+(
+    const std::string& path,
+    std::string_view source,
+    uint32_t flags,
+    const t_Program& program
+);
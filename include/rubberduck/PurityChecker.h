@@ -0,0 +1,41 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <rubberduck/AST.h>
+
+// Static pass run after the last Resolver. Finds the functions whose
+// result depends on nothing but their arguments, so that `--memoize`
+// can reuse it (see MemoCache), and numbers them in `memo_slot`.
+//
+// A function is pure when its body
+//   - reads and writes no global, only its parameters and locals
+//   - has no `display`, `getin` or `benchmark`
+//   - calls only pure functions and builtins
+// Arrays it is passed could be changed by it, so those calls are left
+// to the engines, which never memoize one with an array argument.
+// Functions may call each other in any order, recursion included.
+class PurityChecker
+{
+private:
+    struct t_FunctionInfo
+    {
+        t_FunStmt* function;
+        bool is_pure;
+        std::vector<t_FunStmt*> callees;
+    };
+
+    std::vector<t_FunctionInfo> m_Functions;
+    std::unordered_map<const t_FunStmt*, size_t> m_Index;
+    t_FunctionInfo* m_Current = nullptr;
+
+    // Clear `is_pure` of the current function on the first reason
+    void CheckStatement(t_Stmt* stmt);
+    void CheckExpression(t_Expr* expr);
+    void CheckBinding(const t_Binding& binding);
+
+public:
+    // Sets `memo_slot` of every pure function of at most
+    // MAX_MEMO_ARITY parameters, and -1 on all others
+    void Check(const StmtList& statements);
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <rubberduck/AST.h>
+
+// Storage the interpreter has to provide for a resolved script
+struct t_ResolvedScript
+{
+    std::vector<t_Symbol> global_names;
+    uint32_t main_frame_size = 0;
+    std::vector<t_ForStmt*> parallel_loops; // for PrepareParallelLoops()
+};
+
+// Static pass run between Parser::Parse() and Interpreter::Interpret().
+// Every variable reference is bound to a slot so the interpreter never
+// looks a variable up by name.
+//
+// Scoping rules (the same as the bytecode compiler):
+//   - `auto` at the top level of the script declares a global
+//   - every other declaration is a local in the enclosing block and
+//     gets a slot in the frame of the enclosing function
+//   - functions see their parameters, their own locals and globals;
+//     locals of the caller are never visible inside a callee
+//
+// Slots of a block are reused once the block ends, so a frame is only
+// as large as the deepest set of simultaneously live locals.
+//
+// A `return f(...)` in a function, outside any benchmark, is marked as
+// a tail call: nothing of the returning frame is used after the call.
+class Resolver
+{
+private:
+    struct t_Local
+    {
+        t_Symbol name;
+        int depth;
+        bool is_const;
+    };
+
+    struct t_GlobalInfo
+    {
+        uint32_t slot;
+        bool is_const;
+        bool is_declared;
+    };
+
+    std::vector<t_Local> m_Locals;
+    std::unordered_map<t_Symbol, t_GlobalInfo> m_Globals;
+    std::vector<t_Symbol> m_GlobalNames;
+    std::vector<t_ForStmt*> m_ParallelLoops;
+    int m_ScopeDepth = 0;
+    uint32_t m_FrameSize = 0;
+    bool m_InMain = true;
+    int m_BenchmarkDepth = 0;
+
+    void BeginScope();
+    void EndScope();
+    void Declare(t_VarStmt *var_stmt);
+    t_Binding Bind(t_Symbol name);
+    bool TryBind(t_Symbol name, t_Binding& binding) const;
+    uint32_t GlobalSlot(t_Symbol name);
+    bool IsDeclaredInCurrentScope(t_Symbol name) const;
+
+    void ResolveStatement(t_Stmt *stmt);
+    void ResolveScopedStatement(t_Stmt *stmt);
+    void ResolveFunction(t_FunStmt *fun_stmt);
+    void ResolveExpression(t_Expr *expr);
+
+public:
+    t_ResolvedScript Resolve(const StmtList &statements);
+};
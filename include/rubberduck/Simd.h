@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// The lanes of the vectorized kernels (vector loops, array builtins)
+// use the vector extension of GCC and Clang, which becomes SSE2 or
+// AVX2 on x86 and NEON on ARM. Other compilers get an array of
+// doubles with the same operators, which they may vectorize on their
+// own.
+#if defined(__GNUC__) || defined(__clang__)
+#define RD_VECTOR_EXTENSION 1
+#define RD_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define RD_VECTOR_EXTENSION 0
+#define RD_ALWAYS_INLINE inline
+#endif
+
+// x86 builds for the baseline and picks an AVX2 clone of each kernel
+// at runtime
+#if RD_VECTOR_EXTENSION && (defined(__x86_64__) || defined(__i386__))
+#define RD_RUNTIME_AVX2 1
+#else
+#define RD_RUNTIME_AVX2 0
+#endif
+
+constexpr uint32_t LANE_WIDTH = 4;
+
+#if RD_VECTOR_EXTENSION
+typedef double t_Lanes
+__attribute__((vector_size(LANE_WIDTH * sizeof(double))));
+#else
+struct t_Lanes
+{
+    double lane[LANE_WIDTH];
+
+    double& operator[](uint32_t i) { return lane[i]; }
+    double operator[](uint32_t i) const { return lane[i]; }
+};
+
+#define RD_LANE_OPERATOR(op)                                             \
+inline t_Lanes operator op(const t_Lanes& left, const t_Lanes& right)    \
+{                                                                        \
+    t_Lanes result;                                                      \
+    for (uint32_t i = 0; i < LANE_WIDTH; ++i)                            \
+    {                                                                    \
+        result.lane[i] = left.lane[i] op right.lane[i];                  \
+    }                                                                    \
+    return result;                                                       \
+}
+RD_LANE_OPERATOR(+)
+RD_LANE_OPERATOR(-)
+RD_LANE_OPERATOR(*)
+RD_LANE_OPERATOR(/)
+#undef RD_LANE_OPERATOR
+
+inline t_Lanes operator-(const t_Lanes& value)
+{
+    t_Lanes result;
+    for (uint32_t i = 0; i < LANE_WIDTH; ++i)
+    {
+        result.lane[i] = -value.lane[i];
+    }
+    return result;
+}
+#endif
+
+RD_ALWAYS_INLINE void Broadcast(t_Lanes& lanes, double value)
+{
+    for (uint32_t i = 0; i < LANE_WIDTH; ++i)
+    {
+        lanes[i] = value;
+    }
+}
+
+// Unaligned, so any element of a std::vector<double> can start a load
+// (filled in place: returning a 32-byte vector by value changes the
+// calling convention between the baseline and the AVX2 clones)
+RD_ALWAYS_INLINE void LoadLanes(t_Lanes& lanes, const double *source)
+{
+    std::memcpy(&lanes, source, sizeof(lanes));
+}
+
+RD_ALWAYS_INLINE void StoreLanes(double *target, const t_Lanes& lanes)
+{
+    std::memcpy(target, &lanes, sizeof(lanes));
+}
+
+#if RD_RUNTIME_AVX2
+// Asked once per process
+inline bool CpuHasAvx2()
+{
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+#endif
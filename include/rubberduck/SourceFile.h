@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only view of a script on disk. The file is memory-mapped when
+// the platform allows it, so the Lexer scans the page cache directly;
+// otherwise (pipes, special files, a failed mapping) it is read into
+// a buffer with a single bulk read. Either way Text() stays valid for
+// the lifetime of the object, and nothing is copied after loading.
+class SourceFile
+{
+private:
+    std::string m_Buffer;       // fallback storage
+    const char *m_Mapping;      // nullptr unless mapped
+    size_t m_Size;
+#ifdef _WIN32
+    void *m_FileHandle;
+    void *m_MappingHandle;
+#endif
+
+    bool Map(const std::string &path);
+    bool Read(const std::string &path);
+    void Close();
+
+public:
+    SourceFile();
+    ~SourceFile();
+
+    // Non-copyable, non-movable: Text() hands out views into it
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+
+    // false if the file could not be opened or read
+    bool Open(const std::string &path);
+
+    std::string_view Text() const;
+    bool IsMapped() const { return m_Mapping != nullptr; }
+};
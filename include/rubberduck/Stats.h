@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+struct t_LoopKernel;
+
+// What compiling a script took, for --stats. CompiledScript::Compile()
+// always fills it in, for a few clock reads per script.
+struct t_CompileStats
+{
+    int64_t lex_ns = 0;
+    int64_t parse_ns = 0;
+    int64_t passes_ns = 0; // linking through bytecode, after parsing
+    size_t tokens = 0;
+    size_t nodes = 0; // statements and expressions, the optimizer's too
+    // The arena the tree lives in (see Arena)
+    size_t arena_chunks = 0;
+    size_t arena_used = 0;
+    size_t arena_wasted = 0;
+    size_t arena_reserved = 0;
+};
+
+// What one run did, for --stats. Engines only count into one they were
+// given, behind the same null check as the profiler, so a run without
+// it pays one predictable branch per call and per loop started.
+struct t_RunStats
+{
+    int64_t run_ns = 0;
+    uint64_t output_bytes = 0; // of display output
+    uint64_t calls = 0; // of script functions, tail calls included
+    size_t max_call_depth = 0;
+    size_t max_stack_slots = 0; // of the value stack in use at once
+
+    // `for` loops by the path they took, once per start. The VM only
+    // counts the loops it compiled to a kernel: it runs every other
+    // loop as bytecode without noticing.
+    bool counts_every_loop = false;
+    uint64_t kernel_loops = 0;      // scalar loop kernel
+    uint64_t vector_loops = 0;      // kernel with a vectorized loop
+    uint64_t closed_form_loops = 0; // kernel of closed forms only
+    uint64_t parallel_loops = 0;
+    uint64_t general_loops = 0;
+};
+
+// For a kernel that ran: one with any vectorized loop counts as one,
+// and one whose inner loops all have a closed form as such
+void CountKernelLoop(const t_LoopKernel& kernel, t_RunStats& run);
+
+// The --stats report. `compile` is nullptr for a program that was
+// loaded from the cache instead.
+void WriteStats
+(
+    const t_CompileStats* compile,
+    const t_RunStats& run,
+    std::ostream& stream
+);
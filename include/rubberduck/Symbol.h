@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Interned text, numbered in the order it was first seen. Two symbols
+// of the same table are equal exactly when their texts are.
+using t_Symbol = uint32_t;
+
+constexpr t_Symbol NO_SYMBOL = UINT32_MAX;
+
+// Maps text to symbols and back. The lexer interns every identifier
+// and the parser every string literal, so the passes after parsing
+// compare and look up names by number, and a string literal's text
+// has one stable copy that values can point at.
+//
+// Every script has a table of its own in its ASTContext, so it is
+// freed with the script, and a process compiling one script after
+// another never fills one up. Only the thread compiling the script
+// interns; once Compile() returns, the table is only read, by any
+// number of threads.
+class SymbolTable
+{
+private:
+    // A deque never moves its strings, so the views used as keys and
+    // the handles given out by String() stay valid
+    std::deque<std::string> m_Names;
+    std::unordered_map<std::string_view, t_Symbol> m_Index;
+
+public:
+    SymbolTable() = default;
+
+    // Non-copyable: symbols and handles point into the storage.
+    // Moving keeps them valid.
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+    SymbolTable(SymbolTable&&) = default;
+    SymbolTable& operator=(SymbolTable&&) = default;
+
+    t_Symbol Intern(std::string_view text);
+
+    const std::string& Name(t_Symbol symbol) const
+    {
+        return m_Names[symbol];
+    }
+
+    // Stable for the lifetime of the table, usable as a t_Value string
+    const std::string* String(t_Symbol symbol) const
+    {
+        return &Name(symbol);
+    }
+
+    size_t Size() const { return m_Names.size(); }
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// The worker threads `parallel for` runs on, and those of --batch,
+// which has a pool of its own. A job is handed to every worker at
+// once and Run() returns only when all of them are done, so the
+// script never sees a thread outlive the loop that started it.
+//
+// Workers are started once and sleep between jobs; waking them costs
+// far less than starting a thread per loop.
+class ThreadPool
+{
+private:
+    std::vector<std::thread> m_Threads;
+    std::mutex m_RunMutex; // held by the caller of Run()
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::condition_variable m_Idle;
+    const std::function<void(size_t)>* m_Job = nullptr;
+    uint64_t m_Generation = 0; // one per job, so no worker runs twice
+    size_t m_Busy = 0;
+    bool m_Stopping = false;
+
+    void WorkerLoop(size_t worker);
+
+public:
+    // `thread_count` includes the caller, which works as worker 0
+    explicit ThreadPool(size_t thread_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t WorkerCount() const { return m_Threads.size() + 1; }
+
+    // Calls job(worker) once for every worker in [0, WorkerCount())
+    // and waits for all of them. Scripts running on several threads
+    // share the pool; their jobs run one after the other.
+    void Run(const std::function<void(size_t)>& job);
+};
+
+// Sets the size of the shared pool (--threads); 0 uses every core.
+// Only has an effect before the first SharedThreadPool() call.
+void SetThreadCount(size_t thread_count);
+
+// Started on first use, so scripts without `parallel for` never start
+// a thread
+ThreadPool& SharedThreadPool();
@@ -1,5 +1,6 @@
 #pragma once
-#include <string>
+#include <cstdint>
+#include <rubberduck/Symbol.h>
 
 enum class e_TokenType
 {
@@ -8,6 +9,8 @@ enum class e_TokenType
     RIGHT_PAREN,
     LEFT_BRACE,
     RIGHT_BRACE,
+    LEFT_BRACKET,
+    RIGHT_BRACKET,
     COMMA,
     DOT,
     MINUS,
@@ -65,29 +68,65 @@ enum class e_TokenType
     AUTO,
     BENCHMARK,  
     GETIN,      
+    PARALLEL,
     TYPEOF, // TODO
     SIZEOF,
     EOF_TOKEN
 };
 
+// The binary operators that take numbers, and number arrays
+// elementwise
+inline bool IsArithmetic(e_TokenType type)
+{
+    return type == e_TokenType::PLUS  ||
+           type == e_TokenType::MINUS ||
+           type == e_TokenType::STAR  ||
+           type == e_TokenType::SLASH ||
+           type == e_TokenType::MODULUS;
+}
+
+inline bool IsComparison(e_TokenType type)
+{
+    return type == e_TokenType::LESS          ||
+           type == e_TokenType::LESS_EQUAL    ||
+           type == e_TokenType::GREATER       ||
+           type == e_TokenType::GREATER_EQUAL ||
+           type == e_TokenType::EQUAL_EQUAL   ||
+           type == e_TokenType::BANG_EQUAL;
+}
+
+// The arithmetic behind a compound assignment, EQUAL for `=`, and
+// EOF_TOKEN for anything that is not an assignment
+inline e_TokenType AssignmentOperator(e_TokenType type)
+{
+    switch (type)
+    {
+    case e_TokenType::EQUAL:
+        return e_TokenType::EQUAL;
+    case e_TokenType::PLUS_EQUAL:
+        return e_TokenType::PLUS;
+    case e_TokenType::MINUS_EQUAL:
+        return e_TokenType::MINUS;
+    case e_TokenType::STAR_EQUAL:
+        return e_TokenType::STAR;
+    case e_TokenType::SLASH_EQUAL:
+        return e_TokenType::SLASH;
+    case e_TokenType::MODULUS_EQUAL:
+        return e_TokenType::MODULUS;
+    default:
+        return e_TokenType::EOF_TOKEN;
+    }
+}
+
+// A token does not own its text: `offset` and `length` locate the
+// lexeme in the source buffer it was scanned from, which must outlive
+// the tokens. String and format string tokens span their quotes;
+// Lexer::Unescape() decodes the contents when they are needed.
 struct t_Token
 {
     e_TokenType type;
-    std::string lexeme;
-    // For literals, we could use a variant or void* to store the value
-    // For simplicity in this example, we'll just store as string
-    std::string literal;
+    uint32_t offset;
+    uint32_t length;
     int line;
-
-    explicit t_Token
-    (
-        e_TokenType type, 
-        const std::string &lexeme, 
-        const std::string &literal, 
-        int line
-    ) 
-    : type(type), 
-      lexeme(lexeme), 
-      literal(literal), 
-      line(line) {}
-};
\ No newline at end of file
+    t_Symbol symbol; // interned text of an IDENTIFIER, else NO_SYMBOL
+};
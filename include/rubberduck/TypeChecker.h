@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <rubberduck/AST.h>
+#include <rubberduck/ErrorHandling.h>
+#include <rubberduck/Resolver.h>
+
+// Static pass run after the Resolver. Every expression gets the type
+// all of its values have, as far as that is known before running, in
+// `static_type`; binary expressions on numbers get the NUMBER form,
+// which the engines evaluate without testing operand types.
+//
+// A variable keeps the type of the value it is declared with; only
+// one declared without a value (or with nil) may take any type. So a
+// variable's type is known wherever its declaration is, and the
+// parameters of functions and the results of calls to them are not.
+//
+// An operation that fails for every value its operands can have is a
+// type error reported here, before anything runs, even in code that
+// is never reached: assigning another type to a typed variable, `+`
+// on a string, arithmetic, negation or `++`/`--` on values that are
+// not numbers or arrays, and ordering comparisons of non-numbers.
+// Everything that depends on an unknown type is still checked while
+// the script runs, with the same messages.
+class TypeChecker
+{
+private:
+    const SymbolTable& m_Symbols; // of the script, for error messages
+    // Indexed by binding slot. Slots of a frame are reused once a
+    // block ends, but the walk follows the source, so a slot always
+    // has the type of the latest declaration that owns it.
+    std::vector<e_StaticType> m_GlobalTypes;
+    std::vector<e_StaticType> m_LocalTypes;
+    int m_Line = 0; // of the statement being checked
+
+    Expected<int, t_ErrorInfo> CheckStatement(t_Stmt *stmt);
+    Expected<int, t_ErrorInfo> CheckFunction(t_FunStmt *fun_stmt);
+    Expected<int, t_ErrorInfo> CheckVar(t_VarStmt *var_stmt);
+    Expected<e_StaticType, t_ErrorInfo> CheckExpression(t_Expr *expr);
+    Expected<e_StaticType, t_ErrorInfo> InferExpression(t_Expr *expr);
+    Expected<e_StaticType, t_ErrorInfo> CheckBinary(t_BinaryExpr *binary);
+    Expected<e_StaticType, t_ErrorInfo> CheckAssignment
+    (
+        t_BinaryExpr *binary
+    );
+    Expected<e_StaticType, t_ErrorInfo> CheckCall(t_CallExpr *call);
+    Expected<e_StaticType, t_ErrorInfo> CheckIncrement
+    (
+        t_Expr *operand,
+        const char *message
+    );
+
+    // UNKNOWN when the operation may succeed; fails when it cannot
+    Expected<e_StaticType, t_ErrorInfo> ArithmeticType
+    (
+        e_StaticType left,
+        e_TokenType op,
+        e_StaticType right
+    ) const;
+
+    // The declared type of a bound variable
+    e_StaticType VariableType(const t_Binding &binding) const;
+
+    t_ErrorInfo TypeError(const std::string &message) const;
+
+public:
+    explicit TypeChecker(const SymbolTable& symbols) : m_Symbols(symbols) {}
+
+    Expected<int, t_ErrorInfo> Check
+    (
+        const StmtList &statements,
+        const t_ResolvedScript &script
+    );
+};
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <rubberduck/Benchmark.h>
+#include <rubberduck/Bytecode.h>
+#include <rubberduck/ErrorHandling.h>
+#include <rubberduck/Input.h>
+#include <rubberduck/Memo.h>
+#include <rubberduck/Output.h>
+#include <rubberduck/Stats.h>
+#include <rubberduck/Value.h>
+
+// Stack based virtual machine that executes a compiled t_Program.
+// Values live in one preallocated stack; each call frame sees its
+// parameters and locals as a window into that stack.
+//
+// Like the Interpreter, a VM runs one program at a time and keeps its
+// run state to itself, so several VMs can run the same t_Program on
+// different threads.
+class VM
+{
+private:
+    struct t_CallFrame
+    {
+        const t_FunctionProto* proto;
+        const uint32_t* ip;
+        t_Value* slots;
+        bool is_memoized = false; // RETURN stores m_MemoKeys.back()
+    };
+
+    struct t_BenchmarkRun
+    {
+        const t_BenchmarkInfo* info;
+        const uint32_t* body; // first instruction of the body
+        uint32_t runs_done;   // warmup runs included
+        std::chrono::steady_clock::time_point start;
+        std::vector<int64_t> samples;
+    };
+
+    static constexpr size_t STACK_SIZE = 1 << 18;
+    static constexpr size_t SLOTS_PER_CALL = 8; // to size m_Stack
+
+    const t_Program* m_Program;
+    std::vector<t_Value> m_Stack;
+    std::vector<t_CallFrame> m_Frames;
+    size_t m_MaxCallDepth = DEFAULT_MAX_CALL_DEPTH;
+    MemoCache* m_Memo = nullptr; // only set with --memoize
+    std::vector<t_MemoKey> m_MemoKeys; // of the memoized calls running
+    t_RunStats* m_Stats = nullptr; // only set with --stats
+    std::vector<t_Value> m_Globals;
+    std::vector<uint8_t> m_GlobalDefined;
+    std::vector<t_BenchmarkRun> m_Benchmarks;
+    BenchmarkReporter m_Reporter;
+
+    // Strings created while running (format results, input lines)
+    // and arrays
+    StringPool m_Strings;
+    ArrayPool m_Arrays;
+    OutputBuffer m_Output;
+    InputReader* m_Input; // not owned
+    // Fields of the line read by the last READ_INPUT
+    std::vector<std::string_view> m_InputFields;
+    size_t m_NextInputField = 0;
+    // Register file of the last PARALLEL_FOR or LOOP_KERNEL
+    std::vector<double> m_KernelRegisters;
+
+    InterpretationResult Execute();
+
+    // Collects the strings and arrays no value holds, once enough
+    // were made. Unlike the Interpreter, the VM keeps every value it
+    // works on in its stack, below `top` while an instruction runs,
+    // so all of them can be collected.
+    void CollectIfDue(const t_Value* top)
+    {
+        if
+        (
+            m_Strings.ShouldCollect(0) ||
+            m_Arrays.ShouldCollect(ArrayPool::t_Made())
+        )
+        {
+            Collect(top);
+        }
+    }
+    void Collect(const t_Value* top);
+
+    // For --stats: one more call, `depth` calls deep, whose frame
+    // ends at `top`
+    void CountCall(size_t depth, const t_Value* top)
+    {
+        m_Stats->calls++;
+        m_Stats->max_call_depth = std::max(m_Stats->max_call_depth, depth);
+        m_Stats->max_stack_slots = std::max
+        (
+            m_Stats->max_stack_slots,
+            static_cast<size_t>(top - m_Stack.data())
+        );
+    }
+
+    // Records the run that just ended; true if the body runs again
+    bool EndBenchmarkRun(bool is_leaving);
+
+    t_ErrorInfo MakeError
+    (
+        e_ErrorType type,
+        const std::string& message,
+        const t_CallFrame& frame,
+        const uint32_t* ip
+    ) const;
+
+    const std::string& DebugName
+    (
+        const t_FunctionProto& proto,
+        const uint32_t* ip
+    ) const;
+
+    // The guard of both kernels: false when an outside variable does
+    // not hold a number. Otherwise m_KernelRegisters is ready to run.
+    bool LoadKernelRegisters
+    (
+        const t_LoopKernel& kernel,
+        const std::vector<t_VariableSlot>& kernel_slots,
+        const t_Value* slots
+    );
+    // PARALLEL_FOR: false when the guard fails, in which case nothing
+    // has been executed yet
+    Expected<bool, t_ErrorInfo> RunParallelFor
+    (
+        const t_ParallelFor& parallel,
+        t_Value* slots
+    );
+    // LOOP_KERNEL: false when the guard fails or the kernel stops on
+    // a runtime error. No variable has been written then, so the loop
+    // runs again as bytecode and reports the error at its line.
+    bool RunKernelFor(const t_KernelFor& kernel_for, t_Value* slots);
+
+    // READ_INPUT: false at the end of the input
+    bool ReadInputLine(uint32_t field_count);
+    // GETIN_*: converts the next field to the type of `current`
+    Expected<t_Value, t_ErrorInfo> NextInputField
+    (
+        const t_Value& current,
+        const std::string& name
+    );
+
+public:
+    VM();
+
+    VM(const VM&) = delete;
+    VM& operator=(const VM&) = delete;
+
+    void SetBenchmarkFormat(e_BenchmarkFormat format);
+    void SetFlushPolicy(e_FlushPolicy policy);
+    // Not owned; display output and benchmark results go here
+    void SetOutput(std::ostream& stream);
+    // Not owned; read by `getin`
+    void SetInput(InputReader& input);
+    // Calls that may be nested at once; one more is a runtime error.
+    // Frames live on the heap, so only memory bounds the depth; a
+    // tail call replaces its caller and does not count.
+    void SetMaxCallDepth(size_t depth);
+    // Not owned; must outlive Run(). Calls of pure functions reuse
+    // the results it holds.
+    void SetMemoCache(MemoCache* memo);
+    // Not owned; must outlive Run(). Counts calls and the loops that
+    // ran as kernels.
+    void SetStats(t_RunStats* stats);
+    // Bytes of display output written since construction
+    uint64_t OutputBytes() const { return m_Output.BytesWritten(); }
+    InterpretationResult Run(const t_Program& program);
+};
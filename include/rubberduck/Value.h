@@ -0,0 +1,402 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <rubberduck/ErrorHandling.h>
+
+// Type enumeration for RD Script values
+enum class e_ValueType
+{
+    NIL,
+    NUMBER,
+    STRING,
+    BOOLEAN,
+    ARRAY,       // of numbers
+    STRING_ARRAY
+};
+
+// Elements of an array value, contiguous so that the builtins can run
+// over them with vector instructions
+using t_NumberArray = std::vector<double>;
+using t_StringArray = std::vector<const std::string*>;
+
+// Compact tagged value used by the bytecode VM. Strings are handles
+// into a StringPool and arrays into an ArrayPool, so copying a value
+// never touches the heap.
+struct t_Value
+{
+    e_ValueType type;
+    union
+    {
+        double number;
+        bool boolean;
+        const std::string* string;
+        t_NumberArray* array;
+        t_StringArray* string_array;
+    };
+
+    t_Value() : type(e_ValueType::NIL), number(0.0) {}
+
+    explicit t_Value(double number_)
+        : type(e_ValueType::NUMBER), number(number_) {}
+
+    explicit t_Value(bool boolean_)
+        : type(e_ValueType::BOOLEAN), boolean(boolean_) {}
+
+    explicit t_Value(const std::string* string_)
+        : type(e_ValueType::STRING), string(string_) {}
+
+    explicit t_Value(t_NumberArray* array_)
+        : type(e_ValueType::ARRAY), array(array_) {}
+
+    explicit t_Value(t_StringArray* string_array_)
+        : type(e_ValueType::STRING_ARRAY), string_array(string_array_) {}
+
+    bool IsNumber() const { return type == e_ValueType::NUMBER; }
+    bool IsString() const { return type == e_ValueType::STRING; }
+    bool IsBoolean() const { return type == e_ValueType::BOOLEAN; }
+    bool IsNil() const { return type == e_ValueType::NIL; }
+    bool IsArray() const { return type == e_ValueType::ARRAY; }
+    bool IsStringArray() const
+    {
+        return type == e_ValueType::STRING_ARRAY;
+    }
+};
+
+// Values an engine makes while running, each in a slot of its own.
+// The pool cannot see which values the engine still holds, so the
+// engine collects: once ShouldCollect() says enough were made since
+// the last time, it passes every value it holds to Mark() and then
+// calls Sweep(), which takes back the slots no Mark() reached. A slot
+// keeps its buffer when it is taken back, so a loop that keeps making
+// and dropping values settles on a fixed set of slots.
+//
+// An engine may also hold values it cannot pass to Mark(), if it
+// knows they were all made before a certain one: it then collects
+// only the values made from that one on (`first`).
+//
+// A value counts toward a collection by its weight, so that a large
+// array brings the next collection closer than a small one.
+template<typename T>
+class CollectedPool
+{
+private:
+    struct t_Slot
+    {
+        T value;
+        size_t weight = 1;
+        uint32_t collection = 0; // the last one that marked it
+    };
+
+    // Collections wait for no less weight than this
+    static constexpr size_t MIN_COLLECT_INTERVAL = 1 << 14;
+
+    std::deque<t_Slot> m_Slots;
+    std::unordered_map<const T*, t_Slot*> m_SlotOf; // every slot
+    std::vector<t_Slot*> m_Made;  // in use, oldest first
+    std::vector<size_t> m_Weight; // [i]: of m_Made[0, i) together
+    std::vector<t_Slot*> m_Free;
+    uint32_t m_Collection = 1;
+    size_t m_Visited = 0; // values looked at during this collection
+    // Unswept weight a collection waits for
+    size_t m_Interval = MIN_COLLECT_INTERVAL;
+    // m_Made[m_KeptFirst, m_Kept) survived the last collection
+    size_t m_KeptFirst = 0;
+    size_t m_Kept = 0;
+
+public:
+    CollectedPool() : m_Weight(1, 0) {}
+
+    // Non-copyable: values hold raw handles into the storage
+    CollectedPool(const CollectedPool&) = delete;
+    CollectedPool& operator=(const CollectedPool&) = delete;
+
+    // A slot in use until a Sweep() finds it unmarked. A reused slot
+    // holds what it held before; the caller overwrites it.
+    T* Make(size_t weight = 1)
+    {
+        t_Slot* slot = nullptr;
+        if (m_Free.empty())
+        {
+            slot = &m_Slots.emplace_back();
+            m_SlotOf.emplace(&slot->value, slot);
+        }
+        else
+        {
+            slot = m_Free.back();
+            m_Free.pop_back();
+        }
+        slot->weight = weight;
+        m_Made.push_back(slot);
+        m_Weight.push_back(m_Weight.back() + weight);
+        return &slot->value;
+    }
+
+    // A value made earlier gained `weight`. It is counted with the
+    // newest value instead, which is in the region of the code that
+    // runs unless that has made none yet.
+    void Grow(size_t weight)
+    {
+        if (!m_Made.empty())
+        {
+            m_Made.back()->weight += weight;
+            m_Weight.back() += weight;
+        }
+    }
+
+    // Values made so far that no Sweep() has taken back yet
+    size_t MadeCount() const { return m_Made.size(); }
+
+    // True once the values made from the `first`-th on, less those
+    // the last collection kept, fill the interval. Values a deeper
+    // collection could not reach count here too, so the first
+    // collection that can take them back does.
+    bool ShouldCollect(size_t first) const
+    {
+        size_t made = m_Weight.back() - m_Weight[first];
+        if (made < m_Interval)
+        {
+            return false;
+        }
+        size_t kept_first = std::max(first, m_KeptFirst);
+        size_t kept = m_Kept > kept_first
+            ? m_Weight[m_Kept] - m_Weight[kept_first]
+            : 0;
+        return made - kept >= m_Interval;
+    }
+
+    // Marks `value` if it is one of the pool's and was not marked by
+    // this collection yet, and says whether it did. Anything else,
+    // even a handle to a slot that was taken back, is ignored.
+    bool Mark(const T* value)
+    {
+        m_Visited++;
+        typename std::unordered_map<const T*, t_Slot*>::iterator it =
+        m_SlotOf.find(value);
+        if (it == m_SlotOf.end() || it->second->collection == m_Collection)
+        {
+            return false;
+        }
+        it->second->collection = m_Collection;
+        return true;
+    }
+
+    // Counts values looked at without a Mark() of their own, such as
+    // the strings of a string array
+    void Visit(size_t count) { m_Visited += count; }
+
+    // Takes back the unmarked slots among those made from the
+    // `first`-th on, the older ones are all kept, and ends the
+    // collection. `release` is given the value of each slot taken
+    // back.
+    template<typename F>
+    void Sweep(size_t first, F release)
+    {
+        size_t kept = first;
+        for (size_t i = first; i < m_Made.size(); ++i)
+        {
+            t_Slot* slot = m_Made[i];
+            if (slot->collection == m_Collection)
+            {
+                m_Made[kept++] = slot;
+                continue;
+            }
+            release(slot->value);
+            m_Free.push_back(slot);
+        }
+        m_Made.resize(kept);
+        m_Weight.resize(kept + 1);
+        for (size_t i = first; i < kept; ++i)
+        {
+            m_Weight[i + 1] = m_Weight[i] + m_Made[i]->weight;
+        }
+
+        // The next collection waits for at least as much unswept
+        // weight as this one looked at, which bounds the time spent
+        // marking and sweeping by a constant per value made
+        m_Interval = std::max
+        (
+            MIN_COLLECT_INTERVAL,
+            std::max(m_Weight[kept] - m_Weight[first], m_Visited)
+        );
+        m_KeptFirst = first;
+        m_Kept = kept;
+        m_Visited = 0;
+        m_Collection++;
+    }
+
+    // Frees every slot, in use or not
+    void Clear()
+    {
+        m_SlotOf.clear();
+        m_Made.clear();
+        m_Weight.assign(1, 0);
+        m_Free.clear();
+        m_Slots.clear();
+        m_Visited = 0;
+        m_Interval = MIN_COLLECT_INTERVAL;
+        m_KeptFirst = 0;
+        m_Kept = 0;
+    }
+};
+
+// Storage for string values. Text known before the run, such as the
+// value of a literal, is interned: stored once per distinct text, at
+// an address that stays valid until Clear(). Strings made while
+// running (format strings, input) are not interned, and a collection
+// (see CollectedPool) takes back the ones no value holds any more.
+class StringPool
+{
+private:
+    // Made strings whose buffer grew past this give it back when
+    // their slot is taken back, instead of keeping it for reuse
+    static constexpr size_t MAX_KEPT_CAPACITY = 1 << 12;
+
+    std::deque<std::string> m_Storage;
+    std::unordered_map<std::string_view, const std::string*> m_Index;
+    CollectedPool<std::string> m_Made;
+
+public:
+    StringPool() = default;
+
+    // Non-copyable: values hold raw handles into the storage
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    const std::string* Intern(std::string_view text);
+    size_t Size() const { return m_Storage.size() + m_Made.MadeCount(); }
+
+    // An empty string to build a value in. Strings made later, by
+    // calls it waits on for instance, never reuse it before a
+    // collection finds nothing holding it.
+    std::string* Make()
+    {
+        std::string* text = m_Made.Make();
+        text->clear();
+        return text;
+    }
+    const std::string* Make(std::string_view text)
+    {
+        std::string* made = Make();
+        made->assign(text);
+        return made;
+    }
+
+    // See CollectedPool
+    size_t MadeCount() const { return m_Made.MadeCount(); }
+    bool ShouldCollect(size_t first) const
+    {
+        return m_Made.ShouldCollect(first);
+    }
+    // Marks the string of a value; ArrayPool marks those of the
+    // string arrays it keeps
+    void Mark(const t_Value& value);
+    void Mark(const t_Value* values, size_t count);
+    void Mark(const t_StringArray& array);
+    void Sweep(size_t first);
+
+    // Frees every string, interned or made
+    void Clear();
+};
+
+// Storage for array values. An array is shared, not copied: every
+// value holding its handle sees the same elements. Arrays are
+// collected like made strings (see CollectedPool), weighing one per
+// element, and collected together with them: marking a string array
+// marks its strings.
+class ArrayPool
+{
+private:
+    // Arrays that grew past this many elements give their buffer back
+    // when their slot is taken back
+    static constexpr size_t MAX_KEPT_CAPACITY = 1 << 12;
+
+    CollectedPool<t_NumberArray> m_Numbers;
+    CollectedPool<t_StringArray> m_Strings;
+
+public:
+    // Arrays of each kind made so far, see CollectedPool::MadeCount()
+    struct t_Made
+    {
+        size_t numbers = 0;
+        size_t strings = 0;
+    };
+
+    ArrayPool() = default;
+
+    // Non-copyable: values hold raw handles into the storage
+    ArrayPool(const ArrayPool&) = delete;
+    ArrayPool& operator=(const ArrayPool&) = delete;
+
+    t_NumberArray* NewNumbers(size_t size = 0);
+    t_StringArray* NewStrings(size_t size = 0);
+    size_t Size() const
+    {
+        return m_Numbers.MadeCount() + m_Strings.MadeCount();
+    }
+
+    // `array` gained `count` elements
+    void Grow(const t_Value& array, size_t count);
+
+    // See CollectedPool
+    t_Made MadeCount() const
+    {
+        return t_Made{m_Numbers.MadeCount(), m_Strings.MadeCount()};
+    }
+    bool ShouldCollect(const t_Made& first) const
+    {
+        return
+            m_Numbers.ShouldCollect(first.numbers) ||
+            m_Strings.ShouldCollect(first.strings);
+    }
+    // Marks the array of a value, and the strings of a string array
+    // it marks first
+    void Mark(const t_Value& value, StringPool& strings);
+    void Mark(const t_Value* values, size_t count, StringPool& strings);
+    void Sweep(const t_Made& first);
+
+    // Frees every array
+    void Clear();
+};
+
+// Formats a number the way `display` prints it (trailing zeros removed)
+std::string FormatNumber(double value);
+void AppendNumber(std::string& out, double value);
+
+// Appends the display form of a value to the output string
+void AppendValue(std::string& out, const t_Value& value);
+
+// Only `false` and `nil` are falsey
+bool IsTruthy(const t_Value& value);
+
+// Strict equality: values of different types are never equal, and
+// arrays are equal when their elements are
+bool ValuesEqual(const t_Value& left, const t_Value& right);
+
+// Human readable type name used in type errors
+const char* ValueTypeName(e_ValueType type);
+
+// Parses a leading number like std::stod: skips leading whitespace,
+// ignores trailing characters. Returns false if no number was found.
+bool ParseNumber(std::string_view text, double& out_value);
+
+// Infers the type of untyped text the way `getin` does: nil, true and
+// false are keywords, an optional '-' with digits and at most one '.'
+// is a number, anything else is a string.
+t_Value InferValue(std::string_view text, StringPool& strings);
+
+// Converts a line read by `getin` to the type currently held by the
+// target variable; `name` is only used in error messages.
+Expected<t_Value, t_ErrorInfo> ConvertInput
+(
+    std::string_view input,
+    const t_Value& current,
+    const std::string& name,
+    StringPool& strings
+);
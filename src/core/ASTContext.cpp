@@ -1,25 +1,17 @@
 #include <rubberduck/ASTContext.h>
 
 ASTContext::ASTContext()
-    : m_StmtPool(std::make_unique<MemoryPool>(sizeof(StmtVariant)))
-    , m_ExprPool(std::make_unique<MemoryPool>(sizeof(ExprVariant)))
+    : m_Arena(std::make_unique<Arena>())
 {
 }
 
-ASTContext::~ASTContext()
-{
-    Reset();
-}
+ASTContext::~ASTContext() = default;
 
 void ASTContext::Reset()
 {
-    if (m_StmtPool)
+    if (m_Arena)
     {
-        m_StmtPool->Reset();
+        m_Arena->Reset();
     }
-    
-    if (m_ExprPool)
-    {
-        m_ExprPool->Reset();
-    }
-}
\ No newline at end of file
+    m_NodeCount = 0;
+}
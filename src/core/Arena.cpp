@@ -0,0 +1,97 @@
+#include <rubberduck/Arena.h>
+
+Arena::Arena()
+    : m_Chunks(nullptr), 
+      m_Cursor(nullptr), 
+      m_End(nullptr), 
+      m_NextChunkSize(FIRST_CHUNK_SIZE),
+      m_BytesUsed(0),
+      m_BytesWasted(0),
+      m_BytesReserved(0),
+      m_ChunkCount(0)
+{
+}
+
+Arena::~Arena()
+{
+    t_Chunk* chunk = m_Chunks;
+    while (chunk)
+    {
+        t_Chunk* next = chunk->next;
+        std::free(chunk);
+        chunk = next;
+    }
+}
+
+bool Arena::AddChunk(size_t min_size)
+{
+    size_t size = m_NextChunkSize;
+    while (size < min_size)
+    {
+        size *= 2;
+    }
+
+    t_Chunk* chunk = static_cast<t_Chunk*>
+    (
+        std::malloc(sizeof(t_Chunk) + size)
+    );
+    if (!chunk)
+    {
+        return false;
+    }
+
+    // Whatever is left of the current chunk can no longer be used
+    if (m_Cursor)
+    {
+        m_BytesWasted += static_cast<size_t>(m_End - m_Cursor);
+    }
+
+    chunk->next = m_Chunks;
+    chunk->size = size;
+    m_Chunks = chunk;
+    m_Cursor = reinterpret_cast<char*>(chunk + 1);
+    m_End = m_Cursor + size;
+    m_BytesReserved += size;
+    m_ChunkCount++;
+
+    if (m_NextChunkSize < MAX_CHUNK_SIZE)
+    {
+        m_NextChunkSize *= 2;
+    }
+    return true;
+}
+
+void* Arena::AllocateSlow(size_t size, size_t alignment)
+{
+    // Room for the worst-case padding, since the chunk start is only
+    // aligned to max_align_t
+    if (!AddChunk(size + alignment))
+    {
+        return nullptr;
+    }
+    return Allocate(size, alignment);
+}
+
+void Arena::Reset()
+{
+    if (!m_Chunks)
+    {
+        return;
+    }
+
+    t_Chunk* chunk = m_Chunks->next;
+    while (chunk)
+    {
+        t_Chunk* next = chunk->next;
+        std::free(chunk);
+        chunk = next;
+    }
+
+    m_Chunks->next = nullptr;
+    m_Cursor = reinterpret_cast<char*>(m_Chunks + 1);
+    m_End = m_Cursor + m_Chunks->size;
+    m_BytesUsed = 0;
+    m_BytesWasted = 0;
+    m_BytesReserved = m_Chunks->size;
+    m_ChunkCount = 1;
+}
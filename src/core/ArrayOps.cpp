@@ -0,0 +1,771 @@
+#include <rubberduck/ArrayOps.h>
+#include <rubberduck/Simd.h>
+#include <cmath>
+#include <limits>
+#include <string>
+
+namespace
+{
+    // Four vectors in flight hide the latency of the additions
+    constexpr size_t UNROLL = 4;
+    constexpr size_t BLOCK = UNROLL * LANE_WIDTH;
+    static_assert(LANE_WIDTH == 4, "CombineLanes() adds four lanes");
+
+    // (s0 + s1) + (s2 + s3), then the same across the lanes: the order
+    // does not depend on the instruction set
+    RD_ALWAYS_INLINE double CombineLanes(const t_Lanes sums[UNROLL])
+    {
+        t_Lanes total = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+        return (total[0] + total[1]) + (total[2] + total[3]);
+    }
+
+    RD_ALWAYS_INLINE double SumBody(const double *values, size_t count)
+    {
+        t_Lanes sums[UNROLL];
+        for (size_t u = 0; u < UNROLL; ++u)
+        {
+            Broadcast(sums[u], 0.0);
+        }
+
+        size_t i = 0;
+        for (; i + BLOCK <= count; i += BLOCK)
+        {
+            for (size_t u = 0; u < UNROLL; ++u)
+            {
+                t_Lanes lanes;
+                LoadLanes(lanes, values + i + u * LANE_WIDTH);
+                sums[u] = sums[u] + lanes;
+            }
+        }
+
+        double total = CombineLanes(sums);
+        for (; i < count; ++i)
+        {
+            total += values[i];
+        }
+        return total;
+    }
+
+    RD_ALWAYS_INLINE double DotBody
+    (
+        const double *left,
+        const double *right,
+        size_t count
+    )
+    {
+        t_Lanes sums[UNROLL];
+        for (size_t u = 0; u < UNROLL; ++u)
+        {
+            Broadcast(sums[u], 0.0);
+        }
+
+        size_t i = 0;
+        for (; i + BLOCK <= count; i += BLOCK)
+        {
+            for (size_t u = 0; u < UNROLL; ++u)
+            {
+                size_t at = i + u * LANE_WIDTH;
+                t_Lanes left_lanes;
+                t_Lanes right_lanes;
+                LoadLanes(left_lanes, left + at);
+                LoadLanes(right_lanes, right + at);
+                sums[u] = sums[u] + left_lanes * right_lanes;
+            }
+        }
+
+        double total = CombineLanes(sums);
+        for (; i < count; ++i)
+        {
+            total += left[i] * right[i];
+        }
+        return total;
+    }
+
+    // One running extreme per element of a block. `v < best ? v : best`
+    // is exactly what MINPD computes, NaN included, so the compiler
+    // turns the inner loop into vector instructions.
+    template<bool IS_MAX>
+    RD_ALWAYS_INLINE double ExtremeBody(const double *values, size_t count)
+    {
+        constexpr double START = IS_MAX
+            ? -std::numeric_limits<double>::infinity()
+            : std::numeric_limits<double>::infinity();
+
+        double best[BLOCK];
+        for (size_t b = 0; b < BLOCK; ++b)
+        {
+            best[b] = START;
+        }
+
+        size_t i = 0;
+        for (; i + BLOCK <= count; i += BLOCK)
+        {
+            for (size_t b = 0; b < BLOCK; ++b)
+            {
+                double value = values[i + b];
+                bool is_better = IS_MAX ? value > best[b] : value < best[b];
+                best[b] = is_better ? value : best[b];
+            }
+        }
+        for (; i < count; ++i)
+        {
+            double value = values[i];
+            bool is_better = IS_MAX ? value > best[0] : value < best[0];
+            best[0] = is_better ? value : best[0];
+        }
+
+        for (size_t b = 1; b < BLOCK; ++b)
+        {
+            bool is_better = IS_MAX ? best[b] > best[0] : best[b] < best[0];
+            best[0] = is_better ? best[b] : best[0];
+        }
+        return best[0];
+    }
+
+    struct t_Add
+    {
+        template<typename T>
+        RD_ALWAYS_INLINE void operator()
+        (
+            T& out,
+            const T& a,
+            const T& b
+        ) const
+        {
+            out = a + b;
+        }
+    };
+
+    struct t_Subtract
+    {
+        template<typename T>
+        RD_ALWAYS_INLINE void operator()
+        (
+            T& out,
+            const T& a,
+            const T& b
+        ) const
+        {
+            out = a - b;
+        }
+    };
+
+    struct t_Multiply
+    {
+        template<typename T>
+        RD_ALWAYS_INLINE void operator()
+        (
+            T& out,
+            const T& a,
+            const T& b
+        ) const
+        {
+            out = a * b;
+        }
+    };
+
+    struct t_Divide
+    {
+        template<typename T>
+        RD_ALWAYS_INLINE void operator()
+        (
+            T& out,
+            const T& a,
+            const T& b
+        ) const
+        {
+            out = a / b;
+        }
+    };
+
+    // out[i] = left[i] op right[i], where a scalar side is one number
+    // used for every element
+    template<bool LEFT_SCALAR, bool RIGHT_SCALAR, typename t_Op>
+    RD_ALWAYS_INLINE void MapLanes
+    (
+        const double *left,
+        const double *right,
+        double *out,
+        size_t count,
+        t_Op op
+    )
+    {
+        t_Lanes left_lanes;
+        t_Lanes right_lanes;
+        Broadcast(left_lanes, LEFT_SCALAR ? *left : 0.0);
+        Broadcast(right_lanes, RIGHT_SCALAR ? *right : 0.0);
+
+        size_t i = 0;
+        for (; i + LANE_WIDTH <= count; i += LANE_WIDTH)
+        {
+            if (!LEFT_SCALAR)
+            {
+                LoadLanes(left_lanes, left + i);
+            }
+            if (!RIGHT_SCALAR)
+            {
+                LoadLanes(right_lanes, right + i);
+            }
+            t_Lanes out_lanes;
+            op(out_lanes, left_lanes, right_lanes);
+            StoreLanes(out + i, out_lanes);
+        }
+        for (; i < count; ++i)
+        {
+            op
+            (
+                out[i],
+                left[LEFT_SCALAR ? 0 : i],
+                right[RIGHT_SCALAR ? 0 : i]
+            );
+        }
+    }
+
+    template<typename t_Op>
+    RD_ALWAYS_INLINE void MapShape
+    (
+        const double *left,
+        bool is_left_scalar,
+        const double *right,
+        bool is_right_scalar,
+        double *out,
+        size_t count,
+        t_Op op
+    )
+    {
+        if (is_left_scalar)
+        {
+            MapLanes<true, false>(left, right, out, count, op);
+        }
+        else if (is_right_scalar)
+        {
+            MapLanes<false, true>(left, right, out, count, op);
+        }
+        else
+        {
+            MapLanes<false, false>(left, right, out, count, op);
+        }
+    }
+
+    // `%` has no vector instruction and stays a scalar loop
+    RD_ALWAYS_INLINE void MapBody
+    (
+        e_TokenType op,
+        const double *left,
+        bool is_left_scalar,
+        const double *right,
+        bool is_right_scalar,
+        double *out,
+        size_t count
+    )
+    {
+        switch (op)
+        {
+        case e_TokenType::PLUS:
+            MapShape
+            (
+                left, is_left_scalar, right, is_right_scalar, out, count,
+                t_Add()
+            );
+            break;
+        case e_TokenType::MINUS:
+            MapShape
+            (
+                left, is_left_scalar, right, is_right_scalar, out, count,
+                t_Subtract()
+            );
+            break;
+        case e_TokenType::STAR:
+            MapShape
+            (
+                left, is_left_scalar, right, is_right_scalar, out, count,
+                t_Multiply()
+            );
+            break;
+        case e_TokenType::SLASH:
+            MapShape
+            (
+                left, is_left_scalar, right, is_right_scalar, out, count,
+                t_Divide()
+            );
+            break;
+        default:
+            for (size_t i = 0; i < count; ++i)
+            {
+                out[i] = std::fmod
+                (
+                    left[is_left_scalar ? 0 : i],
+                    right[is_right_scalar ? 0 : i]
+                );
+            }
+            break;
+        }
+    }
+
+    double SumBaseline(const double *values, size_t count)
+    {
+        return SumBody(values, count);
+    }
+
+    double DotBaseline(const double *left, const double *right, size_t count)
+    {
+        return DotBody(left, right, count);
+    }
+
+    double MinBaseline(const double *values, size_t count)
+    {
+        return ExtremeBody<false>(values, count);
+    }
+
+    double MaxBaseline(const double *values, size_t count)
+    {
+        return ExtremeBody<true>(values, count);
+    }
+
+    void MapBaseline
+    (
+        e_TokenType op,
+        const double *left,
+        bool is_left_scalar,
+        const double *right,
+        bool is_right_scalar,
+        double *out,
+        size_t count
+    )
+    {
+        MapBody(op, left, is_left_scalar, right, is_right_scalar, out, count);
+    }
+
+#if RD_RUNTIME_AVX2
+    __attribute__((target("avx2")))
+    double SumAvx2(const double *values, size_t count)
+    {
+        return SumBody(values, count);
+    }
+
+    __attribute__((target("avx2")))
+    double DotAvx2(const double *left, const double *right, size_t count)
+    {
+        return DotBody(left, right, count);
+    }
+
+    __attribute__((target("avx2")))
+    double MinAvx2(const double *values, size_t count)
+    {
+        return ExtremeBody<false>(values, count);
+    }
+
+    __attribute__((target("avx2")))
+    double MaxAvx2(const double *values, size_t count)
+    {
+        return ExtremeBody<true>(values, count);
+    }
+
+    __attribute__((target("avx2")))
+    void MapAvx2
+    (
+        e_TokenType op,
+        const double *left,
+        bool is_left_scalar,
+        const double *right,
+        bool is_right_scalar,
+        double *out,
+        size_t count
+    )
+    {
+        MapBody(op, left, is_left_scalar, right, is_right_scalar, out, count);
+    }
+#endif
+
+    // The starting value of ExtremeBody() comes back when every
+    // element is NaN, or when that infinity is in the array
+    bool CheckExtreme
+    (
+        const double *values,
+        size_t count,
+        double start,
+        double& result
+    )
+    {
+        if (result != start)
+        {
+            return true;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (values[i] == start)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    t_ErrorInfo ArithmeticError()
+    {
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR,
+            "Cannot perform arithmetic operation"
+        );
+    }
+
+    Expected<size_t, t_ErrorInfo> ElementIndex
+    (
+        const t_Value& index,
+        size_t size
+    )
+    {
+        if (!index.IsNumber())
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Array index must be a number"
+            );
+        }
+
+        // NaN fails the first test as well
+        double number = index.number;
+        if (std::floor(number) != number)
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Array index must be a whole number"
+            );
+        }
+        if (number < 0.0 || number >= static_cast<double>(size))
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Array index " + FormatNumber(number) +
+                " is out of range for an array of " +
+                std::to_string(size) + " elements"
+            );
+        }
+        return Expected<size_t, t_ErrorInfo>(static_cast<size_t>(number));
+    }
+}
+
+double SumNumbers(const double *values, size_t count)
+{
+#if RD_RUNTIME_AVX2
+    if (CpuHasAvx2())
+    {
+        return SumAvx2(values, count);
+    }
+#endif
+    return SumBaseline(values, count);
+}
+
+double DotNumbers(const double *left, const double *right, size_t count)
+{
+#if RD_RUNTIME_AVX2
+    if (CpuHasAvx2())
+    {
+        return DotAvx2(left, right, count);
+    }
+#endif
+    return DotBaseline(left, right, count);
+}
+
+bool MinNumber(const double *values, size_t count, double& result)
+{
+#if RD_RUNTIME_AVX2
+    result = CpuHasAvx2()
+        ? MinAvx2(values, count)
+        : MinBaseline(values, count);
+#else
+    result = MinBaseline(values, count);
+#endif
+    return CheckExtreme
+    (
+        values,
+        count,
+        std::numeric_limits<double>::infinity(),
+        result
+    );
+}
+
+bool MaxNumber(const double *values, size_t count, double& result)
+{
+#if RD_RUNTIME_AVX2
+    result = CpuHasAvx2()
+        ? MaxAvx2(values, count)
+        : MaxBaseline(values, count);
+#else
+    result = MaxBaseline(values, count);
+#endif
+    return CheckExtreme
+    (
+        values,
+        count,
+        -std::numeric_limits<double>::infinity(),
+        result
+    );
+}
+
+Expected<t_Value, t_ErrorInfo> MakeArray
+(
+    const t_Value *elements,
+    size_t count,
+    ArrayPool& arrays
+)
+{
+    if (count > 0 && elements[0].IsString())
+    {
+        t_StringArray *array = arrays.NewStrings(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!elements[i].IsString())
+            {
+                return t_ErrorInfo
+                (
+                    e_ErrorType::RUNTIME_ERROR,
+                    "Array elements must be all numbers or all strings"
+                );
+            }
+            (*array)[i] = elements[i].string;
+        }
+        return Expected<t_Value, t_ErrorInfo>(t_Value(array));
+    }
+
+    t_NumberArray *array = arrays.NewNumbers(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!elements[i].IsNumber())
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Array elements must be all numbers or all strings"
+            );
+        }
+        (*array)[i] = elements[i].number;
+    }
+    return Expected<t_Value, t_ErrorInfo>(t_Value(array));
+}
+
+Expected<t_Value, t_ErrorInfo> GetElement
+(
+    const t_Value& array,
+    const t_Value& index
+)
+{
+    if (array.IsArray())
+    {
+        Expected<size_t, t_ErrorInfo> at =
+        ElementIndex(index, array.array->size());
+        if (!at)
+        {
+            return at.Error();
+        }
+        return Expected<t_Value, t_ErrorInfo>
+        (
+            t_Value((*array.array)[at.Value()])
+        );
+    }
+
+    if (array.IsStringArray())
+    {
+        Expected<size_t, t_ErrorInfo> at =
+        ElementIndex(index, array.string_array->size());
+        if (!at)
+        {
+            return at.Error();
+        }
+        return Expected<t_Value, t_ErrorInfo>
+        (
+            t_Value((*array.string_array)[at.Value()])
+        );
+    }
+
+    return t_ErrorInfo
+    (
+        e_ErrorType::RUNTIME_ERROR,
+        std::string("Cannot index a ") + ValueTypeName(array.type) +
+        " value"
+    );
+}
+
+Expected<t_Value, t_ErrorInfo> SetElement
+(
+    const t_Value& array,
+    const t_Value& index,
+    const t_Value& value
+)
+{
+    if (!array.IsArray() && !array.IsStringArray())
+    {
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR,
+            std::string("Cannot index a ") + ValueTypeName(array.type) +
+            " value"
+        );
+    }
+
+    size_t size = array.IsArray()
+        ? array.array->size()
+        : array.string_array->size();
+    Expected<size_t, t_ErrorInfo> at = ElementIndex(index, size);
+    if (!at)
+    {
+        return at.Error();
+    }
+
+    e_ValueType element_type = array.IsArray()
+        ? e_ValueType::NUMBER
+        : e_ValueType::STRING;
+    if (value.type != element_type)
+    {
+        return t_ErrorInfo
+        (
+            e_ErrorType::TYPE_ERROR,
+            std::string("Type mismatch: array element is ") +
+            ValueTypeName(element_type) + ", cannot assign " +
+            ValueTypeName(value.type)
+        );
+    }
+
+    if (array.IsArray())
+    {
+        (*array.array)[at.Value()] = value.number;
+    }
+    else
+    {
+        (*array.string_array)[at.Value()] = value.string;
+    }
+    return Expected<t_Value, t_ErrorInfo>(value);
+}
+
+Expected<t_Value, t_ErrorInfo> SizeOf(const t_Value& value)
+{
+    switch (value.type)
+    {
+    case e_ValueType::ARRAY:
+        return Expected<t_Value, t_ErrorInfo>
+        (
+            t_Value(static_cast<double>(value.array->size()))
+        );
+    case e_ValueType::STRING_ARRAY:
+        return Expected<t_Value, t_ErrorInfo>
+        (
+            t_Value(static_cast<double>(value.string_array->size()))
+        );
+    case e_ValueType::STRING:
+        return Expected<t_Value, t_ErrorInfo>
+        (
+            t_Value(static_cast<double>(value.string->size()))
+        );
+    default:
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR,
+            std::string("Cannot take sizeof() of a ") +
+            ValueTypeName(value.type) + " value"
+        );
+    }
+}
+
+Expected<t_Value, t_ErrorInfo> ArrayArithmetic
+(
+    const t_Value& left,
+    e_TokenType op,
+    const t_Value& right,
+    ArrayPool& arrays
+)
+{
+    if
+    (
+        !(left.IsArray() || right.IsArray()) ||
+        !(left.IsArray() || left.IsNumber()) ||
+        !(right.IsArray() || right.IsNumber())
+    )
+    {
+        return ArithmeticError();
+    }
+
+    bool is_left_scalar = left.IsNumber();
+    bool is_right_scalar = right.IsNumber();
+    const double *left_data = is_left_scalar
+        ? &left.number
+        : left.array->data();
+    const double *right_data = is_right_scalar
+        ? &right.number
+        : right.array->data();
+    size_t count = is_left_scalar ? right.array->size() : left.array->size();
+    if (!is_left_scalar && !is_right_scalar && right.array->size() != count)
+    {
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR,
+            "Cannot combine arrays of " + std::to_string(count) + " and " +
+            std::to_string(right.array->size()) + " elements"
+        );
+    }
+
+    switch (op)
+    {
+    case e_TokenType::PLUS:
+    case e_TokenType::MINUS:
+    case e_TokenType::STAR:
+        break;
+    case e_TokenType::SLASH:
+    case e_TokenType::MODULUS:
+        {
+            size_t divisors = is_right_scalar ? 1 : count;
+            for (size_t i = 0; i < divisors; ++i)
+            {
+                if (right_data[i] == 0.0)
+                {
+                    return t_ErrorInfo
+                    (
+                        e_ErrorType::RUNTIME_ERROR,
+                        op == e_TokenType::SLASH
+                            ? "Division by zero"
+                            : "Modulus by zero"
+                    );
+                }
+            }
+        }
+        break;
+    default:
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR,
+            "Unsupported binary operator"
+        );
+    }
+
+    t_NumberArray *result = arrays.NewNumbers(count);
+#if RD_RUNTIME_AVX2
+    if (CpuHasAvx2())
+    {
+        MapAvx2
+        (
+            op,
+            left_data,
+            is_left_scalar,
+            right_data,
+            is_right_scalar,
+            result->data(),
+            count
+        );
+        return Expected<t_Value, t_ErrorInfo>(t_Value(result));
+    }
+#endif
+    MapBaseline
+    (
+        op,
+        left_data,
+        is_left_scalar,
+        right_data,
+        is_right_scalar,
+        result->data(),
+        count
+    );
+    return Expected<t_Value, t_ErrorInfo>(t_Value(result));
+}
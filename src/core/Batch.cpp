@@ -0,0 +1,316 @@
+#include <rubberduck/Batch.h>
+#include <rubberduck/Input.h>
+#include <rubberduck/Interpreter.h>
+#include <rubberduck/ProgramCache.h>
+#include <rubberduck/SourceFile.h>
+#include <rubberduck/ThreadPool.h>
+#include <rubberduck/VM.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+    int64_t NanosecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>
+        (
+            std::chrono::steady_clock::now() - start
+        ).count();
+    }
+
+    void Fail(t_BatchResult& result, const std::string& message)
+    {
+        result.failed = true;
+        result.error = t_ErrorInfo(e_ErrorType::RUNTIME_ERROR, message);
+    }
+
+    // Compiles and runs one script, the same way main() runs a single
+    // one; `output` collects what it displays
+    void RunScript
+    (
+        t_BatchResult& result,
+        const t_BatchOptions& options,
+        std::ostream& output
+    )
+    {
+        std::chrono::steady_clock::time_point start = 
+        std::chrono::steady_clock::now();
+
+        if (!result.path.ends_with(".rd"))
+        {
+            Fail(result, "File name must contain .rd extension");
+            return;
+        }
+        SourceFile file;
+        if (!file.Open(result.path))
+        {
+            Fail(result, "Could not open file");
+            return;
+        }
+        std::string_view source = file.Text();
+        if (source.empty())
+        {
+            Fail(result, "File is empty");
+            return;
+        }
+
+        // No input: `getin` reports the end of its input
+        std::istringstream no_input;
+        InputReader input(no_input);
+
+        bool use_vm = options.use_vm;
+        std::string cache_path = CachePath(result.path);
+        t_Program cached;
+        const t_Program* program = nullptr;
+        std::shared_ptr<const CompiledScript> compiled;
+        if 
+        (
+            use_vm && options.cache &&
+            LoadCachedProgram
+            (
+                cache_path, source, CacheFlags(options.compile), cached
+            )
+        )
+        {
+            program = &cached;
+        }
+        else
+        {
+            t_CompileOptions compile_options = options.compile;
+            compile_options.bytecode = use_vm;
+            Expected<std::shared_ptr<const CompiledScript>, t_ErrorInfo>
+            compile_result = 
+            CompiledScript::Compile(source, compile_options);
+            if (!compile_result)
+            {
+                result.failed = true;
+                result.error = compile_result.Error();
+                result.compile_ns = NanosecondsSince(start);
+                return;
+            }
+            compiled = std::move(compile_result.Value());
+            program = compiled->Program();
+            if (use_vm && options.cache)
+            {
+                SaveCachedProgram
+                (
+                    cache_path, source, CacheFlags(options.compile),
+                    *program
+                );
+            }
+        }
+        result.compile_ns = NanosecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        InterpretationResult run_result(0);
+        if (use_vm)
+        {
+            VM vm;
+            vm.SetBenchmarkFormat(options.benchmark_format);
+            vm.SetOutput(output);
+            vm.SetInput(input);
+            vm.SetMaxCallDepth(options.max_call_depth);
+            run_result = vm.Run(*program);
+        }
+        else
+        {
+            Interpreter interpreter;
+            interpreter.SetBenchmarkFormat(options.benchmark_format);
+            interpreter.SetOutput(output);
+            interpreter.SetInput(input);
+            interpreter.SetClosures(options.use_closures);
+            interpreter.SetMaxCallDepth(options.max_call_depth);
+            run_result = interpreter.Interpret(*compiled);
+        }
+        result.run_ns = NanosecondsSince(start);
+
+        if (!run_result)
+        {
+            result.failed = true;
+            result.error = run_result.Error();
+        }
+    }
+
+    void FormatMilliseconds(char* buffer, size_t size, int64_t ns)
+    {
+        std::snprintf
+        (
+            buffer, size, "%10.3f ms", static_cast<double>(ns) / 1e6
+        );
+    }
+}
+
+Expected<std::vector<std::string>, std::string> CollectBatchScripts
+(
+    const std::string& target
+)
+{
+    namespace fs = std::filesystem;
+    std::error_code error;
+    std::vector<std::string> paths;
+
+    if (fs::is_directory(target, error))
+    {
+        fs::recursive_directory_iterator it(target, error);
+        fs::recursive_directory_iterator end;
+        while (!error && it != end)
+        {
+            if 
+            (
+                it->is_regular_file(error) && 
+                it->path().extension() == ".rd"
+            )
+            {
+                paths.push_back(it->path().string());
+            }
+            it.increment(error);
+        }
+        if (error)
+        {
+            return "Could not read directory " + target + ": " +
+                   error.message();
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    std::ifstream manifest(target);
+    if (!manifest)
+    {
+        return "Could not open " + target;
+    }
+    fs::path base = fs::path(target).parent_path();
+    std::string line;
+    while (std::getline(manifest, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (line.empty() || line.front() == '#')
+        {
+            continue;
+        }
+        fs::path path(line);
+        paths.push_back
+        (
+            path.is_absolute() ? path.string() : (base / path).string()
+        );
+    }
+    return paths;
+}
+
+std::vector<t_BatchResult> RunBatch
+(
+    const std::vector<std::string>& paths,
+    const t_BatchOptions& options,
+    std::ostream& output
+)
+{
+    std::vector<t_BatchResult> results(paths.size());
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        results[i].path = paths[i];
+    }
+
+    // Scripts are claimed one at a time; the finished prefix is
+    // written by whichever worker completes it
+    std::atomic<size_t> next_script{0};
+    std::mutex emit_mutex;
+    std::vector<uint8_t> finished(paths.size(), 0);
+    size_t next_to_emit = 0;
+
+    size_t threads = options.threads != 0
+        ? options.threads
+        : std::max<size_t>(1, std::thread::hardware_concurrency());
+    ThreadPool pool(std::min(threads, std::max<size_t>(1, paths.size())));
+
+    pool.Run
+    (
+        [&](size_t)
+        {
+            while (true)
+            {
+                size_t index = next_script.fetch_add(1);
+                if (index >= results.size())
+                {
+                    return;
+                }
+
+                std::ostringstream captured;
+                RunScript(results[index], options, captured);
+                results[index].output = std::move(captured).str();
+
+                std::lock_guard<std::mutex> lock(emit_mutex);
+                finished[index] = 1;
+                while 
+                (
+                    next_to_emit < results.size() && 
+                    finished[next_to_emit]
+                )
+                {
+                    t_BatchResult& done = results[next_to_emit];
+                    output << "=== " << done.path << " ===\n";
+                    output << done.output;
+                    if (!done.output.empty() && done.output.back() != '\n')
+                    {
+                        output << '\n';
+                    }
+                    std::string().swap(done.output);
+                    next_to_emit++;
+                }
+                output.flush();
+            }
+        }
+    );
+    return results;
+}
+
+void WriteBatchSummary
+(
+    const std::vector<t_BatchResult>& results,
+    int64_t wall_ns,
+    std::ostream& stream
+)
+{
+    char compile_time[32];
+    char run_time[32];
+    int64_t total_ns = 0;
+    size_t failures = 0;
+
+    stream << "Batch summary:\n";
+    for (const t_BatchResult& result : results)
+    {
+        FormatMilliseconds
+        (
+            compile_time, sizeof(compile_time), result.compile_ns
+        );
+        FormatMilliseconds(run_time, sizeof(run_time), result.run_ns);
+        stream << (result.failed ? "  FAIL " : "  ok   ")
+               << compile_time << " compile " << run_time << " run  "
+               << result.path << '\n';
+        if (result.failed)
+        {
+            stream << "       ";
+            ReportError(result.error, stream);
+            failures++;
+        }
+        total_ns += result.compile_ns + result.run_ns;
+    }
+
+    char total_time[32];
+    char wall_time[32];
+    FormatMilliseconds(total_time, sizeof(total_time), total_ns);
+    FormatMilliseconds(wall_time, sizeof(wall_time), wall_ns);
+    stream << results.size() << " scripts, " << failures << " failed\n"
+           << "  script time " << total_time << '\n'
+           << "  wall time   " << wall_time << '\n';
+    stream.flush();
+}
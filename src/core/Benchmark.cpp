@@ -0,0 +1,158 @@
+#include <rubberduck/Benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ostream>
+
+namespace
+{
+    // "12.345 ms": the largest unit that keeps the value at least 1
+    void WriteDuration
+    (
+        std::ostream& stream,
+        const char *label,
+        double nanoseconds
+    )
+    {
+        const char *unit = "ns";
+        double value = nanoseconds;
+        if (nanoseconds >= 1e9)
+        {
+            unit = "s";
+            value = nanoseconds / 1e9;
+        }
+        else if (nanoseconds >= 1e6)
+        {
+            unit = "ms";
+            value = nanoseconds / 1e6;
+        }
+        else if (nanoseconds >= 1e3)
+        {
+            unit = "us";
+            value = nanoseconds / 1e3;
+        }
+
+        char buffer[64];
+        std::snprintf
+        (
+            buffer, sizeof(buffer),
+            "  %-8s%.3f %s\n", label, value, unit
+        );
+        stream << buffer;
+    }
+}
+
+t_BenchmarkStats ComputeBenchmarkStats
+(
+    std::vector<int64_t>& samples,
+    int line,
+    uint32_t warmup
+)
+{
+    t_BenchmarkStats stats;
+    stats.line = line;
+    stats.warmup = warmup;
+    stats.runs = static_cast<uint32_t>(samples.size());
+    if (samples.empty())
+    {
+        return stats;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    size_t count = samples.size();
+
+    double sum = 0.0;
+    for (int64_t sample : samples)
+    {
+        sum += static_cast<double>(sample);
+    }
+    stats.mean = sum / static_cast<double>(count);
+
+    double squares = 0.0;
+    for (int64_t sample : samples)
+    {
+        double delta = static_cast<double>(sample) - stats.mean;
+        squares += delta * delta;
+    }
+    if (count > 1)
+    {
+        stats.stddev = std::sqrt(squares / static_cast<double>(count - 1));
+    }
+
+    stats.min = static_cast<double>(samples.front());
+    stats.median = count % 2 == 1
+        ? static_cast<double>(samples[count / 2])
+        : (static_cast<double>(samples[count / 2 - 1]) +
+           static_cast<double>(samples[count / 2])) / 2.0;
+
+    // Smallest sample that at least 99% of the runs do not exceed
+    size_t rank = (count * 99 + 99) / 100;
+    stats.p99 = static_cast<double>(samples[rank - 1]);
+
+    return stats;
+}
+
+void BenchmarkReporter::SetFormat(e_BenchmarkFormat format)
+{
+    m_Format = format;
+    m_HeaderWritten = false;
+}
+
+void BenchmarkReporter::Report
+(
+    const t_BenchmarkStats& stats,
+    std::ostream& stream
+)
+{
+    char buffer[256];
+    switch (m_Format)
+    {
+    case e_BenchmarkFormat::JSON:
+        std::snprintf
+        (
+            buffer, sizeof(buffer),
+            "{\"line\":%d,\"runs\":%u,\"warmup\":%u,\"min_ns\":%.1f,"
+            "\"mean_ns\":%.1f,\"median_ns\":%.1f,\"p99_ns\":%.1f,"
+            "\"stddev_ns\":%.1f}\n",
+            stats.line, stats.runs, stats.warmup, stats.min,
+            stats.mean, stats.median, stats.p99, stats.stddev
+        );
+        stream << buffer;
+        break;
+
+    case e_BenchmarkFormat::CSV:
+        if (!m_HeaderWritten)
+        {
+            stream << "line,runs,warmup,min_ns,mean_ns,median_ns,"
+                         "p99_ns,stddev_ns\n";
+            m_HeaderWritten = true;
+        }
+        std::snprintf
+        (
+            buffer, sizeof(buffer),
+            "%d,%u,%u,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+            stats.line, stats.runs, stats.warmup, stats.min,
+            stats.mean, stats.median, stats.p99, stats.stddev
+        );
+        stream << buffer;
+        break;
+
+    case e_BenchmarkFormat::TEXT:
+    default:
+        std::snprintf
+        (
+            buffer, sizeof(buffer),
+            "Benchmark Results (line %d, %u %s, %u warmup):\n",
+            stats.line, stats.runs, stats.runs == 1 ? "run" : "runs",
+            stats.warmup
+        );
+        stream << buffer;
+        WriteDuration(stream, "min:", stats.min);
+        WriteDuration(stream, "mean:", stats.mean);
+        WriteDuration(stream, "median:", stats.median);
+        WriteDuration(stream, "p99:", stats.p99);
+        WriteDuration(stream, "stddev:", stats.stddev);
+        break;
+    }
+    stream.flush();
+}
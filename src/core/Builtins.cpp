@@ -0,0 +1,303 @@
+#include <rubberduck/Builtins.h>
+#include <rubberduck/ArrayOps.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace
+{
+    struct t_BuiltinInfo
+    {
+        const char *name;
+        e_Builtin builtin;
+        uint32_t arity;
+    };
+
+    const t_BuiltinInfo BUILTINS[] =
+    {
+        {"sum", e_Builtin::SUM, 1},
+        {"min", e_Builtin::MIN, 1},
+        {"max", e_Builtin::MAX, 1},
+        {"dot", e_Builtin::DOT, 2},
+        {"sort", e_Builtin::SORT, 1},
+        {"array", e_Builtin::ARRAY, 2},
+        {"push", e_Builtin::PUSH, 2}
+    };
+
+    // Half a gigabyte of numbers; more is almost surely a mistake
+    constexpr double MAX_ARRAY_SIZE = 1 << 26;
+
+    const char* BuiltinName(e_Builtin builtin)
+    {
+        for (const t_BuiltinInfo& info : BUILTINS)
+        {
+            if (info.builtin == builtin)
+            {
+                return info.name;
+            }
+        }
+        return "<builtin>";
+    }
+
+    t_ErrorInfo NeedsNumberArray(e_Builtin builtin, const t_Value& value)
+    {
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR,
+            std::string(BuiltinName(builtin)) +
+            "() needs a number array, not a " + ValueTypeName(value.type)
+        );
+    }
+
+    Expected<t_Value, t_ErrorInfo> Extreme
+    (
+        e_Builtin builtin,
+        const t_NumberArray& values
+    )
+    {
+        if (values.empty())
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                std::string(BuiltinName(builtin)) + "() of an empty array"
+            );
+        }
+
+        double result = 0.0;
+        bool found = builtin == e_Builtin::MIN
+            ? MinNumber(values.data(), values.size(), result)
+            : MaxNumber(values.data(), values.size(), result);
+        return Expected<t_Value, t_ErrorInfo>
+        (
+            t_Value(found ? result : std::nan(""))
+        );
+    }
+
+    Expected<t_Value, t_ErrorInfo> Sort(const t_Value& value)
+    {
+        if (value.IsStringArray())
+        {
+            std::sort
+            (
+                value.string_array->begin(),
+                value.string_array->end(),
+                [](const std::string* a, const std::string* b)
+                {
+                    return *a < *b;
+                }
+            );
+            return Expected<t_Value, t_ErrorInfo>(value);
+        }
+
+        if (!value.IsArray())
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                std::string("sort() needs an array, not a ") +
+                ValueTypeName(value.type)
+            );
+        }
+
+        // NaN is unordered, so it cannot take part in std::sort
+        t_NumberArray& values = *value.array;
+        t_NumberArray::iterator numbers_end = std::stable_partition
+        (
+            values.begin(),
+            values.end(),
+            [](double element) { return !std::isnan(element); }
+        );
+        std::sort(values.begin(), numbers_end);
+        return Expected<t_Value, t_ErrorInfo>(value);
+    }
+
+    Expected<t_Value, t_ErrorInfo> MakeFilled
+    (
+        const t_Value& size,
+        const t_Value& fill,
+        ArrayPool& arrays
+    )
+    {
+        if
+        (
+            !size.IsNumber() ||
+            std::floor(size.number) != size.number ||
+            size.number < 0.0 ||
+            size.number > MAX_ARRAY_SIZE
+        )
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "array() size must be a whole number from 0 to " +
+                FormatNumber(MAX_ARRAY_SIZE)
+            );
+        }
+
+        size_t count = static_cast<size_t>(size.number);
+        if (fill.IsNumber())
+        {
+            t_NumberArray *array = arrays.NewNumbers(count);
+            std::fill(array->begin(), array->end(), fill.number);
+            return Expected<t_Value, t_ErrorInfo>(t_Value(array));
+        }
+        if (fill.IsString())
+        {
+            t_StringArray *array = arrays.NewStrings(count);
+            std::fill(array->begin(), array->end(), fill.string);
+            return Expected<t_Value, t_ErrorInfo>(t_Value(array));
+        }
+
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR,
+            std::string("array() fills with a number or a string, not a ") +
+            ValueTypeName(fill.type)
+        );
+    }
+
+    Expected<t_Value, t_ErrorInfo> Push
+    (
+        const t_Value& array,
+        const t_Value& value,
+        ArrayPool& arrays
+    )
+    {
+        if (array.IsArray() && value.IsNumber())
+        {
+            array.array->push_back(value.number);
+            arrays.Grow(array, 1);
+            return Expected<t_Value, t_ErrorInfo>(array);
+        }
+        if (array.IsStringArray() && value.IsString())
+        {
+            array.string_array->push_back(value.string);
+            arrays.Grow(array, 1);
+            return Expected<t_Value, t_ErrorInfo>(array);
+        }
+
+        if (!array.IsArray() && !array.IsStringArray())
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                std::string("push() needs an array, not a ") +
+                ValueTypeName(array.type)
+            );
+        }
+        return t_ErrorInfo
+        (
+            e_ErrorType::TYPE_ERROR,
+            std::string("Type mismatch: cannot push a ") +
+            ValueTypeName(value.type) + " onto " +
+            (array.IsArray() ? "a number array" : "a string array")
+        );
+    }
+}
+
+e_Builtin FindBuiltin(std::string_view name)
+{
+    for (const t_BuiltinInfo& info : BUILTINS)
+    {
+        if (name == info.name)
+        {
+            return info.builtin;
+        }
+    }
+    return e_Builtin::NONE;
+}
+
+uint32_t BuiltinArity(e_Builtin builtin)
+{
+    for (const t_BuiltinInfo& info : BUILTINS)
+    {
+        if (info.builtin == builtin)
+        {
+            return info.arity;
+        }
+    }
+    return 0;
+}
+
+Expected<t_Value, t_ErrorInfo> CallBuiltin
+(
+    e_Builtin builtin,
+    const t_Value *arguments,
+    ArrayPool& arrays
+)
+{
+    const t_Value& first = arguments[0];
+    switch (builtin)
+    {
+    case e_Builtin::SUM:
+        if (!first.IsArray())
+        {
+            return NeedsNumberArray(builtin, first);
+        }
+        return Expected<t_Value, t_ErrorInfo>
+        (
+            t_Value(SumNumbers(first.array->data(), first.array->size()))
+        );
+
+    case e_Builtin::MIN:
+    case e_Builtin::MAX:
+        if (!first.IsArray())
+        {
+            return NeedsNumberArray(builtin, first);
+        }
+        return Extreme(builtin, *first.array);
+
+    case e_Builtin::DOT:
+        {
+            const t_Value& second = arguments[1];
+            if (!first.IsArray())
+            {
+                return NeedsNumberArray(builtin, first);
+            }
+            if (!second.IsArray())
+            {
+                return NeedsNumberArray(builtin, second);
+            }
+            if (first.array->size() != second.array->size())
+            {
+                return t_ErrorInfo
+                (
+                    e_ErrorType::RUNTIME_ERROR,
+                    "dot() of arrays of " +
+                    std::to_string(first.array->size()) + " and " +
+                    std::to_string(second.array->size()) + " elements"
+                );
+            }
+            return Expected<t_Value, t_ErrorInfo>
+            (
+                t_Value
+                (
+                    DotNumbers
+                    (
+                        first.array->data(),
+                        second.array->data(),
+                        first.array->size()
+                    )
+                )
+            );
+        }
+
+    case e_Builtin::SORT:
+        return Sort(first);
+
+    case e_Builtin::ARRAY:
+        return MakeFilled(first, arguments[1], arrays);
+
+    case e_Builtin::PUSH:
+        return Push(first, arguments[1], arrays);
+
+    case e_Builtin::NONE:
+    default:
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR,
+            "Unknown builtin function"
+        );
+    }
+}
@@ -0,0 +1,148 @@
+#include <rubberduck/CompiledScript.h>
+#include <rubberduck/Compiler.h>
+#include <rubberduck/Lexer.h>
+#include <rubberduck/Linker.h>
+#include <rubberduck/Optimizer.h>
+#include <rubberduck/ParallelLoop.h>
+#include <rubberduck/Parser.h>
+#include <rubberduck/PurityChecker.h>
+#include <rubberduck/TypeChecker.h>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    int64_t NanosecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>
+        (
+            std::chrono::steady_clock::now() - start
+        ).count();
+    }
+
+    // Scripts may be compiled on several threads at once
+    std::atomic<uint64_t> g_NextScriptId{1};
+}
+
+Expected<std::shared_ptr<const CompiledScript>, t_ErrorInfo>
+CompiledScript::Compile
+(
+    std::string_view source,
+    const t_CompileOptions& options
+)
+{
+    // Token offsets are 32-bit
+    if (source.size() > std::numeric_limits<uint32_t>::max())
+    {
+        return t_ErrorInfo
+        (
+            e_ErrorType::LEXING_ERROR,
+            "Script is too large"
+        );
+    }
+
+    std::shared_ptr<CompiledScript> script = 
+    std::make_shared<CompiledScript>();
+    script->m_Options = options;
+    script->m_Id = g_NextScriptId.fetch_add(1);
+
+    t_CompileStats& stats = script->m_Stats;
+    std::chrono::steady_clock::time_point start =
+    std::chrono::steady_clock::now();
+
+    // Tokens point into `source`, which is only needed until parsing
+    // is done
+    const SymbolTable& symbols = script->m_Context.Symbols();
+    Lexer lexer(source, script->m_Context.Symbols());
+    ParsingResult tokens_result = lexer.ScanTokens();
+    if (!tokens_result)
+    {
+        return tokens_result.Error();
+    }
+    std::vector<t_Token> tokens = std::move(tokens_result.Value());
+    stats.lex_ns = NanosecondsSince(start);
+    stats.tokens = tokens.size();
+    start = std::chrono::steady_clock::now();
+
+    Parser parser(source, tokens, script->m_Context);
+    Expected<StmtList, t_ErrorInfo> statements_result = parser.Parse();
+    if (!statements_result)
+    {
+        return statements_result.Error();
+    }
+    script->m_Statements = std::move(statements_result.Value());
+    stats.parse_ns = NanosecondsSince(start);
+    start = std::chrono::steady_clock::now();
+
+    // Bind every call to its function and check the argument counts
+    Linker linker(symbols);
+    Expected<int, t_ErrorInfo> link_result = 
+    linker.Link(script->m_Statements);
+    if (!link_result)
+    {
+        return link_result.Error();
+    }
+
+    // Bind every variable to a slot. The VM has its own scopes, but
+    // parallel loops are compiled from the bound tree for both engines.
+    Resolver resolver;
+    script->m_Resolved = resolver.Resolve(script->m_Statements);
+
+    // Type errors are reported before anything runs, and before the
+    // optimizer removes any code, so -O0 and -O1 report the same ones
+    TypeChecker checker(symbols);
+    Expected<int, t_ErrorInfo> check_result =
+    checker.Check(script->m_Statements, script->m_Resolved);
+    if (!check_result)
+    {
+        return check_result.Error();
+    }
+
+    // Shared by both engines, so they always run the same tree. Nodes
+    // it creates have no static types; slots are bound again.
+    if (options.optimize)
+    {
+        Optimizer optimizer(script->m_Context);
+        optimizer.Optimize(script->m_Statements);
+        script->m_Resolved = resolver.Resolve(script->m_Statements);
+    }
+
+    Expected<int, t_ErrorInfo> parallel_result = PrepareParallelLoops
+    (
+        script->m_Resolved.parallel_loops,
+        options.strict_fp
+    );
+    if (!parallel_result)
+    {
+        return parallel_result.Error();
+    }
+
+    // Which functions --memoize may cache, on the final tree
+    PurityChecker purity;
+    purity.Check(script->m_Statements);
+
+    if (options.bytecode)
+    {
+        Compiler compiler(symbols);
+        compiler.SetStrictFloatingPoint(options.strict_fp);
+        Expected<int, t_ErrorInfo> compile_result = 
+        compiler.Compile(script->m_Statements, script->m_Program);
+        if (!compile_result)
+        {
+            return compile_result.Error();
+        }
+    }
+
+    stats.passes_ns = NanosecondsSince(start);
+    const Arena& arena = script->m_Context.GetArena();
+    stats.nodes = script->m_Context.NodeCount();
+    stats.arena_chunks = arena.ChunkCount();
+    stats.arena_used = arena.BytesUsed();
+    stats.arena_wasted = arena.BytesWasted();
+    stats.arena_reserved = arena.BytesReserved();
+
+    return std::shared_ptr<const CompiledScript>(std::move(script));
+}
@@ -2,7 +2,7 @@
 #include <iostream>
 #include <string_view>
 
-void ReportError(const t_ErrorInfo& error)
+void ReportError(const t_ErrorInfo& error, std::ostream& stream)
 {
     std::string_view error_type;
     switch (error.type)
@@ -19,6 +19,9 @@ void ReportError(const t_ErrorInfo& error)
         case e_ErrorType::TYPE_ERROR:
             error_type = "Type Error";
             break;
+        case e_ErrorType::COMPILE_ERROR:
+            error_type = "Compile Error";
+            break;
         default:
             error_type = "Unknown Error";
             break;
@@ -26,17 +29,22 @@ void ReportError(const t_ErrorInfo& error)
 
     if (error.line > 0)
     {
-        std::cerr << "[" << error_type << "] " << error.message 
-                  << " at line " << error.line;
+        stream << "[" << error_type << "] " << error.message 
+               << " at line " << error.line;
         if (error.column > 0)
         {
-            std::cerr << ", column " << error.column;
+            stream << ", column " << error.column;
         }
-        std::cerr << std::endl;
+        stream << std::endl;
     }
     else
     {
-        std::cerr << "[" << error_type << "] " << error.message << std::endl;
+        stream << "[" << error_type << "] " << error.message << std::endl;
     }
-    std::cerr.flush();
-}
\ No newline at end of file
+    stream.flush();
+}
+
+void ReportError(const t_ErrorInfo& error)
+{
+    ReportError(error, std::cerr);
+}
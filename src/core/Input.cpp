@@ -0,0 +1,225 @@
+#include <rubberduck/Input.h>
+#include <cerrno>
+#include <cstring>
+#include <istream>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    bool IsFieldSeparator(char c)
+    {
+        return c == ' ' || c == '\t';
+    }
+
+    // -1 with errno set on an error; a signal that interrupts the
+    // read before any input arrived is not one
+    long ReadStandardInput(char *buffer, size_t size)
+    {
+        while (true)
+        {
+#ifdef _WIN32
+            long count = _read(0, buffer, static_cast<unsigned int>(size));
+#else
+            long count = static_cast<long>(read(STDIN_FILENO, buffer, size));
+#endif
+            if (count >= 0 || errno != EINTR)
+            {
+                return count;
+            }
+        }
+    }
+
+    // Whatever the stream has buffered, or else one more character,
+    // which makes it fill its buffer for the next call
+    long ReadStream(std::istream &stream, char *buffer, size_t size)
+    {
+        std::streamsize count = stream.readsome
+        (
+            buffer,
+            static_cast<std::streamsize>(size)
+        );
+        if (count == 0)
+        {
+            stream.read(buffer, 1);
+            count = stream.gcount();
+        }
+        return static_cast<long>(count);
+    }
+}
+
+InputReader::InputReader()
+    : m_Buffer(BLOCK_SIZE),
+      m_Stream(nullptr)
+{
+}
+
+InputReader::InputReader(std::istream &stream)
+    : m_Buffer(BLOCK_SIZE),
+      m_Stream(&stream)
+{
+}
+
+bool InputReader::Fill()
+{
+    if (m_AtEnd)
+    {
+        return false;
+    }
+
+    // Keep the partial line, make room behind it
+    if (m_Begin > 0)
+    {
+        std::memmove
+        (
+            m_Buffer.data(),
+            m_Buffer.data() + m_Begin,
+            m_End - m_Begin
+        );
+        m_End -= m_Begin;
+        m_Begin = 0;
+    }
+    if (m_End == m_Buffer.size())
+    {
+        m_Buffer.resize(m_Buffer.size() * 2);
+    }
+
+    char *free_space = m_Buffer.data() + m_End;
+    size_t free_size = m_Buffer.size() - m_End;
+    long count = m_Stream
+        ? ReadStream(*m_Stream, free_space, free_size)
+        : ReadStandardInput(free_space, free_size);
+    if (count < 0)
+    {
+        m_Error = std::generic_category().message(errno);
+    }
+    else if (count == 0 && m_Stream && m_Stream->bad())
+    {
+        m_Error = "the input stream failed";
+    }
+    if (count <= 0)
+    {
+        m_AtEnd = true;
+        return false;
+    }
+    m_End += static_cast<size_t>(count);
+    return true;
+}
+
+bool InputReader::ReadLine(std::string_view &line)
+{
+    size_t searched = m_Begin;
+    while (true)
+    {
+        const char *start = m_Buffer.data() + searched;
+        const void *newline = std::memchr(start, '\n', m_End - searched);
+        if (newline)
+        {
+            size_t end = static_cast<size_t>
+            (
+                static_cast<const char*>(newline) - m_Buffer.data()
+            );
+            line = std::string_view
+            (
+                m_Buffer.data() + m_Begin,
+                end - m_Begin
+            );
+            m_Begin = end + 1;
+            break;
+        }
+
+        // Fill() moves the unread bytes to the front
+        size_t unread = m_End - m_Begin;
+        if (!Fill())
+        {
+            if (m_Begin == m_End)
+            {
+                return false;
+            }
+            // Last line without a newline
+            line = std::string_view(m_Buffer.data() + m_Begin, unread);
+            m_Begin = m_End;
+            break;
+        }
+        searched = m_Begin + unread;
+    }
+
+    if (!line.empty() && line.back() == '\r')
+    {
+        line.remove_suffix(1);
+    }
+    return true;
+}
+
+std::string ReadFailureMessage
+(
+    const InputReader& input,
+    const std::string& name
+)
+{
+    std::string message = "Failed to read input for variable '" + name + "'";
+    if (!input.Error().empty())
+    {
+        message += ": " + input.Error();
+    }
+    return message;
+}
+
+InputReader& StandardInput()
+{
+    static InputReader reader;
+    return reader;
+}
+
+void SplitInputFields
+(
+    std::string_view line,
+    size_t count,
+    std::vector<std::string_view> &fields
+)
+{
+    fields.clear();
+    if (count == 1)
+    {
+        fields.push_back(line);
+        return;
+    }
+
+    size_t position = 0;
+    while (fields.size() < count)
+    {
+        while (position < line.size() && IsFieldSeparator(line[position]))
+        {
+            position++;
+        }
+        if (position == line.size())
+        {
+            return;
+        }
+
+        size_t end = position;
+        if (fields.size() + 1 == count)
+        {
+            // The last field keeps the rest, minus trailing blanks
+            end = line.size();
+            while (IsFieldSeparator(line[end - 1]))
+            {
+                end--;
+            }
+        }
+        else
+        {
+            while (end < line.size() && !IsFieldSeparator(line[end]))
+            {
+                end++;
+            }
+        }
+        fields.push_back(line.substr(position, end - position));
+        position = end;
+    }
+}
@@ -3,7 +3,7 @@
 #include <unordered_map>
 #include <cctype>
 
-static const std::unordered_map<std::string, e_TokenType> keywords =
+static const std::unordered_map<std::string_view, e_TokenType> keywords =
 {
     {"and", e_TokenType::AND},
     {"break", e_TokenType::BREAK},
@@ -26,27 +26,33 @@ static const std::unordered_map<std::string, e_TokenType> keywords =
     {"auto", e_TokenType::AUTO},
     {"benchmark", e_TokenType::BENCHMARK},
     {"getin", e_TokenType::GETIN},
+    {"parallel", e_TokenType::PARALLEL},
     {"typeof", e_TokenType::TYPEOF},
     {"sizeof", e_TokenType::SIZEOF} 
 };
 
-Lexer::Lexer(const std::string &source)
-    : m_Source(source), m_Start(0), m_Current(0), m_Line(1) {}
+Lexer::Lexer(std::string_view source, SymbolTable& symbols)
+    : m_Source(source),
+      m_Symbols(symbols),
+      m_Start(0),
+      m_Current(0),
+      m_Line(1) {}
 
 ParsingResult Lexer::ScanTokens()
 {
     while (!IsAtEnd())
     {
         m_Start = m_Current;
-        ParsingResult result = ScanToken();
+        Expected<int, t_ErrorInfo> result = ScanToken();
         if (!result)
         {
-            return result; 
+            return ParsingResult(result.Error()); 
         }
     }
 
-    m_Tokens.emplace_back(e_TokenType::EOF_TOKEN, "", "", m_Line);
-    return ParsingResult(m_Tokens);
+    m_Start = m_Current;
+    AddToken(e_TokenType::EOF_TOKEN);
+    return ParsingResult(std::move(m_Tokens));
 }
 
 bool Lexer::IsAtEnd()
@@ -54,7 +60,7 @@ bool Lexer::IsAtEnd()
     return m_Current >= static_cast<int>(m_Source.length());
 }
 
-ParsingResult Lexer::ScanToken()
+Expected<int, t_ErrorInfo> Lexer::ScanToken()
 {
     char c = Advance();
     switch (c)
@@ -71,6 +77,12 @@ ParsingResult Lexer::ScanToken()
     case '}':
         AddToken(e_TokenType::RIGHT_BRACE);
         break;
+    case '[':
+        AddToken(e_TokenType::LEFT_BRACKET);
+        break;
+    case ']':
+        AddToken(e_TokenType::RIGHT_BRACKET);
+        break;
     case ',':
         AddToken(e_TokenType::COMMA);
         break;
@@ -147,7 +159,7 @@ ParsingResult Lexer::ScanToken()
         } 
         else 
         {
-            return ParsingResult
+            return Expected<int, t_ErrorInfo>
             (
                 t_ErrorInfo
                 (
@@ -166,7 +178,7 @@ ParsingResult Lexer::ScanToken()
         }
         else
         {
-            return ParsingResult
+            return Expected<int, t_ErrorInfo>
             (
                 t_ErrorInfo
                 (
@@ -220,28 +232,30 @@ ParsingResult Lexer::ScanToken()
         break;
     case '"':
         {
-            Expected<std::string, t_ErrorInfo> result = String();
+            Expected<int, t_ErrorInfo> result = 
+            String("Unterminated string");
             if (!result)
             {
-                return ParsingResult(result.Error());
+                return result;
             }
-            AddToken(e_TokenType::STRING, result.Value());
+            AddToken(e_TokenType::STRING);
         }
         break;
     case '$':
         if (Peek() == '"') 
         {
             Advance(); 
-            Expected<std::string, t_ErrorInfo> result = FormatString();
+            Expected<int, t_ErrorInfo> result = 
+            String("Unterminated format string");
             if (!result)
             {
-                return ParsingResult(result.Error());
+                return result;
             }
-            AddToken(e_TokenType::FORMAT_STRING, result.Value());
+            AddToken(e_TokenType::FORMAT_STRING);
         }
         else
         {
-            return ParsingResult
+            return Expected<int, t_ErrorInfo>
             (
                 t_ErrorInfo
                 (
@@ -264,7 +278,7 @@ ParsingResult Lexer::ScanToken()
         }
         else
         {
-            return ParsingResult
+            return Expected<int, t_ErrorInfo>
             (
                 t_ErrorInfo
                 (
@@ -278,7 +292,7 @@ ParsingResult Lexer::ScanToken()
         break;
     }
     
-    return ParsingResult(m_Tokens);
+    return Expected<int, t_ErrorInfo>(0);
 }
 
 bool Lexer::Match(char expected)
@@ -304,57 +318,32 @@ char Lexer::PeekNext()
     ) ? m_Source[m_Current + 1] : '\0';
 }
 
-Expected<std::string, t_ErrorInfo> Lexer::String()
+Expected<int, t_ErrorInfo> Lexer::String
+(
+    const char *unterminated_message
+)
 {
-    std::string value;
+    // Only finds the closing quote; the contents stay in the source
+    // until the parser asks Unescape() for them
     while (Peek() != '"' && !IsAtEnd())
     {
         if (Peek() == '\n') m_Line++;
-        
-        // Handle escape sequences
-        if (Peek() == '\\') 
-        {
-            Advance(); // Consume the backslash
-            char escaped = Advance(); // Get the character after backslash
-            
-            switch (escaped) 
-            {
-                case 'n':
-                    value += '\n';
-                    break;
-                case 't':
-                    value += '\t';
-                    break;
-                case 'r':
-                    value += '\r';
-                    break;
-                case '\\':
-                    value += '\\';
-                    break;
-                case '"':
-                    value += '"';
-                    break;
-                default:
-                    // For unrecognized escape sequences, keep both characters
-                    value += '\\';
-                    value += escaped;
-                    break;
-            }
-        } 
-        else 
+
+        // An escaped character never ends the string
+        if (Advance() == '\\' && !IsAtEnd())
         {
-            value += Advance();
+            Advance();
         }
     }
 
     if (IsAtEnd())
     {
-        return Expected<std::string, t_ErrorInfo>
+        return Expected<int, t_ErrorInfo>
         (
             t_ErrorInfo
             (
                 e_ErrorType::LEXING_ERROR, 
-                "Unterminated string", 
+                unterminated_message, 
                 m_Line, 
                 m_Current
             )
@@ -362,71 +351,47 @@ Expected<std::string, t_ErrorInfo> Lexer::String()
     }
     Advance();
 
-    // Return the processed string value (without surrounding quotes)
-    return Expected<std::string, t_ErrorInfo>(value);
+    return Expected<int, t_ErrorInfo>(0);
 }
 
-Expected<std::string, t_ErrorInfo> Lexer::FormatString()
+std::string Lexer::Unescape(std::string_view raw)
 {
     std::string value;
-    while (Peek() != '"' && !IsAtEnd())
+    value.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); i++)
     {
-        if (Peek() == '\n') m_Line++;
-        
-        // Handle escape sequences
-        if (Peek() == '\\') 
+        if (raw[i] != '\\' || i + 1 == raw.size())
         {
-            Advance(); // Consume the backslash
-            char escaped = Advance(); // Get the character after backslash
-            
-            switch (escaped) 
-            {
-                case 'n':
-                    value += '\n';
-                    break;
-                case 't':
-                    value += '\t';
-                    break;
-                case 'r':
-                    value += '\r';
-                    break;
-                case '\\':
-                    value += '\\';
-                    break;
-                case '"':
-                    value += '"';
-                    break;
-                default:
-                    // For unrecognized escape sequences, keep both characters
-                    value += '\\';
-                    value += escaped;
-                    break;
-            }
-        } 
-        else 
-        {
-            value += Advance();
+            value += raw[i];
+            continue;
         }
-    }
 
-    if (IsAtEnd())
-    {
-        return Expected<std::string, t_ErrorInfo>
-        (
-            t_ErrorInfo
-            (
-                e_ErrorType::LEXING_ERROR, 
-                "Unterminated format string", 
-                m_Line,
-                m_Current
-            )
-        );
+        char escaped = raw[++i];
+        switch (escaped) 
+        {
+            case 'n':
+                value += '\n';
+                break;
+            case 't':
+                value += '\t';
+                break;
+            case 'r':
+                value += '\r';
+                break;
+            case '\\':
+                value += '\\';
+                break;
+            case '"':
+                value += '"';
+                break;
+            default:
+                // For unrecognized escape sequences, keep both characters
+                value += '\\';
+                value += escaped;
+                break;
+        }
     }
-
-    Advance();
-
-    // Return the processed string value (without surrounding quotes)
-    return Expected<std::string, t_ErrorInfo>(value);
+    return value;
 }
 
 void Lexer::Number()
@@ -440,25 +405,27 @@ void Lexer::Number()
         while (std::isdigit(Peek())) Advance();
     }
 
-    AddToken
-    (
-        e_TokenType::NUMBER, 
-        m_Source.substr(m_Start, m_Current - m_Start)
-    );
+    AddToken(e_TokenType::NUMBER);
 }
 
 void Lexer::Identifier()
 {
     while (std::isalnum(Peek()) || Peek() == '_') Advance();
 
-    std::string text = m_Source.substr(m_Start, m_Current - m_Start);
     e_TokenType type = IdentifierType();
-    AddToken(type, text);
+    AddToken(type);
+    if (type == e_TokenType::IDENTIFIER)
+    {
+        m_Tokens.back().symbol = m_Symbols.Intern
+        (
+            m_Source.substr(m_Start, m_Current - m_Start)
+        );
+    }
 }
 
 e_TokenType Lexer::IdentifierType()
 {
-    std::string text = m_Source.substr(m_Start, m_Current - m_Start);
+    std::string_view text = m_Source.substr(m_Start, m_Current - m_Start);
     
     auto it = keywords.find(text);
     return (it != keywords.end()) ? it->second : e_TokenType::IDENTIFIER;
@@ -471,11 +438,15 @@ char Lexer::Advance()
 
 void Lexer::AddToken(e_TokenType type)
 {
-    AddToken(type, "");
+    m_Tokens.push_back
+    (
+        t_Token
+        {
+            type,
+            static_cast<uint32_t>(m_Start),
+            static_cast<uint32_t>(m_Current - m_Start),
+            m_Line,
+            NO_SYMBOL
+        }
+    );
 }
-
-void Lexer::AddToken(e_TokenType type, const std::string &literal)
-{
-    std::string text = m_Source.substr(m_Start, m_Current - m_Start);
-    m_Tokens.emplace_back(type, text, literal, m_Line);
-}
\ No newline at end of file
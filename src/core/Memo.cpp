@@ -0,0 +1,191 @@
+#include <rubberduck/Memo.h>
+#include <bit>
+#include <cstdio>
+#include <functional>
+#include <ostream>
+#include <string_view>
+
+namespace
+{
+    // The bits that identify a value of a key, a hash of the text for
+    // a string; see MemoCache
+    uint64_t ValueBits(const t_Value& value)
+    {
+        switch (value.type)
+        {
+        case e_ValueType::NUMBER:
+            return std::bit_cast<uint64_t>(value.number);
+        case e_ValueType::BOOLEAN:
+            return value.boolean ? 1 : 0;
+        case e_ValueType::STRING:
+            return std::hash<std::string_view>()(*value.string);
+        default:
+            return 0;
+        }
+    }
+
+    uint64_t Mix(uint64_t hash, uint64_t bits)
+    {
+        hash ^= bits + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+        return hash;
+    }
+
+    // Small integers differ only in the high bits of a double, and
+    // the table is indexed by the low ones
+    uint64_t Finalize(uint64_t hash)
+    {
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+        hash *= 0xC4CEB9FE1A85EC53ull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    bool IsPowerOfTwo(size_t value)
+    {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+}
+
+MemoCache::MemoCache(size_t capacity)
+    : m_Entries(IsPowerOfTwo(capacity) ? capacity : DEFAULT_CAPACITY)
+{
+}
+
+void MemoCache::Reset(std::vector<std::string> names)
+{
+    for (t_Entry& entry : m_Entries)
+    {
+        entry.is_used = false;
+    }
+    m_Counters.assign(names.size(), t_Counters());
+    m_Names = std::move(names);
+}
+
+bool MemoCache::MakeKey
+(
+    int32_t function,
+    const t_Value* arguments,
+    uint32_t count,
+    t_MemoKey& key
+)
+{
+    key.function = function;
+    key.count = count;
+    key.hash = static_cast<uint64_t>(function);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const t_Value& argument = arguments[i];
+        if (argument.IsArray() || argument.IsStringArray())
+        {
+            return false;
+        }
+        key.arguments[i] = argument;
+        key.hash = Mix(key.hash, static_cast<uint64_t>(argument.type));
+        key.hash = Mix(key.hash, ValueBits(argument));
+    }
+    key.hash = Finalize(key.hash);
+    return true;
+}
+
+bool MemoCache::IsSameKey(const t_MemoKey& left, const t_MemoKey& right)
+{
+    if
+    (
+        left.hash != right.hash ||
+        left.function != right.function ||
+        left.count != right.count
+    )
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < left.count; ++i)
+    {
+        const t_Value& left_argument = left.arguments[i];
+        const t_Value& right_argument = right.arguments[i];
+        if (left_argument.type != right_argument.type)
+        {
+            return false;
+        }
+        if (left_argument.IsString())
+        {
+            if (*left_argument.string != *right_argument.string)
+            {
+                return false;
+            }
+        }
+        else if (ValueBits(left_argument) != ValueBits(right_argument))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const t_Value* MemoCache::Find(const t_MemoKey& key)
+{
+    t_Entry& entry = m_Entries[key.hash & (m_Entries.size() - 1)];
+    t_Counters& counters = m_Counters[static_cast<size_t>(key.function)];
+    if (entry.is_used && IsSameKey(entry.key, key))
+    {
+        counters.hits++;
+        return &entry.result;
+    }
+    counters.misses++;
+    return nullptr;
+}
+
+void MemoCache::Store(const t_MemoKey& key, const t_Value& result)
+{
+    if (result.IsArray() || result.IsStringArray())
+    {
+        return;
+    }
+    t_Entry& entry = m_Entries[key.hash & (m_Entries.size() - 1)];
+    entry.key = key;
+    entry.result = result;
+    entry.is_used = true;
+}
+
+void MemoCache::Mark(StringPool& strings) const
+{
+    for (const t_Entry& entry : m_Entries)
+    {
+        if (entry.is_used)
+        {
+            strings.Mark(entry.key.arguments, entry.key.count);
+            strings.Mark(entry.result);
+        }
+    }
+}
+
+void MemoCache::WriteReport(std::ostream& stream) const
+{
+    char buffer[256];
+    stream << "\nMemoized functions\n"
+           << "        hits       misses  function\n";
+    bool any_called = false;
+    for (size_t i = 0; i < m_Counters.size(); ++i)
+    {
+        const t_Counters& counters = m_Counters[i];
+        if (counters.hits == 0 && counters.misses == 0)
+        {
+            continue;
+        }
+        any_called = true;
+        std::snprintf
+        (
+            buffer, sizeof(buffer),
+            "%12llu %12llu  %s\n",
+            static_cast<unsigned long long>(counters.hits),
+            static_cast<unsigned long long>(counters.misses),
+            m_Names[i].c_str()
+        );
+        stream << buffer;
+    }
+    if (!any_called)
+    {
+        stream << "  no pure function was called\n";
+    }
+}
@@ -0,0 +1,70 @@
+#include <rubberduck/NativeStack.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace
+{
+    // Lowest address of the calling thread's stack, 0 if unknown
+#if defined(_WIN32)
+
+    uintptr_t StackLimit()
+    {
+        ULONG_PTR low = 0;
+        ULONG_PTR high = 0;
+        GetCurrentThreadStackLimits(&low, &high);
+        return static_cast<uintptr_t>(low);
+    }
+
+#elif defined(__APPLE__)
+
+    uintptr_t StackLimit()
+    {
+        // The address macOS gives is the top of the stack
+        pthread_t self = pthread_self();
+        uintptr_t high =
+        reinterpret_cast<uintptr_t>(pthread_get_stackaddr_np(self));
+        return high - pthread_get_stacksize_np(self);
+    }
+
+#elif defined(__linux__)
+
+    uintptr_t StackLimit()
+    {
+        // For the main thread glibc works the size out from the stack
+        // limit, so `ulimit -s` is taken into account
+        pthread_attr_t attributes;
+        if (pthread_getattr_np(pthread_self(), &attributes) != 0)
+        {
+            return 0;
+        }
+        void* low = nullptr;
+        size_t size = 0;
+        int failed = pthread_attr_getstack(&attributes, &low, &size);
+        pthread_attr_destroy(&attributes);
+        return failed ? 0 : reinterpret_cast<uintptr_t>(low);
+    }
+
+#else
+
+    uintptr_t StackLimit()
+    {
+        return 0;
+    }
+
+#endif
+}
+
+size_t NativeStackLeft(uintptr_t address)
+{
+    // Asked once per thread: for the main thread glibc reads all of
+    // /proc/self/maps, which takes longer than running a small script
+    thread_local uintptr_t limit = StackLimit();
+    return limit != 0 && address > limit ? address - limit : 0;
+}
@@ -0,0 +1,34 @@
+#include <rubberduck/Output.h>
+#include <iostream>
+
+OutputBuffer::OutputBuffer()
+    : m_Stream(&std::cout)
+{
+    m_Text.reserve(FLUSH_THRESHOLD * 2);
+}
+
+OutputBuffer::~OutputBuffer()
+{
+    Flush();
+}
+
+void OutputBuffer::SetStream(std::ostream& stream)
+{
+    Flush();
+    m_Stream = &stream;
+}
+
+void OutputBuffer::Flush()
+{
+    if (!m_Text.empty())
+    {
+        m_Stream->write
+        (
+            m_Text.data(),
+            static_cast<std::streamsize>(m_Text.size())
+        );
+        m_BytesWritten += m_Text.size();
+        m_Text.clear();
+    }
+    m_Stream->flush();
+}
@@ -0,0 +1,198 @@
+#include <rubberduck/SourceFile.h>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SourceFile::SourceFile()
+    : m_Mapping(nullptr), 
+      m_Size(0)
+#ifdef _WIN32
+    , m_FileHandle(nullptr), 
+      m_MappingHandle(nullptr)
+#endif
+{}
+
+SourceFile::~SourceFile()
+{
+    Close();
+}
+
+bool SourceFile::Open(const std::string &path)
+{
+    Close();
+    return Map(path) || Read(path);
+}
+
+std::string_view SourceFile::Text() const
+{
+    if (m_Mapping)
+    {
+        return std::string_view(m_Mapping, m_Size);
+    }
+    return m_Buffer;
+}
+
+#ifdef _WIN32
+
+bool SourceFile::Map(const std::string &path)
+{
+    HANDLE file = CreateFileA
+    (
+        path.c_str(), 
+        GENERIC_READ, 
+        FILE_SHARE_READ, 
+        nullptr, 
+        OPEN_EXISTING, 
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if 
+    (
+        GetFileType(file) != FILE_TYPE_DISK  ||
+        !GetFileSizeEx(file, &size)          || 
+        size.QuadPart <= 0
+    )
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA
+    (
+        file, nullptr, PAGE_READONLY, 0, 0, nullptr
+    );
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_FileHandle = file;
+    m_MappingHandle = mapping;
+    m_Mapping = static_cast<const char*>(view);
+    m_Size = static_cast<size_t>(size.QuadPart);
+    return true;
+}
+
+void SourceFile::Close()
+{
+    if (m_Mapping)
+    {
+        UnmapViewOfFile(m_Mapping);
+        CloseHandle(m_MappingHandle);
+        CloseHandle(m_FileHandle);
+        m_Mapping = nullptr;
+        m_MappingHandle = nullptr;
+        m_FileHandle = nullptr;
+    }
+    m_Buffer.clear();
+    m_Size = 0;
+}
+
+#else
+
+bool SourceFile::Map(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    // Empty files cannot be mapped, and pipes have no size to map
+    struct stat info;
+    if 
+    (
+        fstat(fd, &info) != 0     || 
+        !S_ISREG(info.st_mode)    || 
+        info.st_size <= 0
+    )
+    {
+        close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    void *view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    close(fd);
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // The lexer makes one pass from start to end
+    madvise(view, size, MADV_SEQUENTIAL);
+
+    m_Mapping = static_cast<const char*>(view);
+    m_Size = size;
+    return true;
+}
+
+void SourceFile::Close()
+{
+    if (m_Mapping)
+    {
+        munmap(const_cast<char*>(m_Mapping), m_Size);
+        m_Mapping = nullptr;
+    }
+    m_Buffer.clear();
+    m_Size = 0;
+}
+
+#endif
+
+bool SourceFile::Read(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    // One bulk read when the size is known up front
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    if (size >= 0)
+    {
+        file.seekg(0, std::ios::beg);
+        m_Buffer.resize(static_cast<size_t>(size));
+        file.read(m_Buffer.data(), size);
+        m_Buffer.resize(static_cast<size_t>(file.gcount()));
+        return !file.bad();
+    }
+
+    // Streams without a size (pipes) are read until they end
+    file.clear();
+    m_Buffer.assign
+    (
+        std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>()
+    );
+    return !file.bad();
+}
@@ -0,0 +1,98 @@
+#include <rubberduck/Stats.h>
+#include <rubberduck/LoopKernel.h>
+#include <cstdio>
+#include <ostream>
+
+namespace
+{
+    double Milliseconds(int64_t ns)
+    {
+        return static_cast<double>(ns) / 1e6;
+    }
+
+    void WriteLine
+    (
+        std::ostream& stream,
+        const char* name,
+        unsigned long long value
+    )
+    {
+        char buffer[128];
+        std::snprintf(buffer, sizeof(buffer), "%-24s %14llu\n", name, value);
+        stream << buffer;
+    }
+
+    void WriteTime(std::ostream& stream, const char* name, int64_t ns)
+    {
+        char buffer[128];
+        std::snprintf
+        (
+            buffer, sizeof(buffer),
+            "%-24s %14.3f ms\n", name, Milliseconds(ns)
+        );
+        stream << buffer;
+    }
+}
+
+void CountKernelLoop(const t_LoopKernel& kernel, t_RunStats& run)
+{
+    if (kernel.vector_loops.empty())
+    {
+        run.kernel_loops++;
+        return;
+    }
+    for (const t_VectorLoop& loop : kernel.vector_loops)
+    {
+        if (!loop.is_closed_form)
+        {
+            run.vector_loops++;
+            return;
+        }
+    }
+    run.closed_form_loops++;
+}
+
+void WriteStats
+(
+    const t_CompileStats* compile,
+    const t_RunStats& run,
+    std::ostream& stream
+)
+{
+    stream << "\nStatistics\n";
+    if (compile)
+    {
+        WriteTime(stream, "lex", compile->lex_ns);
+        WriteTime(stream, "parse", compile->parse_ns);
+        WriteTime(stream, "other passes", compile->passes_ns);
+    }
+    else
+    {
+        stream << "compile                  loaded from the cache\n";
+    }
+    WriteTime(stream, "execute", run.run_ns);
+
+    if (compile)
+    {
+        WriteLine(stream, "tokens", compile->tokens);
+        WriteLine(stream, "nodes", compile->nodes);
+        WriteLine(stream, "arena chunks", compile->arena_chunks);
+        WriteLine(stream, "arena bytes used", compile->arena_used);
+        WriteLine(stream, "arena bytes wasted", compile->arena_wasted);
+        WriteLine(stream, "arena bytes reserved", compile->arena_reserved);
+    }
+
+    WriteLine(stream, "calls", run.calls);
+    WriteLine(stream, "max call depth", run.max_call_depth);
+    WriteLine(stream, "max stack slots", run.max_stack_slots);
+
+    if (run.counts_every_loop)
+    {
+        WriteLine(stream, "loops, general path", run.general_loops);
+    }
+    WriteLine(stream, "loops, scalar kernel", run.kernel_loops);
+    WriteLine(stream, "loops, vectorized", run.vector_loops);
+    WriteLine(stream, "loops, closed form", run.closed_form_loops);
+    WriteLine(stream, "loops, parallel", run.parallel_loops);
+    WriteLine(stream, "output bytes", run.output_bytes);
+}
@@ -0,0 +1,15 @@
+#include <rubberduck/Symbol.h>
+
+t_Symbol SymbolTable::Intern(std::string_view text)
+{
+    auto it = m_Index.find(text);
+    if (it != m_Index.end())
+    {
+        return it->second;
+    }
+
+    t_Symbol symbol = static_cast<t_Symbol>(m_Names.size());
+    const std::string& stored = m_Names.emplace_back(text);
+    m_Index.emplace(std::string_view(stored), symbol);
+    return symbol;
+}
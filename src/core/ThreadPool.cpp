@@ -0,0 +1,99 @@
+#include <rubberduck/ThreadPool.h>
+#include <algorithm>
+
+namespace
+{
+    size_t g_ThreadCount = 0;
+}
+
+ThreadPool::ThreadPool(size_t thread_count)
+{
+    for (size_t worker = 1; worker < thread_count; ++worker)
+    {
+        m_Threads.emplace_back(&ThreadPool::WorkerLoop, this, worker);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_Wake.notify_all();
+    for (std::thread& thread : m_Threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::WorkerLoop(size_t worker)
+{
+    uint64_t seen = 0;
+    while (true)
+    {
+        const std::function<void(size_t)>* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Wake.wait
+            (
+                lock,
+                [&] { return m_Stopping || m_Generation != seen; }
+            );
+            if (m_Stopping)
+            {
+                return;
+            }
+            seen = m_Generation;
+            job = m_Job;
+        }
+
+        (*job)(worker);
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (--m_Busy == 0)
+        {
+            m_Idle.notify_one();
+        }
+    }
+}
+
+void ThreadPool::Run(const std::function<void(size_t)>& job)
+{
+    if (m_Threads.empty())
+    {
+        job(0);
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(m_RunMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Job = &job;
+        m_Busy = m_Threads.size();
+        m_Generation++;
+    }
+    m_Wake.notify_all();
+
+    job(0);
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Idle.wait(lock, [&] { return m_Busy == 0; });
+    m_Job = nullptr;
+}
+
+void SetThreadCount(size_t thread_count)
+{
+    g_ThreadCount = thread_count;
+}
+
+ThreadPool& SharedThreadPool()
+{
+    static ThreadPool pool
+    (
+        g_ThreadCount != 0
+            ? g_ThreadCount
+            : std::max<size_t>(1, std::thread::hardware_concurrency())
+    );
+    return pool;
+}
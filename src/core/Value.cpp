@@ -0,0 +1,451 @@
+#include <rubberduck/Value.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <system_error>
+
+const std::string* StringPool::Intern(std::string_view text)
+{
+    auto it = m_Index.find(text);
+    if (it != m_Index.end())
+    {
+        return it->second;
+    }
+
+    // Deque storage never relocates existing strings, so both the
+    // returned handle and the view used as key stay valid.
+    const std::string& stored = m_Storage.emplace_back(text);
+    m_Index.emplace(std::string_view(stored), &stored);
+    return &stored;
+}
+
+void StringPool::Mark(const t_Value& value)
+{
+    if (value.IsString())
+    {
+        m_Made.Mark(value.string);
+    }
+}
+
+void StringPool::Mark(const t_Value* values, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        Mark(values[i]);
+    }
+}
+
+void StringPool::Mark(const t_StringArray& array)
+{
+    for (const std::string* element : array)
+    {
+        m_Made.Mark(element);
+    }
+}
+
+void StringPool::Sweep(size_t first)
+{
+    m_Made.Sweep
+    (
+        first,
+        [](std::string& text)
+        {
+            if (text.capacity() > MAX_KEPT_CAPACITY)
+            {
+                std::string().swap(text);
+            }
+        }
+    );
+}
+
+void StringPool::Clear()
+{
+    m_Index.clear();
+    m_Storage.clear();
+    m_Made.Clear();
+}
+
+t_NumberArray* ArrayPool::NewNumbers(size_t size)
+{
+    t_NumberArray* array = m_Numbers.Make(size + 1);
+    array->assign(size, 0.0);
+    return array;
+}
+
+t_StringArray* ArrayPool::NewStrings(size_t size)
+{
+    t_StringArray* array = m_Strings.Make(size + 1);
+    array->assign(size, nullptr);
+    return array;
+}
+
+void ArrayPool::Grow(const t_Value& array, size_t count)
+{
+    if (array.IsArray())
+    {
+        m_Numbers.Grow(count);
+    }
+    else if (array.IsStringArray())
+    {
+        m_Strings.Grow(count);
+    }
+}
+
+void ArrayPool::Mark(const t_Value& value, StringPool& strings)
+{
+    if (value.IsArray())
+    {
+        m_Numbers.Mark(value.array);
+    }
+    else if
+    (
+        value.IsStringArray() &&
+        m_Strings.Mark(value.string_array)
+    )
+    {
+        strings.Mark(*value.string_array);
+        m_Strings.Visit(value.string_array->size());
+    }
+}
+
+void ArrayPool::Mark
+(
+    const t_Value* values,
+    size_t count,
+    StringPool& strings
+)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        Mark(values[i], strings);
+    }
+}
+
+void ArrayPool::Sweep(const t_Made& first)
+{
+    m_Numbers.Sweep
+    (
+        first.numbers,
+        [](t_NumberArray& array)
+        {
+            if (array.capacity() > MAX_KEPT_CAPACITY)
+            {
+                t_NumberArray().swap(array);
+            }
+        }
+    );
+    m_Strings.Sweep
+    (
+        first.strings,
+        [](t_StringArray& array)
+        {
+            if (array.capacity() > MAX_KEPT_CAPACITY)
+            {
+                t_StringArray().swap(array);
+            }
+        }
+    );
+}
+
+void ArrayPool::Clear()
+{
+    m_Numbers.Clear();
+    m_Strings.Clear();
+}
+
+void AppendNumber(std::string& out, double value)
+{
+    // Shortest fixed notation that reads back as the same double, so
+    // a literal like 19.99 is printed exactly as it was written.
+    std::array<char, 512> buffer;
+    std::to_chars_result result = std::to_chars
+    (
+        buffer.data(),
+        buffer.data() + buffer.size(),
+        value,
+        std::chars_format::fixed
+    );
+    if (result.ec != std::errc())
+    {
+        out.append("nan");
+        return;
+    }
+
+    out.append(buffer.data(), result.ptr);
+}
+
+std::string FormatNumber(double value)
+{
+    std::string out;
+    AppendNumber(out, value);
+    return out;
+}
+
+void AppendValue(std::string& out, const t_Value& value)
+{
+    switch (value.type)
+    {
+    case e_ValueType::NUMBER:
+        AppendNumber(out, value.number);
+        break;
+    case e_ValueType::STRING:
+        out.append(*value.string);
+        break;
+    case e_ValueType::BOOLEAN:
+        out.append(value.boolean ? "true" : "false");
+        break;
+    case e_ValueType::ARRAY:
+        out.push_back('[');
+        for (size_t i = 0; i < value.array->size(); ++i)
+        {
+            if (i > 0)
+            {
+                out.append(", ");
+            }
+            AppendNumber(out, (*value.array)[i]);
+        }
+        out.push_back(']');
+        break;
+    case e_ValueType::STRING_ARRAY:
+        out.push_back('[');
+        for (size_t i = 0; i < value.string_array->size(); ++i)
+        {
+            if (i > 0)
+            {
+                out.append(", ");
+            }
+            out.append(*(*value.string_array)[i]);
+        }
+        out.push_back(']');
+        break;
+    case e_ValueType::NIL:
+    default:
+        out.append("nil");
+        break;
+    }
+}
+
+bool IsTruthy(const t_Value& value)
+{
+    if (value.type == e_ValueType::NIL)
+    {
+        return false;
+    }
+    if (value.type == e_ValueType::BOOLEAN)
+    {
+        return value.boolean;
+    }
+    return true;
+}
+
+bool ValuesEqual(const t_Value& left, const t_Value& right)
+{
+    if (left.type != right.type)
+    {
+        return false;
+    }
+
+    switch (left.type)
+    {
+    case e_ValueType::NUMBER:
+        return left.number == right.number;
+    case e_ValueType::STRING:
+        return left.string == right.string ||
+               *left.string == *right.string;
+    case e_ValueType::BOOLEAN:
+        return left.boolean == right.boolean;
+    case e_ValueType::ARRAY:
+        return left.array == right.array || *left.array == *right.array;
+    case e_ValueType::STRING_ARRAY:
+        return std::equal
+        (
+            left.string_array->begin(),
+            left.string_array->end(),
+            right.string_array->begin(),
+            right.string_array->end(),
+            [](const std::string* a, const std::string* b)
+            {
+                return a == b || *a == *b;
+            }
+        );
+    case e_ValueType::NIL:
+    default:
+        return true;
+    }
+}
+
+const char* ValueTypeName(e_ValueType type)
+{
+    switch (type)
+    {
+    case e_ValueType::NUMBER:
+        return "number";
+    case e_ValueType::STRING:
+        return "string";
+    case e_ValueType::BOOLEAN:
+        return "boolean";
+    case e_ValueType::ARRAY:
+        return "array";
+    case e_ValueType::STRING_ARRAY:
+        return "string array";
+    case e_ValueType::NIL:
+        return "nil";
+    default:
+        return "unknown";
+    }
+}
+
+bool ParseNumber(std::string_view text, double& out_value)
+{
+    size_t start = 0;
+    while
+    (
+        start < text.size() &&
+        std::isspace(static_cast<unsigned char>(text[start]))
+    )
+    {
+        start++;
+    }
+
+    // std::from_chars rejects an explicit '+' sign
+    if (start < text.size() && text[start] == '+')
+    {
+        start++;
+    }
+
+    const char* begin = text.data() + start;
+    const char* end = text.data() + text.size();
+    std::from_chars_result result = std::from_chars(begin, end, out_value);
+    return result.ec == std::errc() && result.ptr != begin;
+}
+
+static bool LooksLikeNumber(std::string_view text)
+{
+    size_t start = (!text.empty() && text[0] == '-') ? 1 : 0;
+    if (text.size() <= start)
+    {
+        return false;
+    }
+
+    bool has_decimal = false;
+    for (size_t i = start; i < text.size(); ++i)
+    {
+        if (text[i] == '.')
+        {
+            if (has_decimal)
+            {
+                return false;
+            }
+            has_decimal = true;
+        }
+        else if (!std::isdigit(static_cast<unsigned char>(text[i])))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// `keyword` is lower case
+static bool EqualsIgnoreCase(std::string_view text, std::string_view keyword)
+{
+    if (text.size() != keyword.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (std::tolower(static_cast<unsigned char>(text[i])) != keyword[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+t_Value InferValue(std::string_view text, StringPool& strings)
+{
+    if (text == "nil")
+    {
+        return t_Value();
+    }
+    if (text == "true" || text == "false")
+    {
+        return t_Value(text == "true");
+    }
+
+    double number = 0.0;
+    if (LooksLikeNumber(text) && ParseNumber(text, number))
+    {
+        return t_Value(number);
+    }
+    return t_Value(strings.Make(text));
+}
+
+Expected<t_Value, t_ErrorInfo> ConvertInput
+(
+    std::string_view input,
+    const t_Value& current,
+    const std::string& name,
+    StringPool& strings
+)
+{
+    switch (current.type)
+    {
+    case e_ValueType::NUMBER:
+        {
+            double number = 0.0;
+            if (!ParseNumber(input, number))
+            {
+                return t_ErrorInfo
+                (
+                    e_ErrorType::RUNTIME_ERROR,
+                    "Invalid type for variable " + name
+                );
+            }
+            return t_Value(number);
+        }
+
+    case e_ValueType::BOOLEAN:
+        {
+            // Case-insensitive keywords, then any number (non-zero is true)
+            if (EqualsIgnoreCase(input, "true") || input == "1")
+            {
+                return t_Value(true);
+            }
+            if (EqualsIgnoreCase(input, "false") || input == "0")
+            {
+                return t_Value(false);
+            }
+
+            double number = 0.0;
+            if (!ParseNumber(input, number))
+            {
+                return t_ErrorInfo
+                (
+                    e_ErrorType::RUNTIME_ERROR,
+                    "Failed to convert input to boolean for variable '" +
+                    name +
+                    "'. Valid values: true, false, 1, 0"
+                );
+            }
+            return t_Value(number != 0.0);
+        }
+
+    case e_ValueType::STRING:
+        return t_Value(strings.Make(input));
+
+    case e_ValueType::ARRAY:
+    case e_ValueType::STRING_ARRAY:
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR,
+            "Cannot read input into array variable '" + name + "'"
+        );
+
+    case e_ValueType::NIL:
+    default:
+        return InferValue(input, strings);
+    }
+}
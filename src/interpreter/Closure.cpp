@@ -0,0 +1,1625 @@
+#include <rubberduck/Closure.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <rubberduck/ArrayOps.h>
+#include <rubberduck/Builtins.h>
+#include <rubberduck/Interpreter.h>
+
+namespace
+{
+    int OperatorLine(const t_ExprClosure& c)
+    {
+        return static_cast<t_BinaryExpr*>(c.node)->op.line;
+    }
+}
+
+void* ClosureCompiler::Allocate(size_t size, size_t alignment)
+{
+    void* mem = m_Arena.Allocate(size, alignment);
+    if (!mem)
+    {
+        // Like ArenaAllocator: there is no way to run without them
+        std::abort();
+    }
+    return mem;
+}
+
+template<typename T>
+T* ClosureCompiler::New()
+{
+    return new (Allocate(sizeof(T), alignof(T))) T{};
+}
+
+const t_ExprClosure** ClosureCompiler::NewList(uint32_t count)
+{
+    if (count == 0)
+    {
+        return nullptr;
+    }
+    return static_cast<const t_ExprClosure**>
+    (
+        Allocate
+        (
+            count * sizeof(const t_ExprClosure*),
+            alignof(const t_ExprClosure*)
+        )
+    );
+}
+
+void ClosureCompiler::Lower
+(
+    const StmtList& statements,
+    const SymbolTable& symbols,
+    uint64_t script
+)
+{
+    if (script != 0 && script == m_Script)
+    {
+        return;
+    }
+    m_Arena.Reset();
+    m_Bodies.clear();
+    m_Strings.Clear();
+    m_Symbols = &symbols;
+    m_Script = script;
+
+    // Bodies are allocated first so that calls, recursive ones too,
+    // can point at them before they are lowered
+    for (const auto& statement : statements)
+    {
+        if (t_FunStmt* fun_stmt = As<t_FunStmt>(statement.get()))
+        {
+            if (fun_stmt->body)
+            {
+                m_Bodies[fun_stmt] = New<t_StmtClosure>();
+            }
+        }
+    }
+
+    size_t count = statements.size();
+    const t_StmtClosure** main = static_cast<const t_StmtClosure**>
+    (
+        Allocate
+        (
+            (count + 1) * sizeof(const t_StmtClosure*),
+            alignof(const t_StmtClosure*)
+        )
+    );
+    for (size_t i = 0; i < count; ++i)
+    {
+        main[i] = LowerStatement(statements[i].get());
+    }
+    m_Main = main;
+
+    for (const auto& [fun_stmt, body] : m_Bodies)
+    {
+        *body = *LowerStatement(fun_stmt->body.get());
+    }
+}
+
+const t_StmtClosure* ClosureCompiler::Body(const t_FunStmt* fun_stmt) const
+{
+    auto it = m_Bodies.find(fun_stmt);
+    return it != m_Bodies.end() ? it->second : nullptr;
+}
+
+const t_ExprClosure* const* ClosureCompiler::LowerList
+(
+    const ExprList& expressions,
+    uint32_t& count
+)
+{
+    count = static_cast<uint32_t>(expressions.size());
+    const t_ExprClosure** list = NewList(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        list[i] = LowerExpression(expressions[i].get());
+    }
+    return list;
+}
+
+const t_ExprClosure* ClosureCompiler::LowerExpression(t_Expr* expr)
+{
+    if (!expr)
+    {
+        return nullptr;
+    }
+    if (expr->kind == e_ExprKind::GROUPING)
+    {
+        return LowerExpression(As<t_GroupingExpr>(expr)->expression.get());
+    }
+    if (expr->kind == e_ExprKind::BINARY)
+    {
+        return LowerBinary(As<t_BinaryExpr>(expr));
+    }
+    if (expr->kind == e_ExprKind::CALL)
+    {
+        return LowerCall(As<t_CallExpr>(expr));
+    }
+
+    t_ExprClosure* closure = New<t_ExprClosure>();
+    closure->node = expr;
+    closure->run = &Walk;
+
+    switch (expr->kind)
+    {
+    case e_ExprKind::LITERAL:
+        {
+            t_LiteralExpr* literal = As<t_LiteralExpr>(expr);
+            switch (literal->token_type)
+            {
+            case e_TokenType::NUMBER:
+                // An invalid literal fails each time, in the walker
+                if (literal->is_number)
+                {
+                    closure->run = &Constant;
+                    closure->constant = t_Value(literal->number);
+                }
+                break;
+            case e_TokenType::TRUE:
+            case e_TokenType::FALSE:
+                closure->run = &Constant;
+                closure->constant =
+                t_Value(literal->token_type == e_TokenType::TRUE);
+                break;
+            case e_TokenType::NIL:
+                closure->run = &Constant;
+                break;
+            default:
+                closure->run = &Constant;
+                closure->constant = t_Value
+                (
+                    literal->symbol != NO_SYMBOL
+                        ? m_Symbols->String(literal->symbol)
+                        : m_Strings.Intern(literal->value)
+                );
+                break;
+            }
+        }
+        break;
+
+    case e_ExprKind::FORMAT_STRING:
+        {
+            // One operand per segment; nullptr for literal text
+            t_FormatStringExpr* format = As<t_FormatStringExpr>(expr);
+            closure->run = &FormatString;
+            closure->operand_count =
+            static_cast<uint32_t>(format->segments.size());
+            const t_ExprClosure** segments =
+            NewList(closure->operand_count);
+            for (uint32_t i = 0; i < closure->operand_count; ++i)
+            {
+                segments[i] =
+                LowerExpression(format->segments[i].expression.get());
+            }
+            closure->operands = segments;
+        }
+        break;
+
+    case e_ExprKind::VARIABLE:
+        closure->binding = As<t_VariableExpr>(expr)->binding;
+        if (closure->binding.kind == e_BindingKind::LOCAL)
+        {
+            closure->run = &ReadLocal;
+        }
+        else if (closure->binding.kind == e_BindingKind::GLOBAL)
+        {
+            closure->run = &ReadGlobal;
+        }
+        break;
+
+    case e_ExprKind::UNARY:
+        {
+            t_UnaryExpr* unary = As<t_UnaryExpr>(expr);
+            closure->left = LowerExpression(unary->right.get());
+            if (unary->op.type == e_TokenType::MINUS)
+            {
+                closure->run = &Negate;
+            }
+            else if (unary->op.type == e_TokenType::BANG)
+            {
+                closure->run = &Not;
+            }
+        }
+        break;
+
+    case e_ExprKind::PREFIX:
+    case e_ExprKind::POSTFIX:
+        {
+            t_Expr* operand = expr->kind == e_ExprKind::PREFIX
+                ? As<t_PrefixExpr>(expr)->operand.get()
+                : As<t_PostfixExpr>(expr)->operand.get();
+            closure->op = expr->kind == e_ExprKind::PREFIX
+                ? As<t_PrefixExpr>(expr)->op.type
+                : As<t_PostfixExpr>(expr)->op.type;
+
+            // Anything else is an error, reported by the walker
+            t_VariableExpr* variable = As<t_VariableExpr>(operand);
+            if
+            (
+                variable &&
+                !variable->binding.is_const &&
+                variable->binding.kind != e_BindingKind::UNRESOLVED
+            )
+            {
+                closure->run = &Increment;
+                closure->binding = variable->binding;
+            }
+        }
+        break;
+
+    case e_ExprKind::ARRAY:
+        closure->run = &Array;
+        closure->operands = LowerList
+        (
+            As<t_ArrayExpr>(expr)->elements,
+            closure->operand_count
+        );
+        break;
+
+    case e_ExprKind::INDEX:
+        {
+            t_IndexExpr* index = As<t_IndexExpr>(expr);
+            closure->run = &Index;
+            closure->left = LowerExpression(index->object.get());
+            closure->right = LowerExpression(index->index.get());
+        }
+        break;
+
+    case e_ExprKind::INDEX_ASSIGN:
+        {
+            t_IndexAssignExpr* assign = As<t_IndexAssignExpr>(expr);
+            closure->run = &IndexAssign;
+            closure->left = LowerExpression(assign->target->object.get());
+            closure->right = LowerExpression(assign->target->index.get());
+            closure->value = LowerExpression(assign->value.get());
+            closure->op = AssignmentOperator(assign->op.type);
+        }
+        break;
+
+    case e_ExprKind::SIZEOF:
+        closure->run = &Sizeof;
+        closure->left = LowerExpression(As<t_SizeofExpr>(expr)->operand.get());
+        break;
+
+    case e_ExprKind::GROUPING:
+    case e_ExprKind::BINARY:
+    case e_ExprKind::CALL:
+    case e_ExprKind::TYPEOF:
+        break;
+    }
+
+    return closure;
+}
+
+const t_ExprClosure* ClosureCompiler::LowerBinary(t_BinaryExpr* binary)
+{
+    t_ExprClosure* closure = New<t_ExprClosure>();
+    closure->node = binary;
+    closure->run = &Walk;
+
+    e_TokenType op = binary->op.type;
+    e_TokenType assign_op = AssignmentOperator(op);
+    bool is_number = binary->form == e_BinaryForm::NUMBER;
+
+    if (assign_op != e_TokenType::EOF_TOKEN)
+    {
+        // Assigning to anything else fails before the right side runs
+        t_VariableExpr* variable = As<t_VariableExpr>(binary->left.get());
+        if
+        (
+            !variable ||
+            variable->binding.kind == e_BindingKind::UNRESOLVED
+        )
+        {
+            return closure;
+        }
+
+        closure->binding = variable->binding;
+        closure->op = assign_op;
+        closure->right = LowerExpression(binary->right.get());
+        if (!is_number)
+        {
+            closure->run = &Assign;
+            return closure;
+        }
+
+        switch (assign_op)
+        {
+        case e_TokenType::EQUAL:
+            closure->run = &NumberAssign<e_TokenType::EQUAL>;
+            break;
+        case e_TokenType::PLUS:
+            closure->run = &NumberAssign<e_TokenType::PLUS>;
+            break;
+        case e_TokenType::MINUS:
+            closure->run = &NumberAssign<e_TokenType::MINUS>;
+            break;
+        case e_TokenType::STAR:
+            closure->run = &NumberAssign<e_TokenType::STAR>;
+            break;
+        case e_TokenType::SLASH:
+            closure->run = &NumberAssign<e_TokenType::SLASH>;
+            break;
+        case e_TokenType::MODULUS:
+            closure->run = &NumberAssign<e_TokenType::MODULUS>;
+            break;
+        default:
+            closure->run = &Assign;
+            break;
+        }
+        return closure;
+    }
+
+    closure->op = op;
+    closure->left = LowerExpression(binary->left.get());
+    closure->right = LowerExpression(binary->right.get());
+
+    if (op == e_TokenType::AND)
+    {
+        closure->run = &And;
+    }
+    else if (op == e_TokenType::OR)
+    {
+        closure->run = &Or;
+    }
+    else if (!is_number)
+    {
+        if (IsArithmetic(op))
+        {
+            closure->run = &Arithmetic;
+        }
+        else if (IsComparison(op))
+        {
+            closure->run = &Compare;
+        }
+    }
+    else
+    {
+        switch (op)
+        {
+        case e_TokenType::PLUS:
+            closure->run = &NumberBinary<e_TokenType::PLUS>;
+            break;
+        case e_TokenType::MINUS:
+            closure->run = &NumberBinary<e_TokenType::MINUS>;
+            break;
+        case e_TokenType::STAR:
+            closure->run = &NumberBinary<e_TokenType::STAR>;
+            break;
+        case e_TokenType::SLASH:
+            closure->run = &NumberBinary<e_TokenType::SLASH>;
+            break;
+        case e_TokenType::MODULUS:
+            closure->run = &NumberBinary<e_TokenType::MODULUS>;
+            break;
+        case e_TokenType::LESS:
+            closure->run = &NumberBinary<e_TokenType::LESS>;
+            break;
+        case e_TokenType::LESS_EQUAL:
+            closure->run = &NumberBinary<e_TokenType::LESS_EQUAL>;
+            break;
+        case e_TokenType::GREATER:
+            closure->run = &NumberBinary<e_TokenType::GREATER>;
+            break;
+        case e_TokenType::GREATER_EQUAL:
+            closure->run = &NumberBinary<e_TokenType::GREATER_EQUAL>;
+            break;
+        case e_TokenType::EQUAL_EQUAL:
+            closure->run = &NumberBinary<e_TokenType::EQUAL_EQUAL>;
+            break;
+        case e_TokenType::BANG_EQUAL:
+            closure->run = &NumberBinary<e_TokenType::BANG_EQUAL>;
+            break;
+        default:
+            break;
+        }
+    }
+    return closure;
+}
+
+const t_ExprClosure* ClosureCompiler::LowerCall(t_CallExpr* call)
+{
+    t_ExprClosure* closure = New<t_ExprClosure>();
+    closure->node = call;
+    closure->run = &Walk; // an undefined function
+    closure->operands = LowerList(call->arguments, closure->operand_count);
+
+    if (call->target)
+    {
+        closure->run = &Call;
+        closure->body = Body(call->target);
+    }
+    else if (call->builtin != e_Builtin::NONE)
+    {
+        closure->run = &Builtin;
+    }
+    return closure;
+}
+
+const t_StmtClosure* ClosureCompiler::LowerStatement(t_Stmt* stmt)
+{
+    if (!stmt)
+    {
+        return nullptr;
+    }
+
+    t_StmtClosure* closure = New<t_StmtClosure>();
+    closure->node = stmt;
+    closure->run = &WalkStatement;
+
+    switch (stmt->kind)
+    {
+    case e_StmtKind::BLOCK:
+        {
+            t_BlockStmt* block = As<t_BlockStmt>(stmt);
+            closure->run = &Block;
+            closure->count = static_cast<uint32_t>(block->statements.size());
+            const t_StmtClosure** statements = nullptr;
+            if (closure->count != 0)
+            {
+                statements = static_cast<const t_StmtClosure**>
+                (
+                    Allocate
+                    (
+                        closure->count * sizeof(const t_StmtClosure*),
+                        alignof(const t_StmtClosure*)
+                    )
+                );
+            }
+            for (uint32_t i = 0; i < closure->count; ++i)
+            {
+                statements[i] = LowerStatement(block->statements[i].get());
+            }
+            closure->statements = statements;
+        }
+        break;
+
+    case e_StmtKind::IF:
+        {
+            t_IfStmt* if_stmt = As<t_IfStmt>(stmt);
+            closure->run = &If;
+            closure->expr = LowerExpression(if_stmt->condition.get());
+            closure->first = LowerStatement(if_stmt->then_branch.get());
+            closure->second = LowerStatement(if_stmt->else_branch.get());
+        }
+        break;
+
+    case e_StmtKind::FOR:
+        {
+            t_ForStmt* for_stmt = As<t_ForStmt>(stmt);
+            closure->run = &For;
+            closure->first = LowerStatement(for_stmt->initializer.get());
+            closure->expr = LowerExpression(for_stmt->condition.get());
+            closure->increment = LowerExpression(for_stmt->increment.get());
+            closure->second = LowerStatement(for_stmt->body.get());
+        }
+        break;
+
+    case e_StmtKind::VAR:
+        {
+            // A redeclaration only fails, in the walker
+            t_VarStmt* var_stmt = As<t_VarStmt>(stmt);
+            if (!var_stmt->is_redeclaration)
+            {
+                closure->run = &Var;
+                closure->expr = LowerExpression(var_stmt->initializer.get());
+            }
+        }
+        break;
+
+    case e_StmtKind::DISPLAY:
+        {
+            uint32_t count = 0;
+            closure->run = &Display;
+            closure->expressions = LowerList
+            (
+                As<t_DisplayStmt>(stmt)->expressions,
+                count
+            );
+            closure->count = count;
+        }
+        break;
+
+    case e_StmtKind::BENCHMARK:
+        closure->run = &Benchmark;
+        closure->second =
+        LowerStatement(As<t_BenchmarkStmt>(stmt)->body.get());
+        break;
+
+    case e_StmtKind::EXPRESSION:
+        closure->run = &Expression;
+        closure->expr =
+        LowerExpression(As<t_ExpressionStmt>(stmt)->expression.get());
+        break;
+
+    case e_StmtKind::RETURN:
+        {
+            t_ReturnStmt* return_stmt = As<t_ReturnStmt>(stmt);
+            closure->expr = LowerExpression(return_stmt->value.get());
+            closure->run = return_stmt->is_tail_call
+                ? &TailCall
+                : &Return;
+        }
+        break;
+
+    case e_StmtKind::EMPTY:
+    case e_StmtKind::FUNCTION:
+        // Functions were lowered with the script
+        closure->run = &Nothing;
+        break;
+
+    case e_StmtKind::GETIN:
+    case e_StmtKind::BREAK:
+    case e_StmtKind::CONTINUE:
+        // Nothing to evaluate; the walker handles them as they are
+        break;
+    }
+
+    return closure;
+}
+
+// Expressions
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::Constant
+(
+    Interpreter&,
+    const t_ExprClosure& c
+)
+{
+    return Expected<t_Value, t_ErrorInfo>(c.constant);
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::ReadLocal
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    return Expected<t_Value, t_ErrorInfo>(in.m_Frame[c.binding.slot]);
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::ReadGlobal
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    if (!in.m_GlobalDefined[c.binding.slot])
+    {
+        return in.UndeclaredError(As<t_VariableExpr>(c.node)->name);
+    }
+    return Expected<t_Value, t_ErrorInfo>(in.m_Globals[c.binding.slot]);
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::FormatString
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    t_FormatStringExpr* format = static_cast<t_FormatStringExpr*>(c.node);
+    std::string& result = *in.m_Strings.Make();
+    result.reserve(format->text_size + format->segments.size() * 8);
+
+    for (uint32_t i = 0; i < c.operand_count; ++i)
+    {
+        const t_ExprClosure* segment = c.operands[i];
+        if (!segment)
+        {
+            result.append(format->segments[i].text);
+            continue;
+        }
+
+        Expected<t_Value, t_ErrorInfo> value_result =
+        segment->run(in, *segment);
+        if (!value_result)
+        {
+            return value_result;
+        }
+        AppendValue(result, value_result.Value());
+    }
+
+    return Expected<t_Value, t_ErrorInfo>(t_Value(&result));
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::Negate
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    Expected<t_Value, t_ErrorInfo> right_result = c.left->run(in, *c.left);
+    if (!right_result)
+    {
+        return right_result;
+    }
+    if (!right_result.Value().IsNumber())
+    {
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR,
+            "Cannot negate non-numeric value"
+        );
+    }
+    return Expected<t_Value, t_ErrorInfo>
+    (
+        t_Value(-right_result.Value().number)
+    );
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::Not
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    Expected<t_Value, t_ErrorInfo> right_result = c.left->run(in, *c.left);
+    if (!right_result)
+    {
+        return right_result;
+    }
+
+    // `0` counts as false here, unlike in conditions
+    const t_Value& right = right_result.Value();
+    bool is_false =
+    right.IsNil() ||
+    (right.IsBoolean() && !right.boolean) ||
+    (right.IsNumber() && right.number == 0.0);
+    return Expected<t_Value, t_ErrorInfo>(t_Value(is_false));
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::Increment
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    t_Value* target = in.FindVariable(c.binding);
+    if (!target || !target->IsNumber())
+    {
+        // Nothing was changed, so the walker can report the error
+        return Walk(in, c);
+    }
+
+    t_Value old_value = *target;
+    double delta = c.op == e_TokenType::PLUS_PLUS ? 1.0 : -1.0;
+    *target = t_Value(old_value.number + delta);
+    return Expected<t_Value, t_ErrorInfo>
+    (
+        c.node->kind == e_ExprKind::PREFIX ? *target : old_value
+    );
+}
+
+template<e_TokenType OP>
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::NumberBinary
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    Expected<t_Value, t_ErrorInfo> left_result = c.left->run(in, *c.left);
+    if (!left_result)
+    {
+        return left_result;
+    }
+    Expected<t_Value, t_ErrorInfo> right_result = c.right->run(in, *c.right);
+    if (!right_result)
+    {
+        return right_result;
+    }
+
+    double left = left_result.Value().number;
+    double right = right_result.Value().number;
+    if constexpr (OP == e_TokenType::PLUS)
+    {
+        return Expected<t_Value, t_ErrorInfo>(t_Value(left + right));
+    }
+    else if constexpr (OP == e_TokenType::MINUS)
+    {
+        return Expected<t_Value, t_ErrorInfo>(t_Value(left - right));
+    }
+    else if constexpr (OP == e_TokenType::STAR)
+    {
+        return Expected<t_Value, t_ErrorInfo>(t_Value(left * right));
+    }
+    else if constexpr (OP == e_TokenType::SLASH)
+    {
+        if (right == 0)
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Division by zero",
+                OperatorLine(c)
+            );
+        }
+        return Expected<t_Value, t_ErrorInfo>(t_Value(left / right));
+    }
+    else if constexpr (OP == e_TokenType::MODULUS)
+    {
+        if (right == 0)
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Modulus by zero",
+                OperatorLine(c)
+            );
+        }
+        return Expected<t_Value, t_ErrorInfo>
+        (
+            t_Value(std::fmod(left, right))
+        );
+    }
+    else if constexpr (OP == e_TokenType::LESS)
+    {
+        return Expected<t_Value, t_ErrorInfo>(t_Value(left < right));
+    }
+    else if constexpr (OP == e_TokenType::LESS_EQUAL)
+    {
+        return Expected<t_Value, t_ErrorInfo>(t_Value(left <= right));
+    }
+    else if constexpr (OP == e_TokenType::GREATER)
+    {
+        return Expected<t_Value, t_ErrorInfo>(t_Value(left > right));
+    }
+    else if constexpr (OP == e_TokenType::GREATER_EQUAL)
+    {
+        return Expected<t_Value, t_ErrorInfo>(t_Value(left >= right));
+    }
+    else if constexpr (OP == e_TokenType::EQUAL_EQUAL)
+    {
+        return Expected<t_Value, t_ErrorInfo>(t_Value(left == right));
+    }
+    else
+    {
+        static_assert(OP == e_TokenType::BANG_EQUAL);
+        return Expected<t_Value, t_ErrorInfo>(t_Value(left != right));
+    }
+}
+
+template<e_TokenType OP>
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::NumberAssign
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    t_Value* target = in.FindVariable(c.binding);
+    if (!target)
+    {
+        return Walk(in, c); // fails before the right side runs
+    }
+    double left = target->number;
+
+    Expected<t_Value, t_ErrorInfo> right_result = c.right->run(in, *c.right);
+    if (!right_result)
+    {
+        return right_result;
+    }
+    double right = right_result.Value().number;
+
+    double result = right;
+    if constexpr (OP == e_TokenType::PLUS)
+    {
+        result = left + right;
+    }
+    else if constexpr (OP == e_TokenType::MINUS)
+    {
+        result = left - right;
+    }
+    else if constexpr (OP == e_TokenType::STAR)
+    {
+        result = left * right;
+    }
+    else if constexpr (OP == e_TokenType::SLASH)
+    {
+        if (right == 0)
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Division by zero",
+                OperatorLine(c)
+            );
+        }
+        result = left / right;
+    }
+    else if constexpr (OP == e_TokenType::MODULUS)
+    {
+        if (right == 0)
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Modulus by zero",
+                OperatorLine(c)
+            );
+        }
+        result = std::fmod(left, right);
+    }
+
+    *target = t_Value(result);
+    return Expected<t_Value, t_ErrorInfo>(*target);
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::Arithmetic
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    Expected<t_Value, t_ErrorInfo> left_result = c.left->run(in, *c.left);
+    if (!left_result)
+    {
+        return left_result;
+    }
+    Expected<t_Value, t_ErrorInfo> right_result = c.right->run(in, *c.right);
+    if (!right_result)
+    {
+        return right_result;
+    }
+    return in.PerformArithmetic
+    (
+        left_result.Value(),
+        c.op,
+        right_result.Value(),
+        OperatorLine(c)
+    );
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::Compare
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    Expected<t_Value, t_ErrorInfo> left_result = c.left->run(in, *c.left);
+    if (!left_result)
+    {
+        return left_result;
+    }
+    Expected<t_Value, t_ErrorInfo> right_result = c.right->run(in, *c.right);
+    if (!right_result)
+    {
+        return right_result;
+    }
+
+    Expected<bool, t_ErrorInfo> comparison_result = in.PerformComparison
+    (
+        left_result.Value(),
+        c.op,
+        right_result.Value(),
+        OperatorLine(c)
+    );
+    if (!comparison_result)
+    {
+        return comparison_result.Error();
+    }
+    return Expected<t_Value, t_ErrorInfo>
+    (
+        t_Value(comparison_result.Value())
+    );
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::And
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    Expected<t_Value, t_ErrorInfo> left_result = c.left->run(in, *c.left);
+    if (!left_result)
+    {
+        return left_result;
+    }
+    if (!IsTruthy(left_result.Value()))
+    {
+        return Expected<t_Value, t_ErrorInfo>(t_Value(false));
+    }
+
+    Expected<t_Value, t_ErrorInfo> right_result = c.right->run(in, *c.right);
+    if (!right_result)
+    {
+        return right_result;
+    }
+    return Expected<t_Value, t_ErrorInfo>
+    (
+        t_Value(IsTruthy(right_result.Value()))
+    );
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::Or
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    Expected<t_Value, t_ErrorInfo> left_result = c.left->run(in, *c.left);
+    if (!left_result)
+    {
+        return left_result;
+    }
+    if (IsTruthy(left_result.Value()))
+    {
+        return Expected<t_Value, t_ErrorInfo>(t_Value(true));
+    }
+
+    Expected<t_Value, t_ErrorInfo> right_result = c.right->run(in, *c.right);
+    if (!right_result)
+    {
+        return right_result;
+    }
+    return Expected<t_Value, t_ErrorInfo>
+    (
+        t_Value(IsTruthy(right_result.Value()))
+    );
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::Assign
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    t_VariableExpr* variable = static_cast<t_VariableExpr*>
+    (
+        static_cast<t_BinaryExpr*>(c.node)->left.get()
+    );
+    // Fails before the right side runs
+    Expected<t_Value*, t_ErrorInfo> target_result =
+    in.AssignmentTarget(c.binding, variable->name);
+    if (!target_result)
+    {
+        return target_result.Error();
+    }
+    t_Value* target = target_result.Value();
+    t_Value left_value = *target;
+
+    Expected<t_Value, t_ErrorInfo> right_result = c.right->run(in, *c.right);
+    if (!right_result)
+    {
+        return right_result;
+    }
+
+    Expected<t_Value, t_ErrorInfo> final_value_result =
+    c.op == e_TokenType::EQUAL
+        ? right_result
+        : in.PerformArithmetic
+          (
+              left_value,
+              c.op,
+              right_result.Value(),
+              OperatorLine(c)
+          );
+    if (!final_value_result)
+    {
+        return final_value_result;
+    }
+
+    // Typing is enforced as in the walker
+    Expected<int, t_ErrorInfo> type_check = in.CheckAssignedType
+    (
+        left_value, final_value_result.Value(), variable->name
+    );
+    if (!type_check)
+    {
+        return type_check.Error();
+    }
+
+    *target = final_value_result.Value();
+    return final_value_result;
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::Call
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    t_CallExpr* call_expr = static_cast<t_CallExpr*>(c.node);
+    t_FunStmt* fun_stmt = call_expr->target;
+
+    size_t base = in.m_StackTop;
+    Expected<int, t_ErrorInfo> check = in.CheckCall
+    (
+        fun_stmt, base, call_expr->line
+    );
+    if (!check)
+    {
+        return check.Error();
+    }
+    if (in.m_Stats)
+    {
+        in.CountCall(in.m_Frames.size(), base + fun_stmt->frame_size);
+    }
+
+    // The same frame layout as Interpreter::CallFunction()
+    in.m_StackTop = base + fun_stmt->frame_size;
+    for (uint32_t i = 0; i < c.operand_count; ++i)
+    {
+        Expected<t_Value, t_ErrorInfo> arg_result =
+        c.operands[i]->run(in, *c.operands[i]);
+        if (!arg_result)
+        {
+            in.m_StackTop = base;
+            return arg_result;
+        }
+        in.m_Stack[base + i] = arg_result.Value();
+    }
+
+    if (in.m_Memo && fun_stmt->memo_slot >= 0)
+    {
+        return in.RunMemoized(fun_stmt, base, c.body);
+    }
+
+    // Interpreter::RunFunction(), without leaving this file
+    in.m_Frames.push_back
+    (
+        Interpreter::t_CallFrame
+        {
+            fun_stmt,
+            base,
+            in.m_LoopDepth,
+            t_Value(),
+            in.m_Strings.MadeCount(),
+            in.m_Arrays.MadeCount()
+        }
+    );
+    t_Value* caller_frame = in.m_Frame;
+    in.m_Frame = in.m_Stack.data() + base;
+    in.m_LoopDepth = 0;
+
+    Expected<int, t_ErrorInfo> body_result(0);
+    const t_StmtClosure* body = c.body;
+    while (true)
+    {
+        if (body)
+        {
+            in.m_IsReturning = false;
+            body_result = body->run(in, *body);
+            in.m_IsReturning = false;
+        }
+        if (!body_result || !in.m_TailCall)
+        {
+            break;
+        }
+
+        const t_StmtClosure* next_body = in.m_TailBody;
+        Expected<t_FunStmt*, t_ErrorInfo> next = in.EnterTailCall(base);
+        if (!next)
+        {
+            body_result = next.Error();
+            break;
+        }
+        body = next_body;
+        in.CollectAtLoop();
+    }
+
+    t_Value return_value = in.m_Frames.back().return_value;
+    size_t strings_made = in.m_Frames.back().strings_made;
+    ArrayPool::t_Made arrays_made = in.m_Frames.back().arrays_made;
+    in.m_LoopDepth = in.m_Frames.back().loop_depth;
+    in.m_Frames.pop_back();
+    in.m_Frame = caller_frame;
+    in.m_StackTop = base;
+
+    if (!body_result)
+    {
+        return body_result.Error();
+    }
+    in.CollectAtReturn(return_value, strings_made, arrays_made);
+    return Expected<t_Value, t_ErrorInfo>(return_value);
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::Builtin
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    t_CallExpr* call_expr = static_cast<t_CallExpr*>(c.node);
+    t_Value arguments[MAX_BUILTIN_ARITY];
+    for (uint32_t i = 0; i < c.operand_count; ++i)
+    {
+        Expected<t_Value, t_ErrorInfo> arg_result =
+        c.operands[i]->run(in, *c.operands[i]);
+        if (!arg_result)
+        {
+            return arg_result;
+        }
+        arguments[i] = arg_result.Value();
+    }
+
+    Expected<t_Value, t_ErrorInfo> result =
+    CallBuiltin(call_expr->builtin, arguments, in.m_Arrays);
+    if (!result)
+    {
+        t_ErrorInfo error = result.Error();
+        error.line = call_expr->line;
+        return error;
+    }
+    return result;
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::Array
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    std::vector<t_Value> elements;
+    elements.reserve(c.operand_count);
+    for (uint32_t i = 0; i < c.operand_count; ++i)
+    {
+        Expected<t_Value, t_ErrorInfo> element_result =
+        c.operands[i]->run(in, *c.operands[i]);
+        if (!element_result)
+        {
+            return element_result;
+        }
+        elements.push_back(element_result.Value());
+    }
+
+    Expected<t_Value, t_ErrorInfo> result =
+    MakeArray(elements.data(), elements.size(), in.m_Arrays);
+    if (!result)
+    {
+        t_ErrorInfo error = result.Error();
+        error.line = static_cast<t_ArrayExpr*>(c.node)->line;
+        return error;
+    }
+    return result;
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::Index
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    Expected<t_Value, t_ErrorInfo> object_result = c.left->run(in, *c.left);
+    if (!object_result)
+    {
+        return object_result;
+    }
+    Expected<t_Value, t_ErrorInfo> index_result = c.right->run(in, *c.right);
+    if (!index_result)
+    {
+        return index_result;
+    }
+
+    Expected<t_Value, t_ErrorInfo> result =
+    GetElement(object_result.Value(), index_result.Value());
+    if (!result)
+    {
+        t_ErrorInfo error = result.Error();
+        error.line = static_cast<t_IndexExpr*>(c.node)->line;
+        return error;
+    }
+    return result;
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::IndexAssign
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    t_IndexAssignExpr* assign = static_cast<t_IndexAssignExpr*>(c.node);
+    Expected<t_Value, t_ErrorInfo> object_result = c.left->run(in, *c.left);
+    if (!object_result)
+    {
+        return object_result;
+    }
+    t_Value object = object_result.Value();
+
+    Expected<t_Value, t_ErrorInfo> index_result = c.right->run(in, *c.right);
+    if (!index_result)
+    {
+        return index_result;
+    }
+    t_Value index = index_result.Value();
+
+    // A compound assignment reads the element before the right side
+    t_Value current;
+    if (c.op != e_TokenType::EQUAL)
+    {
+        Expected<t_Value, t_ErrorInfo> current_result =
+        GetElement(object, index);
+        if (!current_result)
+        {
+            t_ErrorInfo error = current_result.Error();
+            error.line = assign->target->line;
+            return error;
+        }
+        current = current_result.Value();
+    }
+
+    Expected<t_Value, t_ErrorInfo> value_result = c.value->run(in, *c.value);
+    if (!value_result)
+    {
+        return value_result;
+    }
+
+    if (c.op != e_TokenType::EQUAL)
+    {
+        value_result = in.PerformArithmetic
+        (
+            current,
+            c.op,
+            value_result.Value(),
+            assign->op.line
+        );
+        if (!value_result)
+        {
+            return value_result;
+        }
+    }
+
+    Expected<t_Value, t_ErrorInfo> result =
+    SetElement(object, index, value_result.Value());
+    if (!result)
+    {
+        t_ErrorInfo error = result.Error();
+        error.line = assign->op.line;
+        return error;
+    }
+    return result;
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::Sizeof
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    Expected<t_Value, t_ErrorInfo> operand_result = c.left->run(in, *c.left);
+    if (!operand_result)
+    {
+        return operand_result;
+    }
+
+    Expected<t_Value, t_ErrorInfo> result = SizeOf(operand_result.Value());
+    if (!result)
+    {
+        t_ErrorInfo error = result.Error();
+        error.line = static_cast<t_SizeofExpr*>(c.node)->line;
+        return error;
+    }
+    return result;
+}
+
+Expected<t_Value, t_ErrorInfo> ClosureCompiler::Walk
+(
+    Interpreter& in,
+    const t_ExprClosure& c
+)
+{
+    return in.Evaluate(c.node);
+}
+
+// Statements
+
+Expected<int, t_ErrorInfo> ClosureCompiler::Block
+(
+    Interpreter& in,
+    const t_StmtClosure& c
+)
+{
+    for (uint32_t i = 0; i < c.count; ++i)
+    {
+        const t_StmtClosure* statement = c.statements[i];
+        Expected<int, t_ErrorInfo> result = statement->run(in, *statement);
+        if (!result)
+        {
+            AddLine(result.Error(), statement->node->line);
+            return result;
+        }
+
+        // break, continue and return leave the rest of the block
+        if (!in.m_ControlSignal.empty() || in.m_IsReturning)
+        {
+            break;
+        }
+    }
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> ClosureCompiler::If
+(
+    Interpreter& in,
+    const t_StmtClosure& c
+)
+{
+    Expected<t_Value, t_ErrorInfo> condition_result = c.expr->run(in, *c.expr);
+    if (!condition_result)
+    {
+        return condition_result.Error();
+    }
+
+    const t_StmtClosure* branch = IsTruthy(condition_result.Value())
+        ? c.first
+        : c.second;
+    if (branch)
+    {
+        return branch->run(in, *branch);
+    }
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> ClosureCompiler::For
+(
+    Interpreter& in,
+    const t_StmtClosure& c
+)
+{
+    // Loops that only do arithmetic still run as a register kernel
+    t_ForStmt* for_stmt = static_cast<t_ForStmt*>(c.node);
+    Expected<bool, t_ErrorInfo> kernel_result =
+    for_stmt->parallel
+        ? in.ExecuteParallelLoop(for_stmt)
+        : Expected<bool, t_ErrorInfo>(false);
+    if (kernel_result && !kernel_result.Value())
+    {
+        kernel_result = in.ExecuteLoopKernel(for_stmt);
+    }
+    if (!kernel_result)
+    {
+        return kernel_result.Error();
+    }
+    if (kernel_result.Value())
+    {
+        return Expected<int, t_ErrorInfo>(0);
+    }
+
+    in.m_LoopDepth++;
+    Expected<int, t_ErrorInfo> result(0);
+    if (c.first)
+    {
+        result = c.first->run(in, *c.first);
+    }
+
+    while (result)
+    {
+        in.CollectAtLoop();
+        if (c.expr)
+        {
+            Expected<t_Value, t_ErrorInfo> condition_result =
+            c.expr->run(in, *c.expr);
+            if (!condition_result)
+            {
+                result = condition_result.Error();
+                break;
+            }
+            if (!IsTruthy(condition_result.Value()))
+            {
+                break;
+            }
+        }
+
+        in.m_ControlSignal.clear();
+        result = c.second->run(in, *c.second);
+        if (!result)
+        {
+            break;
+        }
+        if (in.m_ControlSignal == "break")
+        {
+            in.m_ControlSignal.clear();
+            break;
+        }
+        // `continue` falls through to the increment
+        in.m_ControlSignal.clear();
+        if (in.m_IsReturning)
+        {
+            break;
+        }
+
+        if (c.increment)
+        {
+            Expected<t_Value, t_ErrorInfo> increment_result =
+            c.increment->run(in, *c.increment);
+            if (!increment_result)
+            {
+                result = increment_result.Error();
+            }
+        }
+    }
+
+    in.m_LoopDepth--;
+    return result;
+}
+
+Expected<int, t_ErrorInfo> ClosureCompiler::Var
+(
+    Interpreter& in,
+    const t_StmtClosure& c
+)
+{
+    t_Value typed_value;
+    if (c.expr)
+    {
+        Expected<t_Value, t_ErrorInfo> value_result = c.expr->run(in, *c.expr);
+        if (!value_result)
+        {
+            return value_result.Error();
+        }
+        typed_value = value_result.Value();
+    }
+
+    const t_Binding& binding = static_cast<t_VarStmt*>(c.node)->binding;
+    if (binding.kind == e_BindingKind::GLOBAL)
+    {
+        in.m_Globals[binding.slot] = typed_value;
+        in.m_GlobalDefined[binding.slot] = 1;
+    }
+    else
+    {
+        in.m_Frame[binding.slot] = typed_value;
+    }
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> ClosureCompiler::Display
+(
+    Interpreter& in,
+    const t_StmtClosure& c
+)
+{
+    for (uint32_t i = 0; i < c.count; ++i)
+    {
+        if (i != 0)
+        {
+            in.m_Output.Write(" ");
+        }
+
+        // Format strings are written piece by piece, as in the walker
+        const t_ExprClosure* expr = c.expressions[i];
+        if (expr->run == &FormatString)
+        {
+            t_FormatStringExpr* format =
+            static_cast<t_FormatStringExpr*>(expr->node);
+            for (uint32_t j = 0; j < expr->operand_count; ++j)
+            {
+                const t_ExprClosure* segment = expr->operands[j];
+                if (!segment)
+                {
+                    in.m_Output.Write(format->segments[j].text);
+                    continue;
+                }
+
+                Expected<t_Value, t_ErrorInfo> segment_result =
+                segment->run(in, *segment);
+                if (!segment_result)
+                {
+                    return segment_result.Error();
+                }
+                AppendValue(in.m_Output.Text(), segment_result.Value());
+                in.m_Output.Commit();
+            }
+            continue;
+        }
+
+        Expected<t_Value, t_ErrorInfo> value_result = expr->run(in, *expr);
+        if (!value_result)
+        {
+            return value_result.Error();
+        }
+        AppendValue(in.m_Output.Text(), value_result.Value());
+        in.m_Output.Commit();
+    }
+    in.m_Output.Write("\n");
+
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> ClosureCompiler::Benchmark
+(
+    Interpreter& in,
+    const t_StmtClosure& c
+)
+{
+    return in.ExecuteBenchmark
+    (
+        static_cast<t_BenchmarkStmt*>(c.node),
+        c.second
+    );
+}
+
+Expected<int, t_ErrorInfo> ClosureCompiler::Expression
+(
+    Interpreter& in,
+    const t_StmtClosure& c
+)
+{
+    Expected<t_Value, t_ErrorInfo> result = c.expr->run(in, *c.expr);
+    if (!result)
+    {
+        return result.Error();
+    }
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> ClosureCompiler::Return
+(
+    Interpreter& in,
+    const t_StmtClosure& c
+)
+{
+    t_Value return_value;
+    if (c.expr)
+    {
+        Expected<t_Value, t_ErrorInfo> result = c.expr->run(in, *c.expr);
+        if (!result)
+        {
+            return result.Error();
+        }
+        return_value = result.Value();
+    }
+
+    in.m_Frames.back().return_value = return_value;
+    in.m_IsReturning = true;
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> ClosureCompiler::TailCall
+(
+    Interpreter& in,
+    const t_StmtClosure& c
+)
+{
+    // Interpreter::ExecuteTailCall() over the lowered arguments
+    const t_ExprClosure& call = *c.expr;
+    t_CallExpr* call_expr = static_cast<t_CallExpr*>(call.node);
+    size_t arguments = in.m_StackTop;
+    if (arguments + call.operand_count > in.m_Stack.size())
+    {
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR,
+            "Stack overflow",
+            call_expr->line
+        );
+    }
+
+    in.m_StackTop = arguments + call.operand_count;
+    for (uint32_t i = 0; i < call.operand_count; ++i)
+    {
+        Expected<t_Value, t_ErrorInfo> arg_result =
+        call.operands[i]->run(in, *call.operands[i]);
+        if (!arg_result)
+        {
+            in.m_StackTop = arguments;
+            return arg_result.Error();
+        }
+        in.m_Stack[arguments + i] = arg_result.Value();
+    }
+    in.m_StackTop = arguments;
+
+    in.m_TailCall = call_expr;
+    in.m_TailBody = call.body;
+    in.m_IsReturning = true;
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> ClosureCompiler::Nothing
+(
+    Interpreter&,
+    const t_StmtClosure&
+)
+{
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> ClosureCompiler::WalkStatement
+(
+    Interpreter& in,
+    const t_StmtClosure& c
+)
+{
+    return in.Execute(c.node);
+}
@@ -1,117 +1,179 @@
 #include <rubberduck/Interpreter.h>
+#include <algorithm>
 #include <iostream>
-#include <sstream>
 #include <cctype>
-#include <iomanip>
 #include <unordered_set>
 #include <cmath>
+#include <rubberduck/ArrayOps.h>
 #include <rubberduck/Lexer.h>
 #include <rubberduck/Parser.h>
 #include <rubberduck/ErrorHandling.h>
+#include <rubberduck/Input.h>
+#include <rubberduck/NativeStack.h>
+#include <rubberduck/ParallelLoop.h>
 
-// Helper: Assigns variable to all visible scopes where it exists.
-static void AssignToVisibleVariable
-(
-    const std::string &name, 
-    const t_TypedValue &value, 
-    std::unordered_map<std::string, 
-    t_TypedValue> &m_Environment, 
-    std::vector<std::unordered_map<std::string, 
-    t_TypedValue>> &m_ScopeStack
-)
+Interpreter::Interpreter()
+    : m_Input(&StandardInput())
 {
-    auto& env_entry = m_Environment[name];
-    env_entry = value;
-    
-    const auto& key_ref = name;
-    for(auto& scope : m_ScopeStack) 
-    {
-        auto it = scope.find(key_ref);
-        if(it != scope.end())
-        {
-            it->second = value;
-        }
-    }
+    m_Stack.resize(STACK_SIZE);
 }
 
-Interpreter::Interpreter()
+void Interpreter::SetBenchmarkFormat(e_BenchmarkFormat format)
 {
-    std::ios::sync_with_stdio(false);
-    std::cin.tie(nullptr);
-    
-    PushScope();
-    m_BufferOutput = false;
-    m_OutputBuffer.clear();
+    m_Benchmarks.SetFormat(format);
+}
+
+void Interpreter::SetFlushPolicy(e_FlushPolicy policy)
+{
+    m_Output.SetPolicy(policy);
+}
+
+void Interpreter::SetStrictFloatingPoint(bool strict)
+{
+    m_LoopCompiler.SetStrictFloatingPoint(strict);
+}
+
+void Interpreter::SetProfiler(Profiler* profiler)
+{
+    m_Profiler = profiler;
+}
 
-    m_Functions.reserve(64);
-    m_Environment.reserve(256);
-    m_ScopeStack.reserve(32);
+void Interpreter::SetOutput(std::ostream& stream)
+{
+    m_Output.SetStream(stream);
+}
+
+void Interpreter::SetInput(InputReader& input)
+{
+    m_Input = &input;
 }
 
-void Interpreter::WriteOutput(const std::string& text)
+void Interpreter::SetClosures(bool enabled)
 {
-    if (m_BufferOutput)
+    if (!enabled)
     {
-        m_OutputBuffer.append(text);
-        static const std::size_t FLUSH_THRESHOLD = 4 * 1024 * 1024;
-        if (m_OutputBuffer.size() >= FLUSH_THRESHOLD)
-        {
-            std::cout.write
-            (
-                m_OutputBuffer.data(),
-                static_cast<std::streamsize>(m_OutputBuffer.size())
-            );
-            m_OutputBuffer.clear();
-        }
+        m_Closures.reset();
     }
-    else
+    else if (!m_Closures)
     {
-        std::cout.write
-        (
-            text.data(), 
-            static_cast<std::streamsize>(text.size())
-        );
+        m_Closures = std::make_unique<ClosureCompiler>();
     }
 }
 
-void Interpreter::FlushOutput()
+void Interpreter::SetMemoCache(MemoCache* memo)
 {
-    if (!m_OutputBuffer.empty())
-    {
-        std::cout.write
-        (
-            m_OutputBuffer.data(),
-            static_cast<std::streamsize>(m_OutputBuffer.size())
-        );
-        std::cout.flush();
-        m_OutputBuffer.clear();
-    }
+    m_Memo = memo;
+}
+
+void Interpreter::SetStats(t_RunStats* stats)
+{
+    m_Stats = stats;
+}
+
+void Interpreter::SetMaxCallDepth(size_t depth)
+{
+    m_MaxCallDepth = depth;
+    m_Stack.resize(std::max(STACK_SIZE, depth * SLOTS_PER_CALL));
+}
+
+InterpretationResult Interpreter::Interpret(const CompiledScript &script)
+{
+    SetStrictFloatingPoint(script.Options().strict_fp);
+    // Lets the closures lowered by an earlier run of it be reused
+    m_ScriptId = script.Id();
+    InterpretationResult result = Interpret
+    (
+        script.Statements(),
+        script.Resolved(),
+        script.Symbols()
+    );
+    m_ScriptId = 0;
+    return result;
 }
 
 InterpretationResult Interpreter::Interpret
 (
-    const std::vector<PoolPtr<t_Stmt>> &statements
+    const StmtList &statements,
+    const t_ResolvedScript &script,
+    const SymbolTable &symbols
 )
 {
-    m_Functions.clear();
+    m_Symbols = &symbols;
+    // Nothing holds a value of an earlier run any more
+    m_Strings.Clear();
+    m_Arrays.Clear();
+    m_Globals.assign(script.global_names.size(), t_Value());
+    m_GlobalDefined.assign(script.global_names.size(), 0);
+    // The script itself runs in the bottom frame of the stack. Only
+    // that frame is cleared: the slots above it keep values of earlier
+    // calls, but the Resolver guarantees each local is written before
+    // it is read, and a collection ignores handles it did not make.
+    std::fill_n(m_Stack.begin(), script.main_frame_size, t_Value());
+    m_Frames.clear();
+    m_Frames.reserve(std::min(m_MaxCallDepth, DEFAULT_MAX_CALL_DEPTH) + 1);
+    m_Frames.push_back
+    (
+        t_CallFrame{nullptr, 0, 0, t_Value(), 0, ArrayPool::t_Made()}
+    );
+    m_StackTop = script.main_frame_size;
+    m_Frame = m_Stack.data();
+    m_LoopDepth = 0;
+    m_TailCall = nullptr;
+    m_TailBody = nullptr;
 
-    for (const auto &statement : statements)
+    if (m_Memo)
     {
-        if (t_FunStmt *fun_stmt = As<t_FunStmt>(statement.get()))
+        // Pure functions are numbered in the order they are declared
+        std::vector<std::string> names;
+        for (const auto &statement : statements)
         {
-            m_Functions[fun_stmt->name] = fun_stmt;
+            t_FunStmt *fun_stmt = As<t_FunStmt>(statement.get());
+            if (fun_stmt && fun_stmt->memo_slot >= 0)
+            {
+                names.push_back(SymbolName(fun_stmt->name));
+            }
         }
+        m_Memo->Reset(std::move(names));
+    }
+    if (m_Stats)
+    {
+        m_Stats->counts_every_loop = true;
+        m_Stats->max_call_depth = 0;
+        m_Stats->max_stack_slots = m_StackTop;
+    }
+
+    // Calls measure the native stack they use from here
+    char stack_marker = 0;
+    m_NativeStackBase = reinterpret_cast<uintptr_t>(&stack_marker);
+    size_t native_left = NativeStackLeft(m_NativeStackBase);
+    m_NativeStackBudget = native_left == 0
+        ? NATIVE_STACK_FALLBACK
+        : native_left - std::min
+          (
+              native_left,
+              std::max(NATIVE_STACK_RESERVE, native_left / 8)
+          );
+
+    bool use_closures = m_Closures && !m_Profiler;
+    if (use_closures)
+    {
+        m_Closures->Lower(statements, symbols, m_ScriptId);
     }
 
-    for (const auto &statement : statements)
+    for (size_t i = 0; i < statements.size(); ++i)
     {
         try
         {
-            Expected<int, t_ErrorInfo> result = Execute(statement.get());
+            Expected<int, t_ErrorInfo> result = use_closures
+                ? ClosureCompiler::Run(*this, *m_Closures->Main()[i])
+                : Execute(statements[i].get());
             if (!result)
             {
-                // Report the error and stop execution
-                ReportError(result.Error());
+                // Stop execution, after whatever the script displayed
+                // before the error
+                AddLine(result.Error(), statements[i]->line);
+                m_Output.SetHeld(false);
+                m_Output.Flush();
                 return InterpretationResult(result.Error());
             }
         }
@@ -122,7 +184,8 @@ InterpretationResult Interpreter::Interpret
                 e_ErrorType::RUNTIME_ERROR,
                 std::string("Unhandled std::exception: ") + ex.what()
             );
-            ReportError(err);
+            m_Output.SetHeld(false);
+            m_Output.Flush();
             return InterpretationResult(err);
         }
         catch (...)
@@ -132,348 +195,320 @@ InterpretationResult Interpreter::Interpret
                 e_ErrorType::RUNTIME_ERROR,
                 "Unhandled unknown exception during execution"
             );
-            ReportError(err);
+            m_Output.SetHeld(false);
+            m_Output.Flush();
             return InterpretationResult(err);
         }
     }
-    
-    return InterpretationResult(0); // Success represented by 0
-}
-
-// Scope management m_Functions
-void Interpreter::PushScope()
-{
-    // Save the current state of the m_Environment
-    m_ScopeStack.emplace_back(m_Environment);
-}
 
-void Interpreter::PopScope()
-{
-    if (!m_ScopeStack.empty()) 
-    {
-        // Restore the m_Environment to its previous state
-        m_Environment = std::move(m_ScopeStack.back());
-        m_ScopeStack.pop_back();
-    }
+    m_Output.Flush();
+    return InterpretationResult(0); // Success represented by 0
 }
 
-Expected<int, t_ErrorInfo> Interpreter::DeclareVariable
+void Interpreter::Collect
 (
-    const std::string& name, int line
+    size_t strings_made,
+    const ArrayPool::t_Made &arrays_made,
+    const t_Value &result
 )
 {
-    // Check if variable is already declared in current scope
-    // We do this by checking if it exists in the current m_Environment
-    // and comparing with the previous scope's m_Environment if it exists
-    if (!m_Environment.count(name)) 
+    m_Strings.Mark(result);
+    m_Arrays.Mark(result, m_Strings);
+    m_Strings.Mark(m_Globals.data(), m_Globals.size());
+    m_Arrays.Mark(m_Globals.data(), m_Globals.size(), m_Strings);
+    m_Strings.Mark(m_Stack.data(), m_StackTop);
+    m_Arrays.Mark(m_Stack.data(), m_StackTop, m_Strings);
+    for (const t_CallFrame &frame : m_Frames)
     {
-        // Variable not declared yet, this is fine
-        return Expected<int, t_ErrorInfo>(0); // Success
+        m_Strings.Mark(frame.return_value);
+        m_Arrays.Mark(frame.return_value, m_Strings);
     }
-    
-    // Variable already exists, check if it was declared in current scope
-    if (!m_ScopeStack.empty()) 
+    if (m_Memo)
     {
-        const auto& previous_scope = m_ScopeStack.back();
-        if (previous_scope.find(name) == previous_scope.end()) 
-        {
-            // Variable exists but was declared in current scope - this is an error
-            return t_ErrorInfo
-            (
-                e_ErrorType::RUNTIME_ERROR, 
-                "Variable '" 
-                + name + 
-                "' has already been declared in this scope", 
-                line
-            );
-        }
+        m_Memo->Mark(m_Strings);
     }
-    
-    // Variable exists but was declared in a previous scope - this is shadowing, which is allowed
-    return Expected<int, t_ErrorInfo>(0); // Success
-}
-
-// Helper function to format numbers (removes trailing zeros)
-std::string Interpreter::FormatNumber(double value)
-{
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(15) << value;
-    std::string str = oss.str();
-    
-    // Remove trailing zeros and decimal point if not needed
-    str.erase(str.find_last_not_of('0') + 1, std::string::npos);
-    str.erase(str.find_last_not_of('.') + 1, std::string::npos);
-    
-    return str;
+    m_Strings.Sweep(strings_made);
+    m_Arrays.Sweep(arrays_made);
 }
 
-// Helper function to detect the type of a value
-e_ValueType Interpreter::DetectType(const std::string& value)
+t_Value* Interpreter::FindVariable(const t_Binding &binding)
 {
-    if (value == "nil")
+    if (binding.kind == e_BindingKind::LOCAL)
     {
-        return e_ValueType::NIL;
+        return &m_Frame[binding.slot];
     }
-    
-    if (value == "true" || value == "false")
-    {
-        return e_ValueType::BOOLEAN;
-    }
-    
-    // Check if it's a number (integer or floating point)
-    if (!value.empty())
+    if 
+    (
+        binding.kind == e_BindingKind::GLOBAL && 
+        m_GlobalDefined[binding.slot]
+    )
     {
-        bool is_number = true;
-        bool has_decimal = false;
-        size_t start = 0;
-        
-        // Handle negative numbers
-        if (value[0] == '-')
-        {
-            start = 1;
-        }
-        
-        // Check each character
-        for (size_t i = start; i < value.length(); i++)
-        {
-            if (value[i] == '.')
-            {
-                if (has_decimal)
-                {
-                    is_number = false;
-                    break;
-                }
-                has_decimal = true;
-            }
-            else if (!std::isdigit(value[i]))
-            {
-                is_number = false;
-                break;
-            }
-        }
-        
-        // Make sure we have at least one digit
-        if (is_number && value.length() > start)
-        {
-            return e_ValueType::NUMBER;
-        }
+        return &m_Globals[binding.slot];
     }
-    
-    // Default to string for all other values
-    return e_ValueType::STRING;
+    return nullptr;
 }
 
-// Helper function to check if a string represents an integer
-bool Interpreter::IsInteger(const std::string& value)
+t_ErrorInfo Interpreter::UndeclaredError(t_Symbol name) const
 {
-    if (value.empty()) return false;
-    
-    size_t start = 0;
-    if (value[0] == '-' || value[0] == '+') 
+    return t_ErrorInfo
+    (
+        e_ErrorType::RUNTIME_ERROR,
+        "Variable '" + SymbolName(name) +
+        "' must be declared with 'auto' keyword before use"
+    );
+}
+
+Expected<t_Value*, t_ErrorInfo> Interpreter::AssignmentTarget
+(
+    const t_Binding &binding,
+    t_Symbol name
+)
+{
+    t_Value *target = FindVariable(binding);
+    if (!target)
     {
-        if (value.length() == 1) return false;
-        start = 1;
+        return UndeclaredError(name);
     }
-    
-    for (size_t i = start; i < value.length(); i++) 
+    if (binding.is_const)
     {
-        if (!std::isdigit(value[i])) 
-        {
-            return false;
-        }
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR,
+            "Cannot assign to constant '" + SymbolName(name) + "'"
+        );
     }
-    
-    return true;
+    return target;
 }
 
-// Helper function to check if a string represents a float
-bool Interpreter::IsFloat(const std::string& value)
+Expected<int, t_ErrorInfo> Interpreter::CheckAssignedType
+(
+    const t_Value &old_value,
+    const t_Value &value,
+    t_Symbol name
+) const
 {
-    if (value.empty()) return false;
-    
-    int start = 0;
-    if (value[0] == '-' || value[0] == '+') 
-    {
-        if (value.length() == 1) return false;
-        start = 1;
-    }
-    
-    bool has_decimal = false;
-    for (size_t i = start; i < value.size(); i++) 
+    if
+    (
+        old_value.type != e_ValueType::NIL &&
+        old_value.type != value.type
+    )
     {
-        if (value[i] == '.') 
-        {
-            if (has_decimal) return false;
-            has_decimal = true;
-        } 
-        else if (!std::isdigit(value[i])) 
-        {
-            return false;
-        }
+        return t_ErrorInfo
+        (
+            e_ErrorType::TYPE_ERROR,
+            "Type mismatch: variable '"              +
+            SymbolName(name)                         +
+            "' is "                                  +
+            ValueTypeName(old_value.type)            +
+            ", cannot assign "                       +
+            ValueTypeName(value.type)
+        );
     }
-    
-    return has_decimal && 
-    (
-        static_cast<size_t>(value.length()) > static_cast<size_t>(start + 1)
-    );
+    return 0;
 }
 
-// Comparison operations are kept as they are more complex
-Expected<bool, t_ErrorInfo> Interpreter::PerformComparison
-(
-    const t_TypedValue& left, 
-    const e_TokenType op,
-    const t_TypedValue& right
-)
+namespace
 {
-    // If both values have precomputed numeric values, use them directly
-    if (left.has_numeric_value && right.has_numeric_value)
+    // Shared by the generic operators and the NUMBER form
+    Expected<t_Value, t_ErrorInfo> NumberArithmetic
+    (
+        double left_val,
+        const e_TokenType op,
+        double right_val,
+        int line
+    )
     {
         switch (op)
         {
-        case e_TokenType::GREATER:
-            return Expected<bool, t_ErrorInfo>
-            (
-                left.numeric_value > right.numeric_value
-            );
-        
-        case e_TokenType::GREATER_EQUAL:
-            return Expected<bool, t_ErrorInfo>
+        case e_TokenType::PLUS:
+            return Expected<t_Value, t_ErrorInfo>
             (
-                left.numeric_value >= right.numeric_value
+                t_Value(left_val + right_val)
             );
-        
-        case e_TokenType::LESS:
-            return Expected<bool, t_ErrorInfo>
+
+        case e_TokenType::MINUS:
+            return Expected<t_Value, t_ErrorInfo>
             (
-                left.numeric_value < right.numeric_value
+                t_Value(left_val - right_val)
             );
-        
-        case e_TokenType::LESS_EQUAL:
-            return Expected<bool, t_ErrorInfo>
+
+        case e_TokenType::STAR:
+            return Expected<t_Value, t_ErrorInfo>
             (
-                left.numeric_value <= right.numeric_value
+                t_Value(left_val * right_val)
             );
-        
-        case e_TokenType::EQUAL_EQUAL:
-            return Expected<bool, t_ErrorInfo>
+
+        case e_TokenType::SLASH:
+            if (right_val == 0)
+            {
+                return t_ErrorInfo
+                (
+                    e_ErrorType::RUNTIME_ERROR, 
+                    "Division by zero",
+                    line
+                );
+            }
+            return Expected<t_Value, t_ErrorInfo>
             (
-                left.numeric_value == right.numeric_value
+                t_Value(left_val / right_val)
             );
-        
-        case e_TokenType::BANG_EQUAL:
-            return Expected<bool, t_ErrorInfo>
+
+        case e_TokenType::MODULUS:
+            if (right_val == 0)
+            {
+                return t_ErrorInfo
+                (
+                    e_ErrorType::RUNTIME_ERROR, 
+                    "Modulus by zero",
+                    line
+                );
+            }
+            return Expected<t_Value, t_ErrorInfo>
             (
-                left.numeric_value != right.numeric_value
+                t_Value(std::fmod(left_val, right_val))
             );
-        
+
         default:
-            return Expected<bool, t_ErrorInfo>
+            return t_ErrorInfo
             (
-                false
+                e_ErrorType::RUNTIME_ERROR, 
+                "Unsupported binary operator",
+                line
             );
-
         }
     }
-    
-    // Fallback to string-based conversion
-    try
-    {
-        double left_num = left.has_numeric_value ? 
-        left.numeric_value : std::stod(left.value);
 
-        double right_num = right.has_numeric_value ? 
-        right.numeric_value : std::stod(right.value);
-        
+    bool NumberComparison
+    (
+        double left_num,
+        const e_TokenType op,
+        double right_num
+    )
+    {
         switch (op)
         {
         case e_TokenType::GREATER:
-            return Expected<bool, t_ErrorInfo>(left_num > right_num);
+            return left_num > right_num;
         case e_TokenType::GREATER_EQUAL:
-            return Expected<bool, t_ErrorInfo>(left_num >= right_num);
+            return left_num >= right_num;
         case e_TokenType::LESS:
-            return Expected<bool, t_ErrorInfo>(left_num < right_num);
+            return left_num < right_num;
         case e_TokenType::LESS_EQUAL:
-            return Expected<bool, t_ErrorInfo>(left_num <= right_num);
+            return left_num <= right_num;
         case e_TokenType::EQUAL_EQUAL:
-            return Expected<bool, t_ErrorInfo>(left_num == right_num);
+            return left_num == right_num;
         case e_TokenType::BANG_EQUAL:
-            return Expected<bool, t_ErrorInfo>(left_num != right_num);
+            return left_num != right_num;
         default:
-            return Expected<bool, t_ErrorInfo>(false);
+            return false;
         }
     }
-    catch (...)
+}
+
+// Arithmetic on two values: numbers, or arrays with anything numeric
+Expected<t_Value, t_ErrorInfo> Interpreter::PerformArithmetic
+(
+    const t_Value& left, 
+    const e_TokenType op,
+    const t_Value& right,
+    int line
+)
+{
+    if (!left.IsNumber() || !right.IsNumber())
     {
-        // For non-numeric comparisons, fallback to string comparison
-        switch (op)
+        if 
+        (
+            op == e_TokenType::PLUS && 
+            (left.IsString() || right.IsString())
+        )
         {
-        case e_TokenType::EQUAL_EQUAL:
-            return Expected<bool, t_ErrorInfo>(left.value == right.value);
-        case e_TokenType::BANG_EQUAL:
-            return Expected<bool, t_ErrorInfo>(left.value != right.value);
-        default:
             return t_ErrorInfo
             (
                 e_ErrorType::RUNTIME_ERROR, 
-                "Cannot compare non-numeric values"
+                "String concatenation with '+' is not allowed. Use comma-separated values in display statements instead.",
+                line
             );
         }
+        Expected<t_Value, t_ErrorInfo> result =
+        ArrayArithmetic(left, op, right, m_Arrays);
+        if (!result)
+        {
+            AddLine(result.Error(), line);
+        }
+        return result;
+    }
+    return NumberArithmetic(left.number, op, right.number, line);
+}
+
+Expected<bool, t_ErrorInfo> Interpreter::PerformComparison
+(
+    const t_Value& left, 
+    const e_TokenType op,
+    const t_Value& right,
+    int line
+)
+{
+    if (left.IsNumber() && right.IsNumber())
+    {
+        return Expected<bool, t_ErrorInfo>
+        (
+            NumberComparison(left.number, op, right.number)
+        );
+    }
+
+    // Values of other types can only be tested for equality
+    switch (op)
+    {
+    case e_TokenType::EQUAL_EQUAL:
+        return Expected<bool, t_ErrorInfo>(ValuesEqual(left, right));
+    case e_TokenType::BANG_EQUAL:
+        return Expected<bool, t_ErrorInfo>(!ValuesEqual(left, right));
+    default:
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR, 
+            "Cannot compare non-numeric values",
+            line
+        );
     }
 }
 
 Expected<int, t_ErrorInfo> Interpreter::Execute(t_Stmt *stmt)
 {
-    if (t_BlockStmt* block_stmt = As<t_BlockStmt>(stmt))
-    {
-        // Push a new scope for the block
-        PushScope();
-		try
-		{
-			for (const auto &statement : block_stmt->statements)
-			{
-				Expected<int, t_ErrorInfo> result = 
-                Execute(statement.get());
-				if (!result)
-				{
-					PopScope(); // Clean up scope before returning
-					return result.Error();
-				}
-
-                // If a control signal was raised inside this block (break/continue),
-                // stop executing further statements in this block and propagate upward.
-                if (!m_ControlSignal.empty())
-                {
-                    // Pop the scope to clean up variables declared in this block
-                    PopScope();
-                    return Expected<int, t_ErrorInfo>(0);
-                }
-                
-                // If we're returning from a function, stop executing further statements
-                // and propagate the return signal upward.
-                if (m_IsReturning)
-                {
-                    PopScope();
-                    return Expected<int, t_ErrorInfo>(0);
-                }
-			}
-
-			// Pop the block scope, which will automatically clean up variables declared in this scope
-			PopScope();
-		}
-		catch (...)
-		{
-			// Ensure scope is popped and convert to runtime error
-			PopScope();
-			return t_ErrorInfo
-			(
-				e_ErrorType::RUNTIME_ERROR,
-				"Unhandled exception in block"
-			);
-		}
-    }
-    else if (As<t_BreakStmt>(stmt))
+    if (m_Profiler)
+    {
+        return ExecuteProfiled(stmt);
+    }
+    return Dispatch(stmt);
+}
+
+Expected<int, t_ErrorInfo> Interpreter::ExecuteProfiled(t_Stmt *stmt)
+{
+    // Blocks and declarations take no time of their own worth showing
+    if
+    (
+        stmt->kind == e_StmtKind::BLOCK ||
+        stmt->kind == e_StmtKind::FUNCTION ||
+        stmt->kind == e_StmtKind::EMPTY
+    )
     {
+        return Dispatch(stmt);
+    }
+
+    m_Profiler->BeginStatement();
+    Expected<int, t_ErrorInfo> result = Dispatch(stmt);
+    m_Profiler->EndStatement(stmt);
+    return result;
+}
+
+Expected<int, t_ErrorInfo> Interpreter::Dispatch(t_Stmt *stmt)
+{
+    switch (stmt->kind)
+    {
+    case e_StmtKind::BLOCK:
+        return ExecuteBlock(static_cast<t_BlockStmt*>(stmt));
+
+    case e_StmtKind::BREAK:
         // Validate that we're inside a loop
         if (m_LoopDepth <= 0)
         {
@@ -486,9 +521,8 @@ Expected<int, t_ErrorInfo> Interpreter::Execute(t_Stmt *stmt)
         // Signal break without throwing
         m_ControlSignal = "break";
         return Expected<int, t_ErrorInfo>(0);
-    }
-    else if (As<t_ContinueStmt>(stmt))
-    {
+
+    case e_StmtKind::CONTINUE:
         // Validate that we're inside a loop
         if (m_LoopDepth <= 0)
         {
@@ -501,2876 +535,1722 @@ Expected<int, t_ErrorInfo> Interpreter::Execute(t_Stmt *stmt)
         // Signal continue without throwing
         m_ControlSignal = "continue";
         return Expected<int, t_ErrorInfo>(0);
-    }
-    else if (t_IfStmt *if_stmt = As<t_IfStmt>(stmt))
-    {
-        Expected<std::string, t_ErrorInfo> condition_result = Evaluate
-        (
-            if_stmt->condition.get()
-        );
-        if (!condition_result)
-        {
-            return condition_result.Error();
-        }
-        
-        if (IsTruthy(condition_result.Value()))
-        {
-            Expected<int, t_ErrorInfo> then_result = Execute
-            (
-                if_stmt->then_branch.get()
-            );
-            if (!then_result)
-            {
-                return then_result;
-            }
-            
-            // If we're returning from a function, propagate the return
-            if (m_IsReturning)
-            {
-                return Expected<int, t_ErrorInfo>(0);
-            }
-        }
-        else if (if_stmt->else_branch)
-        {
-            Expected<int, t_ErrorInfo> else_result = 
-            Execute(if_stmt->else_branch.get());
 
-            if (!else_result)
-            {
-                return else_result;
-            }
-            
-            // If we're returning from a function, propagate the return
-            if (m_IsReturning)
-            {
-                return Expected<int, t_ErrorInfo>(0);
-            }
-        }
-    }
-    else if (t_ForStmt *for_stmt = As<t_ForStmt>(stmt))
-    {
-        // Check for ultra-fast nested arithmetic loop pattern: nested loops with arithmetic
-        if (IsNestedArithmeticLoop(for_stmt))
-        {
-            Expected<int, t_ErrorInfo> result = 
-            ExecuteNestedArithmeticLoop(for_stmt);
+    case e_StmtKind::IF:
+        return ExecuteIf(static_cast<t_IfStmt*>(stmt));
 
-            if (!result)
-            {
-                return result;
-            }
-        }
-        // Check for ultra-fast accumulation loop pattern: for (auto i = 0; i < N; i++) { var += i; }
-        else if (IsSimpleAccumulationLoop(for_stmt))
-        {
-            Expected<int, t_ErrorInfo> result = 
-            ExecuteAccumulationLoop(for_stmt);
+    case e_StmtKind::FOR:
+        return ExecuteFor(static_cast<t_ForStmt*>(stmt));
 
-            if (!result)
-            {
-                return result;
-            }
-        }
-        // Check for specialized numeric loop pattern: for (auto i = 0; i < N; i++)
-        else if (IsSimpleNumericLoop(for_stmt))
-        {
-            Expected<int, t_ErrorInfo> result = 
-            ExecuteSimpleNumericLoop(for_stmt);
+    case e_StmtKind::VAR:
+        return ExecuteVar(static_cast<t_VarStmt*>(stmt));
 
-            if (!result)
-            {
-                return result;
-            }
-        }
-        else
-        {
-            // Store variables that existed before the loop
-            std::unordered_set<std::string_view> pre_loop_variables;
-            pre_loop_variables.reserve(m_Environment.size());
-            for (auto&& [key, _] : m_Environment) 
-            {
-                pre_loop_variables.insert(key);
-            }
+    case e_StmtKind::DISPLAY:
+        return ExecuteDisplay(static_cast<t_DisplayStmt*>(stmt));
 
-            // Push a new scope for the loop
-            PushScope();
-            m_LoopDepth++;
-            try
-            {
-                // Execute initializer (if any)
-                if (for_stmt->initializer)
-                {
-                    Expected<int, t_ErrorInfo> init_result = 
-                    Execute(for_stmt->initializer.get());
-
-                    if (!init_result)
-                    {
-                        PopScope(); // Clean up scope before returning
-                        m_LoopDepth--;
-                        return init_result;
-                    }
-                }
+    case e_StmtKind::GETIN:
+        return ExecuteGetin(static_cast<t_GetinStmt*>(stmt));
 
-                // Loop while condition is true (or forever if no condition)
-                while (true)
-                {
-                    // Check condition (if any)
-                    if (for_stmt->condition)
-                    {
-                        Expected<std::string, t_ErrorInfo> condition_result = 
-                        Evaluate(for_stmt->condition.get());
-                        if (!condition_result)
-                        {
-                            PopScope(); // Clean up scope before returning
-                            m_LoopDepth--;
-                            return condition_result.Error();
-                        }
-
-                        if (!IsTruthy(condition_result.Value()))
-                        {
-                            break; // Exit loop if condition is false
-                        }
-                    }
-                    else if (!for_stmt->condition && !for_stmt->increment)
-                    {
-                        // Special case: for (;;) should run forever unless broken
-                    }
-
-                    // Execute body
-                    {
-                        m_ControlSignal.clear();
-                        Expected<int, t_ErrorInfo> body_result = 
-                        Execute(for_stmt->body.get());
-
-                        if (!body_result)
-                        {
-                            PopScope(); // Clean up scope before returning
-                            m_LoopDepth--;
-                            return body_result;
-                        }
-                        if (m_ControlSignal == "break")
-                        {
-                            m_ControlSignal.clear();
-                            break;
-                        }
-                        if (m_ControlSignal == "continue")
-                        {
-                            // Skip increment and start next iteration
-                            m_ControlSignal.clear();
-                            continue; // Continue to the next loop iteration without incrementing
-                        }
-                        
-                        // If we're returning from a function, stop the loop and propagate the return
-                        if (m_IsReturning)
-                        {
-                            PopScope();
-                            m_LoopDepth--;
-                            return Expected<int, t_ErrorInfo>(0);
-                        }
-                    }
-
-                    // Execute increment (if any)
-                    if (for_stmt->increment && m_ControlSignal.empty())
-                    {
-                        Expected<std::string, t_ErrorInfo> increment_result= 
-                        Evaluate(for_stmt->increment.get());
-
-                        if (!increment_result)
-                        {
-                            PopScope(); // Clean up scope before returning
-                            m_LoopDepth--;
-                            return increment_result.Error();
-                        }
-                    }
-                }
+    case e_StmtKind::BENCHMARK:
+        return ExecuteBenchmark(static_cast<t_BenchmarkStmt*>(stmt));
 
-                // Before popping scope, preserve modifications to pre-existing variables
-                std::unordered_map<std::string, t_TypedValue> modified_pre_existing;
-                modified_pre_existing.reserve(m_Environment.size());
-                for (auto&& [key, value] : m_Environment)
-                {
-                    if (pre_loop_variables.contains(key))
-                    {
-                        modified_pre_existing.try_emplace(key, value);
-                    }
-                }
+    case e_StmtKind::EMPTY:
+    case e_StmtKind::FUNCTION:
+        // Functions were registered before the script started
+        return Expected<int, t_ErrorInfo>(0);
 
-                // Pop the loop scope
-                PopScope();
-                
-                // Restore the modified values of pre-existing variables
-                for (auto&& [key, value] : modified_pre_existing)
-                {
-                    m_Environment.try_emplace(key, value);
-                }
-                
-                m_LoopDepth--;
-            }
-			catch (...)
-			{
-				// Ensure scope is cleaned and convert to runtime error
-				PopScope();
-				m_LoopDepth--;
-				return t_ErrorInfo
-				(
-					e_ErrorType::RUNTIME_ERROR,
-					"Unhandled exception in for-loop"
-				);
-			}
-        }
-    }
-    else if 
-    (
-        t_VarStmt *var_stmt = As<t_VarStmt>(stmt)
-    )
-    {
-        // Check if variable is already declared in current scope
-        Expected<int, t_ErrorInfo> declare_result =
-        DeclareVariable(var_stmt->name, 0); 
+    case e_StmtKind::EXPRESSION:
+        return ExecuteExpression(static_cast<t_ExpressionStmt*>(stmt));
 
-        if (!declare_result)
+    case e_StmtKind::RETURN:
+        return ExecuteReturn(static_cast<t_ReturnStmt*>(stmt));
+    }
+
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> Interpreter::ExecuteBlock(t_BlockStmt *block_stmt)
+{
+    // Locals of the block already own their slots in the frame,
+    // so entering and leaving a block costs nothing.
+    for (const auto &statement : block_stmt->statements)
+    {
+        Expected<int, t_ErrorInfo> result = 
+        Execute(statement.get());
+        if (!result)
         {
-            return declare_result.Error();
+            AddLine(result.Error(), statement->line);
+            return result;
         }
 
-        t_TypedValue typed_value;
-        if (var_stmt->initializer)
+        // If a control signal was raised inside this block (break/continue),
+        // stop executing further statements in this block and propagate upward.
+        if (!m_ControlSignal.empty())
         {
-            Expected<std::string, t_ErrorInfo> value_result = 
-            Evaluate(var_stmt->initializer.get());
-
-            if (!value_result)
-            {
-                return value_result.Error();
-            }
-            
-            std::string value = value_result.Value();
-            e_ValueType type = DetectType(value);
-            typed_value = t_TypedValue(value, type);
+            return Expected<int, t_ErrorInfo>(0);
         }
         
-        // Add to constants set if this is a constant declaration
-        if (var_stmt->is_const)
+        // If we're returning from a function, stop executing further statements
+        // and propagate the return signal upward.
+        if (m_IsReturning)
         {
-            m_Constants.insert(var_stmt->name);
+            return Expected<int, t_ErrorInfo>(0);
         }
-        
-        m_Environment[var_stmt->name] = typed_value;
     }
-    else if (t_DisplayStmt *display_stmt = As<t_DisplayStmt>(stmt))
-    {
-        bool first = true;
-        for (const auto &EXPR : display_stmt->expressions)
-        {
-            if (!first)
-            {
-                WriteOutput(" ");
-            }
-            first = false;
 
-            Expected<std::string, t_ErrorInfo> value_result = 
-            Evaluate(EXPR.get());
+    return Expected<int, t_ErrorInfo>(0);
+}
 
-            if (!value_result)
-            {
-                return value_result.Error();
-            }
-            
-            std::string value = value_result.Value();
-            WriteOutput(value);
+Expected<int, t_ErrorInfo> Interpreter::ExecuteIf(t_IfStmt *if_stmt)
+{
+    Expected<t_Value, t_ErrorInfo> condition_result = Evaluate
+    (
+        if_stmt->condition.get()
+    );
+    if (!condition_result)
+    {
+        return condition_result.Error();
+    }
+    
+    if (IsTruthy(condition_result.Value()))
+    {
+        Expected<int, t_ErrorInfo> then_result = Execute
+        (
+            if_stmt->then_branch.get()
+        );
+        if (!then_result)
+        {
+            return then_result;
+        }
+        
+        // If we're returning from a function, propagate the return
+        if (m_IsReturning)
+        {
+            return Expected<int, t_ErrorInfo>(0);
         }
-        WriteOutput("\n");
     }
-    else if (t_GetinStmt *getin_stmt = As<t_GetinStmt>(stmt))
+    else if (if_stmt->else_branch)
     {
-        const std::string &var_name = getin_stmt->variable_name;
+        Expected<int, t_ErrorInfo> else_result = 
+        Execute(if_stmt->else_branch.get());
 
-        auto it = m_Environment.find(var_name);
-        if (it == m_Environment.end())
+        if (!else_result)
         {
-            return t_ErrorInfo
-            (
-                e_ErrorType::RUNTIME_ERROR,
-                "Variable '" + var_name +
-                "' must be declared with 'auto' keyword before use"
-            );
+            return else_result;
         }
-
-        if(m_Constants.count(var_name))
+        
+        // If we're returning from a function, propagate the return
+        if (m_IsReturning)
         {
-            return t_ErrorInfo
-            (
-                e_ErrorType::RUNTIME_ERROR,
-                "Cannot modify constant '" + var_name + "' with getin"
-            );
+            return Expected<int, t_ErrorInfo>(0);
         }
+    }
 
-        t_TypedValue &current_value = it->second;
-        std::string input_line;
+    return Expected<int, t_ErrorInfo>(0);
+}
 
-        // Read the entire line for all types first
-        if (!std::getline(std::cin, input_line))
-        {
-            // If getline fails, clear the error state
-            std::cin.clear();
-            return t_ErrorInfo
-            (
-                e_ErrorType::RUNTIME_ERROR,
-                "Failed to read input for variable '" + var_name + "'"
-            );
-        }
+Expected<int, t_ErrorInfo> Interpreter::ExecuteFor(t_ForStmt *for_stmt)
+{
+    // Loops that only do arithmetic run as a register kernel, split
+    // across threads for a `parallel for`
+    Expected<bool, t_ErrorInfo> kernel_result = 
+    for_stmt->parallel
+        ? ExecuteParallelLoop(for_stmt)
+        : Expected<bool, t_ErrorInfo>(false);
+    if (kernel_result && !kernel_result.Value())
+    {
+        kernel_result = ExecuteLoopKernel(for_stmt);
+    }
+
+    if (!kernel_result)
+    {
+        return kernel_result.Error();
+    }
+    if (!kernel_result.Value())
+    {
+        m_LoopDepth++;
 
-        // Trim trailing carriage return if present (for cross-platform compatibility)
-        if (!input_line.empty() && input_line.back() == '\r')
+        // Execute initializer (if any)
+        if (for_stmt->initializer)
         {
-            input_line.pop_back();
+            Expected<int, t_ErrorInfo> init_result = 
+            Execute(for_stmt->initializer.get());
+
+            if (!init_result)
+            {
+                m_LoopDepth--;
+                return init_result;
+            }
         }
 
-        switch (current_value.type)
+        // Loop while condition is true (or forever if no condition)
+        while (true)
         {
-        case e_ValueType::NUMBER:
+            CollectAtLoop();
+            // Check condition (if any)
+            if (for_stmt->condition)
             {
-                try
+                Expected<t_Value, t_ErrorInfo> condition_result = 
+                Evaluate(for_stmt->condition.get());
+                if (!condition_result)
                 {
-                    double number_value = std::stod(input_line);
-                    AssignToVisibleVariable
-                    (
-                        var_name,
-                        t_TypedValue(number_value),
-                        m_Environment,
-                        m_ScopeStack
-                    );
+                    m_LoopDepth--;
+                    return condition_result.Error();
                 }
-                catch (...)
+
+                if (!IsTruthy(condition_result.Value()))
                 {
-                    return t_ErrorInfo
-                    (
-                        e_ErrorType::RUNTIME_ERROR,
-                        "Invalid type for variable " +
-                        var_name
-                    );
+                    break; // Exit loop if condition is false
                 }
-                break;
             }
 
-        case e_ValueType::BOOLEAN:
-            {
-                // Convert string to lowercase for case-insensitive comparison
-                std::string lower_input = input_line;
-                std::transform
-                (
-                    lower_input.begin(), 
-                    lower_input.end(), 
-                    lower_input.begin(), 
-                    ::tolower
-                );
-
-                // Try parsing as boolean
-                bool bool_value = false;
-                if (lower_input == "true" || lower_input == "1")
-                {
-                    bool_value = true;
-                }
-                else if (lower_input == "false" || lower_input == "0")
-                {
-                    bool_value = false;
-                }
-                else
-                {
-                    // Try to parse as number
-                    try
-                    {
-                        double num = std::stod(input_line);
-                        bool_value = (num != 0.0);
-                    }
-                    catch (...)
-                    {
-                        return t_ErrorInfo
-                        (
-                            e_ErrorType::RUNTIME_ERROR,
-                            "Failed to convert input to boolean for variable '" +
-                            var_name    + 
-                            "'. Valid values: true, false, 1, 0"
-                        );
-                    }
-                }
+            // Execute body
+            m_ControlSignal.clear();
+            Expected<int, t_ErrorInfo> body_result = 
+            Execute(for_stmt->body.get());
 
-                std::string stored_value = bool_value ? "true" : "false";
-                AssignToVisibleVariable
-                (
-                    var_name,
-                    t_TypedValue(stored_value, e_ValueType::BOOLEAN),
-                    m_Environment,
-                    m_ScopeStack
-                );
-                break;
+            if (!body_result)
+            {
+                m_LoopDepth--;
+                return body_result;
             }
-
-        case e_ValueType::STRING:
+            if (m_ControlSignal == "break")
             {
-                // For strings, we already have the input line
-                AssignToVisibleVariable
-                (
-                    var_name,
-                    t_TypedValue(input_line, e_ValueType::STRING),
-                    m_Environment,
-                    m_ScopeStack
-                );
+                m_ControlSignal.clear();
                 break;
             }
+            // `continue` falls through to the increment
+            m_ControlSignal.clear();
+            
+            // If we're returning from a function, stop the loop and propagate the return
+            if (m_IsReturning)
+            {
+                m_LoopDepth--;
+                return Expected<int, t_ErrorInfo>(0);
+            }
 
-        case e_ValueType::NIL:
-        default:
+            // Execute increment (if any)
+            if (for_stmt->increment)
             {
-                // For untyped variables, infer type from input
-                e_ValueType inferred_type = DetectType(input_line);
-                AssignToVisibleVariable
-                (
-                    var_name,
-                    t_TypedValue(input_line, inferred_type),
-                    m_Environment,
-                    m_ScopeStack
-                );
-                break;
+                Expected<t_Value, t_ErrorInfo> increment_result = 
+                Evaluate(for_stmt->increment.get());
+
+                if (!increment_result)
+                {
+                    m_LoopDepth--;
+                    return increment_result.Error();
+                }
             }
         }
-    }
-    else if 
-    (
-        t_BenchmarkStmt *benchmark_stmt = As<t_BenchmarkStmt>(stmt)
-    )
-    {
-        bool previous_buffering = m_BufferOutput;
-        m_BufferOutput = true;
 
-        if (!previous_buffering)
-        {
-            m_OutputBuffer.clear();
-            m_OutputBuffer.reserve(1024 * 1024);
-        }
+        m_LoopDepth--;
+    }
 
-        // Record start time
-        auto start_time = std::chrono::steady_clock::now();
-        
-        // Execute the benchmark body
-        Expected<int, t_ErrorInfo> body_result = 
-        Execute(benchmark_stmt->body.get());
+    return Expected<int, t_ErrorInfo>(0);
+}
 
-        FlushOutput();
-        m_BufferOutput = previous_buffering;
-        
-        if (!body_result)
-        {
-            return body_result;
-        }
-        
-        // Record end time
-        auto end_time = std::chrono::steady_clock::now();
-        
-        // Calculate duration
-        auto duration = 
-        std::chrono::duration_cast<std::chrono::nanoseconds>
+Expected<int, t_ErrorInfo> Interpreter::ExecuteVar(t_VarStmt *var_stmt)
+{
+    // Redeclarations in the same scope are found by the Resolver
+    // but only reported once execution reaches them
+    if (var_stmt->is_redeclaration)
+    {
+        return t_ErrorInfo
         (
-            end_time - start_time
+            e_ErrorType::RUNTIME_ERROR, 
+            "Variable '" 
+            + SymbolName(var_stmt->name) + 
+            "' has already been declared in this scope"
         );
-        
-        // Display benchmark results
-        std::cout << "Benchmark Results:\n";
-
-        std::cout << "  Execution time: " 
-                  << duration.count() 
-                  << " nanoseconds\n";
-                  
-        std::cout << "  Execution time: " 
-                  << duration.count() / 1000.0 
-                  << " microseconds\n";
+    }
 
-        std::cout << "  Execution time: " 
-                  << duration.count() / 1000000.0 
-                  << " milliseconds\n";
+    t_Value typed_value;
+    if (var_stmt->initializer)
+    {
+        Expected<t_Value, t_ErrorInfo> value_result = 
+        Evaluate(var_stmt->initializer.get());
 
-        std::cout << "  Execution time: " 
-                  << duration.count() / 1000000000.0 
-                  << " seconds\n";
+        if (!value_result)
+        {
+            return value_result.Error();
+        }
+        
+        typed_value = value_result.Value();
     }
-    else if (As<t_EmptyStmt>(stmt))
+    
+    if (var_stmt->binding.kind == e_BindingKind::GLOBAL)
     {
-        // Do nothing for empty statements
+        m_Globals[var_stmt->binding.slot] = typed_value;
+        m_GlobalDefined[var_stmt->binding.slot] = 1;
     }
-    else if 
-    (
-        t_FunStmt *fun_stmt =
-        As<t_FunStmt>(stmt)
-    )
+    else
     {
-        // Native m_Functions are implemented in C++.
-        // The fun declaration is currently a no-op placeholder.
-        (void)fun_stmt;
+        m_Frame[var_stmt->binding.slot] = typed_value;
     }
-    else if 
-    (
-        t_ExpressionStmt *expr_stmt = 
-        As<t_ExpressionStmt>(stmt)
-    )
-    {
-        Expected<std::string, t_ErrorInfo> result =
-        Evaluate(expr_stmt->expression.get());
 
-        if (!result)
-        {
-            return result.Error();
-        }
-    }
-    else if 
-    (
-        t_ReturnStmt *return_stmt = 
-        As<t_ReturnStmt>(stmt)
-    )
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> Interpreter::ExecuteDisplay
+(
+    t_DisplayStmt *display_stmt
+)
+{
+    bool first = true;
+    for (const auto &EXPR : display_stmt->expressions)
     {
-        // Evaluate the return value expression (if any)
-        if (return_stmt->value)
+        if (!first)
         {
-            Expected<std::string, t_ErrorInfo> result =
-            Evaluate(return_stmt->value.get());
+            m_Output.Write(" ");
+        }
+        first = false;
 
-            if (!result)
+        // Format strings are written piece by piece instead of
+        // being assembled into a string first
+        if 
+        (
+            t_FormatStringExpr *format = 
+            As<t_FormatStringExpr>(EXPR.get())
+        )
+        {
+            for (const t_FormatSegment &segment : format->segments)
             {
-                return result.Error();
+                if (!segment.expression)
+                {
+                    m_Output.Write(segment.text);
+                    continue;
+                }
+
+                Expected<t_Value, t_ErrorInfo> segment_result =
+                Evaluate(segment.expression.get());
+                if (!segment_result)
+                {
+                    return segment_result.Error();
+                }
+
+                AppendValue(m_Output.Text(), segment_result.Value());
+                m_Output.Commit();
             }
-            
-            m_ReturnValue = result.Value();
+            continue;
         }
-        else
+
+        Expected<t_Value, t_ErrorInfo> value_result = 
+        Evaluate(EXPR.get());
+
+        if (!value_result)
         {
-            // No return value specified, return nil
-            m_ReturnValue = "nil";
+            return value_result.Error();
         }
         
-        // Set the returning flag to indicate we should stop execution
-        m_IsReturning = true;
-        return Expected<int, t_ErrorInfo>(0);
+        AppendValue(m_Output.Text(), value_result.Value());
+        m_Output.Commit();
     }
-    
-    return Expected<int, t_ErrorInfo>(0); // Success represented by 0
-}
+    m_Output.Write("\n");
 
-bool Interpreter::IsTruthy(const std::string &value)
-{
-    return value != "false" && value != "nil";
+    return Expected<int, t_ErrorInfo>(0);
 }
 
-Expected<std::string, t_ErrorInfo> Interpreter::Evaluate(t_Expr *expr)
+Expected<int, t_ErrorInfo> Interpreter::ExecuteGetin(t_GetinStmt *getin_stmt)
 {
-    if (t_LiteralExpr *literal = As<t_LiteralExpr>(expr))
+    // Every target is checked before anything is read
+    for (const t_GetinTarget &target : getin_stmt->targets)
     {
-        // Check if this is a format string based on token type
-        if (literal->token_type == e_TokenType::FORMAT_STRING)
+        if (!FindVariable(target.binding))
         {
-            // Process format string
-            std::string format_str = literal->value;
-            std::string result = format_str;
-
-            // Improved string replacement approach with better error handling
-            size_t pos = 0;
-            while ((pos = result.find('{')) != std::string::npos)
-            {
-                size_t end_pos = result.find('}', pos);
-                if (end_pos != std::string::npos)
-                {
-                    std::string expression = 
-                    result.substr(pos + 1, end_pos - pos - 1);
-
-                    // Trim whitespace from expression
-                    expression.erase(0, expression.find_first_not_of(" \t"));
-                    expression.erase(expression.find_last_not_of(" \t") + 1);
-
-                    // Evaluate the expression instead of just looking it up as a variable
-                    Expected<std::string, t_ErrorInfo> expr_result = 
-                    EvaluateFormatExpression(expression);
-                    if (!expr_result)
-                    {
-                        return expr_result.Error();
-                    }
-
-                    result.replace
-                    (
-                        pos, end_pos - pos + 1, expr_result.Value()
-                    );
-                }
-                else
-                {
-                    // No closing brace found, treat as literal
-                    break;
-                }
-            }
-
-            return Expected<std::string, t_ErrorInfo>(result);
+            return UndeclaredError(target.name);
         }
 
-        return Expected<std::string, t_ErrorInfo>(literal->value);
+        if (target.binding.is_const)
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Cannot modify constant '" + SymbolName(target.name) +
+                "' with getin"
+            );
+        }
     }
 
-    if (t_GroupingExpr *grouping = As<t_GroupingExpr>(expr))
+    // Anything displayed so far must be visible before blocking
+    m_Output.Flush();
+
+    std::string_view input_line;
+    if (!m_Input->ReadLine(input_line))
     {
-        return Evaluate(grouping->expression.get());
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR,
+            ReadFailureMessage
+            (
+                *m_Input,
+                SymbolName(getin_stmt->targets[0].name)
+            )
+        );
     }
 
-    if (t_CallExpr *call_expr = As<t_CallExpr>(expr))
+    SplitInputFields
+    (
+        input_line,
+        getin_stmt->targets.size(),
+        m_InputFields
+    );
+    for (size_t i = 0; i < getin_stmt->targets.size(); ++i)
     {
-        // User-defined m_Functions
-        if 
+        const t_GetinTarget &target = getin_stmt->targets[i];
+        const std::string &var_name = SymbolName(target.name);
+        if (i >= m_InputFields.size())
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Missing input for variable '" + var_name + "'"
+            );
+        }
+
+        // The current type of the variable decides the conversion
+        t_Value *variable = FindVariable(target.binding);
+        Expected<t_Value, t_ErrorInfo> input_result = ConvertInput
         (
-            auto fun_it = m_Functions.find(call_expr->callee);
-            fun_it != m_Functions.end()
-        )
+            m_InputFields[i],
+            *variable,
+            var_name,
+            m_Strings
+        );
+        if (!input_result)
         {
-            t_FunStmt *fun_stmt = fun_it->second;
-            if (call_expr->arguments.size() != fun_stmt->parameters.size())
-            {
-                return t_ErrorInfo
-                (
-                    e_ErrorType::RUNTIME_ERROR,
-                    "Function '" + fun_stmt->name +
-                    "' called with wrong number of arguments"
-                );
-            }
+            return input_result.Error();
+        }
+        *variable = input_result.Value();
+    }
 
-            std::vector<t_TypedValue> argument_values;
-            argument_values.reserve(call_expr->arguments.size());
+    return Expected<int, t_ErrorInfo>(0);
+}
 
-            for (size_t i = 0; i < call_expr->arguments.size(); ++i)
-            {
-                Expected<std::string, t_ErrorInfo> arg_result =
-                Evaluate(call_expr->arguments[i].get());
-                if (!arg_result)
-                {
-                    return arg_result;
-                }
+Expected<int, t_ErrorInfo> Interpreter::ExecuteBenchmark
+(
+    t_BenchmarkStmt *benchmark_stmt,
+    const t_StmtClosure *body
+)
+{
+    bool was_held = m_Output.IsHeld();
+    m_Output.SetHeld(true);
 
-                std::string arg_value = arg_result.Value();
-                e_ValueType arg_type = DetectType(arg_value);
-                argument_values.emplace_back(arg_value, arg_type);
-            }
+    std::vector<int64_t> samples;
+    samples.reserve(benchmark_stmt->iterations);
 
-            // Preserve modifications to pre-existing variables as in for-loops
-            std::unordered_set<std::string_view> pre_call_variables; 
-            pre_call_variables.reserve(m_Environment.size());
-            for (auto&& [key, _]: m_Environment)
-            {
-                pre_call_variables.insert(key);
-            }
+    uint32_t runs = benchmark_stmt->warmup + benchmark_stmt->iterations;
+    for (uint32_t run = 0; run < runs; ++run)
+    {
+        CollectAtLoop();
+        std::chrono::steady_clock::time_point start_time =
+        std::chrono::steady_clock::now();
 
-            PushScope();
-            try
-            {
-                // Bind parameters in the new scope
-                for (size_t i = 0; i < fun_stmt->parameters.size(); ++i)
-                {
-                    const std::string& param_name = fun_stmt->parameters[i];
-                    m_Environment[param_name] = argument_values[i];
-                }
+        Expected<int, t_ErrorInfo> body_result = body
+            ? ClosureCompiler::Run(*this, *body)
+            : Execute(benchmark_stmt->body.get());
 
-                std::string return_value = "nil";
-                if (fun_stmt->body)
-                {
-                    m_IsReturning = false;
-                
-                    Expected<int, t_ErrorInfo> body_result =
-                        Execute(fun_stmt->body.get());
-                
-                    if (!body_result)
-                    {
-                        PopScope();
-                        return body_result.Error();
-                    }
-                
-                    if (m_IsReturning)
-                    {
-                        return_value = m_ReturnValue;
-                        m_IsReturning = false;
-                    }
-                }
-            
-                // Preserve modifications to variables that existed before the call
-                std::unordered_map<std::string, t_TypedValue> modified_pre_existing;
-                modified_pre_existing.reserve(pre_call_variables.size());
-            
-                for (auto&& [key, value] : m_Environment)
-                {
-                    if (pre_call_variables.contains(key))
-                    {
-                        modified_pre_existing.emplace(key, value);
-                    }
-                }
-            
-                // Exit function scope
-                PopScope();
-            
-                // Restore preserved variables
-                for (auto&& [key, value] : modified_pre_existing)
-                {
-                    m_Environment.find(key)->second = value;
-                }
-            
-                return Expected<std::string, t_ErrorInfo>(return_value);
-            }
+        std::chrono::steady_clock::time_point end_time =
+        std::chrono::steady_clock::now();
 
-            catch (...)
-            {
-                PopScope();
-                return t_ErrorInfo
+        // Printing what the body displayed is not part of the timing
+        m_Output.Flush();
+
+        if (!body_result)
+        {
+            m_Output.SetHeld(was_held);
+            return body_result;
+        }
+
+        // A run cut short by break, continue or return is measured
+        // like any other and ends the benchmark
+        bool is_leaving = m_IsReturning || !m_ControlSignal.empty();
+        if (run >= benchmark_stmt->warmup || is_leaving)
+        {
+            samples.push_back
+            (
+                std::chrono::duration_cast<std::chrono::nanoseconds>
                 (
-                    e_ErrorType::RUNTIME_ERROR,
-                    "Unhandled exception in function '" +
-                    fun_stmt->name + "'"
-                );
-            }
+                    end_time - start_time
+                ).count()
+            );
+        }
+        if (is_leaving)
+        {
+            break;
         }
+    }
 
-        return t_ErrorInfo
+    m_Output.SetHeld(was_held);
+    m_Benchmarks.Report
+    (
+        ComputeBenchmarkStats
         (
-            e_ErrorType::RUNTIME_ERROR,
-            "Undefined function '" + call_expr->callee + "'",
-            call_expr->line
+            samples,
+            benchmark_stmt->line,
+            benchmark_stmt->warmup
+        ),
+        m_Output.Stream()
+    );
+
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> Interpreter::ExecuteExpression
+(
+    t_ExpressionStmt *expr_stmt
+)
+{
+    Expected<t_Value, t_ErrorInfo> result =
+    Evaluate(expr_stmt->expression.get());
+
+    if (!result)
+    {
+        return result.Error();
+    }
+
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> Interpreter::ExecuteReturn
+(
+    t_ReturnStmt *return_stmt
+)
+{
+    if (return_stmt->is_tail_call)
+    {
+        return ExecuteTailCall
+        (
+            static_cast<t_CallExpr*>(return_stmt->value.get())
         );
     }
 
-    if (t_UnaryExpr *unary = As<t_UnaryExpr>(expr))
+    // Evaluate the return value expression (if any)
+    if (return_stmt->value)
     {
-        Expected<std::string, t_ErrorInfo> right_result = 
-        Evaluate(unary->right.get());
-        if (!right_result)
+        Expected<t_Value, t_ErrorInfo> result =
+        Evaluate(return_stmt->value.get());
+
+        if (!result)
         {
-            return right_result;
+            return result.Error();
         }
         
-        std::string right = right_result.Value();
-        switch (unary->op.type)
-        {
-        case e_TokenType::MINUS:
-            // Optimize unary minus for numeric literals
-            if 
-            (
-                t_LiteralExpr* right_literal = 
-                As<t_LiteralExpr>(unary->right.get())
-            )
-            {
-                e_ValueType type = DetectType(right_literal->value);
-                if (type == e_ValueType::NUMBER)
-                {
-                    try
-                    {
-                        double value = std::stod(right_literal->value);
-                        return Expected<std::string, t_ErrorInfo>
-                        (
-                            FormatNumber(-value)
-                        );
-                    }
-                    catch (...) {}
-                }
-            }
-            return Expected<std::string, t_ErrorInfo>("-" + right);
-
-        case e_TokenType::BANG:
-            return Expected<std::string, t_ErrorInfo>
-            (
-                (right == "false" || right == "0") ? "true" : "false"
-            );
-
-        default:
-            return t_ErrorInfo
-            (
-                e_ErrorType::RUNTIME_ERROR,
-                "Unsupported unary operator"
-            );
-        }
+        m_Frames.back().return_value = result.Value();
     }
+    else
+    {
+        // No return value specified, return nil
+        m_Frames.back().return_value = t_Value();
+    }
+    
+    // Set the returning flag to indicate we should stop execution
+    m_IsReturning = true;
+    return Expected<int, t_ErrorInfo>(0);
+}
 
-    if (t_PrefixExpr *prefix = As<t_PrefixExpr>(expr))
+Expected<t_Value, t_ErrorInfo> Interpreter::Evaluate(t_Expr *expr)
+{
+    switch (expr->kind)
     {
-        if
-        (
-            t_VariableExpr *var_expr = 
-            As<t_VariableExpr>(prefix->operand.get())
-        )
-        {
-            std::string var_name = var_expr->name;
-            auto it = m_Environment.find(var_name);
-            
-            if (it == m_Environment.end())
-            {
-                return t_ErrorInfo
-                (
-                    e_ErrorType::RUNTIME_ERROR, 
-                    "Undefined variable '" + var_name + "'"
-                );
-            }
-            
-            if (m_Constants.count(var_name))
-            {
-                return t_ErrorInfo
-                (
-                    e_ErrorType::RUNTIME_ERROR,
-                    "Cannot modify constant '" + var_name + "'"
-                );
-            }
-            
-            t_TypedValue& current_value = it->second;
-            // Use direct numeric operations when possible
-            if (current_value.has_numeric_value)
-            {
-                if (prefix->op.type == e_TokenType::PLUS_PLUS)
-                {
-                    double new_value = current_value.numeric_value + 1.0;
-                    m_Environment[var_name] = t_TypedValue(new_value);
-                    return Expected<std::string, t_ErrorInfo>
-                    (
-                        std::to_string(new_value)
-                    );
-                }
-                else if (prefix->op.type == e_TokenType::MINUS_MINUS)
-                {
-                    double new_value = current_value.numeric_value - 1.0;
-                    m_Environment[var_name] = t_TypedValue(new_value);
-                    return Expected<std::string, t_ErrorInfo>
-                    (
-                        std::to_string(new_value)
-                    );
-                }
-            }
-            else
-            {
-                // Fallback to string-based operations
-                try
-                {
-                    double num_value = std::stod(current_value.value);
-                    
-                    if (prefix->op.type == e_TokenType::PLUS_PLUS)
-                    {
-                        num_value += 1.0;
-                        std::string new_value = std::to_string(num_value);
-                        // Remove trailing zeros and decimal point if not needed
-                        new_value.erase
-                        (
-                            new_value.find_last_not_of('0') + 1, std::string::npos
-                        );
-                        new_value.erase
-                        (
-                            new_value.find_last_not_of('.') + 1, std::string::npos
-                        );
-                        m_Environment[var_name] =
-                        t_TypedValue
-                        (
-                            new_value, e_ValueType::NUMBER
-                        );
-                        return Expected<std::string, t_ErrorInfo>(new_value);
-                    }
-                    else if (prefix->op.type == e_TokenType::MINUS_MINUS)
-                    {
-                        num_value -= 1.0;
-                        std::string new_value = std::to_string(num_value);
-
-                        // Remove trailing zeros and decimal point if not needed
-                        new_value.erase
-                        (
-                            new_value.find_last_not_of('0') + 1,
-                            std::string::npos
-                        );
-                        new_value.erase
-                        (
-                            new_value.find_last_not_of('.') + 1,
-                            std::string::npos
-                        );
-                        m_Environment[var_name] = 
-                        t_TypedValue
-                        (
-                            new_value, e_ValueType::NUMBER
-                        );
-                        return Expected<std::string, t_ErrorInfo>(new_value);
-                    }
-                }
-                catch (...)
-                {
-                    return t_ErrorInfo
-                    (
-                        e_ErrorType::RUNTIME_ERROR, 
-                        "Cannot perform increment/decrement on non-numeric value"
-                    );
-                }
-            }
-        }
-        return t_ErrorInfo
+    case e_ExprKind::LITERAL:
+        return EvaluateLiteral(static_cast<t_LiteralExpr*>(expr));
+
+    case e_ExprKind::FORMAT_STRING:
+        return EvaluateFormatString(static_cast<t_FormatStringExpr*>(expr));
+
+    case e_ExprKind::GROUPING:
+        return Evaluate
         (
-            e_ErrorType::RUNTIME_ERROR, 
-            "Prefix increment/decrement can only be applied to variables"
+            static_cast<t_GroupingExpr*>(expr)->expression.get()
         );
+
+    case e_ExprKind::CALL:
+        return EvaluateCall(static_cast<t_CallExpr*>(expr));
+
+    case e_ExprKind::UNARY:
+        return EvaluateUnary(static_cast<t_UnaryExpr*>(expr));
+
+    case e_ExprKind::PREFIX:
+        return EvaluatePrefix(static_cast<t_PrefixExpr*>(expr));
+
+    case e_ExprKind::POSTFIX:
+        return EvaluatePostfix(static_cast<t_PostfixExpr*>(expr));
+
+    case e_ExprKind::BINARY:
+        return EvaluateBinary(static_cast<t_BinaryExpr*>(expr));
+
+    case e_ExprKind::VARIABLE:
+        return EvaluateVariable(static_cast<t_VariableExpr*>(expr));
+
+    case e_ExprKind::ARRAY:
+        return EvaluateArray(static_cast<t_ArrayExpr*>(expr));
+
+    case e_ExprKind::INDEX:
+        return EvaluateIndex(static_cast<t_IndexExpr*>(expr));
+
+    case e_ExprKind::INDEX_ASSIGN:
+        return EvaluateIndexAssign(static_cast<t_IndexAssignExpr*>(expr));
+
+    case e_ExprKind::SIZEOF:
+        return EvaluateSizeof(static_cast<t_SizeofExpr*>(expr));
+
+    case e_ExprKind::TYPEOF:
+        // Not produced by the parser yet
+        break;
     }
 
-    if (t_PostfixExpr *postfix = As<t_PostfixExpr>(expr))
+    return Expected<t_Value, t_ErrorInfo>(t_Value());
+}
+
+Expected<t_Value, t_ErrorInfo> Interpreter::EvaluateLiteral
+(
+    t_LiteralExpr *literal
+)
+{
+    switch (literal->token_type)
     {
-        if 
-        (
-            t_VariableExpr *var_expr = 
-            As<t_VariableExpr>(postfix->operand.get())
-        )
+    case e_TokenType::NUMBER:
         {
-            std::string var_name = var_expr->name;
-            auto it = m_Environment.find(var_name);
-            if (it == m_Environment.end())
-            {
-                return t_ErrorInfo
-                (
-                    e_ErrorType::RUNTIME_ERROR, 
-                    "Undefined variable '" + var_name + "'"
-                );
-            }
-
-            if (m_Constants.count(var_name))
+            if (!literal->is_number)
             {
                 return t_ErrorInfo
                 (
                     e_ErrorType::RUNTIME_ERROR,
-                    "Cannot modify constant '" + var_name + "'"
+                    "Invalid number literal '" + std::string(literal->value) + "'"
                 );
             }
-
-            t_TypedValue& current_value = it->second;
-            std::string old_value = current_value.value;
-            if (postfix->op.type == e_TokenType::PLUS_PLUS)
-            {
-                if (current_value.has_numeric_value)
-                {
-                    current_value.numeric_value += 1.0;
-                    current_value.value = FormatNumber
-                    (
-                        current_value.numeric_value
-                    );
-                }
-                else
-                {
-                    try
-                    {
-                        double num_value = std::stod(current_value.value);
-                        num_value += 1.0;
-                        current_value.value = FormatNumber(num_value);
-                        current_value.has_numeric_value = true;
-                        current_value.numeric_value = num_value;
-                        current_value.type = e_ValueType::NUMBER;
-                    }
-                    catch (...)
-                    {
-                        return t_ErrorInfo
-                        (
-                            e_ErrorType::RUNTIME_ERROR, 
-                            "Cannot perform increment on non-numeric value"
-                        );
-                    }
-                }
-            }
-            else if (postfix->op.type == e_TokenType::MINUS_MINUS)
-            {
-                if (current_value.has_numeric_value)
-                {
-                    current_value.numeric_value -= 1.0;
-                    current_value.value = FormatNumber
-                    (
-                        current_value.numeric_value
-                    );
-                }
-                else
-                {
-                    try
-                    {
-                        double num_value = std::stod(current_value.value);
-                        num_value -= 1.0;
-                        current_value.value = FormatNumber(num_value);
-                        current_value.has_numeric_value = true;
-                        current_value.numeric_value = num_value;
-                        current_value.type = e_ValueType::NUMBER;
-                    }
-                    catch (...)
-                    {
-                        return t_ErrorInfo
-                        (
-                            e_ErrorType::RUNTIME_ERROR, 
-                            "Cannot perform decrement on non-numeric value"
-                        );
-                    }
-                }
-            }
-
-            // Return the OLD value (postfix behavior)
-            // Also ensure the variable is updated in all scopes
-            AssignToVisibleVariable
+            return Expected<t_Value, t_ErrorInfo>
             (
-                var_name, 
-                current_value, 
-                m_Environment, 
-                m_ScopeStack
+                t_Value(literal->number)
             );
-
-            return Expected<std::string, t_ErrorInfo>(old_value);
         }
-        return t_ErrorInfo
-        (
-            e_ErrorType::RUNTIME_ERROR, 
-            "Postfix increment/decrement can only be applied to variables"
-        );
-    }
 
-    if (t_BinaryExpr *binary = As<t_BinaryExpr>(expr))
-    {
-        // Handle assignment expressions
-        if 
+    case e_TokenType::TRUE:
+        return Expected<t_Value, t_ErrorInfo>(t_Value(true));
+
+    case e_TokenType::FALSE:
+        return Expected<t_Value, t_ErrorInfo>(t_Value(false));
+
+    case e_TokenType::NIL:
+        return Expected<t_Value, t_ErrorInfo>(t_Value());
+
+    default:
+        return Expected<t_Value, t_ErrorInfo>
         (
-            binary->op.type == e_TokenType::EQUAL       || 
-            binary->op.type == e_TokenType::PLUS_EQUAL  ||
-            binary->op.type == e_TokenType::MINUS_EQUAL ||
-            binary->op.type == e_TokenType::STAR_EQUAL  ||
-            binary->op.type == e_TokenType::SLASH_EQUAL ||
-            binary->op.type == e_TokenType::MODULUS_EQUAL
-        )
-        {
-            // Left side must be a variable
-            if 
+            t_Value
             (
-                t_VariableExpr *var_expr = 
-                As<t_VariableExpr>(binary->left.get())
+                literal->symbol != NO_SYMBOL ? 
+                m_Symbols->String(literal->symbol) : 
+                m_Strings.Intern(literal->value)
             )
-            {
-                std::string var_name = var_expr->name;
-                
-                // Check if variable was properly declared with 'auto' keyword
-                // All variables must be declared before use
-                if (!m_Environment.contains(var_name))
-                {
-                    return t_ErrorInfo
-                    (
-                        e_ErrorType::RUNTIME_ERROR, 
-                        "Variable '" + var_name + "' must be declared with 'auto' keyword before use"
-                    );
-                }
-                
-                if (m_Constants.count(var_name))
-                {
-                    return t_ErrorInfo
-                    (
-                        e_ErrorType::RUNTIME_ERROR,
-                        "Cannot assign to constant '" + var_name + "'"
-                    );
-                }
+        );
+    }
 
-                // For compound assignments, we need to get the current value first
-                Expected<std::string, t_ErrorInfo> left_result = 
-                Evaluate(binary->left.get());
+    return Expected<t_Value, t_ErrorInfo>(t_Value());
+}
 
-                if (!left_result)
-                {
-                    return left_result;
-                }
-                std::string left_value = left_result.Value();
-                
-                Expected<std::string, t_ErrorInfo> right_result = 
-                Evaluate(binary->right.get());
+Expected<t_Value, t_ErrorInfo> Interpreter::EvaluateFormatString
+(
+    t_FormatStringExpr *format
+)
+{
+    // Built in place. Sized for the literal text plus a short value
+    // per expression, which a reused string usually has already.
+    std::string &result = *m_Strings.Make();
+    result.reserve(format->text_size + format->segments.size() * 8);
 
-                if (!right_result)
-                {
-                    return right_result;
-                }
-                std::string right_value = right_result.Value();
-                
-                Expected<std::string, t_ErrorInfo> final_value_result
-                (
-                    right_value
-                );
-                
-                // Handle compound assignments by converting them to regular operations
-                switch (binary->op.type)
-                {
-                case e_TokenType::EQUAL:
-                    final_value_result = 
-                    Expected<std::string, t_ErrorInfo>(right_value);
-                    break;
-                    
-                case e_TokenType::PLUS_EQUAL:
-                    {
-                        try 
-                        {
-                            double left_val = std::stod(left_value);
-                            double right_val = std::stod(right_value);
-                            final_value_result = 
-                            Expected<std::string, t_ErrorInfo>
-                            (
-                                FormatNumber(left_val + right_val)
-                            );
-                        }
-                        catch (...)
-                        {
-                            final_value_result = t_ErrorInfo
-                            (
-                                e_ErrorType::RUNTIME_ERROR, 
-                                "String concatenation with '+' is not allowed. Use comma-separated values in display statements instead."
-                            );
-                        }
-                    }
-                    break;
-                    
-                case e_TokenType::MINUS_EQUAL:
-                    {
-                        try 
-                        {
-                            double left_val = std::stod(left_value);
-                            double right_val = std::stod(right_value);
-                            final_value_result = 
-                            Expected<std::string, t_ErrorInfo>
-                            (
-                                FormatNumber(left_val - right_val)
-                            );
-                        }
-                        catch (...)
-                        {
-                            final_value_result = 
-                            t_ErrorInfo
-                            (
-                                e_ErrorType::RUNTIME_ERROR, 
-                                "Cannot perform arithmetic operation"
-                            );
-                        }
-                    }
-                    break;
-                    
-                case e_TokenType::STAR_EQUAL:
-                    {
-                        try 
-                        {
-                            double left_val = std::stod(left_value);
-                            double right_val = std::stod(right_value);
-                            final_value_result = 
-                            Expected<std::string, t_ErrorInfo>
-                            (
-                                FormatNumber(left_val * right_val)
-                            );
-                        }
-                        catch (...)
-                        {
-                            final_value_result = t_ErrorInfo
-                            (
-                                e_ErrorType::RUNTIME_ERROR, 
-                                "Cannot perform arithmetic operation"
-                            );
-                        }
-                    }
-                    break;
-                    
-                case e_TokenType::MODULUS_EQUAL:
-                    {
-                        try 
-                        {
-                            double left_val = std::stod(left_value);
-                            double right_val = std::stod(right_value);
-                            
-                            if (right_val == 0)
-                            {
-                                final_value_result = t_ErrorInfo
-                                (
-                                    e_ErrorType::RUNTIME_ERROR, 
-                                    "Modulus by zero"
-                                );
-                            }
-                            else
-                            {
-                                final_value_result = 
-                                Expected<std::string, t_ErrorInfo>
-                                (
-                                    FormatNumber(std::fmod(left_val, right_val))
-                                );
-                            }
-                        }
-                        catch (...)
-                        {
-                            final_value_result = t_ErrorInfo
-                            (
-                                e_ErrorType::RUNTIME_ERROR, 
-                                "Cannot perform arithmetic operation"
-                            );
-                        }
-                    }
-                    break;
-                    
-                case e_TokenType::SLASH_EQUAL:
-                    {
-                        try 
-                        {
-                            double left_val = std::stod(left_value);
-                            double right_val = std::stod(right_value);
-                            
-                            if (right_val == 0)
-                            {
-                                final_value_result = t_ErrorInfo
-                                (
-                                    e_ErrorType::RUNTIME_ERROR, 
-                                    "Division by zero"
-                                );
-                            }
-                            else
-                            {
-                                final_value_result = 
-                                Expected<std::string, t_ErrorInfo>
-                                (
-                                    FormatNumber(left_val / right_val)
-                                );
-                            }
-                        }
-                        catch (...)
-                        {
-                            final_value_result = t_ErrorInfo
-                            (
-                                e_ErrorType::RUNTIME_ERROR, 
-                                "Cannot perform arithmetic operation"
-                            );
-                        }
-                    }
-                    break;
-                    
-                default:
-                    final_value_result = 
-                    Expected<std::string, t_ErrorInfo>(right_value);
-                    break;
-                }
-                
-                if (!final_value_result)
-                {
-                    return final_value_result;
-                }
-                
-                std::string final_value = final_value_result.Value();
-                e_ValueType type = DetectType(final_value);
-                
-                // Enforce static typing - check if the new value type matches the declared variable type
-                if 
-                (
-                    auto it = m_Environment.find(var_name); 
-                    it != m_Environment.end()
-                )
-                {
-                    e_ValueType declared_type = it->second.type;
-                    // Allow assignment only if types match or if assigning to a NIL typed variable (initial assignment)
-                    if 
-                    (
-                        declared_type != e_ValueType::NIL && 
-                        declared_type != type
-                    )
-                    {
-                        std::string type_name;
-                        switch (declared_type)
-                        {
-                        case e_ValueType::NUMBER:
-                            type_name = "number";
-                            break;
-                        case e_ValueType::STRING:
-                            type_name = "string";
-                            break;
-                        case e_ValueType::BOOLEAN:
-                            type_name = "boolean";
-                            break;
-                        default:
-                            type_name = "unknown";
-                            break;
-                        }
-                        
-                        std::string new_type_name;
-                        switch (type)
-                        {
-                        case e_ValueType::NUMBER:
-                            new_type_name = "number";
-                            break;
-                        case e_ValueType::STRING:
-                            new_type_name = "string";
-                            break;
-                        case e_ValueType::BOOLEAN:
-                            new_type_name = "boolean";
-                            break;
-                        default:
-                            new_type_name = "unknown";
-                            break;
-                        }
-                        
-                        return t_ErrorInfo
-                        (
-                            e_ErrorType::TYPE_ERROR, 
-                            "Type mismatch: variable '" + 
-                            var_name                    + 
-                            "' is "                     + 
-                            type_name                   + 
-                            ", cannot assign "          + 
-                            new_type_name
-                        );
-                    }
-                }
-                
-                // Update the variable in the m_Environment
-                AssignToVisibleVariable
-                (
-                    var_name, 
-                    t_TypedValue(final_value, type), 
-                    m_Environment, 
-                    m_ScopeStack
-                );
-                
-                // Return the assigned value
-                return Expected<std::string, t_ErrorInfo>(final_value);
-            }
-            else
-            {
-                return t_ErrorInfo
-                (
-                    e_ErrorType::RUNTIME_ERROR, 
-                    "Left side of assignment must be a variable"
-                );
-            }
-        }
-        
-        // Evaluate operands
-        Expected<std::string, t_ErrorInfo> left_result = 
-        Evaluate(binary->left.get());
-        if (!left_result)
+    for (const t_FormatSegment &segment : format->segments)
+    {
+        if (!segment.expression)
         {
-            return left_result;
+            result.append(segment.text);
+            continue;
         }
-        std::string left_str = left_result.Value();
 
-        if (binary->op.type == e_TokenType::AND)
+        Expected<t_Value, t_ErrorInfo> value_result =
+        Evaluate(segment.expression.get());
+        if (!value_result)
         {
-            if (!IsTruthy(left_str))
-            {
-                return Expected<std::string, t_ErrorInfo>("false");
-            }
+            return value_result;
+        }
+        AppendValue(result, value_result.Value());
+    }
 
-            Expected<std::string, t_ErrorInfo> right_result =
-            Evaluate(binary->right.get());
-            if (!right_result)
-            {
-                return right_result;
-            }
+    return Expected<t_Value, t_ErrorInfo>(t_Value(&result));
+}
 
-            return Expected<std::string, t_ErrorInfo>
-            (
-                IsTruthy(right_result.Value()) ? "true" : "false"
-            );
-        }
+Expected<t_Value, t_ErrorInfo> Interpreter::EvaluateCall
+(
+    t_CallExpr *call_expr
+)
+{
+    // The Linker already bound the call and checked its arguments
+    if (call_expr->target)
+    {
+        return CallFunction(call_expr->target, call_expr);
+    }
 
-        if (binary->op.type == e_TokenType::OR)
+    if (call_expr->builtin != e_Builtin::NONE)
+    {
+        t_Value arguments[MAX_BUILTIN_ARITY];
+        for (size_t i = 0; i < call_expr->arguments.size(); ++i)
         {
-            if (IsTruthy(left_str))
+            Expected<t_Value, t_ErrorInfo> arg_result =
+            Evaluate(call_expr->arguments[i].get());
+            if (!arg_result)
             {
-                return Expected<std::string, t_ErrorInfo>("true");
+                return arg_result;
             }
-
-            Expected<std::string, t_ErrorInfo> right_result =
-            Evaluate(binary->right.get());
-            if (!right_result)
-            {
-                return right_result;
-            }
-
-            return Expected<std::string, t_ErrorInfo>
-            (
-                IsTruthy(right_result.Value()) ? "true" : "false"
-            );
-        }
-        
-        Expected<std::string, t_ErrorInfo> right_result = 
-        Evaluate(binary->right.get());
-        if (!right_result)
-        {
-            return right_result;
+            arguments[i] = arg_result.Value();
         }
-        std::string right_str = right_result.Value();
-        
-        // Get typed values for optimized operations
-        t_TypedValue left_typed(left_str, DetectType(left_str));
-        t_TypedValue right_typed(right_str, DetectType(right_str));
 
-        switch (binary->op.type)
+        Expected<t_Value, t_ErrorInfo> result =
+        CallBuiltin(call_expr->builtin, arguments, m_Arrays);
+        if (!result)
         {
-        case e_TokenType::PLUS:
-            {
-                // Simple addition implementation
-                try 
-                {
-                    double left_val = std::stod(left_str);
-                    double right_val = std::stod(right_str);
-                    return Expected<std::string, t_ErrorInfo>
-                    (
-                        FormatNumber(left_val + right_val)
-                    );
-                }
-                catch (...)
-                {
-                    return t_ErrorInfo
-                    (
-                        e_ErrorType::RUNTIME_ERROR, 
-                        "String concatenation with '+' is not allowed. Use comma-separated values in display statements instead."
-                    );
-                }
-            }
+            t_ErrorInfo error = result.Error();
+            error.line = call_expr->line;
+            return error;
+        }
+        return result;
+    }
 
-        case e_TokenType::MINUS:
-            {
-                // Simple subtraction implementation
-                try 
-                {
-                    double left_val = std::stod(left_str);
-                    double right_val = std::stod(right_str);
-                    return Expected<std::string, t_ErrorInfo>
-                    (
-                        FormatNumber(left_val - right_val)
-                    );
-                }
-                catch (...)
-                {
-                    return t_ErrorInfo
-                    (
-                        e_ErrorType::RUNTIME_ERROR, 
-                        "Cannot perform arithmetic operation"
-                    );
-                }
-            }
+    return t_ErrorInfo
+    (
+        e_ErrorType::RUNTIME_ERROR,
+        "Undefined function '" + SymbolName(call_expr->callee) + "'",
+        call_expr->line
+    );
+}
 
-        case e_TokenType::STAR:
-            {
-                // Simple multiplication implementation
-                try 
-                {
-                    double left_val = std::stod(left_str);
-                    double right_val = std::stod(right_str);
-                    return Expected<std::string, t_ErrorInfo>
-                    (
-                        FormatNumber(left_val * right_val)
-                    );
-                }
-                catch (...)
-                {
-                    return t_ErrorInfo
-                    (
-                        e_ErrorType::RUNTIME_ERROR, 
-                        "Cannot perform arithmetic operation"
-                    );
-                }
-            }
-            
-        case e_TokenType::MODULUS:
-            {
-                // Simple modulus implementation
-                try 
-                {
-                    double left_val = std::stod(left_str);
-                    double right_val = std::stod(right_str);
-                    
-                    if (right_val == 0)
-                    {
-                        return t_ErrorInfo
-                        (
-                            e_ErrorType::RUNTIME_ERROR, 
-                            "Modulus by zero"
-                        );
-                    }
-                    
-                    return Expected<std::string, t_ErrorInfo>
-                    (
-                        FormatNumber(std::fmod(left_val, right_val))
-                    );
-                }
-                catch (...)
-                {
-                    return t_ErrorInfo
-                    (
-                        e_ErrorType::RUNTIME_ERROR, 
-                        "Cannot perform arithmetic operation"
-                    );
-                }
-            }
-            
-        case e_TokenType::SLASH:
-            {
-                // Simple division implementation
-                try 
-                {
-                    double left_val = std::stod(left_str);
-                    double right_val = std::stod(right_str);
-                    
-                    if (right_val == 0)
-                    {
-                        return t_ErrorInfo
-                        (
-                            e_ErrorType::RUNTIME_ERROR, 
-                            "Division by zero"
-                        );
-                    }
-                    
-                    return Expected<std::string, t_ErrorInfo>
-                    (
-                        FormatNumber(left_val / right_val)
-                    );
-                }
-                catch (...)
-                {
-                    return t_ErrorInfo
-                    (
-                        e_ErrorType::RUNTIME_ERROR, 
-                        "Cannot perform arithmetic operation"
-                    );
-                }
-            }
-            
-        case e_TokenType::BANG_EQUAL:
-        case e_TokenType::EQUAL_EQUAL:
-        case e_TokenType::GREATER:
-        case e_TokenType::GREATER_EQUAL:
-        case e_TokenType::LESS:
-        case e_TokenType::LESS_EQUAL:
-            {
-                Expected<bool, t_ErrorInfo> comparison_result = 
-                PerformComparison(left_typed, binary->op.type, right_typed);
-                if (!comparison_result)
-                {
-                    return comparison_result.Error();
-                }
-                return Expected<std::string, t_ErrorInfo>
-                (
-                    comparison_result.Value() ? "true" : "false"
-                );
-            }
-        
-        default:
-            {
-                return t_ErrorInfo
-                (
-                    e_ErrorType::RUNTIME_ERROR, 
-                    "Unsupported binary operator"
-                );
-            }
-        }
+Expected<t_Value, t_ErrorInfo> Interpreter::EvaluateUnary(t_UnaryExpr *unary)
+{
+    Expected<t_Value, t_ErrorInfo> right_result =
+    Evaluate(unary->right.get());
+    if (!right_result)
+    {
+        return right_result;
     }
 
-    if (t_VariableExpr *variable = As<t_VariableExpr>(expr))
+    const t_Value &right = right_result.Value();
+    switch (unary->op.type)
     {
-        if 
-        (
-            auto it = m_Environment.find(variable->name);
-            it != m_Environment.end()
-        )
+    case e_TokenType::MINUS:
+        if (!right.IsNumber())
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Cannot negate non-numeric value"
+            );
+        }
+        return Expected<t_Value, t_ErrorInfo>(t_Value(-right.number));
+
+    case e_TokenType::BANG:
         {
-            return Expected<std::string, t_ErrorInfo>(it->second.value);
+            // `0` counts as false here, unlike in conditions
+            bool is_false =
+            right.IsNil() ||
+            (right.IsBoolean() && !right.boolean) ||
+            (right.IsNumber() && right.number == 0.0);
+            return Expected<t_Value, t_ErrorInfo>(t_Value(is_false));
         }
-        // Variables must be declared with 'auto' keyword before use
+
+    default:
         return t_ErrorInfo
         (
-            e_ErrorType::RUNTIME_ERROR, 
-            "Variable '"   + 
-            variable->name + 
-            "' must be declared with 'auto' keyword before use"   
+            e_ErrorType::RUNTIME_ERROR,
+            "Unsupported unary operator"
         );
     }
 
-    return Expected<std::string, t_ErrorInfo>("");
-}
-
-std::string Interpreter::Stringify(const std::string &value)
-{
-    // In a real implementation, we would handle different types
-    return value;
+    return Expected<t_Value, t_ErrorInfo>(t_Value());
 }
 
-Expected<std::string, t_ErrorInfo> Interpreter::EvaluateFormatExpression
+Expected<t_Value, t_ErrorInfo> Interpreter::EvaluatePrefix
 (
-    const std::string &expr_str
+    t_PrefixExpr *prefix
 )
 {
-    try
+    if
+    (
+        t_VariableExpr *var_expr =
+        As<t_VariableExpr>(prefix->operand.get())
+    )
     {
-        // Handle empty expressions
-        if (expr_str.empty())
+        const std::string &var_name = SymbolName(var_expr->name);
+        t_Value *target = FindVariable(var_expr->binding);
+
+        if (!target)
         {
-            return Expected<std::string, t_ErrorInfo>("");
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Undefined variable '" + var_name + "'"
+            );
         }
 
-        // For simple variable names, look them up directly in the m_Environment
-        if 
-        (
-            auto it = m_Environment.find(expr_str);
-            it != m_Environment.end()
-        )
+        if (var_expr->binding.is_const)
         {
-            return Expected<std::string, t_ErrorInfo>(it->second.value);
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Cannot modify constant '" + var_name + "'"
+            );
         }
-        
-        // For numeric literals, return them directly
-        if (DetectType(expr_str) == e_ValueType::NUMBER)
+
+        if (!target->IsNumber())
         {
-            return Expected<std::string, t_ErrorInfo>(expr_str);
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Cannot perform increment/decrement on non-numeric value"
+            );
         }
 
-        // Handle simple arithmetic expressions
-        // Look for operators in order of precedence (multiplication and division first)
-        size_t mul_pos = expr_str.find('*');
-        size_t div_pos = expr_str.find('/');
-        size_t plus_pos = expr_str.find('+');
-        size_t minus_pos = expr_str.find('-');
-        
-        // Handle multiplication
-        if 
+        double delta =
         (
-            mul_pos != std::string::npos && 
-            mul_pos > 0                  && 
-            mul_pos < expr_str.length() - 1
-        )
-        {
-            std::string left_str = expr_str.substr(0, mul_pos);
-            std::string right_str = expr_str.substr(mul_pos + 1);
-            
-            // Trim whitespace
-            left_str.erase(0, left_str.find_first_not_of(" \t"));
-            left_str.erase(left_str.find_last_not_of(" \t") + 1);
-            right_str.erase(0, right_str.find_first_not_of(" \t"));
-            right_str.erase(right_str.find_last_not_of(" \t") + 1);
-            
-            // Evaluate left and right operands
-            Expected<std::string, t_ErrorInfo> left_result = 
-            EvaluateFormatExpression(left_str);
-            if (!left_result)
-            {
-                return left_result;
-            }
-            Expected<std::string, t_ErrorInfo> right_result = 
-            EvaluateFormatExpression(right_str);
-            if (!right_result)
-            {
-                return right_result;
-            }
-            
-            // Try to perform multiplication
-            std::string left_value = left_result.Value();
-            std::string right_value = right_result.Value();
-            
-            try 
-            {
-                double left_val = std::stod(left_value);
-                double right_val = std::stod(right_value);
-                return Expected<std::string, t_ErrorInfo>
-                (
-                    FormatNumber(left_val * right_val)
-                );
-            }
-            catch (...)
-            {
-                return t_ErrorInfo
-                (
-                    e_ErrorType::RUNTIME_ERROR, 
-                    "Cannot perform arithmetic operation"
-                );
-            }
+            prefix->op.type == e_TokenType::PLUS_PLUS
+        ) ? 1.0 : -1.0;
+        t_Value new_value(target->number + delta);
+        *target = new_value;
 
-        }
-        
-        // Handle division
-        if 
-        (
-            div_pos != std::string::npos && 
-            div_pos > 0                  && 
-            div_pos < expr_str.length() - 1
-        )
-        {
-            std::string left_str = expr_str.substr(0, div_pos);
-            std::string right_str = expr_str.substr(div_pos + 1);
-            
-            // Trim whitespace
-            left_str.erase(0, left_str.find_first_not_of(" \t"));
-            left_str.erase(left_str.find_last_not_of(" \t") + 1);
-            right_str.erase(0, right_str.find_first_not_of(" \t"));
-            right_str.erase(right_str.find_last_not_of(" \t") + 1);
-            
-            // Evaluate left and right operands
-            Expected<std::string, t_ErrorInfo> left_result = 
-            EvaluateFormatExpression(left_str);
-            if (!left_result)
-            {
-                return left_result;
-            }
-            Expected<std::string, t_ErrorInfo> right_result = 
-            EvaluateFormatExpression(right_str);
-            if (!right_result)
-            {
-                return right_result;
-            }
-            
-            // Try to perform division
-            std::string left_value = left_result.Value();
-            std::string right_value = right_result.Value();
-            
-            try 
-            {
-                double left_val = std::stod(left_value);
-                double right_val = std::stod(right_value);
-                
-                if (right_val == 0)
-                {
-                    return t_ErrorInfo
-                    (
-                        e_ErrorType::RUNTIME_ERROR, 
-                        "Division by zero"
-                    );
-                }
-                
-                return Expected<std::string, t_ErrorInfo>
-                (
-                    FormatNumber(left_val / right_val)
-                );
-            }
-            catch (...)
-            {
-                return t_ErrorInfo
-                (
-                    e_ErrorType::RUNTIME_ERROR, 
-                    "Cannot perform arithmetic operation"
-                );
-            }
+        // Return the NEW value (prefix behavior)
+        return Expected<t_Value, t_ErrorInfo>(new_value);
+    }
+    return t_ErrorInfo
+    (
+        e_ErrorType::RUNTIME_ERROR,
+        "Prefix increment/decrement can only be applied to variables"
+    );
+}
 
-        }
-        
-        // Handle addition
-        if 
-        (
-            plus_pos != std::string::npos && 
-            plus_pos > 0                  && 
-            plus_pos < expr_str.length() - 1
-        )
+Expected<t_Value, t_ErrorInfo> Interpreter::EvaluatePostfix
+(
+    t_PostfixExpr *postfix
+)
+{
+    if
+    (
+        t_VariableExpr *var_expr =
+        As<t_VariableExpr>(postfix->operand.get())
+    )
+    {
+        const std::string &var_name = SymbolName(var_expr->name);
+        t_Value *target = FindVariable(var_expr->binding);
+        if (!target)
         {
-            std::string left_str = expr_str.substr(0, plus_pos);
-            std::string right_str = expr_str.substr(plus_pos + 1);
-            
-            // Trim whitespace
-            left_str.erase(0, left_str.find_first_not_of(" \t"));
-            left_str.erase(left_str.find_last_not_of(" \t") + 1);
-            right_str.erase(0, right_str.find_first_not_of(" \t"));
-            right_str.erase(right_str.find_last_not_of(" \t") + 1);
-            
-            // Evaluate left and right operands
-            Expected<std::string, t_ErrorInfo> left_result = 
-            EvaluateFormatExpression(left_str);
-            if (!left_result)
-            {
-                return left_result;
-            }
-            Expected<std::string, t_ErrorInfo> right_result = 
-            EvaluateFormatExpression(right_str);
-            if (!right_result)
-            {
-                return right_result;
-            }
-            
-            // Try to perform addition
-            std::string left_value = left_result.Value();
-            std::string right_value = right_result.Value();
-            
-            try 
-            {
-                double left_val = std::stod(left_value);
-                double right_val = std::stod(right_value);
-                return Expected<std::string, t_ErrorInfo>
-                (
-                    FormatNumber(left_val + right_val)
-                );
-            }
-            catch (...)
-            {
-                return t_ErrorInfo
-                (
-                    e_ErrorType::RUNTIME_ERROR, 
-                    "String concatenation with '+' is not allowed. Use comma-separated values in display statements instead."
-                );
-            }
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Undefined variable '" + var_name + "'"
+            );
+        }
 
+        if (var_expr->binding.is_const)
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Cannot modify constant '" + var_name + "'"
+            );
         }
-        
-        // Handle subtraction
-        if 
-        (
-            minus_pos != std::string::npos && 
-            minus_pos > 0                  && 
-            minus_pos < expr_str.length() - 1
-        )
+
+        t_Value old_value = *target;
+        if (!old_value.IsNumber())
         {
-            std::string left_str = expr_str.substr(0, minus_pos);
-            std::string right_str = expr_str.substr(minus_pos + 1);
-            
-            // Trim whitespace
-            left_str.erase(0, left_str.find_first_not_of(" \t"));
-            left_str.erase(left_str.find_last_not_of(" \t") + 1);
-            right_str.erase(0, right_str.find_first_not_of(" \t"));
-            right_str.erase(right_str.find_last_not_of(" \t") + 1);
-            
-            // Evaluate left and right operands
-            Expected<std::string, t_ErrorInfo> left_result = 
-            EvaluateFormatExpression(left_str);
-            if (!left_result)
-            {
-                return left_result;
-            }
-            Expected<std::string, t_ErrorInfo> right_result = 
-            EvaluateFormatExpression(right_str);
-            if (!right_result)
-            {
-                return right_result;
-            }
-            
-            // Try to perform subtraction
-            std::string left_value = left_result.Value();
-            std::string right_value = right_result.Value();
-            
-            try 
-            {
-                double left_val = std::stod(left_value);
-                double right_val = std::stod(right_value);
-                return Expected<std::string, t_ErrorInfo>
-                (
-                    FormatNumber(left_val - right_val)
-                );
-            }
-            catch (...)
-            {
-                return t_ErrorInfo
-                (
-                    e_ErrorType::RUNTIME_ERROR, 
-                    "Cannot perform arithmetic operation"
-                );
-            }
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                postfix->op.type == e_TokenType::PLUS_PLUS ?
+                "Cannot perform increment on non-numeric value" :
+                "Cannot perform decrement on non-numeric value"
+            );
         }
-        
-        // For other complex expressions, return the expression as a string
-        return Expected<std::string, t_ErrorInfo>(expr_str);
-    }
-    catch (...)
-    {
-        // If parsing fails, treat as literal text
-        return Expected<std::string, t_ErrorInfo>(expr_str);
-    }
-}
 
-// Helper function to check if a for loop is a simple numeric loop pattern: for (auto i = 0; i < N; i++)
-bool Interpreter::IsSimpleNumericLoop(t_ForStmt* for_stmt)
-{
-    // Check if initializer is: auto var = 0
-    if (!for_stmt->initializer) return false;
-    
-    t_VarStmt* init_var = As<t_VarStmt>(for_stmt->initializer.get());
-    if (!init_var || !init_var->initializer) return false;
-    
-    t_LiteralExpr* init_literal = 
-    As<t_LiteralExpr>(init_var->initializer.get());
-    if (!init_literal || init_literal->token_type != e_TokenType::NUMBER)
-    {
-        return false;
+        double delta =
+        (
+            postfix->op.type == e_TokenType::PLUS_PLUS
+        ) ? 1.0 : -1.0;
+
+        // Return the OLD value (postfix behavior)
+        *target = t_Value(old_value.number + delta);
+
+        return Expected<t_Value, t_ErrorInfo>(old_value);
     }
+    return t_ErrorInfo
+    (
+        e_ErrorType::RUNTIME_ERROR,
+        "Postfix increment/decrement can only be applied to variables"
+    );
+}
 
-    int start_value = 0;
-    try
+// The NUMBER form: the TypeChecker proved that both operands, and
+// the variable an assignment writes, hold numbers
+Expected<t_Value, t_ErrorInfo> Interpreter::EvaluateNumberBinary
+(
+    t_BinaryExpr *binary
+)
+{
+    e_TokenType op = binary->op.type;
+    e_TokenType assign_op = AssignmentOperator(op);
+    t_Value *target = nullptr;
+    double left_val = 0.0;
+    if (assign_op != e_TokenType::EOF_TOKEN)
     {
-        double raw_value = std::stod(init_literal->value);
-        start_value = static_cast<int>(raw_value);
-        if (raw_value != static_cast<double>(start_value))
+        t_VariableExpr *var_expr =
+        static_cast<t_VariableExpr*>(binary->left.get());
+        target = FindVariable(var_expr->binding);
+        if (!target)
         {
-            return false;
+            return UndeclaredError(var_expr->name);
         }
+        left_val = target->number;
     }
-    catch (...)
+    else
     {
-        return false;
+        Expected<t_Value, t_ErrorInfo> left_result =
+        Evaluate(binary->left.get());
+        if (!left_result)
+        {
+            return left_result;
+        }
+        left_val = left_result.Value().number;
     }
-    
-    // Check if condition is: var < number
-    if (!for_stmt->condition) return false;
-    
-    t_BinaryExpr* condition_binary = 
-    As<t_BinaryExpr>(for_stmt->condition.get());
-    if (!condition_binary) return false;
 
-    e_TokenType condition_op = condition_binary->op.type;
-    if
-    (
-        condition_op != e_TokenType::LESS          &&
-        condition_op != e_TokenType::LESS_EQUAL    &&
-        condition_op != e_TokenType::GREATER       &&
-        condition_op != e_TokenType::GREATER_EQUAL
-    )
+    Expected<t_Value, t_ErrorInfo> right_result =
+    Evaluate(binary->right.get());
+    if (!right_result)
     {
-        return false;
+        return right_result;
     }
-    
-    t_VariableExpr* condition_var = 
-    As<t_VariableExpr>(condition_binary->left.get());
-    if 
-    (
-        !condition_var || 
-        condition_var->name != init_var->name
-    ) return false;
-    
-    t_LiteralExpr* condition_literal = 
-    As<t_LiteralExpr>(condition_binary->right.get());
-    if 
-    (
-        !condition_literal || 
-        condition_literal->token_type != e_TokenType::NUMBER
-    ) return false;
+    double right_val = right_result.Value().number;
 
-    int limit_value = 0;
-    try
+    if (!target)
     {
-        double raw_value = std::stod(condition_literal->value);
-        limit_value = static_cast<int>(raw_value);
-        if (raw_value != static_cast<double>(limit_value))
+        if (IsComparison(op))
         {
-            return false;
+            return Expected<t_Value, t_ErrorInfo>
+            (
+                t_Value(NumberComparison(left_val, op, right_val))
+            );
         }
+        return NumberArithmetic(left_val, op, right_val, binary->op.line);
     }
-    catch (...)
+
+    if (assign_op == e_TokenType::EQUAL)
     {
-        return false;
+        *target = right_result.Value();
+        return right_result;
     }
-    
-    // Try to convert condition literal to number
-    try 
+    Expected<t_Value, t_ErrorInfo> final_value_result =
+    NumberArithmetic(left_val, assign_op, right_val, binary->op.line);
+    if (final_value_result)
     {
-        (void)std::stod(condition_literal->value);
-    } 
-    catch (...) 
+        *target = final_value_result.Value();
+    }
+    return final_value_result;
+}
+
+Expected<t_Value, t_ErrorInfo> Interpreter::EvaluateBinary
+(
+    t_BinaryExpr *binary
+)
+{
+    if (binary->form == e_BinaryForm::NUMBER)
     {
-        return false;
+        return EvaluateNumberBinary(binary);
     }
-    
-    // Check if increment is: var++ or ++var
-    if (!for_stmt->increment) return false;
 
-    int step = 0;
-    
-    // Check for postfix increment: var++
-    t_PostfixExpr* postfix_inc = 
-    As<t_PostfixExpr>(for_stmt->increment.get());
-    if (postfix_inc) 
+    // Handle assignment expressions
+    if
+    (
+        binary->op.type == e_TokenType::EQUAL       ||
+        binary->op.type == e_TokenType::PLUS_EQUAL  ||
+        binary->op.type == e_TokenType::MINUS_EQUAL ||
+        binary->op.type == e_TokenType::STAR_EQUAL  ||
+        binary->op.type == e_TokenType::SLASH_EQUAL ||
+        binary->op.type == e_TokenType::MODULUS_EQUAL
+    )
     {
-        t_VariableExpr* inc_var = 
-        As<t_VariableExpr>(postfix_inc->operand.get());
-        if 
-        (
-            inc_var                         && 
-            inc_var->name == init_var->name && 
-            postfix_inc->op.type == e_TokenType::PLUS_PLUS
-        ) 
+        // Left side must be a variable
+        t_VariableExpr *var_expr = As<t_VariableExpr>(binary->left.get());
+        if (!var_expr)
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Left side of assignment must be a variable"
+            );
+        }
+
+        // All variables must be declared with 'auto' before use
+        Expected<t_Value*, t_ErrorInfo> target_result =
+        AssignmentTarget(var_expr->binding, var_expr->name);
+        if (!target_result)
         {
-            step = 1;
+            return target_result.Error();
         }
-        else if
+        t_Value *target = target_result.Value();
+        t_Value left_value = *target;
+
+        Expected<t_Value, t_ErrorInfo> right_result =
+        Evaluate(binary->right.get());
+
+        if (!right_result)
+        {
+            return right_result;
+        }
+
+        // Handle compound assignments by converting them to regular operations
+        e_TokenType arithmetic_op = AssignmentOperator(binary->op.type);
+
+        Expected<t_Value, t_ErrorInfo> final_value_result =
         (
-            inc_var                         &&
-            inc_var->name == init_var->name &&
-            postfix_inc->op.type == e_TokenType::MINUS_MINUS
-        )
+            arithmetic_op == e_TokenType::EQUAL
+        ) ? right_result : PerformArithmetic
+        (
+            left_value,
+            arithmetic_op,
+            right_result.Value(),
+            binary->op.line
+        );
+
+        if (!final_value_result)
         {
-            step = -1;
+            return final_value_result;
         }
-        else
+
+        const t_Value &final_value = final_value_result.Value();
+
+        // Enforce static typing - allow assignment only if types match
+        // or if assigning to a NIL typed variable (initial assignment)
+        Expected<int, t_ErrorInfo> type_check =
+        CheckAssignedType(left_value, final_value, var_expr->name);
+        if (!type_check)
         {
-            return false;
+            return type_check.Error();
         }
+
+        // The right side cannot move the slot: frames never resize
+        *target = final_value;
+
+        // Return the assigned value
+        return final_value_result;
     }
-    
-    // Check for prefix increment: ++var
-    t_PrefixExpr* prefix_inc = 
-    As<t_PrefixExpr>(for_stmt->increment.get());
 
-    if (prefix_inc) 
+    // Evaluate operands
+    Expected<t_Value, t_ErrorInfo> left_result =
+    Evaluate(binary->left.get());
+    if (!left_result)
     {
-        t_VariableExpr* inc_var = 
-        As<t_VariableExpr>(prefix_inc->operand.get());
-        if 
-        (
-            inc_var                         && 
-            inc_var->name == init_var->name && 
-            prefix_inc->op.type == e_TokenType::PLUS_PLUS
-        )
+        return left_result;
+    }
+
+    if (binary->op.type == e_TokenType::AND)
+    {
+        if (!IsTruthy(left_result.Value()))
+        {
+            return Expected<t_Value, t_ErrorInfo>(t_Value(false));
+        }
+
+        Expected<t_Value, t_ErrorInfo> right_result =
+        Evaluate(binary->right.get());
+        if (!right_result)
         {
-            step = 1;
+            return right_result;
         }
-        else if
+
+        return Expected<t_Value, t_ErrorInfo>
         (
-            inc_var                         &&
-            inc_var->name == init_var->name &&
-            prefix_inc->op.type == e_TokenType::MINUS_MINUS
-        )
+            t_Value(IsTruthy(right_result.Value()))
+        );
+    }
+
+    if (binary->op.type == e_TokenType::OR)
+    {
+        if (IsTruthy(left_result.Value()))
         {
-            step = -1;
+            return Expected<t_Value, t_ErrorInfo>(t_Value(true));
         }
-        else
+
+        Expected<t_Value, t_ErrorInfo> right_result =
+        Evaluate(binary->right.get());
+        if (!right_result)
         {
-            return false;
+            return right_result;
         }
+
+        return Expected<t_Value, t_ErrorInfo>
+        (
+            t_Value(IsTruthy(right_result.Value()))
+        );
     }
 
-    if (step == 0)
+    Expected<t_Value, t_ErrorInfo> right_result =
+    Evaluate(binary->right.get());
+    if (!right_result)
     {
-        if 
+        return right_result;
+    }
+
+    switch (binary->op.type)
+    {
+    case e_TokenType::PLUS:
+    case e_TokenType::MINUS:
+    case e_TokenType::STAR:
+    case e_TokenType::SLASH:
+    case e_TokenType::MODULUS:
+        return PerformArithmetic
         (
-            t_BinaryExpr* assign = 
-            As<t_BinaryExpr>(for_stmt->increment.get())
-        )
+            left_result.Value(),
+            binary->op.type,
+            right_result.Value(),
+            binary->op.line
+        );
+
+    case e_TokenType::BANG_EQUAL:
+    case e_TokenType::EQUAL_EQUAL:
+    case e_TokenType::GREATER:
+    case e_TokenType::GREATER_EQUAL:
+    case e_TokenType::LESS:
+    case e_TokenType::LESS_EQUAL:
         {
-            if
+            Expected<bool, t_ErrorInfo> comparison_result =
+            PerformComparison
             (
-                assign->op.type != e_TokenType::PLUS_EQUAL &&
-                assign->op.type != e_TokenType::MINUS_EQUAL
-            )
+                left_result.Value(),
+                binary->op.type,
+                right_result.Value(),
+                binary->op.line
+            );
+            if (!comparison_result)
             {
-                return false;
+                return comparison_result.Error();
             }
-
-            t_VariableExpr* lhs = As<t_VariableExpr>
+            return Expected<t_Value, t_ErrorInfo>
             (
-                assign->left.get()
+                t_Value(comparison_result.Value())
             );
-            t_LiteralExpr* rhs = As<t_LiteralExpr>
+        }
+
+    default:
+        {
+            return t_ErrorInfo
             (
-                assign->right.get()
+                e_ErrorType::RUNTIME_ERROR,
+                "Unsupported binary operator"
             );
-            if
-            (
-                !lhs ||
-                !rhs ||
-                lhs->name != init_var->name ||
-                rhs->token_type != e_TokenType::NUMBER
-            )
-            {
-                return false;
-            }
+        }
+    }
 
-            int rhs_int = 0;
-            try
-            {
-                double raw_value = std::stod(rhs->value);
-                rhs_int = static_cast<int>(raw_value);
-                if (raw_value != static_cast<double>(rhs_int))
-                {
-                    return false;
-                }
-            }
-            catch (...)
-            {
-                return false;
-            }
+    return Expected<t_Value, t_ErrorInfo>(t_Value());
+}
 
-            if (rhs_int == 0)
-            {
-                return false;
-            }
+Expected<t_Value, t_ErrorInfo> Interpreter::EvaluateVariable
+(
+    t_VariableExpr *variable
+)
+{
+    if (t_Value *value = FindVariable(variable->binding))
+    {
+        return Expected<t_Value, t_ErrorInfo>(*value);
+    }
+    // Variables must be declared with 'auto' keyword before use
+    return UndeclaredError(variable->name);
+}
 
-            step = 
-            (
-                assign->op.type == e_TokenType::PLUS_EQUAL
-            ) ? rhs_int : -rhs_int;
-        }
-        else
+Expected<t_Value, t_ErrorInfo> Interpreter::EvaluateArray
+(
+    t_ArrayExpr *array
+)
+{
+    std::vector<t_Value> elements;
+    elements.reserve(array->elements.size());
+    for (const auto &element : array->elements)
+    {
+        Expected<t_Value, t_ErrorInfo> element_result =
+        Evaluate(element.get());
+        if (!element_result)
         {
-            return false;
+            return element_result;
         }
+        elements.push_back(element_result.Value());
     }
 
-    if
-    (
-        condition_op == e_TokenType::LESS || 
-        condition_op == e_TokenType::LESS_EQUAL
-    )
+    Expected<t_Value, t_ErrorInfo> result =
+    MakeArray(elements.data(), elements.size(), m_Arrays);
+    if (!result)
+    {
+        t_ErrorInfo error = result.Error();
+        error.line = array->line;
+        return error;
+    }
+    return result;
+}
+
+Expected<t_Value, t_ErrorInfo> Interpreter::EvaluateIndex
+(
+    t_IndexExpr *index
+)
+{
+    Expected<t_Value, t_ErrorInfo> object_result =
+    Evaluate(index->object.get());
+    if (!object_result)
+    {
+        return object_result;
+    }
+
+    Expected<t_Value, t_ErrorInfo> index_result =
+    Evaluate(index->index.get());
+    if (!index_result)
+    {
+        return index_result;
+    }
+
+    Expected<t_Value, t_ErrorInfo> result =
+    GetElement(object_result.Value(), index_result.Value());
+    if (!result)
+    {
+        t_ErrorInfo error = result.Error();
+        error.line = index->line;
+        return error;
+    }
+    return result;
+}
+
+Expected<t_Value, t_ErrorInfo> Interpreter::EvaluateIndexAssign
+(
+    t_IndexAssignExpr *assign
+)
+{
+    t_IndexExpr *target = assign->target.get();
+    Expected<t_Value, t_ErrorInfo> object_result =
+    Evaluate(target->object.get());
+    if (!object_result)
+    {
+        return object_result;
+    }
+    t_Value object = object_result.Value();
+
+    Expected<t_Value, t_ErrorInfo> index_result =
+    Evaluate(target->index.get());
+    if (!index_result)
+    {
+        return index_result;
+    }
+    t_Value index = index_result.Value();
+
+    e_TokenType arithmetic_op = e_TokenType::EQUAL;
+    switch (assign->op.type)
+    {
+    case e_TokenType::PLUS_EQUAL:
+        arithmetic_op = e_TokenType::PLUS;
+        break;
+    case e_TokenType::MINUS_EQUAL:
+        arithmetic_op = e_TokenType::MINUS;
+        break;
+    case e_TokenType::STAR_EQUAL:
+        arithmetic_op = e_TokenType::STAR;
+        break;
+    case e_TokenType::SLASH_EQUAL:
+        arithmetic_op = e_TokenType::SLASH;
+        break;
+    case e_TokenType::MODULUS_EQUAL:
+        arithmetic_op = e_TokenType::MODULUS;
+        break;
+    default:
+        break;
+    }
+
+    // A compound assignment reads the element before the right side
+    // runs, like the bytecode does
+    t_Value current;
+    if (arithmetic_op != e_TokenType::EQUAL)
     {
-        if (step <= 0)
+        Expected<t_Value, t_ErrorInfo> current_result =
+        GetElement(object, index);
+        if (!current_result)
         {
-            return false;
+            t_ErrorInfo error = current_result.Error();
+            error.line = target->line;
+            return error;
         }
+        current = current_result.Value();
     }
-    else
+
+    Expected<t_Value, t_ErrorInfo> value_result =
+    Evaluate(assign->value.get());
+    if (!value_result)
+    {
+        return value_result;
+    }
+
+    if (arithmetic_op != e_TokenType::EQUAL)
     {
-        if (step >= 0)
+        value_result = PerformArithmetic
+        (
+            current,
+            arithmetic_op,
+            value_result.Value(),
+            assign->op.line
+        );
+        if (!value_result)
         {
-            return false;
+            return value_result;
         }
     }
-    return true;
+
+    Expected<t_Value, t_ErrorInfo> result =
+    SetElement(object, index, value_result.Value());
+    if (!result)
+    {
+        t_ErrorInfo error = result.Error();
+        error.line = assign->op.line;
+        return error;
+    }
+    return result;
 }
 
-// Ultra-fast optimization for simple accumulation loops: for (auto i = 0; i < N; i++) { var += i; }
-bool Interpreter::IsSimpleAccumulationLoop(t_ForStmt* for_stmt)
+Expected<t_Value, t_ErrorInfo> Interpreter::EvaluateSizeof
+(
+    t_SizeofExpr *size_of
+)
 {
-    // First check if it's a simple numeric loop
-    if (!IsSimpleNumericLoop(for_stmt)) return false;
+    Expected<t_Value, t_ErrorInfo> operand_result =
+    Evaluate(size_of->operand.get());
+    if (!operand_result)
+    {
+        return operand_result;
+    }
 
-    t_VarStmt* init_var = As<t_VarStmt>
+    Expected<t_Value, t_ErrorInfo> result = SizeOf(operand_result.Value());
+    if (!result)
+    {
+        t_ErrorInfo error = result.Error();
+        error.line = size_of->line;
+        return error;
+    }
+    return result;
+}
+
+Expected<t_Value, t_ErrorInfo> Interpreter::CallFunction
+(
+    t_FunStmt *fun_stmt,
+    t_CallExpr *call_expr
+)
+{
+    size_t base = m_StackTop;
+    Expected<int, t_ErrorInfo> check = CheckCall
     (
-        for_stmt->initializer.get()
+        fun_stmt, base, call_expr->line
     );
-    t_LiteralExpr* init_literal =
-    As<t_LiteralExpr>(init_var->initializer.get());
+    if (!check)
+    {
+        return check.Error();
+    }
+    if (m_Stats)
+    {
+        CountCall(m_Frames.size(), base + fun_stmt->frame_size);
+    }
 
-    t_BinaryExpr* condition_binary =
-    As<t_BinaryExpr>(for_stmt->condition.get());
+    // Reserve the callee's slots first so that calls made while
+    // evaluating the arguments are placed above them. Locals are not
+    // cleared: the Resolver guarantees each one is written by its
+    // declaration before it can be read.
+    m_StackTop = base + fun_stmt->frame_size;
+    for (size_t i = 0; i < call_expr->arguments.size(); ++i)
+    {
+        Expected<t_Value, t_ErrorInfo> arg_result =
+        Evaluate(call_expr->arguments[i].get());
+        if (!arg_result)
+        {
+            m_StackTop = base;
+            return arg_result;
+        }
 
-    if
-    (
-        !init_literal ||
-        init_literal->value != "0" ||
-        !condition_binary ||
-        condition_binary->op.type != e_TokenType::LESS
-    )
+        m_Stack[base + i] = arg_result.Value();
+    }
+
+    if (m_Memo && fun_stmt->memo_slot >= 0)
     {
-        return false;
+        return RunMemoized(fun_stmt, base);
     }
+    return RunFunction(fun_stmt, base);
+}
 
-    bool increment_is_plus_plus = false;
-    if 
+Expected<t_Value, t_ErrorInfo> Interpreter::RunFunction
+(
+    t_FunStmt *fun_stmt,
+    size_t base,
+    const t_StmtClosure *body
+)
+{
+    // Loops of the caller cannot be broken out of from the callee
+    m_Frames.push_back
     (
-        t_PostfixExpr* postfix_inc = 
-        As<t_PostfixExpr>(for_stmt->increment.get())
-    )
+        t_CallFrame
+        {
+            fun_stmt,
+            base,
+            m_LoopDepth,
+            t_Value(),
+            m_Strings.MadeCount(),
+            m_Arrays.MadeCount()
+        }
+    );
+    t_Value *caller_frame = m_Frame;
+    m_Frame = m_Stack.data() + base;
+    m_LoopDepth = 0;
+
+    if (m_Profiler)
     {
-        increment_is_plus_plus = 
-        (
-            postfix_inc->op.type == e_TokenType::PLUS_PLUS
-        );
+        m_Profiler->BeginCall(fun_stmt);
+    }
+
+    Expected<int, t_ErrorInfo> body_result(0);
+    while (true)
+    {
+        m_IsReturning = false;
+        if (body)
+        {
+            body_result = body->run(*this, *body);
+        }
+        else if (fun_stmt->body)
+        {
+            body_result = Execute(fun_stmt->body.get());
+        }
+        m_IsReturning = false;
+        if (!body_result || !m_TailCall)
+        {
+            break;
+        }
+
+        // The function returned the result of a tail call: run it in
+        // this frame instead of on top of it
+        const t_StmtClosure *next_body = m_TailBody;
+        Expected<t_FunStmt*, t_ErrorInfo> next = EnterTailCall(base);
+        if (!next)
+        {
+            body_result = next.Error();
+            break;
+        }
+        fun_stmt = next.Value();
+        body = next_body;
+        CollectAtLoop();
+        if (m_Profiler)
+        {
+            m_Profiler->EndCall();
+            m_Profiler->BeginCall(fun_stmt);
+        }
+    }
+
+    if (m_Profiler)
+    {
+        m_Profiler->EndCall();
     }
-    else if 
+
+    t_Value return_value = m_Frames.back().return_value;
+    size_t strings_made = m_Frames.back().strings_made;
+    ArrayPool::t_Made arrays_made = m_Frames.back().arrays_made;
+    m_LoopDepth = m_Frames.back().loop_depth;
+    m_Frames.pop_back();
+    m_Frame = caller_frame;
+    m_StackTop = base;
+
+    if (!body_result)
+    {
+        return body_result.Error();
+    }
+    CollectAtReturn(return_value, strings_made, arrays_made);
+    return Expected<t_Value, t_ErrorInfo>(return_value);
+}
+
+Expected<t_Value, t_ErrorInfo> Interpreter::RunMemoized
+(
+    t_FunStmt *fun_stmt,
+    size_t base,
+    const t_StmtClosure *body
+)
+{
+    t_MemoKey key;
+    bool has_key = MemoCache::MakeKey
     (
-        t_PrefixExpr* prefix_inc = 
-        As<t_PrefixExpr>(for_stmt->increment.get())
-    )
+        fun_stmt->memo_slot,
+        m_Stack.data() + base,
+        static_cast<uint32_t>(fun_stmt->parameters.size()),
+        key
+    );
+    if (!has_key)
+    {
+        return RunFunction(fun_stmt, base, body);
+    }
+
+    if (const t_Value *cached = m_Memo->Find(key))
+    {
+        m_StackTop = base;
+        return Expected<t_Value, t_ErrorInfo>(*cached);
+    }
+
+    Expected<t_Value, t_ErrorInfo> result = RunFunction(fun_stmt, base, body);
+    if (result)
+    {
+        m_Memo->Store(key, result.Value());
+    }
+    return result;
+}
+
+Expected<int, t_ErrorInfo> Interpreter::CheckCall
+(
+    const t_FunStmt *fun_stmt,
+    size_t base,
+    int line
+) const
+{
+    // The script itself has the bottom frame
+    if (m_Frames.size() > m_MaxCallDepth)
     {
-        increment_is_plus_plus = 
+        return t_ErrorInfo
         (
-            prefix_inc->op.type == e_TokenType::PLUS_PLUS
+            e_ErrorType::RUNTIME_ERROR,
+            "Stack overflow: more than " + std::to_string(m_MaxCallDepth) +
+            " nested calls",
+            line
         );
     }
 
-    if (!increment_is_plus_plus)
+    // The stack grows down on every supported platform, but the
+    // distance is all that matters
+    char stack_marker = 0;
+    uintptr_t here = reinterpret_cast<uintptr_t>(&stack_marker);
+    uintptr_t native_used = here < m_NativeStackBase
+        ? m_NativeStackBase - here
+        : here - m_NativeStackBase;
+    if
+    (
+        base + fun_stmt->frame_size > m_Stack.size() ||
+        native_used > m_NativeStackBudget
+    )
     {
-        return false;
+        return t_ErrorInfo(e_ErrorType::RUNTIME_ERROR, "Stack overflow", line);
     }
-    
-    // Check if body is a block with exactly one statement
-    t_BlockStmt* body_block = As<t_BlockStmt>(for_stmt->body.get());
-    if (!body_block || body_block->statements.size() != 1) return false;
-    
-    t_ExpressionStmt* expr_stmt = 
-    As<t_ExpressionStmt>(body_block->statements[0].get());
-    if (!expr_stmt) return false;
-    
-    // Check if the expression is a binary assignment (+=)
-    t_BinaryExpr* binary_expr = 
-    As<t_BinaryExpr>(expr_stmt->expression.get());
-    if 
-    (
-        !binary_expr || 
-        binary_expr->op.type != e_TokenType::PLUS_EQUAL
-    ) return false;
-    
-    // Check if left side is a variable
-    t_VariableExpr* left_var = 
-    As<t_VariableExpr>(binary_expr->left.get());
-    if (!left_var) return false;
-    
-    // Check if right side is the loop variable
-    t_VariableExpr* right_var = 
-    As<t_VariableExpr>(binary_expr->right.get());
-    if (!right_var) return false;
-    
-    // Check if right side matches loop variable
-    if (right_var->name != init_var->name) return false;
-    
-    return true;
+    return Expected<int, t_ErrorInfo>(0);
 }
 
-// Ultra-fast native execution for simple accumulation loops
-Expected<int, t_ErrorInfo> Interpreter::ExecuteAccumulationLoop
+Expected<int, t_ErrorInfo> Interpreter::ExecuteTailCall
 (
-    t_ForStmt* for_stmt
+    t_CallExpr *call_expr
 )
 {
-    // Extract loop parameters
-    t_VarStmt* init_var = As<t_VarStmt>
-    (
-        for_stmt->initializer.get()
-    );
-    t_BinaryExpr* condition_binary = 
-    As<t_BinaryExpr>(for_stmt->condition.get());
-    
-    t_LiteralExpr* condition_literal = 
-    As<t_LiteralExpr>(condition_binary->right.get());
-    
-    // Get the loop limit
-    int limit = static_cast<int>(std::stod(condition_literal->value));
-    
-    // Get accumulation variable name
-    t_BlockStmt* body_block = As<t_BlockStmt>(for_stmt->body.get());
-    t_ExpressionStmt* expr_stmt = 
-    As<t_ExpressionStmt>(body_block->statements[0].get());
-
-    t_BinaryExpr* binary_expr = 
-    As<t_BinaryExpr>(expr_stmt->expression.get());
-    
-    t_VariableExpr* acc_var = 
-    As<t_VariableExpr>(binary_expr->left.get());
-    
-    std::string acc_var_name = acc_var->name;
-    std::string loop_var_name = init_var->name;
-    
-    // Check if accumulation variable exists and get its initial value
-    auto acc_it = m_Environment.find(acc_var_name);
-    if (acc_it == m_Environment.end())
+    // Where a call made by the running function would put them, so
+    // that calls made while evaluating them go above
+    size_t arguments = m_StackTop;
+    size_t count = call_expr->arguments.size();
+    if (arguments + count > m_Stack.size())
     {
         return t_ErrorInfo
         (
-            e_ErrorType::RUNTIME_ERROR, 
-            "Variable '" + 
-            acc_var_name + 
-            "' must be declared with 'auto' keyword before use"
+            e_ErrorType::RUNTIME_ERROR,
+            "Stack overflow",
+            call_expr->line
         );
     }
-    
-    // Get initial value (should be 0 based on test.rd)
-    double accumulator = 0.0;
-    if (acc_it->second.has_numeric_value)
-    {
-        accumulator = acc_it->second.numeric_value;
-    }
-    else
+
+    m_StackTop = arguments + count;
+    for (size_t i = 0; i < count; ++i)
     {
-        try
-        {
-            accumulator = std::stod(acc_it->second.value);
-        }
-        catch (...)
+        Expected<t_Value, t_ErrorInfo> arg_result =
+        Evaluate(call_expr->arguments[i].get());
+        if (!arg_result)
         {
-            return t_ErrorInfo
-            (
-                e_ErrorType::RUNTIME_ERROR, 
-                "Variable '" + acc_var_name + "' must be numeric for accumulation"
-            );
+            m_StackTop = arguments;
+            return arg_result.Error();
         }
+        m_Stack[arguments + i] = arg_result.Value();
     }
-    
-    // NATIVE C++ LOOP: Direct arithmetic without interpretation overhead
-    for (int i = 0; i < limit; i++)
-    {
-        accumulator += i;
-    }
-    
-    // Update the accumulation variable with the result
-    m_Environment[acc_var_name] = t_TypedValue(accumulator);
+    m_StackTop = arguments;
 
+    m_TailCall = call_expr;
+    m_IsReturning = true;
     return Expected<int, t_ErrorInfo>(0);
 }
 
-// Check if a for loop contains a nested loop with arithmetic accumulation
-bool Interpreter::IsNestedArithmeticLoop(t_ForStmt* for_stmt)
+Expected<t_FunStmt*, t_ErrorInfo> Interpreter::EnterTailCall(size_t base)
 {
-    // First check if outer loop is a simple numeric loop
-    if (!IsSimpleNumericLoop(for_stmt)) return false;
-    
-    // Check if body is a block with exactly one statement (the inner loop)
-    t_BlockStmt* body_block = 
-    As<t_BlockStmt>(for_stmt->body.get());
-
-    if (!body_block || body_block->statements.size() != 1) return false;
-    
-    // Check if the statement is a nested for loop
-    t_ForStmt* inner_for = 
-    As<t_ForStmt>(body_block->statements[0].get());
-
-    if (!inner_for) return false;
-    
-    // Check if inner loop is also a simple numeric loop
-    if (!IsSimpleNumericLoop(inner_for)) return false;
-    
-    // Check if inner loop body contains arithmetic accumulation
-    t_BlockStmt* inner_body = As<t_BlockStmt>(inner_for->body.get());
-    if (!inner_body || inner_body->statements.size() != 1) return false;
-    
-    t_ExpressionStmt* expr_stmt = 
-    As<t_ExpressionStmt>(inner_body->statements[0].get());
-    if (!expr_stmt) return false;
-    
-    // Check if the expression is a binary assignment (+=, -=, *=, /=, %=)
-    t_BinaryExpr* binary_expr = 
-    As<t_BinaryExpr>(expr_stmt->expression.get());
-    if 
-    (
-        !binary_expr || 
+    t_CallExpr *call_expr = m_TailCall;
+    t_FunStmt *fun_stmt = call_expr->target;
+    m_TailCall = nullptr;
+    if (base + fun_stmt->frame_size > m_Stack.size())
+    {
+        return t_ErrorInfo
         (
-            binary_expr->op.type != e_TokenType::PLUS_EQUAL &&
-            binary_expr->op.type != e_TokenType::MINUS_EQUAL &&
-            binary_expr->op.type != e_TokenType::STAR_EQUAL &&
-            binary_expr->op.type != e_TokenType::SLASH_EQUAL &&
-            binary_expr->op.type != e_TokenType::MODULUS_EQUAL
-        )
-    ) return false;
-    
-    // Check if left side is a variable
-    t_VariableExpr* left_var = 
-    As<t_VariableExpr>(binary_expr->left.get());
-    if (!left_var) return false;
-    
-    // Check if right side is a binary expression with loop variables
-    t_BinaryExpr* right_binary = 
-    As<t_BinaryExpr>(binary_expr->right.get());
-    if (!right_binary) return false;
-    
-    // Get loop variable names
-    t_VarStmt* outer_init = 
-    As<t_VarStmt>(for_stmt->initializer.get());
-    
-    t_VarStmt* inner_init = 
-    As<t_VarStmt>(inner_for->initializer.get());
-    if (!outer_init || !inner_init) return false;
-    
-    std::string outer_var = outer_init->name;
-    std::string inner_var = inner_init->name;
-    
-    // Check if right side is arithmetic with loop variables (i + j, i - j, etc.)
-    t_VariableExpr* right_left_var = 
-    As<t_VariableExpr>(right_binary->left.get());
+            e_ErrorType::RUNTIME_ERROR,
+            "Stack overflow",
+            call_expr->line
+        );
+    }
 
-    t_VariableExpr* right_right_var = 
-    As<t_VariableExpr>(right_binary->right.get());
-    
-    if (!right_left_var || !right_right_var) return false;
-    
-    // Check if the binary expression uses loop variables
-    bool uses_outer = 
-    (
-        right_left_var->name == outer_var || 
-        right_right_var->name == outer_var
-    );
-    bool uses_inner = 
+    // The arguments sit right above the old frame, so moving them
+    // down never overwrites one that is still to be moved
+    std::copy_n
     (
-        right_left_var->name == inner_var || 
-        right_right_var->name == inner_var
+        m_Stack.begin() + static_cast<ptrdiff_t>(m_StackTop),
+        fun_stmt->parameters.size(),
+        m_Stack.begin() + static_cast<ptrdiff_t>(base)
     );
-    
-    // Must use at least one loop variable
-    if (!uses_outer && !uses_inner) return false;
-    
-    // Check if the operator is arithmetic (+, -, *, /, %)
-    e_TokenType op = right_binary->op.type;
-    if 
-    (
-        op != e_TokenType::PLUS &&
-        op != e_TokenType::MINUS &&
-        op != e_TokenType::STAR &&
-        op != e_TokenType::SLASH &&
-        op != e_TokenType::MODULUS
-    ) return false;
-    
-    return true;
+    m_StackTop = base + fun_stmt->frame_size;
+    m_Frames.back().function = fun_stmt;
+    m_LoopDepth = 0;
+    if (m_Stats)
+    {
+        // In place of the running frame, so no deeper
+        CountCall(m_Frames.size() - 1, m_StackTop);
+    }
+    return Expected<t_FunStmt*, t_ErrorInfo>(fun_stmt);
 }
 
-// Ultra-fast native execution for nested loops with arithmetic expressions
-Expected<int, t_ErrorInfo> Interpreter::ExecuteNestedArithmeticLoop
+Expected<bool, t_ErrorInfo> Interpreter::ExecuteLoopKernel
 (
     t_ForStmt* for_stmt
 )
 {
-    // Extract outer loop parameters
-    t_VarStmt* outer_init = 
-    As<t_VarStmt>(for_stmt->initializer.get());
-    t_BinaryExpr* outer_condition = 
-    As<t_BinaryExpr>(for_stmt->condition.get());
-    t_LiteralExpr* outer_limit_lit = 
-    As<t_LiteralExpr>(outer_condition->right.get());
-    
-    int outer_limit = static_cast<int>(std::stod(outer_limit_lit->value));
-    std::string outer_var = outer_init->name;
-    
-    // Extract inner loop parameters
-    t_BlockStmt* body_block = As<t_BlockStmt>(for_stmt->body.get());
-    t_ForStmt* inner_for = 
-    As<t_ForStmt>(body_block->statements[0].get());
-    
-    t_VarStmt* inner_init = 
-    As<t_VarStmt>(inner_for->initializer.get());
-    t_BinaryExpr* inner_condition = 
-    As<t_BinaryExpr>(inner_for->condition.get());
-    t_LiteralExpr* inner_limit_lit = 
-    As<t_LiteralExpr>(inner_condition->right.get());
-    
-    int inner_limit = static_cast<int>(std::stod(inner_limit_lit->value));
-    std::string inner_var = inner_init->name;
-    
-    // Extract accumulation variable and expression
-    t_BlockStmt* inner_body = As<t_BlockStmt>(inner_for->body.get());
-    t_ExpressionStmt* expr_stmt = 
-    As<t_ExpressionStmt>(inner_body->statements[0].get());
-    t_BinaryExpr* assign_expr = 
-    As<t_BinaryExpr>(expr_stmt->expression.get());
-    
-    t_VariableExpr* acc_var_expr = 
-    As<t_VariableExpr>(assign_expr->left.get());
-    std::string acc_var_name = acc_var_expr->name;
-    
-    t_BinaryExpr* arithmetic_expr = 
-    As<t_BinaryExpr>(assign_expr->right.get());
-    e_TokenType arithmetic_op = arithmetic_expr->op.type;
-    
-    t_VariableExpr* arith_left = 
-    As<t_VariableExpr>(arithmetic_expr->left.get());
-    t_VariableExpr* arith_right = 
-    As<t_VariableExpr>(arithmetic_expr->right.get());
-    
-    // Check if accumulation variable exists and get its initial value
-    auto acc_it = m_Environment.find(acc_var_name);
-    if (acc_it == m_Environment.end())
+    auto it = m_LoopKernels.find(for_stmt);
+    bool is_new = it == m_LoopKernels.end();
+    if (is_new)
     {
-        return t_ErrorInfo
+        it = m_LoopKernels.emplace
         (
-            e_ErrorType::RUNTIME_ERROR, 
-            "Variable '" + 
-            acc_var_name + 
-            "' must be declared with 'auto' keyword before use"
-        );
-    }
-    
-    // Get initial accumulator value
-    double accumulator = 0.0;
-    if (acc_it->second.has_numeric_value)
-    {
-        accumulator = acc_it->second.numeric_value;
+            for_stmt,
+            m_LoopCompiler.Compile(for_stmt)
+        ).first;
     }
-    else
+
+    const t_LoopKernel* kernel = it->second.get();
+    if (!kernel)
     {
-        try
+        if (m_Profiler)
         {
-            accumulator = std::stod(acc_it->second.value);
-        }
-        catch (...)
-        {
-            return t_ErrorInfo
+            // Compiled once, so the reason is only known right here
+            m_Profiler->LoopFellBack
             (
-                e_ErrorType::RUNTIME_ERROR, 
-                "Variable '" + acc_var_name + "' must be numeric for accumulation"
+                for_stmt, 
+                is_new ? m_LoopCompiler.FailureReason() : ""
             );
         }
+        if (m_Stats)
+        {
+            m_Stats->general_loops++;
+        }
+        return Expected<bool, t_ErrorInfo>(false);
     }
-    
-    // NATIVE C++ NESTED LOOP: Direct arithmetic without interpretation overhead
-    e_TokenType assign_op = assign_expr->op.type;
-    
-    for (int i = 0; i < outer_limit; i++)
+
+    // Guard: every outside variable must hold a number right now
+    m_KernelRegisters = kernel->registers;
+    for (const t_KernelVariable& variable : kernel->variables)
     {
-        for (int j = 0; j < inner_limit; j++)
+        t_Value* value = FindVariable(variable.binding);
+        if (!value || !value->IsNumber())
         {
-            // Compute the arithmetic expression value
-            double left_val = 0.0;
-            double right_val = 0.0;
-            
-            if (arith_left->name == outer_var)
-            {
-                left_val = static_cast<double>(i);
-            }
-            else if (arith_left->name == inner_var)
-            {
-                left_val = static_cast<double>(j);
-            }
-            else
-            {
-                // Should not happen if IsNestedArithmeticLoop passed
-                left_val = 0.0;
-            }
-            
-            if (arith_right->name == outer_var)
-            {
-                right_val = static_cast<double>(i);
-            }
-            else if (arith_right->name == inner_var)
-            {
-                right_val = static_cast<double>(j);
-            }
-            else
-            {
-                // Should not happen if IsNestedArithmeticLoop passed
-                right_val = 0.0;
-            }
-            
-            // Compute arithmetic result
-            double arith_result = 0.0;
-            switch (arithmetic_op)
+            if (m_Profiler)
             {
-            case e_TokenType::PLUS:
-                arith_result = left_val + right_val;
-                break;
-            case e_TokenType::MINUS:
-                arith_result = left_val - right_val;
-                break;
-            case e_TokenType::STAR:
-                arith_result = left_val * right_val;
-                break;
-            case e_TokenType::SLASH:
-                if (right_val == 0.0)
-                {
-                    return t_ErrorInfo
-                    (
-                        e_ErrorType::RUNTIME_ERROR, 
-                        "Division by zero"
-                    );
-                }
-                arith_result = left_val / right_val;
-                break;
-            case e_TokenType::MODULUS:
-                if (right_val == 0.0)
-                {
-                    return t_ErrorInfo
-                    (
-                        e_ErrorType::RUNTIME_ERROR, 
-                        "Modulus by zero"
-                    );
-                }
-                arith_result = std::fmod(left_val, right_val);
-                break;
-            default:
-                return t_ErrorInfo
+                m_Profiler->LoopFellBack
                 (
-                    e_ErrorType::RUNTIME_ERROR, 
-                    "Unsupported arithmetic operation in optimized loop"
+                    for_stmt,
+                    "'" + SymbolName(variable.name) +
+                    "' did not hold a number when the loop started"
                 );
             }
-            
-            // Apply assignment operation
-            switch (assign_op)
+            if (m_Stats)
             {
-            case e_TokenType::PLUS_EQUAL:
-                accumulator += arith_result;
-                break;
-            case e_TokenType::MINUS_EQUAL:
-                accumulator -= arith_result;
-                break;
-            case e_TokenType::STAR_EQUAL:
-                accumulator *= arith_result;
-                break;
-            case e_TokenType::SLASH_EQUAL:
-                if (arith_result == 0.0)
-                {
-                    return t_ErrorInfo
-                    (
-                        e_ErrorType::RUNTIME_ERROR, 
-                        "Division by zero"
-                    );
-                }
-                accumulator /= arith_result;
-                break;
-            case e_TokenType::MODULUS_EQUAL:
-                if (arith_result == 0.0)
-                {
-                    return t_ErrorInfo
-                    (
-                        e_ErrorType::RUNTIME_ERROR, 
-                        "Modulus by zero"
-                    );
-                }
-                accumulator = std::fmod(accumulator, arith_result);
-                break;
-            default:
-                return t_ErrorInfo
-                (
-                    e_ErrorType::RUNTIME_ERROR, 
-                    "Unsupported assignment operation in optimized loop"
-                );
+                m_Stats->general_loops++;
             }
+            return Expected<bool, t_ErrorInfo>(false);
         }
+        m_KernelRegisters[variable.reg] = value->number;
     }
-    
-    // Update the accumulation variable with the result
-    m_Environment[acc_var_name] = t_TypedValue(accumulator);
-    
-    return Expected<int, t_ErrorInfo>(0);
-}
-
-Expected<int, t_ErrorInfo> Interpreter::ExecuteSimpleNumericLoop
-(
-    t_ForStmt* for_stmt
-)
-{
-    // Store variables that existed before the loop
-    std::unordered_set<std::string_view> pre_loop_variables;
-    pre_loop_variables.reserve(m_Environment.size());
 
-    for(auto&& [key, _] : m_Environment)
+    if (m_Profiler)
     {
-        pre_loop_variables.insert(key);
+        m_Profiler->LoopUsedKernel(for_stmt);
     }
-    
-    // Push a new scope for the loop
-    PushScope();
-    m_LoopDepth++;
-    
-    // Extract loop parameters
-    t_VarStmt* init_var = As<t_VarStmt>
-    (
-        for_stmt->initializer.get()
-    );
-    t_LiteralExpr* init_literal =
-    As<t_LiteralExpr>(init_var->initializer.get());
-
-    t_BinaryExpr* condition_binary = 
-    As<t_BinaryExpr>(for_stmt->condition.get());
-
-    t_LiteralExpr* condition_literal = 
-    As<t_LiteralExpr>(condition_binary->right.get());
-
-    int start = static_cast<int>(std::stod(init_literal->value));
-    int limit = static_cast<int>(std::stod(condition_literal->value));
-    e_TokenType condition_op = condition_binary->op.type;
-
-    int step = 1;
-    if 
-    (
-        t_PostfixExpr* postfix_inc = 
-        As<t_PostfixExpr>(for_stmt->increment.get())
-    )
+    if (m_Stats)
     {
-        step = (postfix_inc->op.type == e_TokenType::PLUS_PLUS) ? 1 : -1;
+        CountKernelLoop(*kernel, *m_Stats);
     }
-    else if 
-    (
-        t_PrefixExpr* prefix_inc = 
-        As<t_PrefixExpr>(for_stmt->increment.get())
-    )
+
+    Expected<int, t_ErrorInfo> result = 
+    RunLoopKernel(*kernel, m_KernelRegisters.data());
+
+    // Stored even on error, the generic path would have done the same
+    for (const t_KernelVariable& variable : kernel->variables)
     {
-        step = (prefix_inc->op.type == e_TokenType::PLUS_PLUS) ? 1 : -1;
+        if (variable.is_written)
+        {
+            *FindVariable(variable.binding) = 
+            t_Value(m_KernelRegisters[variable.reg]);
+        }
     }
-    else if 
-    (
-        t_BinaryExpr* assign = 
-        As<t_BinaryExpr>(for_stmt->increment.get())
-    )
+
+    if (!result)
     {
-        t_LiteralExpr* rhs = As<t_LiteralExpr>(assign->right.get());
-        int rhs_int = static_cast<int>(std::stod(rhs->value));
-        step = 
-        (
-            assign->op.type == e_TokenType::PLUS_EQUAL
-        ) ? rhs_int : -rhs_int;
+        return result.Error();
     }
+    return Expected<bool, t_ErrorInfo>(true);
+}
 
-    std::string loop_var_name = init_var->name;
-
-    bool use_fast_break_optimization = false;
-    int break_at_value = -1;
-
-    bool allow_break_optimization =
-    (
-        start == 0                  &&
-        step == 1                   &&
-        condition_op == e_TokenType::LESS
-    );
+Expected<bool, t_ErrorInfo> Interpreter::ExecuteParallelLoop
+(
+    t_ForStmt* for_stmt
+)
+{
+    const t_ParallelLoop& loop = *for_stmt->parallel;
 
-    t_BlockStmt* body_block = As<t_BlockStmt>(for_stmt->body.get());
-    if 
-    (
-        allow_break_optimization && 
-        body_block               &&
-        body_block->statements.size() == 1
-    )
+    // The same guard as a sequential kernel
+    m_KernelRegisters = loop.kernel.registers;
+    for (const t_KernelVariable& variable : loop.kernel.variables)
     {
-        t_IfStmt* if_stmt = As<t_IfStmt>
-        (
-            body_block->statements[0].get()
-        );
-        if (if_stmt && !if_stmt->else_branch)
+        t_Value* value = FindVariable(variable.binding);
+        if (!value || !value->IsNumber())
         {
-            bool then_is_break = false;
-
-            if (As<t_BreakStmt>(if_stmt->then_branch.get()))
+            if (m_Profiler)
             {
-                then_is_break = true;
-            }
-            else if 
-            (
-                t_BlockStmt* then_block = 
-                As<t_BlockStmt>(if_stmt->then_branch.get())
-            )
-            {
-                if (then_block->statements.size() == 1)
-                {
-                    if 
-                    (
-                        As<t_BreakStmt>
-                        (
-                            then_block->statements[0].get()
-                        )
-                    )
-                    {
-                        then_is_break = true;
-                    }
-                }
-            }
-
-            if (then_is_break)
-            {
-                t_BinaryExpr* cond_binary = 
-                As<t_BinaryExpr>(if_stmt->condition.get());
-
-                if 
+                m_Profiler->LoopFellBack
                 (
-                    cond_binary && 
-                    cond_binary->op.type == e_TokenType::EQUAL_EQUAL
-                )
-                {
-                    t_VariableExpr* cond_var = 
-                    As<t_VariableExpr>(cond_binary->left.get());
-                    t_LiteralExpr* cond_lit = 
-                    As<t_LiteralExpr>(cond_binary->right.get());
-
-                    if (!cond_var || !cond_lit)
-                    {
-                        cond_var = 
-                        As<t_VariableExpr>(cond_binary->right.get());
-
-                        cond_lit = 
-                        As<t_LiteralExpr>(cond_binary->left.get());
-                    }
-
-                    if 
-                    (
-                        cond_var && 
-                        cond_lit && 
-                        cond_var->name == loop_var_name
-                    )
-                    {
-                        try
-                        {
-                            double raw_value = std::stod(cond_lit->value);
-                            int int_value = static_cast<int>(raw_value);
-                            if (raw_value == static_cast<double>(int_value))
-                            {
-                                break_at_value = int_value;
-                                use_fast_break_optimization = true;
-                            }
-                        }
-                        catch (...) {}
-                    }
-                }
+                    for_stmt,
+                    "'" + SymbolName(variable.name) +
+                    "' did not hold a number when the loop started"
+                );
             }
+            return Expected<bool, t_ErrorInfo>(false);
         }
+        m_KernelRegisters[variable.reg] = value->number;
     }
 
-    // Execute the loop with direct numeric operations
-    // Manually control the loop to properly handle continue statements
-    if (!use_fast_break_optimization)
+    if (m_Profiler)
     {
-        auto ConditionHolds =
-        [condition_op, limit](int i) -> bool
-        {
-            switch (condition_op)
-            {
-            case e_TokenType::LESS:
-                return i < limit;
-
-            case e_TokenType::LESS_EQUAL:
-                return i <= limit;
-
-            case e_TokenType::GREATER:
-                return i > limit;
-
-            case e_TokenType::GREATER_EQUAL:
-                return i >= limit;
-
-            default:
-                return false;
-            }
-        };
-
-        for (int i = start; ConditionHolds(i);)
-        {
-            // Set loop variable directly as integer
-            m_Environment[loop_var_name] = t_TypedValue(static_cast<double>(i));
-            
-            // Execute body
-            m_ControlSignal.clear();
-            Expected<int, t_ErrorInfo> body_result = 
-            Execute(for_stmt->body.get());
-
-            if (!body_result)
-            {
-                PopScope(); // Clean up scope before returning
-                m_LoopDepth--;
-                return body_result;
-            }
-            if (m_ControlSignal == "break")
-            {
-                m_ControlSignal.clear();
-                break;
-            }
-            if (m_ControlSignal == "continue")
-            {
-                m_ControlSignal.clear();
-                // Skip increment and go to next iteration when continue is encountered
-                i += step;
-                continue;
-            }
-            
-            // If we're returning from a function, stop the loop and propagate the return
-            if (m_IsReturning)
-            {
-                PopScope();
-                m_LoopDepth--;
-                return Expected<int, t_ErrorInfo>(0);
-            }
-            
-            // Only increment if no control signal was encountered
-            i += step;
-        }
+        m_Profiler->LoopUsedKernel(for_stmt);
     }
-    else
+    if (m_Stats)
     {
-        int final_i = 0;
-        if (break_at_value >= 0 && break_at_value < limit)
-        {
-            final_i = break_at_value;
-        }
-        else if (limit > 0)
-        {
-            final_i = limit - 1;
-        }
-
-        m_ControlSignal.clear();
-        m_Environment[loop_var_name] = t_TypedValue
-        (
-            static_cast<double>(final_i)
-        );
+        m_Stats->parallel_loops++;
     }
 
-    // Before popping scope, preserve modifications to pre-existing variables
-    std::unordered_map<std::string, t_TypedValue> modified_pre_existing;
-    modified_pre_existing.reserve(pre_loop_variables.size());
-    for (auto&& [key, value] : m_Environment)
+    Expected<int, t_ErrorInfo> result = 
+    RunParallelLoop(loop, m_KernelRegisters.data());
+    if (!result)
     {
-        if (pre_loop_variables.contains(key))
-        {
-            modified_pre_existing.try_emplace(key, value);
-        }
+        // The iteration that failed is not known, only its loop
+        t_ErrorInfo error = result.Error();
+        error.line = for_stmt->line;
+        return error;
     }
 
-    // Pop the loop scope
-    PopScope();
-    
-    // Restore the modified values of pre-existing variables
-    for (auto&& [key, value] : modified_pre_existing)
+    for (const t_KernelReduction& reduction : loop.reductions)
     {
-        m_Environment.try_emplace(key, value);
+        const t_KernelVariable& variable = 
+        loop.kernel.variables[reduction.variable];
+        *FindVariable(variable.binding) = 
+        t_Value(m_KernelRegisters[variable.reg]);
     }
-    m_LoopDepth--;
-    
-    return Expected<int, t_ErrorInfo>(0); 
-}
\ No newline at end of file
+    return Expected<bool, t_ErrorInfo>(true);
+}
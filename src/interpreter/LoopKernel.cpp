@@ -0,0 +1,1263 @@
+#include <rubberduck/LoopKernel.h>
+#include <rubberduck/Value.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace
+{
+    uint64_t BindingKey(const t_Binding& binding)
+    {
+        return (static_cast<uint64_t>(binding.kind) << 32) | binding.slot;
+    }
+
+    e_KernelOp ComparisonJump(e_TokenType type, bool jump_when)
+    {
+        switch (type)
+        {
+        case e_TokenType::LESS:
+            return jump_when ? e_KernelOp::JUMP_LT : e_KernelOp::JUMP_NLT;
+        case e_TokenType::LESS_EQUAL:
+            return jump_when ? e_KernelOp::JUMP_LE : e_KernelOp::JUMP_NLE;
+        case e_TokenType::GREATER:
+            return jump_when ? e_KernelOp::JUMP_GT : e_KernelOp::JUMP_NGT;
+        case e_TokenType::GREATER_EQUAL:
+            return jump_when ? e_KernelOp::JUMP_GE : e_KernelOp::JUMP_NGE;
+        case e_TokenType::EQUAL_EQUAL:
+            return jump_when ? e_KernelOp::JUMP_EQ : e_KernelOp::JUMP_NE;
+        default:
+            return jump_when ? e_KernelOp::JUMP_NE : e_KernelOp::JUMP_EQ;
+        }
+    }
+
+    bool IsJump(e_KernelOp op)
+    {
+        return op >= e_KernelOp::JUMP && op <= e_KernelOp::JUMP_NGE;
+    }
+
+    const char* UnsupportedStatement(const t_Stmt *stmt)
+    {
+        switch (stmt->kind)
+        {
+        case e_StmtKind::DISPLAY:
+            return "displays output";
+        case e_StmtKind::GETIN:
+            return "reads input";
+        case e_StmtKind::RETURN:
+            return "returns from a function";
+        case e_StmtKind::BENCHMARK:
+            return "contains a benchmark";
+        default:
+            return "contains a statement the kernel cannot run";
+        }
+    }
+
+    // What the increment of a counted loop adds to its variable
+    double LoopStep(t_Expr *increment)
+    {
+        e_TokenType op = e_TokenType::PLUS_PLUS;
+        if (t_PrefixExpr *prefix = As<t_PrefixExpr>(increment))
+        {
+            op = prefix->op.type;
+        }
+        else if (t_PostfixExpr *postfix = As<t_PostfixExpr>(increment))
+        {
+            op = postfix->op.type;
+        }
+        else if (t_BinaryExpr *binary = As<t_BinaryExpr>(increment))
+        {
+            double amount = As<t_LiteralExpr>(binary->right.get())->number;
+            return binary->op.type == e_TokenType::MINUS_EQUAL
+                ? -amount
+                : amount;
+        }
+        return op == e_TokenType::PLUS_PLUS ? 1.0 : -1.0;
+    }
+
+    // The registers an instruction reads or writes; a jump target is
+    // not a register
+    bool UsesRegister(const t_KernelInstr& instr, uint32_t reg)
+    {
+        switch (instr.op)
+        {
+        case e_KernelOp::JUMP:
+        case e_KernelOp::HALT:
+            return false;
+        case e_KernelOp::MOVE:
+        case e_KernelOp::NEGATE:
+            return instr.a == reg || instr.b == reg;
+        case e_KernelOp::VECTOR_LOOP:
+            return instr.b == reg || instr.c == reg;
+        default:
+            if (IsJump(instr.op))
+            {
+                return instr.b == reg || instr.c == reg;
+            }
+            return instr.a == reg || instr.b == reg || instr.c == reg;
+        }
+    }
+
+    // Whether `instr` is `reg = reg + x`, `reg = x * reg` and the like,
+    // and which reduction it belongs to (subtracting is adding)
+    bool IsReductionStep
+    (
+        const t_KernelInstr& instr,
+        uint32_t reg,
+        e_KernelOp& family
+    )
+    {
+        if (instr.a != reg || (instr.b == reg) == (instr.c == reg))
+        {
+            return false;
+        }
+        switch (instr.op)
+        {
+        case e_KernelOp::ADD:
+            family = e_KernelOp::ADD;
+            return true;
+        case e_KernelOp::SUBTRACT:
+            family = e_KernelOp::ADD;
+            return instr.b == reg;
+        case e_KernelOp::MULTIPLY:
+            family = e_KernelOp::MULTIPLY;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool HasThirdOperand(e_KernelOp op)
+    {
+        return op != e_KernelOp::MOVE && op != e_KernelOp::NEGATE;
+    }
+
+    // The lane of a vector loop that holds `reg`, added on first use
+    uint32_t LaneOf
+    (
+        t_VectorLoop& loop,
+        std::vector<uint32_t>& lanes,
+        uint32_t reg
+    )
+    {
+        if (lanes[reg] == UINT32_MAX)
+        {
+            lanes[reg] = static_cast<uint32_t>(loop.lane_regs.size());
+            loop.lane_regs.push_back(reg);
+        }
+        return lanes[reg];
+    }
+}
+
+LoopCompiler::LoopCompiler()
+    : m_Kernel(nullptr),
+      m_Failed(false),
+      m_FailureReason("") {}
+
+void LoopCompiler::Reset(t_LoopKernel *kernel)
+{
+    m_Kernel = kernel;
+    m_VariableRegs.clear();
+    m_ConstantRegs.clear();
+    m_Declared.clear();
+    m_IsTemporary.clear();
+    m_Loops.clear();
+    m_Failed = false;
+    m_FailureReason = "";
+}
+
+std::unique_ptr<t_LoopKernel> LoopCompiler::Compile(t_ForStmt *for_stmt)
+{
+    std::unique_ptr<t_LoopKernel> kernel = std::make_unique<t_LoopKernel>();
+    Reset(kernel.get());
+
+    CompileLoop(for_stmt);
+    Emit(e_KernelOp::HALT, 0);
+
+    m_Kernel = nullptr;
+    if (m_Failed)
+    {
+        return nullptr;
+    }
+    return kernel;
+}
+
+std::unique_ptr<t_ParallelLoop> LoopCompiler::CompileParallel
+(
+    t_ForStmt *for_stmt
+)
+{
+    std::unique_ptr<t_ParallelLoop> loop =
+    std::make_unique<t_ParallelLoop>();
+    Reset(&loop->kernel);
+
+    // The Parser made sure the loop counts from an int literal to an
+    // int literal in constant steps
+    t_VarStmt *counter_stmt = As<t_VarStmt>(for_stmt->initializer.get());
+    t_BinaryExpr *condition = As<t_BinaryExpr>(for_stmt->condition.get());
+    loop->first =
+    As<t_LiteralExpr>(counter_stmt->initializer.get())->number;
+    loop->step = LoopStep(for_stmt->increment.get());
+    e_TokenType op = condition->op.type;
+    bool counts_up = op == e_TokenType::LESS ||
+                     op == e_TokenType::LESS_EQUAL;
+    bool inclusive = op == e_TokenType::LESS_EQUAL ||
+                     op == e_TokenType::GREATER_EQUAL;
+    if
+    (
+        !LoopTripCount
+        (
+            loop->first,
+            As<t_LiteralExpr>(condition->right.get())->number,
+            loop->step,
+            counts_up,
+            inclusive,
+            loop->trip_count
+        )
+    )
+    {
+        Fail("does not count towards its bound");
+        m_Kernel = nullptr;
+        return nullptr;
+    }
+
+    // One chunk: for (i = start; i < end; i += step), or `>` when
+    // counting down, so a chunk never depends on the bound literal
+    uint32_t counter = DeclaredRegister(counter_stmt);
+    loop->start_reg = NewRegister();
+    loop->end_reg = NewRegister();
+    m_IsTemporary[loop->start_reg] = 0;
+    m_IsTemporary[loop->end_reg] = 0;
+    Emit(e_KernelOp::MOVE, counter, loop->start_reg);
+
+    size_t loop_start = m_Kernel->code.size();
+    size_t exit_jump = Emit
+    (
+        loop->step > 0 ? e_KernelOp::JUMP_NLT : e_KernelOp::JUMP_NGT,
+        0,
+        counter,
+        loop->end_reg
+    );
+
+    m_Loops.emplace_back();
+    size_t body_start = m_Kernel->code.size();
+    CompileStatement(for_stmt->body.get());
+    size_t body_end = m_Kernel->code.size();
+    if (!m_Failed && !m_Loops.back().break_jumps.empty())
+    {
+        Fail("breaks out of the loop");
+    }
+
+    PatchJumps(m_Loops.back().continue_jumps, m_Kernel->code.size());
+    CompileEffect(for_stmt->increment.get());
+    Emit(e_KernelOp::JUMP, static_cast<uint32_t>(loop_start));
+    PatchJumps({exit_jump}, m_Kernel->code.size());
+    m_Loops.pop_back();
+    Emit(e_KernelOp::HALT, 0);
+
+    if (!m_Failed)
+    {
+        CheckIndependence(*loop, counter, body_start, body_end);
+    }
+
+    m_Kernel = nullptr;
+    if (m_Failed)
+    {
+        return nullptr;
+    }
+    return loop;
+}
+
+void LoopCompiler::CheckIndependence
+(
+    t_ParallelLoop &loop,
+    uint32_t counter,
+    size_t body_start,
+    size_t body_end
+)
+{
+    const std::vector<t_KernelInstr>& code = loop.kernel.code;
+    for (size_t pc = body_start; pc < body_end; ++pc)
+    {
+        e_KernelOp op = code[pc].op;
+        uint32_t target =
+        op == e_KernelOp::VECTOR_LOOP ? code[pc].b : code[pc].a;
+        if (!IsJump(op) && target == counter)
+        {
+            Fail("assigns to its loop variable");
+            return;
+        }
+    }
+
+    // Anything but `x += ...` on a written outside variable would let
+    // one iteration see what another one did
+    for (size_t i = 0; i < loop.kernel.variables.size(); ++i)
+    {
+        const t_KernelVariable& variable = loop.kernel.variables[i];
+        if (!variable.is_written)
+        {
+            continue;
+        }
+
+        bool has_family = false;
+        e_KernelOp family = e_KernelOp::ADD;
+        for (const t_KernelInstr& instr : code)
+        {
+            if (!UsesRegister(instr, variable.reg))
+            {
+                continue;
+            }
+            e_KernelOp step_family = e_KernelOp::ADD;
+            if
+            (
+                !IsReductionStep(instr, variable.reg, step_family) ||
+                (has_family && step_family != family)
+            )
+            {
+                Fail
+                (
+                    "uses an outside variable other than as a sum or a "
+                    "product"
+                );
+                return;
+            }
+            family = step_family;
+            has_family = true;
+        }
+        loop.reductions.push_back
+        (
+            t_KernelReduction{static_cast<uint32_t>(i), family}
+        );
+    }
+}
+
+void LoopCompiler::Fail(const char *reason)
+{
+    // The first reason is the one worth reporting
+    if (!m_Failed)
+    {
+        m_FailureReason = reason;
+    }
+    m_Failed = true;
+}
+
+const char* LoopCompiler::FailureReason() const
+{
+    return m_FailureReason;
+}
+
+uint32_t LoopCompiler::NewRegister()
+{
+    m_Kernel->registers.push_back(0.0);
+    m_IsTemporary.push_back(1);
+    return static_cast<uint32_t>(m_Kernel->registers.size() - 1);
+}
+
+uint32_t LoopCompiler::ConstantRegister(double value)
+{
+    uint64_t key = std::bit_cast<uint64_t>(value);
+    auto it = m_ConstantRegs.find(key);
+    if (it != m_ConstantRegs.end())
+    {
+        return it->second;
+    }
+
+    uint32_t reg = NewRegister();
+    m_Kernel->registers[reg] = value;
+    m_IsTemporary[reg] = 0;
+    m_ConstantRegs.emplace(key, reg);
+    return reg;
+}
+
+uint32_t LoopCompiler::VariableRegister(const t_VariableExpr *variable)
+{
+    if (variable->binding.kind == e_BindingKind::UNRESOLVED)
+    {
+        Fail("reads an unresolved variable");
+        return 0;
+    }
+
+    uint64_t key = BindingKey(variable->binding);
+    auto it = m_VariableRegs.find(key);
+    if (it != m_VariableRegs.end())
+    {
+        return it->second;
+    }
+
+    // First use of a variable declared outside the loop
+    uint32_t reg = NewRegister();
+    m_IsTemporary[reg] = 0;
+    m_VariableRegs.emplace(key, reg);
+    m_Kernel->variables.push_back
+    (
+        t_KernelVariable{variable->binding, variable->name, reg, false}
+    );
+    return reg;
+}
+
+uint32_t LoopCompiler::DeclaredRegister(const t_VarStmt *var_stmt)
+{
+    uint64_t key = BindingKey(var_stmt->binding);
+    auto it = m_VariableRegs.find(key);
+    if (it != m_VariableRegs.end())
+    {
+        // Sibling blocks reuse slots, but an outside variable never
+        // shares a slot with a declaration inside the loop
+        if
+        (
+            std::find(m_Declared.begin(), m_Declared.end(), key) ==
+            m_Declared.end()
+        )
+        {
+            Fail("reuses the slot of an outside variable");
+        }
+        return it->second;
+    }
+
+    uint32_t reg = NewRegister();
+    m_IsTemporary[reg] = 0;
+    m_VariableRegs.emplace(key, reg);
+    m_Declared.push_back(key);
+    return reg;
+}
+
+size_t LoopCompiler::Emit(e_KernelOp op, uint32_t a, uint32_t b, uint32_t c)
+{
+    m_Kernel->code.push_back(t_KernelInstr{op, a, b, c});
+    return m_Kernel->code.size() - 1;
+}
+
+void LoopCompiler::PatchJumps(const std::vector<size_t>& jumps, size_t target)
+{
+    for (size_t jump : jumps)
+    {
+        m_Kernel->code[jump].a = static_cast<uint32_t>(target);
+    }
+}
+
+void LoopCompiler::MoveInto(uint32_t target, uint32_t value)
+{
+    if (target == value)
+    {
+        return;
+    }
+
+    // Let the instruction that produced a temporary write the target
+    // directly instead of copying it afterwards
+    std::vector<t_KernelInstr>& code = m_Kernel->code;
+    if
+    (
+        m_IsTemporary[value]     &&
+        !code.empty()            &&
+        code.back().a == value   &&
+        !IsJump(code.back().op)  &&
+        code.back().op != e_KernelOp::VECTOR_LOOP &&
+        code.back().op != e_KernelOp::HALT
+    )
+    {
+        code.back().a = target;
+        return;
+    }
+    Emit(e_KernelOp::MOVE, target, value);
+}
+
+void LoopCompiler::CompileStore(t_VariableExpr *target, uint32_t value)
+{
+    if (target->binding.is_const)
+    {
+        Fail("assigns to a constant");
+        return;
+    }
+
+    uint32_t reg = VariableRegister(target);
+    for (t_KernelVariable& variable : m_Kernel->variables)
+    {
+        if (variable.reg == reg)
+        {
+            variable.is_written = true;
+        }
+    }
+    MoveInto(reg, value);
+}
+
+void LoopCompiler::CompileLoop(t_ForStmt *for_stmt)
+{
+    if (for_stmt->initializer)
+    {
+        CompileStatement(for_stmt->initializer.get());
+    }
+
+    size_t loop_start = m_Kernel->code.size();
+    std::vector<size_t> exit_jumps;
+    if (for_stmt->condition)
+    {
+        CompileCondition(for_stmt->condition.get(), false, exit_jumps);
+    }
+
+    m_Loops.emplace_back();
+    CompileStatement(for_stmt->body.get());
+    if (m_Failed)
+    {
+        return;
+    }
+
+    // `continue` still runs the increment
+    PatchJumps(m_Loops.back().continue_jumps, m_Kernel->code.size());
+    if (for_stmt->increment)
+    {
+        CompileEffect(for_stmt->increment.get());
+    }
+    Emit(e_KernelOp::JUMP, static_cast<uint32_t>(loop_start));
+
+    size_t loop_end = m_Kernel->code.size();
+    PatchJumps(exit_jumps, loop_end);
+    PatchJumps(m_Loops.back().break_jumps, loop_end);
+    m_Loops.pop_back();
+
+    if (for_stmt->initializer && !m_StrictFloatingPoint)
+    {
+        Vectorize(loop_start, loop_end);
+    }
+}
+
+void LoopCompiler::Vectorize(size_t loop_start, size_t loop_end)
+{
+    // The shape in the comment on t_VectorLoop, nothing else
+    std::vector<t_KernelInstr>& code = m_Kernel->code;
+    if (m_Failed || loop_start == 0 || loop_end < loop_start + 3)
+    {
+        return;
+    }
+    const t_KernelInstr& init = code[loop_start - 1];
+    const t_KernelInstr& exit = code[loop_start];
+    const t_KernelInstr& increment = code[loop_end - 2];
+    uint32_t counter = exit.b;
+    if
+    (
+        init.op != e_KernelOp::MOVE ||
+        init.a != counter ||
+        exit.op < e_KernelOp::JUMP_NLT ||
+        exit.op > e_KernelOp::JUMP_NGE ||
+        exit.a != loop_end ||
+        (
+            increment.op != e_KernelOp::ADD &&
+            increment.op != e_KernelOp::SUBTRACT
+        ) ||
+        increment.a != counter ||
+        increment.b != counter ||
+        m_IsTemporary[increment.c] ||
+        code[loop_end - 1].op != e_KernelOp::JUMP ||
+        code[loop_end - 1].a != loop_start
+    )
+    {
+        return;
+    }
+
+    size_t body_start = loop_start + 1;
+    size_t body_end = loop_end - 2;
+    for (size_t pc = body_start; pc < body_end; ++pc)
+    {
+        const t_KernelInstr& instr = code[pc];
+        if
+        (
+            IsJump(instr.op) ||
+            instr.op == e_KernelOp::VECTOR_LOOP ||
+            instr.op == e_KernelOp::HALT ||
+            instr.a == counter ||
+            instr.a == exit.c ||
+            instr.a == increment.c
+        )
+        {
+            return;
+        }
+    }
+
+    t_VectorLoop loop;
+    loop.exit_op = exit.op;
+    loop.counter = counter;
+    loop.bound = exit.c;
+    loop.step = increment.c;
+    loop.step_negated = increment.op == e_KernelOp::SUBTRACT;
+    loop.has_division = false;
+
+    // Every register the body writes is either private to an
+    // iteration (written before it is read) or a sum or a product
+    size_t register_count = m_Kernel->registers.size();
+    std::vector<uint8_t> is_read(register_count, 0);
+    std::vector<uint8_t> is_written(register_count, 0);
+    std::vector<uint8_t> is_private(register_count, 0);
+    for (size_t pc = body_start; pc < body_end; ++pc)
+    {
+        const t_KernelInstr& instr = code[pc];
+        is_read[instr.b] = 1;
+        if (HasThirdOperand(instr.op))
+        {
+            is_read[instr.c] = 1;
+        }
+        if (!is_written[instr.a] && !is_read[instr.a])
+        {
+            is_private[instr.a] = 1;
+        }
+        is_written[instr.a] = 1;
+        loop.has_division = loop.has_division ||
+                            instr.op == e_KernelOp::DIVIDE ||
+                            instr.op == e_KernelOp::MODULO;
+    }
+
+    std::vector<uint32_t> lanes(register_count, UINT32_MAX);
+    loop.counter_lane = LaneOf(loop, lanes, counter);
+
+    for (uint32_t reg = 0; reg < is_written.size(); ++reg)
+    {
+        if (!is_written[reg] || is_private[reg])
+        {
+            continue;
+        }
+        bool has_family = false;
+        e_KernelOp family = e_KernelOp::ADD;
+        for (size_t pc = body_start; pc < body_end; ++pc)
+        {
+            if (!UsesRegister(code[pc], reg))
+            {
+                continue;
+            }
+            e_KernelOp step_family = e_KernelOp::ADD;
+            if
+            (
+                !IsReductionStep(code[pc], reg, step_family) ||
+                (has_family && step_family != family)
+            )
+            {
+                return;
+            }
+            family = step_family;
+            has_family = true;
+        }
+        loop.reductions.push_back
+        (
+            t_VectorReduction{LaneOf(loop, lanes, reg), family}
+        );
+    }
+
+    // A closed form needs every addend to be linear in the loop
+    // variable: degree 0 is invariant, 1 linear, 2 anything else
+    std::vector<uint8_t> degree(register_count, 0);
+    degree[counter] = 1;
+    bool is_closed_form = !loop.has_division;
+    for (size_t pc = body_start; pc < body_end && is_closed_form; ++pc)
+    {
+        const t_KernelInstr& instr = code[pc];
+        e_KernelOp family = e_KernelOp::ADD;
+        if
+        (
+            !is_private[instr.a] &&
+            IsReductionStep(instr, instr.a, family)
+        )
+        {
+            uint32_t addend = instr.b == instr.a ? instr.c : instr.b;
+            uint8_t limit = family == e_KernelOp::MULTIPLY ? 0 : 1;
+            is_closed_form = degree[addend] <= limit;
+            continue;
+        }
+        switch (instr.op)
+        {
+        case e_KernelOp::MOVE:
+        case e_KernelOp::NEGATE:
+            degree[instr.a] = degree[instr.b];
+            break;
+        case e_KernelOp::MULTIPLY:
+            degree[instr.a] = static_cast<uint8_t>
+            (
+                std::min(2, degree[instr.b] + degree[instr.c])
+            );
+            break;
+        default:
+            degree[instr.a] = std::max(degree[instr.b], degree[instr.c]);
+            break;
+        }
+    }
+    loop.is_closed_form = is_closed_form;
+
+    for (size_t pc = body_start; pc < body_end; ++pc)
+    {
+        t_KernelInstr instr = code[pc];
+        instr.b = LaneOf(loop, lanes, instr.b);
+        if (HasThirdOperand(instr.op))
+        {
+            instr.c = LaneOf(loop, lanes, instr.c);
+        }
+        instr.a = LaneOf(loop, lanes, instr.a);
+        loop.body.push_back(instr);
+    }
+    if (loop.lane_regs.size() > t_VectorLoop::MAX_LANES)
+    {
+        return;
+    }
+
+    uint32_t first = init.b;
+    code[loop_start - 1] = t_KernelInstr
+    {
+        e_KernelOp::VECTOR_LOOP,
+        static_cast<uint32_t>(m_Kernel->vector_loops.size()),
+        counter,
+        first
+    };
+    m_Kernel->vector_loops.push_back(std::move(loop));
+}
+
+void LoopCompiler::CompileStatement(t_Stmt *stmt)
+{
+    if (m_Failed || !stmt)
+    {
+        return;
+    }
+
+    if (t_BlockStmt *block = As<t_BlockStmt>(stmt))
+    {
+        for (const auto &statement : block->statements)
+        {
+            CompileStatement(statement.get());
+        }
+    }
+    else if (t_ExpressionStmt *expr_stmt = As<t_ExpressionStmt>(stmt))
+    {
+        CompileEffect(expr_stmt->expression.get());
+    }
+    else if (t_VarStmt *var_stmt = As<t_VarStmt>(stmt))
+    {
+        // A declaration without a value would hold nil
+        if (var_stmt->is_redeclaration || !var_stmt->initializer)
+        {
+            Fail("declares a variable without a value");
+            return;
+        }
+        uint32_t value = CompileNumber(var_stmt->initializer.get());
+        MoveInto(DeclaredRegister(var_stmt), value);
+    }
+    else if (t_IfStmt *if_stmt = As<t_IfStmt>(stmt))
+    {
+        std::vector<size_t> else_jumps;
+        CompileCondition(if_stmt->condition.get(), false, else_jumps);
+        CompileStatement(if_stmt->then_branch.get());
+
+        if (if_stmt->else_branch)
+        {
+            size_t end_jump = Emit(e_KernelOp::JUMP, 0);
+            PatchJumps(else_jumps, m_Kernel->code.size());
+            CompileStatement(if_stmt->else_branch.get());
+            PatchJumps({end_jump}, m_Kernel->code.size());
+        }
+        else
+        {
+            PatchJumps(else_jumps, m_Kernel->code.size());
+        }
+    }
+    else if (t_ForStmt *for_stmt = As<t_ForStmt>(stmt))
+    {
+        // It runs faster on its own than as part of this loop
+        if (for_stmt->is_parallel)
+        {
+            Fail("contains a parallel for");
+            return;
+        }
+        CompileLoop(for_stmt);
+    }
+    else if (As<t_BreakStmt>(stmt))
+    {
+        m_Loops.back().break_jumps.push_back(Emit(e_KernelOp::JUMP, 0));
+    }
+    else if (As<t_ContinueStmt>(stmt))
+    {
+        m_Loops.back().continue_jumps.push_back(Emit(e_KernelOp::JUMP, 0));
+    }
+    else if (!As<t_EmptyStmt>(stmt))
+    {
+        Fail(UnsupportedStatement(stmt));
+    }
+}
+
+void LoopCompiler::CompileEffect(t_Expr *expr)
+{
+    if (m_Failed)
+    {
+        return;
+    }
+
+    if (t_BinaryExpr *binary = As<t_BinaryExpr>(expr))
+    {
+        e_KernelOp op = e_KernelOp::MOVE;
+        switch (binary->op.type)
+        {
+        case e_TokenType::EQUAL:
+            op = e_KernelOp::MOVE;
+            break;
+        case e_TokenType::PLUS_EQUAL:
+            op = e_KernelOp::ADD;
+            break;
+        case e_TokenType::MINUS_EQUAL:
+            op = e_KernelOp::SUBTRACT;
+            break;
+        case e_TokenType::STAR_EQUAL:
+            op = e_KernelOp::MULTIPLY;
+            break;
+        case e_TokenType::SLASH_EQUAL:
+            op = e_KernelOp::DIVIDE;
+            break;
+        case e_TokenType::MODULUS_EQUAL:
+            op = e_KernelOp::MODULO;
+            break;
+        default:
+            // Not an assignment: evaluated only for its errors
+            CompileNumber(expr);
+            return;
+        }
+
+        t_VariableExpr *target = As<t_VariableExpr>(binary->left.get());
+        if (!target || target->binding.is_const)
+        {
+            Fail("assigns to a constant");
+            return;
+        }
+
+        uint32_t value = CompileNumber(binary->right.get());
+        if (op == e_KernelOp::MOVE)
+        {
+            CompileStore(target, value);
+            return;
+        }
+
+        uint32_t current = VariableRegister(target);
+        uint32_t result = NewRegister();
+        Emit(op, result, current, value);
+        CompileStore(target, result);
+        return;
+    }
+
+    t_Expr *operand = nullptr;
+    bool is_increment = false;
+    if (t_PrefixExpr *prefix = As<t_PrefixExpr>(expr))
+    {
+        operand = prefix->operand.get();
+        is_increment = prefix->op.type == e_TokenType::PLUS_PLUS;
+    }
+    else if (t_PostfixExpr *postfix = As<t_PostfixExpr>(expr))
+    {
+        operand = postfix->operand.get();
+        is_increment = postfix->op.type == e_TokenType::PLUS_PLUS;
+    }
+
+    if (!operand)
+    {
+        CompileNumber(expr);
+        return;
+    }
+
+    t_VariableExpr *target = As<t_VariableExpr>(operand);
+    if (!target)
+    {
+        Fail("increments something that is not a variable");
+        return;
+    }
+
+    uint32_t current = VariableRegister(target);
+    uint32_t result = NewRegister();
+    Emit
+    (
+        is_increment ? e_KernelOp::ADD : e_KernelOp::SUBTRACT,
+        result,
+        current,
+        ConstantRegister(1.0)
+    );
+    CompileStore(target, result);
+}
+
+uint32_t LoopCompiler::CompileNumber(t_Expr *expr)
+{
+    if (m_Failed || !expr)
+    {
+        Fail("misses a value");
+        return 0;
+    }
+
+    if (t_LiteralExpr *literal = As<t_LiteralExpr>(expr))
+    {
+        if
+        (
+            literal->token_type != e_TokenType::NUMBER ||
+            !literal->is_number
+        )
+        {
+            Fail("uses a string, boolean or nil value");
+            return 0;
+        }
+        return ConstantRegister(literal->number);
+    }
+
+    if (t_VariableExpr *variable = As<t_VariableExpr>(expr))
+    {
+        return VariableRegister(variable);
+    }
+
+    if (t_GroupingExpr *grouping = As<t_GroupingExpr>(expr))
+    {
+        return CompileNumber(grouping->expression.get());
+    }
+
+    if (t_UnaryExpr *unary = As<t_UnaryExpr>(expr))
+    {
+        if (unary->op.type != e_TokenType::MINUS)
+        {
+            Fail("uses `!` where a number is needed");
+            return 0;
+        }
+        uint32_t operand = CompileNumber(unary->right.get());
+        uint32_t result = NewRegister();
+        Emit(e_KernelOp::NEGATE, result, operand);
+        return result;
+    }
+
+    t_BinaryExpr *binary = As<t_BinaryExpr>(expr);
+    if (!binary)
+    {
+        const char *reason = "uses an expression the kernel cannot compute";
+        if (As<t_CallExpr>(expr))
+        {
+            reason = "calls a function";
+        }
+        else if
+        (
+            As<t_ArrayExpr>(expr) ||
+            As<t_IndexExpr>(expr) ||
+            As<t_IndexAssignExpr>(expr)
+        )
+        {
+            reason = "uses an array";
+        }
+        Fail(reason);
+        return 0;
+    }
+
+    e_KernelOp op = e_KernelOp::ADD;
+    switch (binary->op.type)
+    {
+    case e_TokenType::PLUS:
+        op = e_KernelOp::ADD;
+        break;
+    case e_TokenType::MINUS:
+        op = e_KernelOp::SUBTRACT;
+        break;
+    case e_TokenType::STAR:
+        op = e_KernelOp::MULTIPLY;
+        break;
+    case e_TokenType::SLASH:
+        op = e_KernelOp::DIVIDE;
+        break;
+    case e_TokenType::MODULUS:
+        op = e_KernelOp::MODULO;
+        break;
+    default:
+        Fail("uses a comparison or logic result as a number");
+        return 0;
+    }
+
+    uint32_t left = CompileNumber(binary->left.get());
+    uint32_t right = CompileNumber(binary->right.get());
+    uint32_t result = NewRegister();
+    Emit(op, result, left, right);
+    return result;
+}
+
+bool LoopCompiler::IsCondition(t_Expr *expr) const
+{
+    if (t_GroupingExpr *grouping = As<t_GroupingExpr>(expr))
+    {
+        return IsCondition(grouping->expression.get());
+    }
+    if (t_LiteralExpr *literal = As<t_LiteralExpr>(expr))
+    {
+        return literal->token_type == e_TokenType::TRUE ||
+               literal->token_type == e_TokenType::FALSE;
+    }
+    if (t_UnaryExpr *unary = As<t_UnaryExpr>(expr))
+    {
+        return unary->op.type == e_TokenType::BANG;
+    }
+    if (t_BinaryExpr *binary = As<t_BinaryExpr>(expr))
+    {
+        return IsComparison(binary->op.type)       ||
+               binary->op.type == e_TokenType::AND ||
+               binary->op.type == e_TokenType::OR;
+    }
+    return false;
+}
+
+void LoopCompiler::CompileCondition
+(
+    t_Expr *expr,
+    bool jump_when,
+    std::vector<size_t>& jumps
+)
+{
+    if (m_Failed)
+    {
+        return;
+    }
+
+    if (t_GroupingExpr *grouping = As<t_GroupingExpr>(expr))
+    {
+        CompileCondition(grouping->expression.get(), jump_when, jumps);
+        return;
+    }
+
+    if (!IsCondition(expr))
+    {
+        // Every number is truthy, but it may still fail to evaluate
+        CompileNumber(expr);
+        if (jump_when)
+        {
+            jumps.push_back(Emit(e_KernelOp::JUMP, 0));
+        }
+        return;
+    }
+
+    if (t_LiteralExpr *literal = As<t_LiteralExpr>(expr))
+    {
+        bool value = literal->token_type == e_TokenType::TRUE;
+        if (value == jump_when)
+        {
+            jumps.push_back(Emit(e_KernelOp::JUMP, 0));
+        }
+        return;
+    }
+
+    if (t_UnaryExpr *unary = As<t_UnaryExpr>(expr))
+    {
+        if (IsCondition(unary->right.get()))
+        {
+            CompileCondition(unary->right.get(), !jump_when, jumps);
+            return;
+        }
+
+        // `!x` on a number is true exactly when x is zero
+        uint32_t operand = CompileNumber(unary->right.get());
+        jumps.push_back
+        (
+            Emit
+            (
+                jump_when ? e_KernelOp::JUMP_EQ : e_KernelOp::JUMP_NE,
+                0,
+                operand,
+                ConstantRegister(0.0)
+            )
+        );
+        return;
+    }
+
+    t_BinaryExpr *binary = As<t_BinaryExpr>(expr);
+    if (binary->op.type == e_TokenType::AND)
+    {
+        if (jump_when)
+        {
+            std::vector<size_t> skip_jumps;
+            CompileCondition(binary->left.get(), false, skip_jumps);
+            CompileCondition(binary->right.get(), true, jumps);
+            PatchJumps(skip_jumps, m_Kernel->code.size());
+        }
+        else
+        {
+            CompileCondition(binary->left.get(), false, jumps);
+            CompileCondition(binary->right.get(), false, jumps);
+        }
+        return;
+    }
+
+    if (binary->op.type == e_TokenType::OR)
+    {
+        if (jump_when)
+        {
+            CompileCondition(binary->left.get(), true, jumps);
+            CompileCondition(binary->right.get(), true, jumps);
+        }
+        else
+        {
+            std::vector<size_t> skip_jumps;
+            CompileCondition(binary->left.get(), true, skip_jumps);
+            CompileCondition(binary->right.get(), false, jumps);
+            PatchJumps(skip_jumps, m_Kernel->code.size());
+        }
+        return;
+    }
+
+    uint32_t left = CompileNumber(binary->left.get());
+    uint32_t right = CompileNumber(binary->right.get());
+    jumps.push_back
+    (
+        Emit(ComparisonJump(binary->op.type, jump_when), 0, left, right)
+    );
+}
+
+bool LoopTripCount
+(
+    double first,
+    double bound,
+    double step,
+    bool counts_up,
+    bool inclusive,
+    uint64_t &trip_count
+)
+{
+    double distance = counts_up ? bound - first : first - bound;
+    if (distance < 0.0 || (distance == 0.0 && !inclusive))
+    {
+        trip_count = 0;
+        return true;
+    }
+
+    double stride = counts_up ? step : -step;
+    if (stride <= 0.0)
+    {
+        return false;
+    }
+    double count = std::floor(distance / stride);
+    if (inclusive || count * stride < distance)
+    {
+        count += 1.0;
+    }
+    trip_count = static_cast<uint64_t>(count);
+    return true;
+}
+
+// fmod() is far slower than an integer division, and loop
+// counters are nearly always whole numbers
+double KernelModulo(double left, double right)
+{
+    constexpr double LIMIT = 9007199254740992.0; // 2^53
+    if (std::fabs(left) < LIMIT && std::fabs(right) < LIMIT)
+    {
+        int64_t left_int = static_cast<int64_t>(left);
+        int64_t right_int = static_cast<int64_t>(right);
+        if
+        (
+            static_cast<double>(left_int) == left &&
+            static_cast<double>(right_int) == right
+        )
+        {
+            // Keep the sign of a zero result the way fmod() does
+            double result = static_cast<double>(left_int % right_int);
+            return result == 0.0 ? std::copysign(0.0, left) : result;
+        }
+    }
+    return std::fmod(left, right);
+}
+
+Expected<int, t_ErrorInfo> RunLoopKernel
+(
+    const t_LoopKernel& kernel,
+    double *r
+)
+{
+    const t_KernelInstr *code = kernel.code.data();
+    size_t pc = 0;
+
+    while (true)
+    {
+        const t_KernelInstr& instr = code[pc++];
+        switch (instr.op)
+        {
+        case e_KernelOp::MOVE:
+            r[instr.a] = r[instr.b];
+            break;
+
+        case e_KernelOp::ADD:
+            r[instr.a] = r[instr.b] + r[instr.c];
+            break;
+
+        case e_KernelOp::SUBTRACT:
+            r[instr.a] = r[instr.b] - r[instr.c];
+            break;
+
+        case e_KernelOp::MULTIPLY:
+            r[instr.a] = r[instr.b] * r[instr.c];
+            break;
+
+        case e_KernelOp::DIVIDE:
+            if (r[instr.c] == 0)
+            {
+                return t_ErrorInfo
+                (
+                    e_ErrorType::RUNTIME_ERROR,
+                    "Division by zero"
+                );
+            }
+            r[instr.a] = r[instr.b] / r[instr.c];
+            break;
+
+        case e_KernelOp::MODULO:
+            if (r[instr.c] == 0)
+            {
+                return t_ErrorInfo
+                (
+                    e_ErrorType::RUNTIME_ERROR,
+                    "Modulus by zero"
+                );
+            }
+            r[instr.a] = KernelModulo(r[instr.b], r[instr.c]);
+            break;
+
+        case e_KernelOp::NEGATE:
+            r[instr.a] = -r[instr.b];
+            break;
+
+        case e_KernelOp::JUMP:
+            pc = instr.a;
+            break;
+
+        case e_KernelOp::JUMP_LT:
+            if (r[instr.b] < r[instr.c]) pc = instr.a;
+            break;
+
+        case e_KernelOp::JUMP_LE:
+            if (r[instr.b] <= r[instr.c]) pc = instr.a;
+            break;
+
+        case e_KernelOp::JUMP_GT:
+            if (r[instr.b] > r[instr.c]) pc = instr.a;
+            break;
+
+        case e_KernelOp::JUMP_GE:
+            if (r[instr.b] >= r[instr.c]) pc = instr.a;
+            break;
+
+        case e_KernelOp::JUMP_EQ:
+            if (r[instr.b] == r[instr.c]) pc = instr.a;
+            break;
+
+        case e_KernelOp::JUMP_NE:
+            if (r[instr.b] != r[instr.c]) pc = instr.a;
+            break;
+
+        case e_KernelOp::JUMP_NLT:
+            if (!(r[instr.b] < r[instr.c])) pc = instr.a;
+            break;
+
+        case e_KernelOp::JUMP_NLE:
+            if (!(r[instr.b] <= r[instr.c])) pc = instr.a;
+            break;
+
+        case e_KernelOp::JUMP_NGT:
+            if (!(r[instr.b] > r[instr.c])) pc = instr.a;
+            break;
+
+        case e_KernelOp::JUMP_NGE:
+            if (!(r[instr.b] >= r[instr.c])) pc = instr.a;
+            break;
+
+        case e_KernelOp::VECTOR_LOOP:
+            r[instr.b] = r[instr.c];
+            RunVectorLoop(kernel.vector_loops[instr.a], r);
+            break;
+
+        case e_KernelOp::HALT:
+            return Expected<int, t_ErrorInfo>(0);
+        }
+    }
+}
@@ -0,0 +1,294 @@
+#include <rubberduck/ParallelLoop.h>
+#include <rubberduck/ThreadPool.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <string>
+
+namespace
+{
+    // Enough chunks for every worker to steal from the others many
+    // times over, few enough that combining them costs nothing
+    constexpr uint64_t MAX_CHUNKS = 1024;
+
+    // The chunks a worker has not started yet, [next, end), packed
+    // into one word so that the owner taking one and a thief taking
+    // half are both a single compare-exchange
+    struct alignas(64) t_WorkRange
+    {
+        std::atomic<uint64_t> chunks{0};
+    };
+
+    uint64_t PackRange(uint64_t next, uint64_t end)
+    {
+        return (next << 32) | end;
+    }
+
+    uint64_t RangeNext(uint64_t range)
+    {
+        return range >> 32;
+    }
+
+    uint64_t RangeEnd(uint64_t range)
+    {
+        return range & 0xFFFFFFFFu;
+    }
+
+    bool TakeOwnChunk(t_WorkRange& own, uint64_t& chunk)
+    {
+        uint64_t range = own.chunks.load();
+        while (RangeNext(range) < RangeEnd(range))
+        {
+            uint64_t taken =
+            PackRange(RangeNext(range) + 1, RangeEnd(range));
+            if (own.chunks.compare_exchange_weak(range, taken))
+            {
+                chunk = RangeNext(range);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Moves the upper half of what `victim` has left to `thief`,
+    // whose own range is empty
+    bool StealChunks(t_WorkRange& victim, t_WorkRange& thief)
+    {
+        uint64_t range = victim.chunks.load();
+        while (RangeNext(range) < RangeEnd(range))
+        {
+            uint64_t next = RangeNext(range);
+            uint64_t end = RangeEnd(range);
+            uint64_t middle = next + (end - next) / 2;
+            uint64_t kept = PackRange(next, middle);
+            if (victim.chunks.compare_exchange_weak(range, kept))
+            {
+                thief.chunks.store(PackRange(middle, end));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool NextChunk
+    (
+        std::vector<t_WorkRange>& ranges,
+        size_t worker,
+        uint64_t& chunk
+    )
+    {
+        while (!TakeOwnChunk(ranges[worker], chunk))
+        {
+            bool stole = false;
+            for (size_t i = 1; i < ranges.size() && !stole; ++i)
+            {
+                size_t victim = (worker + i) % ranges.size();
+                stole = StealChunks(ranges[victim], ranges[worker]);
+            }
+            if (!stole)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The first iteration of `chunk`, without overflowing T * chunk
+    uint64_t ChunkBegin
+    (
+        uint64_t trip_count,
+        uint64_t chunks,
+        uint64_t chunk
+    )
+    {
+        return trip_count / chunks * chunk +
+               trip_count % chunks * chunk / chunks;
+    }
+
+    double Combine(e_KernelOp op, double left, double right)
+    {
+        return op == e_KernelOp::MULTIPLY ? left * right : left + right;
+    }
+
+    // The first error of a worker, by chunk
+    struct t_WorkerFailure
+    {
+        uint64_t chunk = UINT64_MAX;
+        t_ErrorInfo error;
+    };
+}
+
+Expected<int, t_ErrorInfo> PrepareParallelLoops
+(
+    const std::vector<t_ForStmt*>& loops,
+    bool strict_fp
+)
+{
+    LoopCompiler compiler;
+    compiler.SetStrictFloatingPoint(strict_fp);
+    for (t_ForStmt *for_stmt : loops)
+    {
+        std::unique_ptr<t_ParallelLoop> loop =
+        compiler.CompileParallel(for_stmt);
+        if (!loop)
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::COMPILE_ERROR,
+                std::string("This loop cannot run in parallel: it ") +
+                compiler.FailureReason(),
+                for_stmt->line
+            );
+        }
+        for_stmt->parallel = std::move(loop);
+    }
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> RunParallelLoop
+(
+    const t_ParallelLoop& loop,
+    double *registers
+)
+{
+    uint64_t trip_count = loop.trip_count;
+    if (trip_count == 0)
+    {
+        return Expected<int, t_ErrorInfo>(0);
+    }
+
+    const t_LoopKernel& kernel = loop.kernel;
+    const std::vector<t_KernelReduction>& reductions = loop.reductions;
+    uint64_t chunks = std::min(trip_count, MAX_CHUNKS);
+    std::vector<double> partials(chunks * reductions.size());
+
+    // Chunks past a failed one are skipped; the ones before it still
+    // run, so the reported error is always the same
+    std::atomic<uint64_t> failed_chunk{chunks};
+
+    ThreadPool& pool = SharedThreadPool();
+    size_t workers = chunks > 1 ? pool.WorkerCount() : 1;
+    std::vector<t_WorkRange> ranges(workers);
+    std::vector<t_WorkerFailure> failures(workers);
+    for (size_t worker = 0; worker < workers; ++worker)
+    {
+        ranges[worker].chunks.store
+        (
+            PackRange
+            (
+                chunks * worker / workers,
+                chunks * (worker + 1) / workers
+            )
+        );
+    }
+
+    size_t register_count = kernel.registers.size();
+    std::function<void(size_t)> job = [&](size_t worker)
+    {
+        std::vector<double> scratch(register_count);
+        uint64_t chunk = 0;
+        while (NextChunk(ranges, worker, chunk))
+        {
+            if (chunk > failed_chunk.load(std::memory_order_relaxed))
+            {
+                continue;
+            }
+
+            std::copy
+            (
+                registers,
+                registers + register_count,
+                scratch.begin()
+            );
+            uint64_t begin = ChunkBegin(trip_count, chunks, chunk);
+            uint64_t end = ChunkBegin(trip_count, chunks, chunk + 1);
+            scratch[loop.start_reg] =
+            loop.first + static_cast<double>(begin) * loop.step;
+            scratch[loop.end_reg] =
+            loop.first + static_cast<double>(end) * loop.step;
+            for (const t_KernelReduction& reduction : reductions)
+            {
+                uint32_t reg = kernel.variables[reduction.variable].reg;
+                scratch[reg] =
+                reduction.op == e_KernelOp::MULTIPLY ? 1.0 : 0.0;
+            }
+
+            Expected<int, t_ErrorInfo> result =
+            RunLoopKernel(kernel, scratch.data());
+            if (!result)
+            {
+                t_WorkerFailure& failure = failures[worker];
+                if (chunk < failure.chunk)
+                {
+                    failure.chunk = chunk;
+                    failure.error = result.Error();
+                }
+                uint64_t failed = failed_chunk.load();
+                while
+                (
+                    chunk < failed &&
+                    !failed_chunk.compare_exchange_weak(failed, chunk)
+                )
+                {
+                }
+                continue;
+            }
+
+            for (size_t i = 0; i < reductions.size(); ++i)
+            {
+                uint32_t reg = kernel.variables[reductions[i].variable].reg;
+                partials[chunk * reductions.size() + i] = scratch[reg];
+            }
+        }
+    };
+
+    if (workers == 1)
+    {
+        job(0);
+    }
+    else
+    {
+        pool.Run(job);
+    }
+
+    if (failed_chunk.load() < chunks)
+    {
+        const t_WorkerFailure* first = &failures[0];
+        for (const t_WorkerFailure& failure : failures)
+        {
+            if (failure.chunk < first->chunk)
+            {
+                first = &failure;
+            }
+        }
+        return first->error;
+    }
+
+    // Pairwise in a fixed order: (p0 + p1) + (p2 + p3), ...
+    for (size_t i = 0; i < reductions.size(); ++i)
+    {
+        e_KernelOp op = reductions[i].op;
+        for (uint64_t width = 1; width < chunks; width *= 2)
+        {
+            for
+            (
+                uint64_t chunk = 0;
+                chunk + width < chunks;
+                chunk += 2 * width
+            )
+            {
+                double& left = partials[chunk * reductions.size() + i];
+                left = Combine
+                (
+                    op,
+                    left,
+                    partials[(chunk + width) * reductions.size() + i]
+                );
+            }
+        }
+
+        uint32_t reg = kernel.variables[reductions[i].variable].reg;
+        registers[reg] = Combine(op, registers[reg], partials[i]);
+    }
+    return Expected<int, t_ErrorInfo>(0);
+}
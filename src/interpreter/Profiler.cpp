@@ -0,0 +1,348 @@
+#include <rubberduck/Profiler.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+    constexpr uint32_t NO_NODE = UINT32_MAX;
+
+    double Milliseconds(int64_t nanoseconds)
+    {
+        return static_cast<double>(nanoseconds) / 1e6;
+    }
+
+    double Percent(int64_t part, int64_t whole)
+    {
+        return whole > 0
+            ? 100.0 * static_cast<double>(part) / static_cast<double>(whole)
+            : 0.0;
+    }
+}
+
+Profiler::Profiler() = default;
+
+int64_t Profiler::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+    (
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+uint32_t Profiler::FunctionId(const t_FunStmt *function)
+{
+    auto [it, inserted] = m_FunctionIds.emplace
+    (
+        function,
+        static_cast<uint32_t>(m_Functions.size())
+    );
+    if (inserted)
+    {
+        m_Functions.push_back(t_FunctionProfile{function});
+    }
+    return it->second;
+}
+
+uint32_t Profiler::StackNode(uint32_t parent, uint32_t function)
+{
+    uint64_t key = (static_cast<uint64_t>(parent) << 32) | function;
+    auto [it, inserted] = m_NodeIds.emplace
+    (
+        key,
+        static_cast<uint32_t>(m_Nodes.size())
+    );
+    if (inserted)
+    {
+        m_Nodes.push_back(t_StackNode{parent, function, 0});
+    }
+    return it->second;
+}
+
+std::string Profiler::FunctionName(uint32_t function) const
+{
+    const t_FunStmt *fun_stmt = m_Functions[function].function;
+    if (!fun_stmt)
+    {
+        return "<script>";
+    }
+    return m_Symbols->Name(fun_stmt->name);
+}
+
+std::string Profiler::StackName(uint32_t node) const
+{
+    std::vector<uint32_t> path;
+    for (uint32_t current = node; current != NO_NODE;)
+    {
+        path.push_back(current);
+        current = m_Nodes[current].parent;
+    }
+
+    std::string name;
+    for (size_t i = path.size(); i > 0; --i)
+    {
+        if (!name.empty())
+        {
+            name += ';';
+        }
+        name += FunctionName(m_Nodes[path[i - 1]].function);
+    }
+    return name;
+}
+
+void Profiler::Start(const SymbolTable& symbols)
+{
+    m_Symbols = &symbols;
+    m_Functions.clear();
+    m_FunctionIds.clear();
+    m_Lines.clear();
+    m_Loops.clear();
+    m_Nodes.clear();
+    m_NodeIds.clear();
+    m_Statements.clear();
+    m_Calls.clear();
+    m_Elapsed = 0;
+
+    // The script is the root of every call path
+    uint32_t script = FunctionId(nullptr);
+    m_Functions[script].calls = 1;
+    m_Functions[script].active = 1;
+    m_Start = Now();
+    m_Calls.push_back
+    (
+        t_FunctionTimer{script, StackNode(NO_NODE, script), m_Start, 0}
+    );
+}
+
+void Profiler::Stop()
+{
+    // Statements only stay open if an error unwound past them
+    m_Statements.clear();
+    while (!m_Calls.empty())
+    {
+        EndCall();
+    }
+    m_Elapsed = Now() - m_Start;
+}
+
+void Profiler::BeginStatement()
+{
+    m_Statements.push_back(t_StatementTimer{Now(), 0});
+}
+
+void Profiler::EndStatement(const t_Stmt *stmt)
+{
+    t_StatementTimer timer = m_Statements.back();
+    m_Statements.pop_back();
+
+    int64_t elapsed = Now() - timer.start;
+    t_LineProfile &line = m_Lines[stmt->line];
+    line.count++;
+    line.self_ns += elapsed - timer.child_ns;
+
+    if (!m_Statements.empty())
+    {
+        m_Statements.back().child_ns += elapsed;
+    }
+
+    if (stmt->kind == e_StmtKind::FOR)
+    {
+        const t_ForStmt *for_stmt = static_cast<const t_ForStmt*>(stmt);
+        t_LoopProfile &loop = m_Loops[for_stmt];
+        loop.line = stmt->line;
+        loop.runs++;
+        loop.total_ns += elapsed;
+    }
+}
+
+void Profiler::BeginCall(const t_FunStmt *function)
+{
+    uint32_t id = FunctionId(function);
+    t_FunctionProfile &profile = m_Functions[id];
+    profile.calls++;
+    profile.active++;
+
+    m_Calls.push_back
+    (
+        t_FunctionTimer{id, StackNode(m_Calls.back().node, id), Now(), 0}
+    );
+}
+
+void Profiler::EndCall()
+{
+    t_FunctionTimer timer = m_Calls.back();
+    m_Calls.pop_back();
+
+    int64_t elapsed = Now() - timer.start;
+    int64_t self = elapsed - timer.callee_ns;
+
+    t_FunctionProfile &profile = m_Functions[timer.function];
+    profile.self_ns += self;
+    profile.active--;
+    // A recursive call is already inside the outermost one
+    if (profile.active == 0)
+    {
+        profile.total_ns += elapsed;
+    }
+    m_Nodes[timer.node].self_ns += self;
+
+    if (!m_Calls.empty())
+    {
+        m_Calls.back().callee_ns += elapsed;
+    }
+}
+
+void Profiler::LoopUsedKernel(const t_ForStmt *loop)
+{
+    m_Loops[loop].kernel_runs++;
+}
+
+void Profiler::LoopFellBack
+(
+    const t_ForStmt *loop,
+    const std::string &reason
+)
+{
+    t_LoopProfile &profile = m_Loops[loop];
+    if (profile.fallback_reason.empty())
+    {
+        profile.fallback_reason = reason;
+    }
+}
+
+void Profiler::WriteFlatProfile(std::ostream &out) const
+{
+    char buffer[256];
+    std::snprintf
+    (
+        buffer, sizeof(buffer),
+        "\nFlat profile: %.3f ms in total\n", Milliseconds(m_Elapsed)
+    );
+    out << buffer;
+
+    std::vector<uint32_t> functions(m_Functions.size());
+    for (uint32_t i = 0; i < functions.size(); ++i)
+    {
+        functions[i] = i;
+    }
+    std::sort
+    (
+        functions.begin(),
+        functions.end(),
+        [this](uint32_t a, uint32_t b)
+        {
+            return m_Functions[a].self_ns > m_Functions[b].self_ns;
+        }
+    );
+
+    out << "\nFunctions\n"
+        << "       calls     total ms      self ms   self %  function\n";
+    for (uint32_t id : functions)
+    {
+        const t_FunctionProfile &profile = m_Functions[id];
+        std::string name = FunctionName(id);
+        if (profile.function)
+        {
+            name += " (line " +
+                    std::to_string(profile.function->line) + ")";
+        }
+        std::snprintf
+        (
+            buffer, sizeof(buffer),
+            "%12llu %12.3f %12.3f %7.1f%%  %s\n",
+            static_cast<unsigned long long>(profile.calls),
+            Milliseconds(profile.total_ns),
+            Milliseconds(profile.self_ns),
+            Percent(profile.self_ns, m_Elapsed),
+            name.c_str()
+        );
+        out << buffer;
+    }
+
+    std::vector<std::pair<int, t_LineProfile>> lines
+    (
+        m_Lines.begin(),
+        m_Lines.end()
+    );
+    std::stable_sort
+    (
+        lines.begin(),
+        lines.end(),
+        [](const auto &a, const auto &b)
+        {
+            return a.second.self_ns > b.second.self_ns;
+        }
+    );
+
+    out << "\nLines\n"
+        << "       count      self ms   self %  line\n";
+    for (const auto &[line, profile] : lines)
+    {
+        std::snprintf
+        (
+            buffer, sizeof(buffer),
+            "%12llu %12.3f %7.1f%%  %d\n",
+            static_cast<unsigned long long>(profile.count),
+            Milliseconds(profile.self_ns),
+            Percent(profile.self_ns, m_Elapsed),
+            line
+        );
+        out << buffer;
+    }
+
+    std::vector<const t_LoopProfile*> loops;
+    for (const auto &[loop, profile] : m_Loops)
+    {
+        loops.push_back(&profile);
+    }
+    std::sort
+    (
+        loops.begin(),
+        loops.end(),
+        [](const t_LoopProfile *a, const t_LoopProfile *b)
+        {
+            return a->total_ns != b->total_ns
+                ? a->total_ns > b->total_ns
+                : a->line < b->line;
+        }
+    );
+
+    out << "\nLoops\n"
+        << "        line         runs     total ms  path\n";
+    for (const t_LoopProfile *profile : loops)
+    {
+        std::string path;
+        if (profile->kernel_runs == profile->runs)
+        {
+            path = "loop kernel";
+        }
+        else
+        {
+            path = profile->kernel_runs == 0
+                ? "general"
+                : "loop kernel on " + std::to_string(profile->kernel_runs) +
+                  " runs, general";
+            path += ": " + profile->fallback_reason;
+        }
+        std::snprintf
+        (
+            buffer, sizeof(buffer),
+            "%12d %12llu %12.3f  ",
+            profile->line,
+            static_cast<unsigned long long>(profile->runs),
+            Milliseconds(profile->total_ns)
+        );
+        out << buffer << path << "\n";
+    }
+}
+
+void Profiler::WriteCollapsedStacks(std::ostream &out) const
+{
+    for (uint32_t node = 0; node < m_Nodes.size(); ++node)
+    {
+        if (m_Nodes[node].self_ns > 0)
+        {
+            out << StackName(node) << " " << m_Nodes[node].self_ns << "\n";
+        }
+    }
+}
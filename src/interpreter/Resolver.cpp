@@ -0,0 +1,345 @@
+#include <rubberduck/Resolver.h>
+#include <algorithm>
+
+t_ResolvedScript Resolver::Resolve
+(
+    const StmtList &statements
+)
+{
+    m_Locals.clear();
+    m_Globals.clear();
+    m_GlobalNames.clear();
+    m_ParallelLoops.clear();
+    m_ScopeDepth = 0;
+    m_FrameSize = 0;
+    m_InMain = true;
+    m_BenchmarkDepth = 0;
+
+    for (const auto &statement : statements)
+    {
+        ResolveStatement(statement.get());
+    }
+
+    t_ResolvedScript script;
+    script.main_frame_size = m_FrameSize;
+
+    // Function bodies are resolved last so that every top-level
+    // declaration (and its constness) is already known.
+    m_InMain = false;
+    for (const auto &statement : statements)
+    {
+        if (t_FunStmt *fun_stmt = As<t_FunStmt>(statement.get()))
+        {
+            ResolveFunction(fun_stmt);
+        }
+    }
+
+    script.global_names = std::move(m_GlobalNames);
+    script.parallel_loops = std::move(m_ParallelLoops);
+    return script;
+}
+
+void Resolver::BeginScope()
+{
+    m_ScopeDepth++;
+}
+
+void Resolver::EndScope()
+{
+    m_ScopeDepth--;
+    while (!m_Locals.empty() && m_Locals.back().depth > m_ScopeDepth)
+    {
+        m_Locals.pop_back();
+    }
+}
+
+bool Resolver::IsDeclaredInCurrentScope(t_Symbol name) const
+{
+    for (size_t i = m_Locals.size(); i > 0; --i)
+    {
+        const t_Local& local = m_Locals[i - 1];
+        if (local.depth < m_ScopeDepth)
+        {
+            break;
+        }
+        if (local.name == name)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t Resolver::GlobalSlot(t_Symbol name)
+{
+    auto it = m_Globals.find(name);
+    if (it != m_Globals.end())
+    {
+        return it->second.slot;
+    }
+
+    uint32_t slot = static_cast<uint32_t>(m_GlobalNames.size());
+    m_GlobalNames.push_back(name);
+    m_Globals.emplace(name, t_GlobalInfo{slot, false, false});
+    return slot;
+}
+
+bool Resolver::TryBind(t_Symbol name, t_Binding& binding) const
+{
+    for (size_t i = m_Locals.size(); i > 0; --i)
+    {
+        if (m_Locals[i - 1].name == name)
+        {
+            binding.kind = e_BindingKind::LOCAL;
+            binding.slot = static_cast<uint32_t>(i - 1);
+            binding.is_const = m_Locals[i - 1].is_const;
+            return true;
+        }
+    }
+
+    auto it = m_Globals.find(name);
+    if (it == m_Globals.end())
+    {
+        return false;
+    }
+    binding.kind = e_BindingKind::GLOBAL;
+    binding.slot = it->second.slot;
+    binding.is_const = it->second.is_const;
+    return true;
+}
+
+t_Binding Resolver::Bind(t_Symbol name)
+{
+    t_Binding binding;
+    if (!TryBind(name, binding))
+    {
+        // Unknown names get a global slot that is never defined, so
+        // using them fails at runtime exactly where they are reached.
+        binding.kind = e_BindingKind::GLOBAL;
+        binding.slot = GlobalSlot(name);
+    }
+    return binding;
+}
+
+void Resolver::Declare(t_VarStmt *var_stmt)
+{
+    bool is_global = m_InMain && m_ScopeDepth == 0;
+
+    // Redeclarations are reported by the interpreter when reached
+    if (is_global)
+    {
+        uint32_t slot = GlobalSlot(var_stmt->name);
+        t_GlobalInfo& info = m_Globals.find(var_stmt->name)->second;
+
+        var_stmt->is_redeclaration = info.is_declared;
+        if (!info.is_declared)
+        {
+            info.is_declared = true;
+            info.is_const = var_stmt->is_const;
+        }
+
+        var_stmt->binding.kind = e_BindingKind::GLOBAL;
+        var_stmt->binding.slot = slot;
+        var_stmt->binding.is_const = info.is_const;
+        return;
+    }
+
+    var_stmt->is_redeclaration = IsDeclaredInCurrentScope(var_stmt->name);
+
+    var_stmt->binding.kind = e_BindingKind::LOCAL;
+    var_stmt->binding.slot = static_cast<uint32_t>(m_Locals.size());
+    var_stmt->binding.is_const = var_stmt->is_const;
+
+    m_Locals.push_back
+    (
+        t_Local{var_stmt->name, m_ScopeDepth, var_stmt->is_const}
+    );
+    m_FrameSize = std::max
+    (
+        m_FrameSize,
+        static_cast<uint32_t>(m_Locals.size())
+    );
+}
+
+void Resolver::ResolveScopedStatement(t_Stmt *stmt)
+{
+    // Branch and loop bodies always get their own scope, so a
+    // declaration without braces stays local to the body.
+    BeginScope();
+    ResolveStatement(stmt);
+    EndScope();
+}
+
+void Resolver::ResolveStatement(t_Stmt *stmt)
+{
+    if (!stmt)
+    {
+        return;
+    }
+
+    if (t_BlockStmt *block_stmt = As<t_BlockStmt>(stmt))
+    {
+        BeginScope();
+        for (const auto &statement : block_stmt->statements)
+        {
+            ResolveStatement(statement.get());
+        }
+        EndScope();
+    }
+    else if (t_IfStmt *if_stmt = As<t_IfStmt>(stmt))
+    {
+        ResolveExpression(if_stmt->condition.get());
+        ResolveScopedStatement(if_stmt->then_branch.get());
+        if (if_stmt->else_branch)
+        {
+            ResolveScopedStatement(if_stmt->else_branch.get());
+        }
+    }
+    else if (t_ForStmt *for_stmt = As<t_ForStmt>(stmt))
+    {
+        BeginScope();
+        ResolveStatement(for_stmt->initializer.get());
+        ResolveExpression(for_stmt->condition.get());
+        ResolveExpression(for_stmt->increment.get());
+        ResolveScopedStatement(for_stmt->body.get());
+        EndScope();
+        if (for_stmt->is_parallel)
+        {
+            m_ParallelLoops.push_back(for_stmt);
+        }
+    }
+    else if (t_VarStmt *var_stmt = As<t_VarStmt>(stmt))
+    {
+        // The initializer still sees an outer variable of the same name
+        ResolveExpression(var_stmt->initializer.get());
+        Declare(var_stmt);
+    }
+    else if (t_DisplayStmt *display_stmt = As<t_DisplayStmt>(stmt))
+    {
+        for (const auto &expr : display_stmt->expressions)
+        {
+            ResolveExpression(expr.get());
+        }
+    }
+    else if (t_GetinStmt *getin_stmt = As<t_GetinStmt>(stmt))
+    {
+        for (t_GetinTarget &target : getin_stmt->targets)
+        {
+            target.binding = Bind(target.name);
+        }
+    }
+    else if (t_BenchmarkStmt *benchmark_stmt = As<t_BenchmarkStmt>(stmt))
+    {
+        m_BenchmarkDepth++;
+        ResolveStatement(benchmark_stmt->body.get());
+        m_BenchmarkDepth--;
+    }
+    else if (t_ExpressionStmt *expr_stmt = As<t_ExpressionStmt>(stmt))
+    {
+        ResolveExpression(expr_stmt->expression.get());
+    }
+    else if (t_ReturnStmt *return_stmt = As<t_ReturnStmt>(stmt))
+    {
+        ResolveExpression(return_stmt->value.get());
+
+        // A benchmark reports when its body is left, which has to stay
+        // after the call returns
+        t_CallExpr *call = As<t_CallExpr>(return_stmt->value.get());
+        return_stmt->is_tail_call = 
+            !m_InMain && m_BenchmarkDepth == 0 && call && call->target;
+    }
+    // Top-level t_FunStmt bodies are resolved after the script; nested
+    // declarations are never callable and t_EmptyStmt has no names.
+}
+
+void Resolver::ResolveFunction(t_FunStmt *fun_stmt)
+{
+    m_Locals.clear();
+    m_ScopeDepth = 1;
+    m_FrameSize = static_cast<uint32_t>(fun_stmt->parameters.size());
+
+    // Parameters occupy the first slots of the frame
+    for (t_Symbol parameter : fun_stmt->parameters)
+    {
+        m_Locals.push_back(t_Local{parameter, 1, false});
+    }
+
+    ResolveStatement(fun_stmt->body.get());
+
+    fun_stmt->frame_size = m_FrameSize;
+    m_Locals.clear();
+    m_ScopeDepth = 0;
+}
+
+void Resolver::ResolveExpression(t_Expr *expr)
+{
+    if (!expr)
+    {
+        return;
+    }
+
+    if (t_VariableExpr *variable = As<t_VariableExpr>(expr))
+    {
+        variable->binding = Bind(variable->name);
+    }
+    else if (t_BinaryExpr *binary = As<t_BinaryExpr>(expr))
+    {
+        ResolveExpression(binary->left.get());
+        ResolveExpression(binary->right.get());
+    }
+    else if (t_UnaryExpr *unary = As<t_UnaryExpr>(expr))
+    {
+        ResolveExpression(unary->right.get());
+    }
+    else if (t_GroupingExpr *grouping = As<t_GroupingExpr>(expr))
+    {
+        ResolveExpression(grouping->expression.get());
+    }
+    else if (t_PrefixExpr *prefix = As<t_PrefixExpr>(expr))
+    {
+        ResolveExpression(prefix->operand.get());
+    }
+    else if (t_PostfixExpr *postfix = As<t_PostfixExpr>(expr))
+    {
+        ResolveExpression(postfix->operand.get());
+    }
+    else if (t_CallExpr *call = As<t_CallExpr>(expr))
+    {
+        for (const auto &argument : call->arguments)
+        {
+            ResolveExpression(argument.get());
+        }
+    }
+    else if (t_TypeofExpr *type_of = As<t_TypeofExpr>(expr))
+    {
+        ResolveExpression(type_of->operand.get());
+    }
+    else if (t_SizeofExpr *size_of = As<t_SizeofExpr>(expr))
+    {
+        ResolveExpression(size_of->operand.get());
+    }
+    else if (t_FormatStringExpr *format = As<t_FormatStringExpr>(expr))
+    {
+        for (const t_FormatSegment &segment : format->segments)
+        {
+            ResolveExpression(segment.expression.get());
+        }
+    }
+    else if (t_ArrayExpr *array = As<t_ArrayExpr>(expr))
+    {
+        for (const auto &element : array->elements)
+        {
+            ResolveExpression(element.get());
+        }
+    }
+    else if (t_IndexExpr *index = As<t_IndexExpr>(expr))
+    {
+        ResolveExpression(index->object.get());
+        ResolveExpression(index->index.get());
+    }
+    else if (t_IndexAssignExpr *assign = As<t_IndexAssignExpr>(expr))
+    {
+        ResolveExpression(assign->target.get());
+        ResolveExpression(assign->value.get());
+    }
+}
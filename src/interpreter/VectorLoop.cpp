@@ -0,0 +1,346 @@
+#include <rubberduck/LoopKernel.h>
+#include <rubberduck/Simd.h>
+#include <cmath>
+
+namespace
+{
+    constexpr uint32_t WIDTH = t_VectorLoop::VECTOR_WIDTH;
+    static_assert(WIDTH == LANE_WIDTH, "a vector loop fills one t_Lanes");
+
+    RD_ALWAYS_INLINE bool HasZeroLane(const t_Lanes& lanes)
+    {
+        bool has_zero = false;
+        for (uint32_t i = 0; i < WIDTH; ++i)
+        {
+            has_zero = has_zero || lanes[i] == 0;
+        }
+        return has_zero;
+    }
+
+    double Combine(e_KernelOp op, double left, double right)
+    {
+        return op == e_KernelOp::MULTIPLY ? left * right : left + right;
+    }
+
+    // Runs `groups` times WIDTH iterations; fewer if a divisor turns
+    // zero, leaving that group to the scalar loop so that it reports
+    // the error at the right iteration. Yields the groups it ran.
+    RD_ALWAYS_INLINE uint64_t RunLaneGroups
+    (
+        const t_VectorLoop& loop,
+        double *r,
+        double first,
+        double step,
+        uint64_t groups
+    )
+    {
+        t_Lanes lanes[t_VectorLoop::MAX_LANES];
+        t_Lanes saved[t_VectorLoop::MAX_LANES];
+        size_t lane_count = loop.lane_regs.size();
+        for (size_t lane = 0; lane < lane_count; ++lane)
+        {
+            Broadcast(lanes[lane], r[loop.lane_regs[lane]]);
+        }
+        for (uint32_t i = 0; i < WIDTH; ++i)
+        {
+            lanes[loop.counter_lane][i] = first + i * step;
+        }
+        for (const t_VectorReduction& reduction : loop.reductions)
+        {
+            Broadcast
+            (
+                lanes[reduction.lane],
+                reduction.op == e_KernelOp::MULTIPLY ? 1.0 : 0.0
+            );
+        }
+        t_Lanes stride;
+        Broadcast(stride, WIDTH * step);
+
+        const t_KernelInstr *body = loop.body.data();
+        const t_KernelInstr *body_end = body + loop.body.size();
+        uint64_t done = 0;
+        for (; done < groups; ++done)
+        {
+            if (loop.has_division)
+            {
+                for (const t_VectorReduction& reduction : loop.reductions)
+                {
+                    saved[reduction.lane] = lanes[reduction.lane];
+                }
+            }
+
+            bool is_stopped = false;
+            for (const t_KernelInstr *instr = body; instr < body_end; ++instr)
+            {
+                t_Lanes& a = lanes[instr->a];
+                const t_Lanes& b = lanes[instr->b];
+                const t_Lanes& c = lanes[instr->c];
+                switch (instr->op)
+                {
+                case e_KernelOp::MOVE:
+                    a = b;
+                    break;
+                case e_KernelOp::ADD:
+                    a = b + c;
+                    break;
+                case e_KernelOp::SUBTRACT:
+                    a = b - c;
+                    break;
+                case e_KernelOp::MULTIPLY:
+                    a = b * c;
+                    break;
+                case e_KernelOp::DIVIDE:
+                    is_stopped = HasZeroLane(c);
+                    if (!is_stopped)
+                    {
+                        a = b / c;
+                    }
+                    break;
+                case e_KernelOp::MODULO:
+                    is_stopped = HasZeroLane(c);
+                    for (uint32_t i = 0; i < WIDTH && !is_stopped; ++i)
+                    {
+                        a[i] = KernelModulo(b[i], c[i]);
+                    }
+                    break;
+                case e_KernelOp::NEGATE:
+                    a = -b;
+                    break;
+                default:
+                    break;
+                }
+                if (is_stopped)
+                {
+                    break;
+                }
+            }
+
+            if (is_stopped)
+            {
+                for (const t_VectorReduction& reduction : loop.reductions)
+                {
+                    lanes[reduction.lane] = saved[reduction.lane];
+                }
+                break;
+            }
+            lanes[loop.counter_lane] = lanes[loop.counter_lane] + stride;
+        }
+
+        // Pairwise, the same way on every machine
+        for (const t_VectorReduction& reduction : loop.reductions)
+        {
+            double partial[WIDTH];
+            for (uint32_t i = 0; i < WIDTH; ++i)
+            {
+                partial[i] = lanes[reduction.lane][i];
+            }
+            for (uint32_t width = 1; width < WIDTH; width *= 2)
+            {
+                for (uint32_t i = 0; i + width < WIDTH; i += 2 * width)
+                {
+                    partial[i] = Combine
+                    (
+                        reduction.op,
+                        partial[i],
+                        partial[i + width]
+                    );
+                }
+            }
+            uint32_t reg = loop.lane_regs[reduction.lane];
+            r[reg] = Combine(reduction.op, r[reg], partial[0]);
+        }
+        return done;
+    }
+
+    uint64_t RunLanesBaseline
+    (
+        const t_VectorLoop& loop,
+        double *r,
+        double first,
+        double step,
+        uint64_t groups
+    )
+    {
+        return RunLaneGroups(loop, r, first, step, groups);
+    }
+
+#if RD_RUNTIME_AVX2
+    __attribute__((target("avx2")))
+    uint64_t RunLanesAvx2
+    (
+        const t_VectorLoop& loop,
+        double *r,
+        double first,
+        double step,
+        uint64_t groups
+    )
+    {
+        return RunLaneGroups(loop, r, first, step, groups);
+    }
+#endif
+
+    uint64_t RunLanes
+    (
+        const t_VectorLoop& loop,
+        double *r,
+        double first,
+        double step,
+        uint64_t groups
+    )
+    {
+#if RD_RUNTIME_AVX2
+        if (CpuHasAvx2())
+        {
+            return RunLanesAvx2(loop, r, first, step, groups);
+        }
+#endif
+        return RunLanesBaseline(loop, r, first, step, groups);
+    }
+
+    // Replaces `count` iterations by their sum: every private register
+    // is alpha * i + beta for the loop variable i, with alpha and beta
+    // known on entry
+    void RunClosedForm
+    (
+        const t_VectorLoop& loop,
+        double *r,
+        double first,
+        double step,
+        uint64_t count
+    )
+    {
+        double alpha[t_VectorLoop::MAX_LANES];
+        double beta[t_VectorLoop::MAX_LANES];
+        double total[t_VectorLoop::MAX_LANES];
+        bool is_reduction[t_VectorLoop::MAX_LANES] = {};
+        size_t lane_count = loop.lane_regs.size();
+        for (size_t lane = 0; lane < lane_count; ++lane)
+        {
+            alpha[lane] = 0.0;
+            beta[lane] = r[loop.lane_regs[lane]];
+        }
+        alpha[loop.counter_lane] = 1.0;
+        beta[loop.counter_lane] = 0.0;
+        for (const t_VectorReduction& reduction : loop.reductions)
+        {
+            is_reduction[reduction.lane] = true;
+            total[reduction.lane] =
+            reduction.op == e_KernelOp::MULTIPLY ? 1.0 : 0.0;
+        }
+
+        // The sum of the loop variable over the skipped iterations
+        double n = static_cast<double>(count);
+        double counter_sum = n * first + step * (n * (n - 1.0) / 2.0);
+
+        for (const t_KernelInstr& instr : loop.body)
+        {
+            uint32_t a = instr.a;
+            uint32_t b = instr.b;
+            uint32_t c = instr.c;
+            if (is_reduction[a])
+            {
+                uint32_t addend = b == a ? c : b;
+                double sum = alpha[addend] * counter_sum + beta[addend] * n;
+                switch (instr.op)
+                {
+                case e_KernelOp::ADD:
+                    total[a] += sum;
+                    break;
+                case e_KernelOp::SUBTRACT:
+                    total[a] -= sum;
+                    break;
+                default:
+                    total[a] *= std::pow(beta[addend], n);
+                    break;
+                }
+                continue;
+            }
+
+            switch (instr.op)
+            {
+            case e_KernelOp::MOVE:
+                alpha[a] = alpha[b];
+                beta[a] = beta[b];
+                break;
+            case e_KernelOp::NEGATE:
+                alpha[a] = -alpha[b];
+                beta[a] = -beta[b];
+                break;
+            case e_KernelOp::ADD:
+                alpha[a] = alpha[b] + alpha[c];
+                beta[a] = beta[b] + beta[c];
+                break;
+            case e_KernelOp::SUBTRACT:
+                alpha[a] = alpha[b] - alpha[c];
+                beta[a] = beta[b] - beta[c];
+                break;
+            default:
+                // One side is invariant, or the result feeds no sum
+                alpha[a] = alpha[b] * beta[c] + beta[b] * alpha[c];
+                beta[a] = beta[b] * beta[c];
+                break;
+            }
+        }
+
+        for (const t_VectorReduction& reduction : loop.reductions)
+        {
+            uint32_t reg = loop.lane_regs[reduction.lane];
+            r[reg] = Combine(reduction.op, r[reg], total[reduction.lane]);
+        }
+    }
+
+    bool IsSmallWholeNumber(double value)
+    {
+        constexpr double LIMIT = 4503599627370496.0; // 2^52
+        return std::fabs(value) < LIMIT && std::floor(value) == value;
+    }
+
+    // Below this many groups the lanes cost more than they save
+    constexpr uint64_t MIN_GROUPS = 2;
+}
+
+void RunVectorLoop(const t_VectorLoop& loop, double *r)
+{
+    double first = r[loop.counter];
+    double bound = r[loop.bound];
+    double step = loop.step_negated ? -r[loop.step] : r[loop.step];
+    if
+    (
+        !IsSmallWholeNumber(first) ||
+        !IsSmallWholeNumber(bound) ||
+        !IsSmallWholeNumber(step)
+    )
+    {
+        return;
+    }
+
+    uint64_t trip_count = 0;
+    bool counts_up = loop.exit_op == e_KernelOp::JUMP_NLT ||
+                     loop.exit_op == e_KernelOp::JUMP_NLE;
+    bool inclusive = loop.exit_op == e_KernelOp::JUMP_NLE ||
+                     loop.exit_op == e_KernelOp::JUMP_NGE;
+    if
+    (
+        !LoopTripCount(first, bound, step, counts_up, inclusive, trip_count)
+        || trip_count < 2
+    )
+    {
+        return;
+    }
+
+    // The last iteration is left to the scalar loop
+    uint64_t skipped = trip_count - 1;
+    if (loop.is_closed_form)
+    {
+        RunClosedForm(loop, r, first, step, skipped);
+    }
+    else
+    {
+        if (skipped / WIDTH < MIN_GROUPS)
+        {
+            return;
+        }
+        skipped = RunLanes(loop, r, first, step, skipped / WIDTH) * WIDTH;
+    }
+    r[loop.counter] = first + static_cast<double>(skipped) * step;
+}
@@ -1,95 +1,546 @@
+#include <charconv>
+#include <chrono>
+#include <cstdint>
 #include <fstream>
+#include <iostream>
+#include <limits>
 #include <print>
-#include <rubberduck/Lexer.h>
-#include <rubberduck/Parser.h>
+#include <string_view>
+#include <memory>
+#include <rubberduck/SourceFile.h>
+#include <rubberduck/Batch.h>
+#include <rubberduck/CompiledScript.h>
 #include <rubberduck/Interpreter.h>
+#include <rubberduck/Memo.h>
+#include <rubberduck/Profiler.h>
+#include <rubberduck/Stats.h>
+#include <rubberduck/ThreadPool.h>
+#include <rubberduck/VM.h>
+#include <rubberduck/ProgramCache.h>
 #include <rubberduck/ErrorHandling.h>
-#include <rubberduck/ASTContext.h>
+#include <rubberduck/Benchmark.h>
 
-static std::string ReadFile(const std::string &filename)
+enum class e_Engine
+{
+    VM,
+    AST,
+    CLOSURE
+};
+
+// Command line options
+struct t_Options
+{
+    e_Engine engine = e_Engine::VM;
+    bool disassemble = false;
+    bool optimize = true; // -O1
+    e_BenchmarkFormat benchmark_format = e_BenchmarkFormat::TEXT;
+    e_FlushPolicy flush_policy = e_FlushPolicy::SIZE;
+    bool profile = false;
+    bool memoize = false;
+    bool stats = false;
+    bool cache = false;
+    size_t threads = 0; // for `parallel for`, 0 = one per core
+    size_t max_depth = DEFAULT_MAX_CALL_DEPTH; // nested calls
+    bool strict_fp = false;
+    bool batch = false; // `script` is a directory or a manifest
+    std::string profile_stacks = "profile.folded";
+    std::string script;
+};
+
+static void PrintUsage()
+{
+    std::println("Usage: rubberduck [options] <script.rd>");
+    std::println("       rubberduck [options] --batch <dir|manifest>");
+    std::println("Options:");
+    std::println("  --engine=vm     Run on the bytecode VM (default)");
+    std::println("  --engine=ast    Run on the tree-walking interpreter");
+    std::println("  --engine=closure");
+    std::println("                  Run on the interpreter, with the tree");
+    std::println("                  lowered to closures first");
+    std::println("  --disassemble   Print the compiled bytecode first");
+    std::println("  -O0             Run the script exactly as written");
+    std::println("  -O1             Fold constants, drop dead code (default)");
+    std::println("  --bench-format=text|json|csv");
+    std::println("                  How benchmark results are reported");
+    std::println("  --flush=size|line");
+    std::println("                  Write output in 64 KB blocks (default)");
+    std::println("                  or after every line");
+    std::println("  --profile[=<file>]");
+    std::println("                  Run on the tree-walking interpreter and");
+    std::println("                  print a flat profile to stderr; call");
+    std::println("                  stacks go to <file> (profile.folded)");
+    std::println("  --memoize       Reuse the result of a pure function");
+    std::println("                  called again with the same arguments;");
+    std::println("                  hits and misses go to stderr");
+    std::println("  --stats         Print phase times, sizes and counts of");
+    std::println("                  calls and loops to stderr");
+    std::println("  --cache         Reuse the compiled program saved next to");
+    std::println("                  the script (script.rdc) while it matches");
+    std::println("  --threads=<n>   Threads for `parallel for` (default: one");
+    std::println("                  per core)");
+    std::println("  --max-depth=<n> Calls a script may nest before it fails");
+    std::println("                  with a stack overflow (default 16384)");
+    std::println("  --strict-fp     Add up loops in their exact order instead");
+    std::println("                  of in vector lanes or closed form");
+    std::println("  --batch         Run every .rd file below a directory, or");
+    std::println("                  every script listed in a manifest, on");
+    std::println("                  --threads threads; the output of each");
+    std::println("                  comes in order, a summary on stderr");
+}
+
+static bool ParseOptions(int argc, char* argv[], t_Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        if (arg == "--engine=vm")
+        {
+            options.engine = e_Engine::VM;
+        }
+        else if (arg == "--engine=ast")
+        {
+            options.engine = e_Engine::AST;
+        }
+        else if (arg == "--engine=closure")
+        {
+            options.engine = e_Engine::CLOSURE;
+        }
+        else if (arg == "--disassemble")
+        {
+            options.disassemble = true;
+        }
+        else if (arg == "-O0")
+        {
+            options.optimize = false;
+        }
+        else if (arg == "-O1")
+        {
+            options.optimize = true;
+        }
+        else if (arg == "--bench-format=text")
+        {
+            options.benchmark_format = e_BenchmarkFormat::TEXT;
+        }
+        else if (arg == "--bench-format=json")
+        {
+            options.benchmark_format = e_BenchmarkFormat::JSON;
+        }
+        else if (arg == "--bench-format=csv")
+        {
+            options.benchmark_format = e_BenchmarkFormat::CSV;
+        }
+        else if (arg == "--flush=size")
+        {
+            options.flush_policy = e_FlushPolicy::SIZE;
+        }
+        else if (arg == "--flush=line")
+        {
+            options.flush_policy = e_FlushPolicy::LINE;
+        }
+        else if (arg == "--profile")
+        {
+            options.profile = true;
+        }
+        else if (arg.starts_with("--profile="))
+        {
+            options.profile = true;
+            options.profile_stacks = arg.substr(10);
+        }
+        else if (arg == "--memoize")
+        {
+            options.memoize = true;
+        }
+        else if (arg == "--stats")
+        {
+            options.stats = true;
+        }
+        else if (arg == "--cache")
+        {
+            options.cache = true;
+        }
+        else if (arg == "--strict-fp")
+        {
+            options.strict_fp = true;
+        }
+        else if (arg == "--batch")
+        {
+            options.batch = true;
+        }
+        else if (arg.starts_with("--threads="))
+        {
+            std::string_view count = arg.substr(10);
+            std::from_chars_result result = std::from_chars
+            (
+                count.data(),
+                count.data() + count.size(),
+                options.threads
+            );
+            if
+            (
+                result.ec != std::errc() ||
+                result.ptr != count.data() + count.size() ||
+                options.threads == 0
+            )
+            {
+                std::println
+                (
+                    stderr,
+                    "Error: Invalid thread count '{}'",
+                    count
+                );
+                return false;
+            }
+        }
+        else if (arg.starts_with("--max-depth="))
+        {
+            std::string_view depth = arg.substr(12);
+            std::from_chars_result result = std::from_chars
+            (
+                depth.data(),
+                depth.data() + depth.size(),
+                options.max_depth
+            );
+            if
+            (
+                result.ec != std::errc() ||
+                result.ptr != depth.data() + depth.size() ||
+                options.max_depth == 0
+            )
+            {
+                std::println
+                (
+                    stderr,
+                    "Error: Invalid call depth '{}'",
+                    depth
+                );
+                return false;
+            }
+        }
+        else if (arg.starts_with("-"))
+        {
+            std::println(stderr, "Error: Unknown option '{}'", arg);
+            return false;
+        }
+        else if (options.script.empty())
+        {
+            options.script = arg;
+        }
+        else
+        {
+            std::println(stderr, "Error: Only one script can be run");
+            return false;
+        }
+    }
+    if 
+    (
+        options.batch && 
+        (
+            options.profile || options.disassemble || options.memoize ||
+            options.stats
+        )
+    )
+    {
+        std::println
+        (
+            stderr,
+            "Error: --batch cannot be combined with --profile, "
+            "--disassemble, --memoize or --stats"
+        );
+        return false;
+    }
+    return !options.script.empty();
+}
+
+static bool ReadFile(const std::string &filename, SourceFile &file)
 {
     if (!filename.ends_with(".rd"))
     {
         std::println(stderr, "Error: File name must contain .rd extension.");
-        return "";
+        return false;
     }
 
-    std::ifstream file(filename);
-    if (!file.is_open())
+    if (!file.Open(filename))
     {
         std::println(stderr, "Error: Could not open file {}'", filename);
-        return "";
+        return false;
     }
 
-    // Check size and decide whether to pre-allocate
-    file.seekg(0, std::ios::end);
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
-    
-    std::string content;
-    
-    // Optimize: pre-allocate only for files > 8KB
-    if (size > 8192)
+    // Token offsets are 32-bit
+    if (file.Text().size() > std::numeric_limits<uint32_t>::max())
     {
-        content.reserve(size);
+        std::println(stderr, "Error: File {} is too large.", filename);
+        return false;
     }
-    
-    content.assign
+    return true;
+}
+
+static void WriteProfile(const Profiler &profiler, const std::string &path)
+{
+    std::cout.flush();
+    profiler.WriteFlatProfile(std::cerr);
+
+    std::ofstream stacks(path);
+    if (!stacks)
+    {
+        std::println(stderr, "Error: Could not write {}", path);
+        return;
+    }
+    profiler.WriteCollapsedStacks(stacks);
+    std::println(stderr, "\nCall stacks written to {}", path);
+}
+
+static void WriteMemoReport(const MemoCache &memo)
+{
+    std::cout.flush();
+    memo.WriteReport(std::cerr);
+}
+
+static void WriteRunStats
+(
+    const t_CompileStats *compile,
+    const t_RunStats &run
+)
+{
+    std::cout.flush();
+    WriteStats(compile, run, std::cerr);
+}
+
+static int64_t NanosecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
     (
-        std::istreambuf_iterator<char>(file),
-        std::istreambuf_iterator<char>()
-    );
-    
-    return content;
+        std::chrono::steady_clock::now() - start
+    ).count();
+}
+
+static t_CompileOptions CompileOptions(const t_Options &options)
+{
+    t_CompileOptions compile_options;
+    compile_options.optimize = options.optimize;
+    compile_options.strict_fp = options.strict_fp;
+    return compile_options;
+}
+
+static int RunBatchMode(const t_Options &options)
+{
+    Expected<std::vector<std::string>, std::string> scripts = 
+    CollectBatchScripts(options.script);
+    if (!scripts)
+    {
+        std::println(stderr, "Error: {}", scripts.Error());
+        return 1;
+    }
+
+    t_BatchOptions batch_options;
+    batch_options.compile = CompileOptions(options);
+    batch_options.use_vm = options.engine == e_Engine::VM;
+    batch_options.use_closures = options.engine == e_Engine::CLOSURE;
+    batch_options.cache = options.cache;
+    batch_options.benchmark_format = options.benchmark_format;
+    batch_options.threads = options.threads;
+    batch_options.max_call_depth = options.max_depth;
+
+    std::chrono::steady_clock::time_point start = 
+    std::chrono::steady_clock::now();
+    std::vector<t_BatchResult> results = 
+    RunBatch(scripts.Value(), batch_options, std::cout);
+    int64_t wall_ns = NanosecondsSince(start);
+
+    WriteBatchSummary(results, wall_ns, std::cerr);
+    for (const t_BatchResult& result : results)
+    {
+        if (result.failed)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// `compile_stats` is nullptr for a program loaded from the cache
+static int RunProgram
+(
+    const t_Program &program,
+    const t_Options &options,
+    const t_CompileStats *compile_stats
+)
+{
+    if (options.disassemble)
+    {
+        Disassemble(program);
+    }
+
+    VM vm;
+    vm.SetBenchmarkFormat(options.benchmark_format);
+    vm.SetFlushPolicy(options.flush_policy);
+    vm.SetMaxCallDepth(options.max_depth);
+
+    std::unique_ptr<MemoCache> memo;
+    if (options.memoize)
+    {
+        memo = std::make_unique<MemoCache>();
+        vm.SetMemoCache(memo.get());
+    }
+    t_RunStats stats;
+    if (options.stats)
+    {
+        vm.SetStats(&stats);
+    }
+
+    std::chrono::steady_clock::time_point start = 
+    std::chrono::steady_clock::now();
+    InterpretationResult run_result = vm.Run(program);
+    stats.run_ns = NanosecondsSince(start);
+    stats.output_bytes = vm.OutputBytes();
+
+    // Also written when the script failed, up to the error
+    if (memo)
+    {
+        WriteMemoReport(*memo);
+    }
+    if (options.stats)
+    {
+        WriteRunStats(compile_stats, stats);
+    }
+    if (!run_result)
+    {
+        ReportError(run_result.Error());
+        return 1;
+    }
+    return 0;
 }
 
 int main(int argc, char* argv[])
 {
-    if (argc < 2) 
+    // The library never touches the global stream state; the process
+    // owns stdin and stdout
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(nullptr);
+
+    t_Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+    SetThreadCount(options.threads);
+
+    if (options.batch)
+    {
+        return RunBatchMode(options);
+    }
+
+    SourceFile file;
+    if (!ReadFile(options.script, file))
     {
-        std::println("Usage: rubberduck <script.rd>");
         return 1;
     }
 
-    std::string source = ReadFile(argv[1]);
+    std::string_view source = file.Text();
     if (source.empty())
     {
         std::println("Error: file is empty or could not be read.");
         return 1; 
     }
 
-    // Lexical analysis
-    Lexer lexer(source);
-    ParsingResult tokens_result = lexer.ScanTokens();
-    if (!tokens_result)
+    // Profiling instruments the tree-walker
+    bool use_vm = options.engine == e_Engine::VM && !options.profile;
+
+    // A cache hit skips every step up to and including compilation
+    std::string cache_path = CachePath(options.script);
+    if (use_vm && options.cache)
     {
-        ReportError(tokens_result.Error());
-        return 1;
+        t_Program cached;
+        if
+        (
+            LoadCachedProgram
+            (
+                cache_path, source, 
+                CacheFlags(CompileOptions(options)), cached
+            )
+        )
+        {
+            return RunProgram(cached, options, nullptr);
+        }
     }
-    std::vector<t_Token> tokens = tokens_result.Value();
 
-    // Create AST context for memory pool management
-    ASTContext ast_context;
-
-    // Parsing with memory pool optimization
-    Parser parser(tokens, ast_context);
-    Expected<std::vector<PoolPtr<t_Stmt>>, t_ErrorInfo> statements_result = 
-    parser.Parse();
-    if (!statements_result)
+    // Every static pass, up to bytecode when the VM runs it
+    t_CompileOptions compile_options = CompileOptions(options);
+    compile_options.bytecode = use_vm;
+    Expected<std::shared_ptr<const CompiledScript>, t_ErrorInfo>
+    compile_result = CompiledScript::Compile(source, compile_options);
+    if (!compile_result)
     {
-        ReportError(statements_result.Error());
+        ReportError(compile_result.Error());
         return 1;
     }
-    std::vector<PoolPtr<t_Stmt>> statements = 
-    std::move(statements_result.Value());
+    const CompiledScript &compiled = *compile_result.Value();
+
+    if (use_vm)
+    {
+        // Best effort: a read-only directory just means no cache
+        if (options.cache)
+        {
+            SaveCachedProgram
+            (
+                cache_path, source, CacheFlags(compile_options), 
+                *compiled.Program()
+            );
+        }
+        return RunProgram(*compiled.Program(), options, &compiled.Stats());
+    }
 
     // Interpretation
     Interpreter interpreter;
+    interpreter.SetBenchmarkFormat(options.benchmark_format);
+    interpreter.SetFlushPolicy(options.flush_policy);
+    interpreter.SetClosures(options.engine == e_Engine::CLOSURE);
+    interpreter.SetMaxCallDepth(options.max_depth);
+
+    Profiler profiler;
+    if (options.profile)
+    {
+        interpreter.SetProfiler(&profiler);
+        profiler.Start(compiled.Symbols());
+    }
+
+    std::unique_ptr<MemoCache> memo;
+    if (options.memoize)
+    {
+        memo = std::make_unique<MemoCache>();
+        interpreter.SetMemoCache(memo.get());
+    }
+    t_RunStats stats;
+    if (options.stats)
+    {
+        interpreter.SetStats(&stats);
+    }
+
+    std::chrono::steady_clock::time_point start = 
+    std::chrono::steady_clock::now();
     InterpretationResult interpret_result = 
-    interpreter.Interpret(statements);
+    interpreter.Interpret(compiled);
+    stats.run_ns = NanosecondsSince(start);
+    stats.output_bytes = interpreter.OutputBytes();
+
+    // Also written when the script failed, up to the error
+    if (options.profile)
+    {
+        profiler.Stop();
+        WriteProfile(profiler, options.profile_stacks);
+    }
+    if (memo)
+    {
+        WriteMemoReport(*memo);
+    }
+    if (options.stats)
+    {
+        WriteRunStats(&compiled.Stats(), stats);
+    }
+
     if (!interpret_result)
     {
-        // Error already reported in Interpret method
+        ReportError(interpret_result.Error());
         return 1;
     }
     
@@ -0,0 +1,274 @@
+#include <rubberduck/Linker.h>
+
+Expected<int, t_ErrorInfo> Linker::Link(const StmtList &statements)
+{
+    m_Functions.clear();
+
+    for (const auto &statement : statements)
+    {
+        if (t_FunStmt *fun_stmt = As<t_FunStmt>(statement.get()))
+        {
+            m_Functions[fun_stmt->name] = fun_stmt;
+        }
+    }
+
+    // Function bodies are top-level statements too, so one walk links
+    // the script and every callable function
+    for (const auto &statement : statements)
+    {
+        Expected<int, t_ErrorInfo> result = LinkStatement(statement.get());
+        if (!result)
+        {
+            return result;
+        }
+    }
+
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> Linker::LinkStatement(t_Stmt *stmt)
+{
+    if (!stmt)
+    {
+        return Expected<int, t_ErrorInfo>(0);
+    }
+
+    if (t_BlockStmt *block_stmt = As<t_BlockStmt>(stmt))
+    {
+        for (const auto &statement : block_stmt->statements)
+        {
+            Expected<int, t_ErrorInfo> result =
+            LinkStatement(statement.get());
+            if (!result)
+            {
+                return result;
+            }
+        }
+    }
+    else if (t_IfStmt *if_stmt = As<t_IfStmt>(stmt))
+    {
+        Expected<int, t_ErrorInfo> condition_result =
+        LinkExpression(if_stmt->condition.get());
+        if (!condition_result)
+        {
+            return condition_result;
+        }
+
+        Expected<int, t_ErrorInfo> then_result =
+        LinkStatement(if_stmt->then_branch.get());
+        if (!then_result)
+        {
+            return then_result;
+        }
+
+        return LinkStatement(if_stmt->else_branch.get());
+    }
+    else if (t_ForStmt *for_stmt = As<t_ForStmt>(stmt))
+    {
+        Expected<int, t_ErrorInfo> init_result =
+        LinkStatement(for_stmt->initializer.get());
+        if (!init_result)
+        {
+            return init_result;
+        }
+
+        Expected<int, t_ErrorInfo> condition_result =
+        LinkExpression(for_stmt->condition.get());
+        if (!condition_result)
+        {
+            return condition_result;
+        }
+
+        Expected<int, t_ErrorInfo> increment_result =
+        LinkExpression(for_stmt->increment.get());
+        if (!increment_result)
+        {
+            return increment_result;
+        }
+
+        return LinkStatement(for_stmt->body.get());
+    }
+    else if (t_VarStmt *var_stmt = As<t_VarStmt>(stmt))
+    {
+        return LinkExpression(var_stmt->initializer.get());
+    }
+    else if (t_DisplayStmt *display_stmt = As<t_DisplayStmt>(stmt))
+    {
+        for (const auto &expr : display_stmt->expressions)
+        {
+            Expected<int, t_ErrorInfo> result = LinkExpression(expr.get());
+            if (!result)
+            {
+                return result;
+            }
+        }
+    }
+    else if (t_BenchmarkStmt *benchmark_stmt = As<t_BenchmarkStmt>(stmt))
+    {
+        return LinkStatement(benchmark_stmt->body.get());
+    }
+    else if (t_ExpressionStmt *expr_stmt = As<t_ExpressionStmt>(stmt))
+    {
+        return LinkExpression(expr_stmt->expression.get());
+    }
+    else if (t_ReturnStmt *return_stmt = As<t_ReturnStmt>(stmt))
+    {
+        return LinkExpression(return_stmt->value.get());
+    }
+    else if (t_FunStmt *fun_stmt = As<t_FunStmt>(stmt))
+    {
+        // Only top-level functions can be called. A nested declaration
+        // never runs, so its calls are not checked either.
+        auto it = m_Functions.find(fun_stmt->name);
+        if (it != m_Functions.end() && it->second == fun_stmt)
+        {
+            return LinkStatement(fun_stmt->body.get());
+        }
+    }
+    // getin, break, continue and t_EmptyStmt contain no calls
+
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> Linker::LinkExpression(t_Expr *expr)
+{
+    if (!expr)
+    {
+        return Expected<int, t_ErrorInfo>(0);
+    }
+
+    if (t_BinaryExpr *binary = As<t_BinaryExpr>(expr))
+    {
+        Expected<int, t_ErrorInfo> left_result =
+        LinkExpression(binary->left.get());
+        if (!left_result)
+        {
+            return left_result;
+        }
+        return LinkExpression(binary->right.get());
+    }
+    else if (t_UnaryExpr *unary = As<t_UnaryExpr>(expr))
+    {
+        return LinkExpression(unary->right.get());
+    }
+    else if (t_GroupingExpr *grouping = As<t_GroupingExpr>(expr))
+    {
+        return LinkExpression(grouping->expression.get());
+    }
+    else if (t_PrefixExpr *prefix = As<t_PrefixExpr>(expr))
+    {
+        return LinkExpression(prefix->operand.get());
+    }
+    else if (t_PostfixExpr *postfix = As<t_PostfixExpr>(expr))
+    {
+        return LinkExpression(postfix->operand.get());
+    }
+    else if (t_CallExpr *call = As<t_CallExpr>(expr))
+    {
+        return LinkCall(call);
+    }
+    else if (t_TypeofExpr *type_of = As<t_TypeofExpr>(expr))
+    {
+        return LinkExpression(type_of->operand.get());
+    }
+    else if (t_SizeofExpr *size_of = As<t_SizeofExpr>(expr))
+    {
+        return LinkExpression(size_of->operand.get());
+    }
+    else if (t_FormatStringExpr *format = As<t_FormatStringExpr>(expr))
+    {
+        for (const t_FormatSegment &segment : format->segments)
+        {
+            Expected<int, t_ErrorInfo> result =
+            LinkExpression(segment.expression.get());
+            if (!result)
+            {
+                return result;
+            }
+        }
+    }
+    else if (t_ArrayExpr *array = As<t_ArrayExpr>(expr))
+    {
+        for (const auto &element : array->elements)
+        {
+            Expected<int, t_ErrorInfo> result = LinkExpression(element.get());
+            if (!result)
+            {
+                return result;
+            }
+        }
+    }
+    else if (t_IndexExpr *index = As<t_IndexExpr>(expr))
+    {
+        Expected<int, t_ErrorInfo> object_result =
+        LinkExpression(index->object.get());
+        if (!object_result)
+        {
+            return object_result;
+        }
+        return LinkExpression(index->index.get());
+    }
+    else if (t_IndexAssignExpr *assign = As<t_IndexAssignExpr>(expr))
+    {
+        Expected<int, t_ErrorInfo> target_result =
+        LinkExpression(assign->target.get());
+        if (!target_result)
+        {
+            return target_result;
+        }
+        return LinkExpression(assign->value.get());
+    }
+    // Literals and variables contain no calls
+
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> Linker::LinkCall(t_CallExpr *call)
+{
+    for (const auto &argument : call->arguments)
+    {
+        Expected<int, t_ErrorInfo> result = LinkExpression(argument.get());
+        if (!result)
+        {
+            return result;
+        }
+    }
+
+    auto it = m_Functions.find(call->callee);
+    if (it == m_Functions.end())
+    {
+        call->target = nullptr;
+        call->builtin = FindBuiltin(m_Symbols.Name(call->callee));
+        if
+        (
+            call->builtin != e_Builtin::NONE &&
+            call->arguments.size() != BuiltinArity(call->builtin)
+        )
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::COMPILE_ERROR,
+                "Function '" + m_Symbols.Name(call->callee) +
+                "' called with wrong number of arguments",
+                call->line
+            );
+        }
+        return Expected<int, t_ErrorInfo>(0);
+    }
+
+    t_FunStmt *fun_stmt = it->second;
+    if (call->arguments.size() != fun_stmt->parameters.size())
+    {
+        return t_ErrorInfo
+        (
+            e_ErrorType::COMPILE_ERROR,
+            "Function '" + m_Symbols.Name(call->callee) +
+            "' called with wrong number of arguments",
+            call->line
+        );
+    }
+
+    call->target = fun_stmt;
+    call->builtin = e_Builtin::NONE;
+    return Expected<int, t_ErrorInfo>(0);
+}
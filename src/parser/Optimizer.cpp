@@ -0,0 +1,863 @@
+#include <rubberduck/Optimizer.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+    bool IsAssignment(e_TokenType type)
+    {
+        return type == e_TokenType::EQUAL       ||
+               type == e_TokenType::PLUS_EQUAL  ||
+               type == e_TokenType::MINUS_EQUAL ||
+               type == e_TokenType::STAR_EQUAL  ||
+               type == e_TokenType::SLASH_EQUAL ||
+               type == e_TokenType::MODULUS_EQUAL;
+    }
+
+    bool IsEmptyStatement(t_Stmt *stmt)
+    {
+        if (!stmt || As<t_EmptyStmt>(stmt))
+        {
+            return true;
+        }
+        t_BlockStmt *block = As<t_BlockStmt>(stmt);
+        return block && block->statements.empty();
+    }
+
+    // Index of the parameter a name refers to; the last one wins, as
+    // in the Resolver. SIZE_MAX if the name is not a parameter.
+    size_t ParameterIndex(const t_FunStmt *fun_stmt, t_Symbol name)
+    {
+        for (size_t i = fun_stmt->parameters.size(); i > 0; --i)
+        {
+            if (fun_stmt->parameters[i - 1] == name)
+            {
+                return i - 1;
+            }
+        }
+        return SIZE_MAX;
+    }
+
+    // The `expr` of a body that is exactly `{ return expr; }`
+    t_Expr* ReturnedExpression(const t_FunStmt *fun_stmt)
+    {
+        t_BlockStmt *block = As<t_BlockStmt>(fun_stmt->body.get());
+        if (!block || block->statements.size() != 1)
+        {
+            return nullptr;
+        }
+        t_ReturnStmt *return_stmt =
+        As<t_ReturnStmt>(block->statements[0].get());
+        return return_stmt ? return_stmt->value.get() : nullptr;
+    }
+
+    // Whether `expr` only reads parameters and can neither call,
+    // assign nor have any other effect that inlining could reorder
+    bool IsInlinable(t_Expr *expr, const t_FunStmt *fun_stmt)
+    {
+        if (!expr)
+        {
+            return false;
+        }
+
+        if (As<t_LiteralExpr>(expr))
+        {
+            return true;
+        }
+        if (t_VariableExpr *variable = As<t_VariableExpr>(expr))
+        {
+            return ParameterIndex(fun_stmt, variable->name) != SIZE_MAX;
+        }
+        if (t_GroupingExpr *grouping = As<t_GroupingExpr>(expr))
+        {
+            return IsInlinable(grouping->expression.get(), fun_stmt);
+        }
+        if (t_UnaryExpr *unary = As<t_UnaryExpr>(expr))
+        {
+            return IsInlinable(unary->right.get(), fun_stmt);
+        }
+        if (t_BinaryExpr *binary = As<t_BinaryExpr>(expr))
+        {
+            return !IsAssignment(binary->op.type) &&
+                   IsInlinable(binary->left.get(), fun_stmt) &&
+                   IsInlinable(binary->right.get(), fun_stmt);
+        }
+        return false;
+    }
+}
+
+Optimizer::Optimizer(ASTContext& context)
+    : m_Context(context) {}
+
+void Optimizer::Optimize(StmtList &statements)
+{
+    m_Locals.clear();
+    m_Globals.clear();
+    m_ScopeDepth = 0;
+    m_InMain = true;
+    m_CallSeen = false;
+
+    OptimizeStatements(statements);
+
+    // Like the Resolver, functions come last so that every global
+    // constant is known
+    m_InMain = false;
+    for (const auto &statement : statements)
+    {
+        if (t_FunStmt *fun_stmt = As<t_FunStmt>(statement.get()))
+        {
+            OptimizeFunction(fun_stmt);
+        }
+    }
+}
+
+void Optimizer::BeginScope()
+{
+    m_ScopeDepth++;
+}
+
+void Optimizer::EndScope()
+{
+    m_ScopeDepth--;
+    while (!m_Locals.empty() && m_Locals.back().depth > m_ScopeDepth)
+    {
+        m_Locals.pop_back();
+    }
+}
+
+void Optimizer::Declare(const t_VarStmt *var_stmt)
+{
+    const t_LiteralExpr *value = nullptr;
+    t_Value unused;
+    if (var_stmt->is_const && ToValue(var_stmt->initializer.get(), unused))
+    {
+        value = As<t_LiteralExpr>(var_stmt->initializer.get());
+    }
+
+    if (m_InMain && m_ScopeDepth == 0)
+    {
+        auto [it, inserted] = m_Globals.emplace
+        (
+            var_stmt->name,
+            t_GlobalName{value, !m_CallSeen}
+        );
+        if (!inserted)
+        {
+            // A redeclaration fails at runtime; keep every read as is
+            it->second = t_GlobalName{nullptr, false};
+        }
+        return;
+    }
+
+    // Non-constants are recorded too, they shadow outer constants
+    m_Locals.push_back(t_Name{var_stmt->name, m_ScopeDepth, value});
+}
+
+bool Optimizer::IsDefined(t_Symbol name) const
+{
+    for (size_t i = m_Locals.size(); i > 0; --i)
+    {
+        if (m_Locals[i - 1].name == name)
+        {
+            return true;
+        }
+    }
+
+    // In a function a global may still be undeclared when it is called
+    return m_InMain && m_Globals.contains(name);
+}
+
+const t_LiteralExpr* Optimizer::FindConstant(t_Symbol name) const
+{
+    for (size_t i = m_Locals.size(); i > 0; --i)
+    {
+        if (m_Locals[i - 1].name == name)
+        {
+            return m_Locals[i - 1].value;
+        }
+    }
+
+    auto it = m_Globals.find(name);
+    if (it == m_Globals.end())
+    {
+        return nullptr;
+    }
+    // A function may be called before the global is declared
+    if (!m_InMain && !it->second.is_visible_in_functions)
+    {
+        return nullptr;
+    }
+    return it->second.value;
+}
+
+bool Optimizer::ToValue(t_Expr *expr, t_Value& value)
+{
+    t_LiteralExpr *literal = As<t_LiteralExpr>(expr);
+    if (!literal)
+    {
+        return false;
+    }
+
+    switch (literal->token_type)
+    {
+    case e_TokenType::NUMBER:
+        {
+            if (!literal->is_number)
+            {
+                return false;
+            }
+            value = t_Value(literal->number);
+            return true;
+        }
+
+    case e_TokenType::TRUE:
+        value = t_Value(true);
+        return true;
+
+    case e_TokenType::FALSE:
+        value = t_Value(false);
+        return true;
+
+    case e_TokenType::NIL:
+        value = t_Value();
+        return true;
+
+    default:
+        value = t_Value
+        (
+            literal->symbol != NO_SYMBOL ? 
+            m_Context.Symbols().String(literal->symbol) : 
+            m_Strings.Intern(literal->value)
+        );
+        return true;
+    }
+}
+
+PoolPtr<t_Expr> Optimizer::MakeLiteral(const t_Value& value)
+{
+    switch (value.type)
+    {
+    case e_ValueType::NUMBER:
+        // inf and nan have no literal form
+        if (!std::isfinite(value.number))
+        {
+            return nullptr;
+        }
+        return PoolPtr<t_Expr>
+        (
+            m_Context.CreateExpr<t_LiteralExpr>
+            (
+                m_Context.CopyString(FormatNumber(value.number)),
+                e_TokenType::NUMBER
+            )
+        );
+
+    case e_ValueType::BOOLEAN:
+        return PoolPtr<t_Expr>
+        (
+            m_Context.CreateExpr<t_LiteralExpr>
+            (
+                value.boolean ? "true" : "false",
+                value.boolean ? e_TokenType::TRUE : e_TokenType::FALSE
+            )
+        );
+
+    case e_ValueType::STRING:
+        {
+            SymbolTable& symbols = m_Context.Symbols();
+            t_Symbol symbol = symbols.Intern(*value.string);
+            return PoolPtr<t_Expr>
+            (
+                m_Context.CreateExpr<t_LiteralExpr>
+                (
+                    symbols.Name(symbol),
+                    e_TokenType::STRING,
+                    symbol
+                )
+            );
+        }
+
+    case e_ValueType::NIL:
+    default:
+        return PoolPtr<t_Expr>
+        (
+            m_Context.CreateExpr<t_LiteralExpr>("nil", e_TokenType::NIL)
+        );
+    }
+}
+
+PoolPtr<t_Stmt> Optimizer::MakeEmptyBlock()
+{
+    return PoolPtr<t_Stmt>
+    (
+        m_Context.CreateStmt<t_BlockStmt>
+        (
+            m_Context.CreateList<PoolPtr<t_Stmt>>()
+        )
+    );
+}
+
+void Optimizer::OptimizeStatements(StmtList &statements)
+{
+    for (PoolPtr<t_Stmt> &statement : statements)
+    {
+        // Functions are optimized separately, with their own scope
+        if (!As<t_FunStmt>(statement.get()))
+        {
+            OptimizeStatement(statement);
+        }
+    }
+
+    std::erase_if
+    (
+        statements,
+        [](const PoolPtr<t_Stmt> &statement)
+        {
+            return IsEmptyStatement(statement.get());
+        }
+    );
+}
+
+void Optimizer::OptimizeScopedStatement(PoolPtr<t_Stmt> &stmt)
+{
+    BeginScope();
+    OptimizeStatement(stmt);
+    EndScope();
+}
+
+void Optimizer::OptimizeStatement(PoolPtr<t_Stmt> &stmt)
+{
+    if (!stmt)
+    {
+        return;
+    }
+
+    if (t_BlockStmt *block_stmt = As<t_BlockStmt>(stmt.get()))
+    {
+        BeginScope();
+        OptimizeStatements(block_stmt->statements);
+        EndScope();
+    }
+    else if (t_IfStmt *if_stmt = As<t_IfStmt>(stmt.get()))
+    {
+        OptimizeExpression(if_stmt->condition);
+
+        t_Value condition;
+        if (!ToValue(if_stmt->condition.get(), condition))
+        {
+            OptimizeScopedStatement(if_stmt->then_branch);
+            OptimizeScopedStatement(if_stmt->else_branch);
+            if (IsEmptyStatement(if_stmt->else_branch.get()))
+            {
+                if_stmt->else_branch.reset();
+            }
+            return;
+        }
+
+        PoolPtr<t_Stmt> taken = IsTruthy(condition)
+            ? std::move(if_stmt->then_branch)
+            : std::move(if_stmt->else_branch);
+
+        // The branch keeps a scope of its own, so its declarations
+        // stay invisible to the statements that follow
+        PoolPtr<t_Stmt> replacement;
+        if (taken && As<t_BlockStmt>(taken.get()))
+        {
+            replacement = std::move(taken);
+        }
+        else
+        {
+            replacement = MakeEmptyBlock();
+            if (replacement && taken)
+            {
+                As<t_BlockStmt>(replacement.get())->statements.push_back
+                (
+                    std::move(taken)
+                );
+            }
+        }
+
+        if (!replacement)
+        {
+            // Out of memory: put the branch back and keep the if
+            if (IsTruthy(condition))
+            {
+                if_stmt->then_branch = std::move(taken);
+            }
+            else
+            {
+                if_stmt->else_branch = std::move(taken);
+            }
+            return;
+        }
+
+        stmt = std::move(replacement);
+        OptimizeStatement(stmt);
+    }
+    else if (t_ForStmt *for_stmt = As<t_ForStmt>(stmt.get()))
+    {
+        BeginScope();
+        OptimizeStatement(for_stmt->initializer);
+        OptimizeExpression(for_stmt->condition);
+        OptimizeExpression(for_stmt->increment);
+        OptimizeScopedStatement(for_stmt->body);
+        EndScope();
+    }
+    else if (t_VarStmt *var_stmt = As<t_VarStmt>(stmt.get()))
+    {
+        // The initializer still sees an outer variable of the same name
+        OptimizeExpression(var_stmt->initializer);
+        Declare(var_stmt);
+    }
+    else if (t_DisplayStmt *display_stmt = As<t_DisplayStmt>(stmt.get()))
+    {
+        for (PoolPtr<t_Expr> &expr : display_stmt->expressions)
+        {
+            OptimizeExpression(expr);
+        }
+    }
+    else if
+    (
+        t_BenchmarkStmt *benchmark_stmt = As<t_BenchmarkStmt>(stmt.get())
+    )
+    {
+        OptimizeStatement(benchmark_stmt->body);
+    }
+    else if (t_ExpressionStmt *expr_stmt = As<t_ExpressionStmt>(stmt.get()))
+    {
+        OptimizeExpression(expr_stmt->expression);
+    }
+    else if (t_ReturnStmt *return_stmt = As<t_ReturnStmt>(stmt.get()))
+    {
+        OptimizeExpression(return_stmt->value);
+    }
+    // getin only names its target; nested t_FunStmts are never
+    // callable and are left as written.
+}
+
+void Optimizer::OptimizeFunction(t_FunStmt *fun_stmt)
+{
+    m_Locals.clear();
+    m_ScopeDepth = 1;
+
+    for (t_Symbol parameter : fun_stmt->parameters)
+    {
+        m_Locals.push_back(t_Name{parameter, 1, nullptr});
+    }
+
+    OptimizeStatement(fun_stmt->body);
+
+    m_Locals.clear();
+    m_ScopeDepth = 0;
+}
+
+void Optimizer::OptimizeExpression(PoolPtr<t_Expr> &expr)
+{
+    if (!expr)
+    {
+        return;
+    }
+
+    if (t_VariableExpr *variable = As<t_VariableExpr>(expr.get()))
+    {
+        const t_LiteralExpr *constant = FindConstant(variable->name);
+        if (!constant)
+        {
+            return;
+        }
+
+        PoolPtr<t_Expr> literal
+        (
+            m_Context.CreateExpr<t_LiteralExpr>
+            (
+                constant->value,
+                constant->token_type,
+                constant->symbol
+            )
+        );
+        if (literal)
+        {
+            expr = std::move(literal);
+        }
+    }
+    else if (t_GroupingExpr *grouping = As<t_GroupingExpr>(expr.get()))
+    {
+        OptimizeExpression(grouping->expression);
+        if (As<t_LiteralExpr>(grouping->expression.get()))
+        {
+            expr = std::move(grouping->expression);
+        }
+    }
+    else if (t_UnaryExpr *unary = As<t_UnaryExpr>(expr.get()))
+    {
+        OptimizeExpression(unary->right);
+
+        t_Value operand;
+        if (!ToValue(unary->right.get(), operand))
+        {
+            return;
+        }
+
+        PoolPtr<t_Expr> literal;
+        if (unary->op.type == e_TokenType::MINUS && operand.IsNumber())
+        {
+            literal = MakeLiteral(t_Value(-operand.number));
+        }
+        else if (unary->op.type == e_TokenType::BANG)
+        {
+            // Same rule as the interpreter: `0` counts as false here
+            bool is_false =
+            operand.IsNil() ||
+            (operand.IsBoolean() && !operand.boolean) ||
+            (operand.IsNumber() && operand.number == 0.0);
+            literal = MakeLiteral(t_Value(is_false));
+        }
+
+        if (literal)
+        {
+            expr = std::move(literal);
+        }
+    }
+    else if (t_BinaryExpr *binary = As<t_BinaryExpr>(expr.get()))
+    {
+        FoldBinary(expr, binary);
+    }
+    else if (t_CallExpr *call = As<t_CallExpr>(expr.get()))
+    {
+        for (PoolPtr<t_Expr> &argument : call->arguments)
+        {
+            OptimizeExpression(argument);
+        }
+        if (TryInline(expr, call))
+        {
+            return;
+        }
+        // From here on a function may run before later declarations
+        if (m_InMain)
+        {
+            m_CallSeen = true;
+        }
+    }
+    else if (t_TypeofExpr *type_of = As<t_TypeofExpr>(expr.get()))
+    {
+        OptimizeExpression(type_of->operand);
+    }
+    else if (t_SizeofExpr *size_of = As<t_SizeofExpr>(expr.get()))
+    {
+        OptimizeExpression(size_of->operand);
+    }
+    else if (t_FormatStringExpr *format = As<t_FormatStringExpr>(expr.get()))
+    {
+        FoldFormatString(expr, format);
+    }
+    else if (t_ArrayExpr *array = As<t_ArrayExpr>(expr.get()))
+    {
+        for (PoolPtr<t_Expr> &element : array->elements)
+        {
+            OptimizeExpression(element);
+        }
+    }
+    else if (t_IndexExpr *index = As<t_IndexExpr>(expr.get()))
+    {
+        OptimizeExpression(index->object);
+        OptimizeExpression(index->index);
+    }
+    else if (t_IndexAssignExpr *assign = As<t_IndexAssignExpr>(expr.get()))
+    {
+        // The array is changed, not the variable that holds it
+        OptimizeExpression(assign->target->object);
+        OptimizeExpression(assign->target->index);
+        OptimizeExpression(assign->value);
+    }
+    // Prefix and postfix operands are assignment targets
+}
+
+void Optimizer::FoldBinary(PoolPtr<t_Expr> &expr, t_BinaryExpr *binary)
+{
+    e_TokenType op = binary->op.type;
+    if (IsAssignment(op))
+    {
+        OptimizeExpression(binary->right);
+        return;
+    }
+
+    OptimizeExpression(binary->left);
+    t_Value left;
+    bool is_left_known = ToValue(binary->left.get(), left);
+
+    if (op == e_TokenType::AND || op == e_TokenType::OR)
+    {
+        // The right operand is only evaluated when the left one does
+        // not decide the result on its own
+        if (is_left_known && IsTruthy(left) == (op == e_TokenType::OR))
+        {
+            if (PoolPtr<t_Expr> literal = MakeLiteral(t_Value(IsTruthy(left))))
+            {
+                expr = std::move(literal);
+            }
+            return;
+        }
+
+        OptimizeExpression(binary->right);
+        t_Value right;
+        if (is_left_known && ToValue(binary->right.get(), right))
+        {
+            if (PoolPtr<t_Expr> literal = MakeLiteral(t_Value(IsTruthy(right))))
+            {
+                expr = std::move(literal);
+            }
+        }
+        return;
+    }
+
+    OptimizeExpression(binary->right);
+    t_Value right;
+    if (!is_left_known || !ToValue(binary->right.get(), right))
+    {
+        return;
+    }
+
+    PoolPtr<t_Expr> literal;
+    if (op == e_TokenType::EQUAL_EQUAL || op == e_TokenType::BANG_EQUAL)
+    {
+        bool equal = ValuesEqual(left, right);
+        literal = MakeLiteral
+        (
+            t_Value(op == e_TokenType::EQUAL_EQUAL ? equal : !equal)
+        );
+    }
+    else if (left.IsNumber() && right.IsNumber())
+    {
+        double a = left.number;
+        double b = right.number;
+        switch (op)
+        {
+        case e_TokenType::PLUS:
+            literal = MakeLiteral(t_Value(a + b));
+            break;
+        case e_TokenType::MINUS:
+            literal = MakeLiteral(t_Value(a - b));
+            break;
+        case e_TokenType::STAR:
+            literal = MakeLiteral(t_Value(a * b));
+            break;
+        case e_TokenType::SLASH:
+            if (b != 0)
+            {
+                literal = MakeLiteral(t_Value(a / b));
+            }
+            break;
+        case e_TokenType::MODULUS:
+            if (b != 0)
+            {
+                literal = MakeLiteral(t_Value(std::fmod(a, b)));
+            }
+            break;
+        case e_TokenType::LESS:
+            literal = MakeLiteral(t_Value(a < b));
+            break;
+        case e_TokenType::LESS_EQUAL:
+            literal = MakeLiteral(t_Value(a <= b));
+            break;
+        case e_TokenType::GREATER:
+            literal = MakeLiteral(t_Value(a > b));
+            break;
+        case e_TokenType::GREATER_EQUAL:
+            literal = MakeLiteral(t_Value(a >= b));
+            break;
+        default:
+            break;
+        }
+    }
+    // Everything else is a type error the runtime has to report
+
+    if (literal)
+    {
+        expr = std::move(literal);
+    }
+}
+
+void Optimizer::FoldFormatString
+(
+    PoolPtr<t_Expr> &expr,
+    t_FormatStringExpr *format
+)
+{
+    ArenaVector<t_FormatSegment> segments = 
+    m_Context.CreateList<t_FormatSegment>();
+    segments.reserve(format->segments.size());
+    std::string pending;
+    size_t text_size = 0;
+    bool has_expression = false;
+
+    auto FlushPending = [&]()
+    {
+        if (pending.empty())
+        {
+            return;
+        }
+        text_size += pending.size();
+        segments.push_back
+        (
+            t_FormatSegment{m_Context.CopyString(pending), nullptr}
+        );
+        pending.clear();
+    };
+
+    for (t_FormatSegment &segment : format->segments)
+    {
+        OptimizeExpression(segment.expression);
+
+        // A known value becomes text, merged with the text around it
+        t_Value value;
+        if (!segment.expression)
+        {
+            pending.append(segment.text);
+        }
+        else if (ToValue(segment.expression.get(), value))
+        {
+            AppendValue(pending, value);
+        }
+        else
+        {
+            FlushPending();
+            segments.push_back(std::move(segment));
+            has_expression = true;
+        }
+    }
+
+    if (!has_expression)
+    {
+        if
+        (
+            PoolPtr<t_Expr> literal =
+            MakeLiteral(t_Value(m_Strings.Intern(pending)))
+        )
+        {
+            expr = std::move(literal);
+            return;
+        }
+    }
+
+    FlushPending();
+    format->segments = std::move(segments);
+    format->text_size = text_size;
+}
+
+bool Optimizer::TryInline(PoolPtr<t_Expr> &expr, t_CallExpr *call)
+{
+    // Undefined functions and prototypes keep their runtime error
+    const t_FunStmt *fun_stmt = call->target;
+    t_Expr *body = fun_stmt ? ReturnedExpression(fun_stmt) : nullptr;
+    if (!body || !IsInlinable(body, fun_stmt))
+    {
+        return false;
+    }
+
+    // Arguments may be read any number of times, or not at all, once
+    // they are substituted, so each one must be free to evaluate
+    for (const PoolPtr<t_Expr> &argument : call->arguments)
+    {
+        t_VariableExpr *variable = As<t_VariableExpr>(argument.get());
+        if (!As<t_LiteralExpr>(argument.get()) &&
+            !(variable && IsDefined(variable->name)))
+        {
+            return false;
+        }
+    }
+
+    PoolPtr<t_Expr> inlined = CloneInlined(body, fun_stmt, call->arguments);
+    if (!inlined)
+    {
+        return false;
+    }
+
+    // The call node is released here, so `call` must not be used after
+    expr = std::move(inlined);
+    OptimizeExpression(expr);
+    return true;
+}
+
+PoolPtr<t_Expr> Optimizer::CloneInlined
+(
+    t_Expr *expr,
+    const t_FunStmt *fun_stmt,
+    const ExprList &arguments
+)
+{
+    if (t_LiteralExpr *literal = As<t_LiteralExpr>(expr))
+    {
+        return PoolPtr<t_Expr>
+        (
+            m_Context.CreateExpr<t_LiteralExpr>
+            (
+                literal->value,
+                literal->token_type,
+                literal->symbol
+            )
+        );
+    }
+
+    if (t_VariableExpr *variable = As<t_VariableExpr>(expr))
+    {
+        // A parameter becomes a copy of its argument, which is a
+        // literal or a variable of the caller
+        if (fun_stmt)
+        {
+            size_t index = ParameterIndex(fun_stmt, variable->name);
+            return CloneInlined(arguments[index].get(), nullptr, arguments);
+        }
+        return PoolPtr<t_Expr>
+        (
+            m_Context.CreateExpr<t_VariableExpr>(variable->name)
+        );
+    }
+
+    if (t_GroupingExpr *grouping = As<t_GroupingExpr>(expr))
+    {
+        PoolPtr<t_Expr> inner =
+        CloneInlined(grouping->expression.get(), fun_stmt, arguments);
+        if (!inner)
+        {
+            return nullptr;
+        }
+        return PoolPtr<t_Expr>
+        (
+            m_Context.CreateExpr<t_GroupingExpr>(std::move(inner))
+        );
+    }
+
+    if (t_UnaryExpr *unary = As<t_UnaryExpr>(expr))
+    {
+        PoolPtr<t_Expr> right =
+        CloneInlined(unary->right.get(), fun_stmt, arguments);
+        if (!right)
+        {
+            return nullptr;
+        }
+        return PoolPtr<t_Expr>
+        (
+            m_Context.CreateExpr<t_UnaryExpr>(unary->op, std::move(right))
+        );
+    }
+
+    t_BinaryExpr *binary = As<t_BinaryExpr>(expr);
+    PoolPtr<t_Expr> left =
+    CloneInlined(binary->left.get(), fun_stmt, arguments);
+    PoolPtr<t_Expr> right =
+    CloneInlined(binary->right.get(), fun_stmt, arguments);
+    if (!left || !right)
+    {
+        return nullptr;
+    }
+    return PoolPtr<t_Expr>
+    (
+        m_Context.CreateExpr<t_BinaryExpr>
+        (
+            std::move(left),
+            binary->op,
+            std::move(right)
+        )
+    );
+}
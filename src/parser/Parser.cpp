@@ -2,7 +2,8 @@
 #include <rubberduck/AST.h>
 #include <rubberduck/ErrorHandling.h>
 #include <rubberduck/ASTContext.h> 
-#include <print>
+#include <rubberduck/Lexer.h>
+#include <rubberduck/Value.h>
 #include <string>
 #include <cmath>
 
@@ -34,27 +35,16 @@ namespace
         {
             return false;
         }
-
-        try
-        {
-            out_value = std::stod(literal->value);
-            return true;
-        }
-        catch (...)
-        {
-            return false;
-        }
+        out_value = literal->number;
+        return literal->is_number;
     }
 
     t_LiteralExpr *MakeNumberLiteral(double value, ASTContext& context)
     {
-        std::string text = std::to_string(value);
-        text.erase(text.find_last_not_of('0') + 1, std::string::npos);
-        text.erase(text.find_last_not_of('.') + 1, std::string::npos);
-
+        // Same text `display` would print, which reads back exactly
         return context.CreateExpr<t_LiteralExpr>
         (
-            text, 
+            context.CopyString(FormatNumber(value)), 
             e_TokenType::NUMBER
         );
     }
@@ -62,25 +52,25 @@ namespace
 
 Parser::Parser
 (
+    std::string_view source,
     const std::vector<t_Token> &tokens, 
     ASTContext& context
 )
-    : m_Tokens(tokens), m_Current(0), m_Context(context) {}
+    : m_Source(source), m_Tokens(tokens), m_Current(0), m_Context(context) {}
 
-Expected<std::vector<PoolPtr<t_Stmt>>, t_ErrorInfo> Parser::Parse()
+Expected<StmtList, t_ErrorInfo> Parser::Parse()
 {
-    std::vector<PoolPtr<t_Stmt>> statements;
-    statements.reserve(64);
+    size_t first = m_StmtStack.size();
     while (!IsAtEnd())
     {
         Expected<t_Stmt*, t_ErrorInfo> result = Statement();
         if(!result) return result.Error();
-        statements.emplace_back(PoolPtr<t_Stmt>(result.Value()));
+        m_StmtStack.emplace_back(PoolPtr<t_Stmt>(result.Value()));
     }
 
-    return Expected<std::vector<PoolPtr<t_Stmt>>, t_ErrorInfo>
+    return Expected<StmtList, t_ErrorInfo>
     (
-        std::move(statements)
+        m_Context.CreateList(m_StmtStack, first)
     );
 }
 
@@ -89,7 +79,7 @@ bool Parser::IsAtEnd()
     return Peek().type == e_TokenType::EOF_TOKEN;
 }
 
-t_Token Parser::Advance()
+const t_Token& Parser::Advance()
 {
     if (!IsAtEnd()) m_Current++;
     return Previous();
@@ -101,26 +91,36 @@ bool Parser::Check(e_TokenType type)
     return Peek().type == type;
 }
 
-t_Token Parser::Peek()
+static const t_Token eof_token
+{
+    e_TokenType::EOF_TOKEN, 0, 0, 0, NO_SYMBOL
+};
+
+const t_Token& Parser::Peek()
 {
     if (static_cast<size_t>(m_Current) >= m_Tokens.size())
     {
         // Return EOF token if we're past the end of the tokens vector
-        return t_Token(e_TokenType::EOF_TOKEN, "", "", 0);
+        return eof_token;
     }
     return m_Tokens[m_Current];
 }
 
-t_Token Parser::Previous()
+const t_Token& Parser::Previous()
 {
     if (m_Current <= 0)
     {
         // Return EOF token if we're at the beginning or before
-        return t_Token(e_TokenType::EOF_TOKEN, "", "", 0);
+        return eof_token;
     }
     return m_Tokens[m_Current - 1];
 }
 
+std::string_view Parser::Text(const t_Token &token) const
+{
+    return m_Source.substr(token.offset, token.length);
+}
+
 bool Parser::Match(std::initializer_list<e_TokenType> types)
 {
     for (e_TokenType type : types)
@@ -151,13 +151,24 @@ Expected<t_Token, t_ErrorInfo> Parser::Consume
     );
 }
 
-t_ErrorInfo Parser::Error(t_Token token, const std::string &message)
+t_ErrorInfo Parser::Error(const t_Token &token, const std::string &message)
 {
-    std::println(stderr, "Error: {} at line {}", message, token.line);
     return t_ErrorInfo(e_ErrorType::PARSING_ERROR, message, token.line, 0);
 }
 
 Expected<t_Stmt*, t_ErrorInfo> Parser::Statement()
+{
+    // Every statement remembers the line it starts on
+    int line = Peek().line;
+    Expected<t_Stmt*, t_ErrorInfo> result = DispatchStatement();
+    if (result)
+    {
+        result.Value()->line = line;
+    }
+    return result;
+}
+
+Expected<t_Stmt*, t_ErrorInfo> Parser::DispatchStatement()
 {
     if (Match({e_TokenType::LEFT_BRACE}))
     {
@@ -179,6 +190,11 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::Statement()
         return ForStatement();
     }
 
+    if (Match({e_TokenType::PARALLEL}))
+    {
+        return ParallelForStatement();
+    }
+
     if (Match({e_TokenType::BREAK}))
     {
         return BreakStatement();
@@ -229,9 +245,7 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::Statement()
 
 Expected<t_Stmt*, t_ErrorInfo> Parser::BlockStatement()
 {
-    std::vector<PoolPtr<t_Stmt>> statements;
-    statements.reserve(64);
-
+    size_t first = m_StmtStack.size();
     while (!Check(e_TokenType::RIGHT_BRACE) && !IsAtEnd())
     {
         Expected<t_Stmt*, t_ErrorInfo> result = Statement();
@@ -239,8 +253,9 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::BlockStatement()
         {
             return result.Error();
         }
-        statements.emplace_back(PoolPtr<t_Stmt>(result.Value()));
+        m_StmtStack.emplace_back(PoolPtr<t_Stmt>(result.Value()));
     }
+    StmtList statements = m_Context.CreateList(m_StmtStack, first);
 
     Expected<t_Token, t_ErrorInfo> consume_result = 
     Consume(e_TokenType::RIGHT_BRACE, "Expect '}' after block.");
@@ -374,6 +389,36 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::IfStatement()
     return Expected<t_Stmt*, t_ErrorInfo>(stmt);
 }
 
+Expected<t_Stmt*, t_ErrorInfo> Parser::ParallelForStatement()
+{
+    Expected<t_Token, t_ErrorInfo> for_result =
+    Consume(e_TokenType::FOR, "Expect 'for' after 'parallel'.");
+    if (!for_result)
+    {
+        return for_result.Error();
+    }
+
+    Expected<t_Stmt*, t_ErrorInfo> loop_result = ForStatement();
+    if (!loop_result)
+    {
+        return loop_result;
+    }
+
+    // The loop variable has to count from a literal to a literal, so
+    // the iteration range is known before the loop starts
+    t_ForStmt *for_stmt = static_cast<t_ForStmt*>(loop_result.Value());
+    if (!As<t_VarStmt>(for_stmt->initializer.get()))
+    {
+        return Error
+        (
+            for_result.Value(),
+            "A parallel for must declare its loop variable."
+        );
+    }
+    for_stmt->is_parallel = true;
+    return loop_result;
+}
+
 Expected<t_Stmt*, t_ErrorInfo> Parser::ForStatement()
 {
     Expected<t_Token, t_ErrorInfo> paren_result = 
@@ -449,6 +494,10 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::ForStatement()
             return semicolon_result.Error();
         }
     }
+    if (initializer)
+    {
+        initializer->line = paren_result.Value().line;
+    }
 
     // Parse condition
     PoolPtr<t_Expr> condition;
@@ -781,7 +830,7 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::VarDeclaration()
             return t_ErrorInfo
             (
                 e_ErrorType::PARSING_ERROR,
-                "Constant '" + name.lexeme + "' must be initialized",
+                "Constant '" + std::string(Text(name)) + "' must be initialized",
                 name.line,
                 0
             );
@@ -822,7 +871,7 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::VarDeclaration()
     
     t_VarStmt* stmt = m_Context.CreateStmt<t_VarStmt>
     (
-        name.lexeme, 
+        name.symbol, 
         std::move(initializer),
         is_const
     );
@@ -841,8 +890,7 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::VarDeclaration()
 
 Expected<t_Stmt*, t_ErrorInfo> Parser::DisplayStatement()
 {
-    std::vector<PoolPtr<t_Expr>> values;
-    values.reserve(64);
+    size_t first = m_ExprStack.size();
 
     // Parse the first expression
     Expected<t_Expr*, t_ErrorInfo> first_expr_result = Expression();
@@ -850,7 +898,7 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::DisplayStatement()
     {
         return first_expr_result.Error();
     }
-    values.emplace_back(PoolPtr<t_Expr>(first_expr_result.Value()));
+    m_ExprStack.emplace_back(PoolPtr<t_Expr>(first_expr_result.Value()));
 
     // Parse additional comma-separated expressions
     while (Match({e_TokenType::COMMA}))
@@ -860,8 +908,9 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::DisplayStatement()
         {
             return expr_result.Error();
         }
-        values.emplace_back(PoolPtr<t_Expr>(expr_result.Value()));
+        m_ExprStack.emplace_back(PoolPtr<t_Expr>(expr_result.Value()));
     }
+    ExprList values = m_Context.CreateList(m_ExprStack, first);
 
     Expected<t_Token, t_ErrorInfo> semicolon_result = 
     Consume(e_TokenType::SEMICOLON, "Expect ';' after value.");
@@ -902,17 +951,26 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::GetinStatement()
         return open_paren_result.Error();
     }
 
-    Expected<t_Token, t_ErrorInfo> name_result =
-    Consume
-    (
-        e_TokenType::IDENTIFIER,
-        "Expect variable (non constant) name in getin()."
-    );
-    if (!name_result)
+    std::vector<t_GetinTarget> targets;
+    while (true)
     {
-        return name_result.Error();
+        Expected<t_Token, t_ErrorInfo> name_result =
+        Consume
+        (
+            e_TokenType::IDENTIFIER,
+            "Expect variable (non constant) name in getin()."
+        );
+        if (!name_result)
+        {
+            return name_result.Error();
+        }
+        targets.push_back(t_GetinTarget{name_result.Value().symbol, {}});
+
+        if (!Match({e_TokenType::COMMA}))
+        {
+            break;
+        }
     }
-    t_Token variable_token = name_result.Value();
 
     Expected<t_Token, t_ErrorInfo> close_paren_result =
     Consume
@@ -939,7 +997,7 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::GetinStatement()
     t_GetinStmt* stmt = m_Context.CreateStmt<t_GetinStmt>
     (
         getin_identifier, 
-        variable_token.lexeme
+        m_Context.CreateList(targets)
     );
     if (!stmt)
     {
@@ -979,8 +1037,7 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::FunDeclaration()
         return open_paren_result.Error();
     }
 
-    std::vector<std::string> parameters;
-    parameters.reserve(128);
+    std::vector<t_Symbol> parameter_names;
     if (!Check(e_TokenType::RIGHT_PAREN))
     {
         while (true)
@@ -1007,10 +1064,7 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::FunDeclaration()
                 return param_name_result.Error();
             }
 
-            parameters.emplace_back
-            (
-                param_name_result.Value().lexeme
-            );
+            parameter_names.push_back(param_name_result.Value().symbol);
 
             if (!Match({e_TokenType::COMMA}))
             {
@@ -1029,6 +1083,8 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::FunDeclaration()
     {
         return close_paren_result.Error();
     }
+    ArenaVector<t_Symbol> parameters = 
+    m_Context.CreateList(parameter_names);
 
     // Function can be declared with a body or as a prototype;
     // if the next token is '{', parse a body statement, otherwise
@@ -1045,7 +1101,7 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::FunDeclaration()
 
         t_FunStmt* stmt = m_Context.CreateStmt<t_FunStmt>
         (
-            name_token.lexeme,
+            name_token.symbol,
             std::move(parameters),
             PoolPtr<t_Stmt>(body_stmt)
         );
@@ -1075,7 +1131,7 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::FunDeclaration()
 
     t_FunStmt* stmt = m_Context.CreateStmt<t_FunStmt>
     (
-        name_token.lexeme,
+        name_token.symbol,
         std::move(parameters),
         PoolPtr<t_Stmt>(nullptr)
     );
@@ -1141,8 +1197,81 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::EmptyStatement()
     return Expected<t_Stmt*, t_ErrorInfo>(stmt);
 }
 
+Expected<uint32_t, t_ErrorInfo> Parser::BenchmarkCount
+(
+    const std::string &what,
+    uint32_t minimum
+)
+{
+    Expected<t_Token, t_ErrorInfo> count_result =
+    Consume(e_TokenType::NUMBER, "Expect " + what + " count.");
+    if (!count_result)
+    {
+        return count_result.Error();
+    }
+
+    double count = 0.0;
+    if
+    (
+        !ParseNumber(Text(count_result.Value()), count) ||
+        count != std::floor(count) ||
+        count < minimum ||
+        count > MAX_BENCHMARK_RUNS
+    )
+    {
+        return t_ErrorInfo
+        (
+            e_ErrorType::PARSING_ERROR,
+            "Benchmark " + what + " count must be a whole number from " +
+            std::to_string(minimum) + " to " +
+            std::to_string(MAX_BENCHMARK_RUNS),
+            count_result.Value().line,
+            0
+        );
+    }
+    return Expected<uint32_t, t_ErrorInfo>(static_cast<uint32_t>(count));
+}
+
 Expected<t_Stmt*, t_ErrorInfo> Parser::BenchmarkStatement()
 {
+    int line = Previous().line;
+
+    // benchmark(iterations) or benchmark(iterations, warmup)
+    uint32_t iterations = 1;
+    uint32_t warmup = 0;
+    if (Match({e_TokenType::LEFT_PAREN}))
+    {
+        Expected<uint32_t, t_ErrorInfo> iterations_result =
+        BenchmarkCount("iteration", 1);
+        if (!iterations_result)
+        {
+            return iterations_result.Error();
+        }
+        iterations = iterations_result.Value();
+
+        if (Match({e_TokenType::COMMA}))
+        {
+            Expected<uint32_t, t_ErrorInfo> warmup_result =
+            BenchmarkCount("warmup", 0);
+            if (!warmup_result)
+            {
+                return warmup_result.Error();
+            }
+            warmup = warmup_result.Value();
+        }
+
+        Expected<t_Token, t_ErrorInfo> close_paren_result =
+        Consume
+        (
+            e_TokenType::RIGHT_PAREN,
+            "Expect ')' after benchmark counts."
+        );
+        if (!close_paren_result)
+        {
+            return close_paren_result.Error();
+        }
+    }
+
     Expected<t_Token, t_ErrorInfo> open_brace_result = 
     Consume
     (
@@ -1151,12 +1280,11 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::BenchmarkStatement()
     );
     if (!open_brace_result)
     {
-        open_brace_result.Error();
+        return open_brace_result.Error();
     }
     
     // Parse the benchmark body
-    std::vector<PoolPtr<t_Stmt>> statements;
-    statements.reserve(32);
+    size_t first = m_StmtStack.size();
     while (!Check(e_TokenType::RIGHT_BRACE) && !IsAtEnd())
     {
         Expected<t_Stmt*, t_ErrorInfo> stmt_result = Statement();
@@ -1164,8 +1292,9 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::BenchmarkStatement()
         {
             return stmt_result.Error();
         }
-        statements.emplace_back(PoolPtr<t_Stmt>(stmt_result.Value()));
+        m_StmtStack.emplace_back(PoolPtr<t_Stmt>(stmt_result.Value()));
     }
+    StmtList statements = m_Context.CreateList(m_StmtStack, first);
     
     Expected<t_Token, t_ErrorInfo> close_brace_result = 
     Consume(e_TokenType::RIGHT_BRACE, "Expect '}' after benchmark body.");
@@ -1190,8 +1319,13 @@ Expected<t_Stmt*, t_ErrorInfo> Parser::BenchmarkStatement()
         );
     }
     
-    t_BenchmarkStmt* stmt = 
-    m_Context.CreateStmt<t_BenchmarkStmt>(PoolPtr<t_Stmt>(body));
+    t_BenchmarkStmt* stmt = m_Context.CreateStmt<t_BenchmarkStmt>
+    (
+        PoolPtr<t_Stmt>(body),
+        iterations,
+        warmup,
+        line
+    );
     if (!stmt)
     {
         return t_ErrorInfo
@@ -1210,6 +1344,131 @@ Expected<t_Expr*, t_ErrorInfo> Parser::Expression()
     return Assignment();
 }
 
+Expected<t_Expr*, t_ErrorInfo> Parser::StandaloneExpression()
+{
+    Expected<t_Expr*, t_ErrorInfo> expr_result = Expression();
+    if (!expr_result)
+    {
+        return expr_result;
+    }
+
+    if (!IsAtEnd())
+    {
+        return t_ErrorInfo
+        (
+            e_ErrorType::PARSING_ERROR,
+            "Unexpected tokens after expression",
+            Peek().line,
+            0
+        );
+    }
+    return expr_result;
+}
+
+Expected<t_Expr*, t_ErrorInfo> Parser::FormatString(const t_Token &token)
+{
+    // Each `{expr}` is parsed once here; the text in between becomes
+    // literal segments. An unterminated brace is kept verbatim, and so
+    // is anything between braces that is not an expression.
+    std::string_view text = Text(token);
+    const std::string format = Lexer::Unescape
+    (
+        text.substr(2, text.size() - 3) // drop `$"` and `"`
+    );
+    std::vector<t_FormatSegment> segments;
+    std::string pending;
+    size_t text_size = 0;
+    size_t pos = 0;
+
+    auto FlushPending = [&]()
+    {
+        if (pending.empty())
+        {
+            return;
+        }
+        text_size += pending.size();
+        segments.push_back
+        (
+            t_FormatSegment{m_Context.CopyString(pending), nullptr}
+        );
+        pending.clear();
+    };
+
+    while (pos < format.size())
+    {
+        size_t open = format.find('{', pos);
+        size_t close =
+        (
+            open == std::string::npos
+        ) ? std::string::npos : format.find('}', open);
+
+        if (open == std::string::npos || close == std::string::npos)
+        {
+            pending.append(format, pos, std::string::npos);
+            break;
+        }
+
+        pending.append(format, pos, open - pos);
+        std::string source = format.substr(open + 1, close - open - 1);
+        source.erase(0, source.find_first_not_of(" \t"));
+        source.erase(source.find_last_not_of(" \t") + 1);
+        pos = close + 1;
+
+        if (source.empty())
+        {
+            continue;
+        }
+
+        Lexer lexer(source, m_Context.Symbols());
+        ParsingResult tokens_result = lexer.ScanTokens();
+        PoolPtr<t_Expr> parsed;
+        if (tokens_result)
+        {
+            // Errors inside the braces point at the string itself
+            std::vector<t_Token> tokens = std::move(tokens_result.Value());
+            for (t_Token &inner : tokens)
+            {
+                inner.line = token.line;
+            }
+
+            Parser parser(source, tokens, m_Context);
+            Expected<t_Expr*, t_ErrorInfo> expr_result =
+            parser.StandaloneExpression();
+            if (expr_result)
+            {
+                parsed = PoolPtr<t_Expr>(expr_result.Value());
+            }
+        }
+
+        if (!parsed)
+        {
+            pending.append(source);
+            continue;
+        }
+
+        FlushPending();
+        segments.push_back(t_FormatSegment{{}, std::move(parsed)});
+    }
+    FlushPending();
+
+    t_FormatStringExpr* expr_node =
+    m_Context.CreateExpr<t_FormatStringExpr>
+    (
+        m_Context.CreateList(segments), text_size
+    );
+    if (!expr_node)
+    {
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR, 
+            "Out of memory", 
+            token.line, 
+            0
+        );
+    }
+    return Expected<t_Expr*, t_ErrorInfo>(expr_node);
+}
+
 Expected<t_Expr*, t_ErrorInfo> Parser::Assignment()
 {
     Expected<t_Expr*, t_ErrorInfo> expr_result = Or();
@@ -1242,9 +1501,8 @@ Expected<t_Expr*, t_ErrorInfo> Parser::Assignment()
         }
         t_Expr *value = value_result.Value();
 
-        if (t_VariableExpr *var_expr = As<t_VariableExpr>(expr))
+        if (As<t_VariableExpr>(expr))
         {
-            std::string name = var_expr->name;
             t_BinaryExpr* expr_node = m_Context.CreateExpr<t_BinaryExpr>
             (
                 PoolPtr<t_Expr>(expr), 
@@ -1264,6 +1522,28 @@ Expected<t_Expr*, t_ErrorInfo> Parser::Assignment()
             return Expected<t_Expr*, t_ErrorInfo>(expr_node);
         }
 
+        if (t_IndexExpr *target = As<t_IndexExpr>(expr))
+        {
+            t_IndexAssignExpr* expr_node =
+            m_Context.CreateExpr<t_IndexAssignExpr>
+            (
+                PoolPtr<t_IndexExpr>(target),
+                equals,
+                PoolPtr<t_Expr>(value)
+            );
+            if (!expr_node)
+            {
+                return t_ErrorInfo
+                (
+                    e_ErrorType::RUNTIME_ERROR,
+                    "Out of memory",
+                    equals.line,
+                    0
+                );
+            }
+            return Expected<t_Expr*, t_ErrorInfo>(expr_node);
+        }
+
         // If we get here, we're trying to assign to a non-variable
         return t_ErrorInfo
         (
@@ -1657,10 +1937,56 @@ Expected<t_Expr*, t_ErrorInfo> Parser::FinishUnary()
     }
     t_Expr *expr = expr_result.Value();
 
-    // Handle postfix increment/decrement
-    while (Match({e_TokenType::PLUS_PLUS, e_TokenType::MINUS_MINUS}))
+    // Handle indexing and postfix increment/decrement
+    while
+    (
+        Match
+        (
+            {
+                e_TokenType::LEFT_BRACKET,
+                e_TokenType::PLUS_PLUS,
+                e_TokenType::MINUS_MINUS
+            }
+        )
+    )
     {
         t_Token op = Previous();
+        if (op.type == e_TokenType::LEFT_BRACKET)
+        {
+            Expected<t_Expr*, t_ErrorInfo> index_result = Expression();
+            if (!index_result)
+            {
+                return index_result;
+            }
+            t_Expr *index = index_result.Value();
+
+            Expected<t_Token, t_ErrorInfo> bracket_result =
+            Consume(e_TokenType::RIGHT_BRACKET, "Expect ']' after index.");
+            if (!bracket_result)
+            {
+                return bracket_result.Error();
+            }
+
+            t_IndexExpr* index_node = m_Context.CreateExpr<t_IndexExpr>
+            (
+                PoolPtr<t_Expr>(expr),
+                PoolPtr<t_Expr>(index),
+                op.line
+            );
+            if (!index_node)
+            {
+                return t_ErrorInfo
+                (
+                    e_ErrorType::RUNTIME_ERROR,
+                    "Out of memory",
+                    op.line,
+                    0
+                );
+            }
+            expr = index_node;
+            continue;
+        }
+
         t_PostfixExpr* expr_node = 
         m_Context.CreateExpr<t_PostfixExpr>
         (
@@ -1747,24 +2073,36 @@ Expected<t_Expr*, t_ErrorInfo> Parser::Primary()
         return Expected<t_Expr*, t_ErrorInfo>(expr_node);
     }
 
-    if 
-    (
-        Match
-        (
-            {
-                e_TokenType::NUMBER, 
-                e_TokenType::STRING, 
-                e_TokenType::FORMAT_STRING
-            }
-        )
-    )
+    if (Match({e_TokenType::FORMAT_STRING}))
     {
-        t_Token previous = Previous();
-        t_LiteralExpr* expr_node = 
-        m_Context.CreateExpr<t_LiteralExpr>
-        (
-            previous.literal, previous.type
-        );
+        return FormatString(Previous());
+    }
+
+    if (Match({e_TokenType::NUMBER, e_TokenType::STRING}))
+    {
+        const t_Token &previous = Previous();
+        std::string_view text = Text(previous);
+        t_LiteralExpr* expr_node = nullptr;
+        if (previous.type == e_TokenType::STRING)
+        {
+            // The symbol table keeps the one copy of the text
+            SymbolTable& symbols = m_Context.Symbols();
+            t_Symbol symbol = symbols.Intern
+            (
+                Lexer::Unescape(text.substr(1, text.size() - 2))
+            );
+            expr_node = m_Context.CreateExpr<t_LiteralExpr>
+            (
+                symbols.Name(symbol), previous.type, symbol
+            );
+        }
+        else
+        {
+            expr_node = m_Context.CreateExpr<t_LiteralExpr>
+            (
+                m_Context.CopyString(text), previous.type
+            );
+        }
         if (!expr_node)
         {
             return t_ErrorInfo
@@ -1810,8 +2148,7 @@ Expected<t_Expr*, t_ErrorInfo> Parser::Primary()
 
         if (Match({e_TokenType::LEFT_PAREN}))
         {
-            std::vector<PoolPtr<t_Expr>> arguments;
-
+            size_t first = m_ExprStack.size();
             if (!Check(e_TokenType::RIGHT_PAREN))
             {
                 while (true)
@@ -1823,7 +2160,7 @@ Expected<t_Expr*, t_ErrorInfo> Parser::Primary()
                         return argument_result;
                     }
 
-                    arguments.emplace_back
+                    m_ExprStack.emplace_back
                     (
                         PoolPtr<t_Expr>(argument_result.Value())
                     );
@@ -1834,6 +2171,7 @@ Expected<t_Expr*, t_ErrorInfo> Parser::Primary()
                     }
                 }
             }
+            ExprList arguments = m_Context.CreateList(m_ExprStack, first);
 
             Expected<t_Token, t_ErrorInfo> close_paren_result =
             Consume
@@ -1848,7 +2186,7 @@ Expected<t_Expr*, t_ErrorInfo> Parser::Primary()
 
             t_CallExpr* call_expr = m_Context.CreateExpr<t_CallExpr>
             (
-                identifier.lexeme, 
+                identifier.symbol, 
                 std::move(arguments),
                 identifier.line
             );
@@ -1866,7 +2204,7 @@ Expected<t_Expr*, t_ErrorInfo> Parser::Primary()
         }
 
         t_VariableExpr* expr_node = 
-        m_Context.CreateExpr<t_VariableExpr>(identifier.lexeme);
+        m_Context.CreateExpr<t_VariableExpr>(identifier.symbol);
         if (!expr_node)
         {
             return t_ErrorInfo
@@ -1880,6 +2218,105 @@ Expected<t_Expr*, t_ErrorInfo> Parser::Primary()
         return Expected<t_Expr*, t_ErrorInfo>(expr_node);
     }
 
+    if (Match({e_TokenType::LEFT_BRACKET}))
+    {
+        int line = Previous().line;
+        size_t first = m_ExprStack.size();
+        if (!Check(e_TokenType::RIGHT_BRACKET))
+        {
+            while (true)
+            {
+                Expected<t_Expr*, t_ErrorInfo> element_result =
+                Expression();
+                if (!element_result)
+                {
+                    return element_result;
+                }
+
+                m_ExprStack.emplace_back
+                (
+                    PoolPtr<t_Expr>(element_result.Value())
+                );
+
+                if (!Match({e_TokenType::COMMA}))
+                {
+                    break;
+                }
+            }
+        }
+        ExprList elements = m_Context.CreateList(m_ExprStack, first);
+
+        Expected<t_Token, t_ErrorInfo> bracket_result = Consume
+        (
+            e_TokenType::RIGHT_BRACKET,
+            "Expect ']' after array elements."
+        );
+        if (!bracket_result)
+        {
+            return bracket_result.Error();
+        }
+
+        t_ArrayExpr* expr_node =
+        m_Context.CreateExpr<t_ArrayExpr>(std::move(elements), line);
+        if (!expr_node)
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Out of memory",
+                line,
+                0
+            );
+        }
+        return Expected<t_Expr*, t_ErrorInfo>(expr_node);
+    }
+
+    if (Match({e_TokenType::SIZEOF}))
+    {
+        t_Token keyword = Previous();
+        Expected<t_Token, t_ErrorInfo> open_result =
+        Consume(e_TokenType::LEFT_PAREN, "Expect '(' after 'sizeof'.");
+        if (!open_result)
+        {
+            return open_result.Error();
+        }
+
+        Expected<t_Expr*, t_ErrorInfo> operand_result = Expression();
+        if (!operand_result)
+        {
+            return operand_result;
+        }
+        t_Expr *operand = operand_result.Value();
+
+        Expected<t_Token, t_ErrorInfo> close_result = Consume
+        (
+            e_TokenType::RIGHT_PAREN,
+            "Expect ')' after sizeof operand."
+        );
+        if (!close_result)
+        {
+            return close_result.Error();
+        }
+
+        t_SizeofExpr* expr_node =
+        m_Context.CreateExpr<t_SizeofExpr>
+        (
+            PoolPtr<t_Expr>(operand),
+            keyword.line
+        );
+        if (!expr_node)
+        {
+            return t_ErrorInfo
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Out of memory",
+                keyword.line,
+                0
+            );
+        }
+        return Expected<t_Expr*, t_ErrorInfo>(expr_node);
+    }
+
     if (Match({e_TokenType::LEFT_PAREN}))
     {
         Expected<t_Expr*, t_ErrorInfo> expr_result = Expression();
@@ -0,0 +1,204 @@
+#include <rubberduck/PurityChecker.h>
+#include <rubberduck/Memo.h>
+
+void PurityChecker::Check(const StmtList& statements)
+{
+    m_Functions.clear();
+    m_Index.clear();
+
+    for (const auto& statement : statements)
+    {
+        if (t_FunStmt* fun_stmt = As<t_FunStmt>(statement.get()))
+        {
+            m_Index[fun_stmt] = m_Functions.size();
+            m_Functions.push_back(t_FunctionInfo{fun_stmt, true, {}});
+        }
+    }
+
+    for (t_FunctionInfo& info : m_Functions)
+    {
+        m_Current = &info;
+        CheckStatement(info.function->body.get());
+    }
+    m_Current = nullptr;
+
+    // A function that calls an impure one is impure too; repeat until
+    // that changes nothing, which also settles recursive functions
+    bool is_changed = true;
+    while (is_changed)
+    {
+        is_changed = false;
+        for (t_FunctionInfo& info : m_Functions)
+        {
+            if (!info.is_pure)
+            {
+                continue;
+            }
+            for (t_FunStmt* callee : info.callees)
+            {
+                auto it = m_Index.find(callee);
+                if (it == m_Index.end() || !m_Functions[it->second].is_pure)
+                {
+                    info.is_pure = false;
+                    is_changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    int32_t slot = 0;
+    for (t_FunctionInfo& info : m_Functions)
+    {
+        bool is_memoized =
+            info.is_pure &&
+            info.function->parameters.size() <= MAX_MEMO_ARITY;
+        info.function->memo_slot = is_memoized ? slot++ : -1;
+    }
+}
+
+void PurityChecker::CheckBinding(const t_Binding& binding)
+{
+    if (binding.kind != e_BindingKind::LOCAL)
+    {
+        m_Current->is_pure = false;
+    }
+}
+
+void PurityChecker::CheckStatement(t_Stmt* stmt)
+{
+    if (!stmt || !m_Current->is_pure)
+    {
+        return;
+    }
+
+    if (t_BlockStmt* block_stmt = As<t_BlockStmt>(stmt))
+    {
+        for (const auto& statement : block_stmt->statements)
+        {
+            CheckStatement(statement.get());
+        }
+    }
+    else if (t_IfStmt* if_stmt = As<t_IfStmt>(stmt))
+    {
+        CheckExpression(if_stmt->condition.get());
+        CheckStatement(if_stmt->then_branch.get());
+        CheckStatement(if_stmt->else_branch.get());
+    }
+    else if (t_ForStmt* for_stmt = As<t_ForStmt>(stmt))
+    {
+        CheckStatement(for_stmt->initializer.get());
+        CheckExpression(for_stmt->condition.get());
+        CheckExpression(for_stmt->increment.get());
+        CheckStatement(for_stmt->body.get());
+    }
+    else if (t_VarStmt* var_stmt = As<t_VarStmt>(stmt))
+    {
+        CheckExpression(var_stmt->initializer.get());
+        CheckBinding(var_stmt->binding);
+    }
+    else if (t_ExpressionStmt* expr_stmt = As<t_ExpressionStmt>(stmt))
+    {
+        CheckExpression(expr_stmt->expression.get());
+    }
+    else if (t_ReturnStmt* return_stmt = As<t_ReturnStmt>(stmt))
+    {
+        CheckExpression(return_stmt->value.get());
+    }
+    else if
+    (
+        As<t_DisplayStmt>(stmt) ||
+        As<t_GetinStmt>(stmt) ||
+        As<t_BenchmarkStmt>(stmt)
+    )
+    {
+        m_Current->is_pure = false;
+    }
+    // break, continue and empty statements change nothing, and a
+    // nested function declaration is never called
+}
+
+void PurityChecker::CheckExpression(t_Expr* expr)
+{
+    if (!expr || !m_Current->is_pure)
+    {
+        return;
+    }
+
+    if (t_VariableExpr* variable = As<t_VariableExpr>(expr))
+    {
+        CheckBinding(variable->binding);
+    }
+    else if (t_BinaryExpr* binary = As<t_BinaryExpr>(expr))
+    {
+        CheckExpression(binary->left.get());
+        CheckExpression(binary->right.get());
+    }
+    else if (t_UnaryExpr* unary = As<t_UnaryExpr>(expr))
+    {
+        CheckExpression(unary->right.get());
+    }
+    else if (t_GroupingExpr* grouping = As<t_GroupingExpr>(expr))
+    {
+        CheckExpression(grouping->expression.get());
+    }
+    else if (t_PrefixExpr* prefix = As<t_PrefixExpr>(expr))
+    {
+        CheckExpression(prefix->operand.get());
+    }
+    else if (t_PostfixExpr* postfix = As<t_PostfixExpr>(expr))
+    {
+        CheckExpression(postfix->operand.get());
+    }
+    else if (t_CallExpr* call = As<t_CallExpr>(expr))
+    {
+        if (call->target)
+        {
+            m_Current->callees.push_back(call->target);
+        }
+        else if (call->builtin == e_Builtin::NONE)
+        {
+            // An undefined function, which fails when it is reached
+            m_Current->is_pure = false;
+        }
+        for (const auto& argument : call->arguments)
+        {
+            CheckExpression(argument.get());
+        }
+    }
+    else if (t_TypeofExpr* type_of = As<t_TypeofExpr>(expr))
+    {
+        CheckExpression(type_of->operand.get());
+    }
+    else if (t_SizeofExpr* size_of = As<t_SizeofExpr>(expr))
+    {
+        CheckExpression(size_of->operand.get());
+    }
+    else if (t_FormatStringExpr* format = As<t_FormatStringExpr>(expr))
+    {
+        for (const t_FormatSegment& segment : format->segments)
+        {
+            CheckExpression(segment.expression.get());
+        }
+    }
+    else if (t_ArrayExpr* array = As<t_ArrayExpr>(expr))
+    {
+        for (const auto& element : array->elements)
+        {
+            CheckExpression(element.get());
+        }
+    }
+    else if (t_IndexExpr* index = As<t_IndexExpr>(expr))
+    {
+        CheckExpression(index->object.get());
+        CheckExpression(index->index.get());
+    }
+    else if (t_IndexAssignExpr* assign = As<t_IndexAssignExpr>(expr))
+    {
+        // Only an array the call made itself can be reached here: a
+        // global is impure and an array argument is never memoized
+        CheckExpression(assign->target.get());
+        CheckExpression(assign->value.get());
+    }
+    // Literals read nothing
+}
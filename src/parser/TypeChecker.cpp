@@ -0,0 +1,774 @@
+#include <rubberduck/TypeChecker.h>
+
+namespace
+{
+    const char* StaticTypeName(e_StaticType type)
+    {
+        switch (type)
+        {
+        case e_StaticType::NIL:
+            return ValueTypeName(e_ValueType::NIL);
+        case e_StaticType::NUMBER:
+            return ValueTypeName(e_ValueType::NUMBER);
+        case e_StaticType::STRING:
+            return ValueTypeName(e_ValueType::STRING);
+        case e_StaticType::BOOLEAN:
+            return ValueTypeName(e_ValueType::BOOLEAN);
+        case e_StaticType::ARRAY:
+            return ValueTypeName(e_ValueType::ARRAY);
+        case e_StaticType::STRING_ARRAY:
+            return ValueTypeName(e_ValueType::STRING_ARRAY);
+        case e_StaticType::UNKNOWN:
+        default:
+            return "unknown";
+        }
+    }
+
+    bool IsOrdering(e_TokenType op)
+    {
+        return op == e_TokenType::GREATER       ||
+               op == e_TokenType::GREATER_EQUAL ||
+               op == e_TokenType::LESS          ||
+               op == e_TokenType::LESS_EQUAL;
+    }
+
+    // Types arithmetic accepts: numbers, and number arrays with
+    // numbers or arrays of the same size
+    bool IsNumeric(e_StaticType type)
+    {
+        return type == e_StaticType::NUMBER || type == e_StaticType::ARRAY;
+    }
+
+    bool IsKnown(e_StaticType type)
+    {
+        return type != e_StaticType::UNKNOWN;
+    }
+}
+
+Expected<int, t_ErrorInfo> TypeChecker::Check
+(
+    const StmtList &statements,
+    const t_ResolvedScript &script
+)
+{
+    m_GlobalTypes.assign
+    (
+        script.global_names.size(),
+        e_StaticType::UNKNOWN
+    );
+    m_LocalTypes.clear();
+    m_Line = 0;
+
+    // Same order as the Resolver: the script first, so that functions
+    // see the type of every global
+    for (const auto &statement : statements)
+    {
+        if (statement->kind == e_StmtKind::FUNCTION)
+        {
+            continue;
+        }
+        Expected<int, t_ErrorInfo> result = CheckStatement(statement.get());
+        if (!result)
+        {
+            return result;
+        }
+    }
+
+    for (const auto &statement : statements)
+    {
+        if (t_FunStmt *fun_stmt = As<t_FunStmt>(statement.get()))
+        {
+            Expected<int, t_ErrorInfo> result = CheckFunction(fun_stmt);
+            if (!result)
+            {
+                return result;
+            }
+        }
+    }
+
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> TypeChecker::CheckFunction(t_FunStmt *fun_stmt)
+{
+    // Parameters take whatever the caller passes
+    m_LocalTypes.assign(fun_stmt->frame_size, e_StaticType::UNKNOWN);
+    Expected<int, t_ErrorInfo> result = CheckStatement(fun_stmt->body.get());
+    m_LocalTypes.clear();
+    return result;
+}
+
+t_ErrorInfo TypeChecker::TypeError(const std::string &message) const
+{
+    return t_ErrorInfo(e_ErrorType::TYPE_ERROR, message, m_Line, 0);
+}
+
+e_StaticType TypeChecker::VariableType(const t_Binding &binding) const
+{
+    if
+    (
+        binding.kind == e_BindingKind::LOCAL &&
+        binding.slot < m_LocalTypes.size()
+    )
+    {
+        return m_LocalTypes[binding.slot];
+    }
+    if
+    (
+        binding.kind == e_BindingKind::GLOBAL &&
+        binding.slot < m_GlobalTypes.size()
+    )
+    {
+        return m_GlobalTypes[binding.slot];
+    }
+    return e_StaticType::UNKNOWN;
+}
+
+Expected<int, t_ErrorInfo> TypeChecker::CheckStatement(t_Stmt *stmt)
+{
+    if (!stmt)
+    {
+        return Expected<int, t_ErrorInfo>(0);
+    }
+    m_Line = stmt->line;
+
+    switch (stmt->kind)
+    {
+    case e_StmtKind::BLOCK:
+        for (const auto &statement : As<t_BlockStmt>(stmt)->statements)
+        {
+            Expected<int, t_ErrorInfo> result =
+            CheckStatement(statement.get());
+            if (!result)
+            {
+                return result;
+            }
+        }
+        break;
+
+    case e_StmtKind::IF:
+        {
+            t_IfStmt *if_stmt = As<t_IfStmt>(stmt);
+            Expected<e_StaticType, t_ErrorInfo> condition =
+            CheckExpression(if_stmt->condition.get());
+            if (!condition)
+            {
+                return condition.Error();
+            }
+            Expected<int, t_ErrorInfo> then_result =
+            CheckStatement(if_stmt->then_branch.get());
+            if (!then_result)
+            {
+                return then_result;
+            }
+            return CheckStatement(if_stmt->else_branch.get());
+        }
+
+    case e_StmtKind::FOR:
+        {
+            t_ForStmt *for_stmt = As<t_ForStmt>(stmt);
+            Expected<int, t_ErrorInfo> init_result =
+            CheckStatement(for_stmt->initializer.get());
+            if (!init_result)
+            {
+                return init_result;
+            }
+            m_Line = for_stmt->line;
+            for
+            (
+                t_Expr *expr :
+                {for_stmt->condition.get(), for_stmt->increment.get()}
+            )
+            {
+                Expected<e_StaticType, t_ErrorInfo> result =
+                CheckExpression(expr);
+                if (!result)
+                {
+                    return result.Error();
+                }
+            }
+            return CheckStatement(for_stmt->body.get());
+        }
+
+    case e_StmtKind::VAR:
+        return CheckVar(As<t_VarStmt>(stmt));
+
+    case e_StmtKind::DISPLAY:
+        for (const auto &expr : As<t_DisplayStmt>(stmt)->expressions)
+        {
+            Expected<e_StaticType, t_ErrorInfo> result =
+            CheckExpression(expr.get());
+            if (!result)
+            {
+                return result.Error();
+            }
+        }
+        break;
+
+    case e_StmtKind::BENCHMARK:
+        return CheckStatement(As<t_BenchmarkStmt>(stmt)->body.get());
+
+    case e_StmtKind::EXPRESSION:
+    case e_StmtKind::RETURN:
+        {
+            t_Expr *expr = stmt->kind == e_StmtKind::EXPRESSION
+                ? As<t_ExpressionStmt>(stmt)->expression.get()
+                : As<t_ReturnStmt>(stmt)->value.get();
+            Expected<e_StaticType, t_ErrorInfo> result =
+            CheckExpression(expr);
+            if (!result)
+            {
+                return result.Error();
+            }
+        }
+        break;
+
+    case e_StmtKind::GETIN:
+        // Input is converted to the type the variable already has
+    case e_StmtKind::FUNCTION:
+        // Top-level functions are checked after the script; nested
+        // declarations are never callable and were not resolved
+    case e_StmtKind::BREAK:
+    case e_StmtKind::CONTINUE:
+    case e_StmtKind::EMPTY:
+        break;
+    }
+
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<int, t_ErrorInfo> TypeChecker::CheckVar(t_VarStmt *var_stmt)
+{
+    e_StaticType type = e_StaticType::UNKNOWN;
+    if (var_stmt->initializer)
+    {
+        Expected<e_StaticType, t_ErrorInfo> result =
+        CheckExpression(var_stmt->initializer.get());
+        if (!result)
+        {
+            return result.Error();
+        }
+        type = result.Value();
+    }
+
+    // A variable declared as nil takes the type of its first value
+    if (type == e_StaticType::NIL)
+    {
+        type = e_StaticType::UNKNOWN;
+    }
+
+    // A redeclaration fails once it is reached, so nothing after it
+    // runs; until then the first declaration holds
+    if (var_stmt->is_redeclaration)
+    {
+        type = e_StaticType::UNKNOWN;
+    }
+
+    uint32_t slot = var_stmt->binding.slot;
+    if (var_stmt->binding.kind == e_BindingKind::GLOBAL)
+    {
+        m_GlobalTypes[slot] = type;
+    }
+    else if (var_stmt->binding.kind == e_BindingKind::LOCAL)
+    {
+        if (slot >= m_LocalTypes.size())
+        {
+            m_LocalTypes.resize(slot + 1, e_StaticType::UNKNOWN);
+        }
+        m_LocalTypes[slot] = type;
+    }
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+Expected<e_StaticType, t_ErrorInfo> TypeChecker::CheckExpression
+(
+    t_Expr *expr
+)
+{
+    if (!expr)
+    {
+        return e_StaticType::UNKNOWN;
+    }
+
+    Expected<e_StaticType, t_ErrorInfo> result = InferExpression(expr);
+    if (result)
+    {
+        expr->static_type = result.Value();
+    }
+    return result;
+}
+
+Expected<e_StaticType, t_ErrorInfo> TypeChecker::InferExpression
+(
+    t_Expr *expr
+)
+{
+    switch (expr->kind)
+    {
+    case e_ExprKind::LITERAL:
+        {
+            t_LiteralExpr *literal = As<t_LiteralExpr>(expr);
+            switch (literal->token_type)
+            {
+            case e_TokenType::NUMBER:
+                // An invalid literal is a runtime error
+                return literal->is_number
+                    ? e_StaticType::NUMBER
+                    : e_StaticType::UNKNOWN;
+            case e_TokenType::TRUE:
+            case e_TokenType::FALSE:
+                return e_StaticType::BOOLEAN;
+            case e_TokenType::NIL:
+                return e_StaticType::NIL;
+            default:
+                return e_StaticType::STRING;
+            }
+        }
+
+    case e_ExprKind::FORMAT_STRING:
+        for
+        (
+            const t_FormatSegment &segment :
+            As<t_FormatStringExpr>(expr)->segments
+        )
+        {
+            Expected<e_StaticType, t_ErrorInfo> result =
+            CheckExpression(segment.expression.get());
+            if (!result)
+            {
+                return result;
+            }
+        }
+        return e_StaticType::STRING;
+
+    case e_ExprKind::GROUPING:
+        return CheckExpression(As<t_GroupingExpr>(expr)->expression.get());
+
+    case e_ExprKind::VARIABLE:
+        return VariableType(As<t_VariableExpr>(expr)->binding);
+
+    case e_ExprKind::CALL:
+        return CheckCall(As<t_CallExpr>(expr));
+
+    case e_ExprKind::UNARY:
+        {
+            t_UnaryExpr *unary = As<t_UnaryExpr>(expr);
+            Expected<e_StaticType, t_ErrorInfo> operand =
+            CheckExpression(unary->right.get());
+            if (!operand)
+            {
+                return operand;
+            }
+            if (unary->op.type == e_TokenType::BANG)
+            {
+                return e_StaticType::BOOLEAN;
+            }
+            if
+            (
+                unary->op.type == e_TokenType::MINUS &&
+                IsKnown(operand.Value()) &&
+                operand.Value() != e_StaticType::NUMBER
+            )
+            {
+                return TypeError("Cannot negate non-numeric value");
+            }
+            return unary->op.type == e_TokenType::MINUS
+                ? e_StaticType::NUMBER
+                : e_StaticType::UNKNOWN;
+        }
+
+    case e_ExprKind::PREFIX:
+        return CheckIncrement
+        (
+            As<t_PrefixExpr>(expr)->operand.get(),
+            "Cannot perform increment/decrement on non-numeric value"
+        );
+
+    case e_ExprKind::POSTFIX:
+        {
+            t_PostfixExpr *postfix = As<t_PostfixExpr>(expr);
+            return CheckIncrement
+            (
+                postfix->operand.get(),
+                postfix->op.type == e_TokenType::PLUS_PLUS
+                    ? "Cannot perform increment on non-numeric value"
+                    : "Cannot perform decrement on non-numeric value"
+            );
+        }
+
+    case e_ExprKind::BINARY:
+        return CheckBinary(As<t_BinaryExpr>(expr));
+
+    case e_ExprKind::ARRAY:
+        {
+            // Elements must all be numbers or all be strings
+            e_StaticType array_type = e_StaticType::ARRAY;
+            bool is_first = true;
+            for (const auto &element : As<t_ArrayExpr>(expr)->elements)
+            {
+                Expected<e_StaticType, t_ErrorInfo> result =
+                CheckExpression(element.get());
+                if (!result)
+                {
+                    return result;
+                }
+                e_StaticType element_type =
+                result.Value() == e_StaticType::STRING
+                    ? e_StaticType::STRING_ARRAY
+                    : result.Value() == e_StaticType::NUMBER
+                        ? e_StaticType::ARRAY
+                        : e_StaticType::UNKNOWN;
+                if (is_first)
+                {
+                    array_type = element_type;
+                    is_first = false;
+                }
+                else if (element_type != array_type)
+                {
+                    array_type = e_StaticType::UNKNOWN;
+                }
+            }
+            return array_type;
+        }
+
+    case e_ExprKind::INDEX:
+        {
+            t_IndexExpr *index = As<t_IndexExpr>(expr);
+            Expected<e_StaticType, t_ErrorInfo> object =
+            CheckExpression(index->object.get());
+            if (!object)
+            {
+                return object;
+            }
+            Expected<e_StaticType, t_ErrorInfo> position =
+            CheckExpression(index->index.get());
+            if (!position)
+            {
+                return position;
+            }
+            if (object.Value() == e_StaticType::ARRAY)
+            {
+                return e_StaticType::NUMBER;
+            }
+            if (object.Value() == e_StaticType::STRING_ARRAY)
+            {
+                return e_StaticType::STRING;
+            }
+            return e_StaticType::UNKNOWN;
+        }
+
+    case e_ExprKind::INDEX_ASSIGN:
+        {
+            t_IndexAssignExpr *assign = As<t_IndexAssignExpr>(expr);
+            Expected<e_StaticType, t_ErrorInfo> target =
+            CheckExpression(assign->target.get());
+            if (!target)
+            {
+                return target;
+            }
+            Expected<e_StaticType, t_ErrorInfo> value =
+            CheckExpression(assign->value.get());
+            if (!value)
+            {
+                return value;
+            }
+            // An element keeps the type of its array
+            return target.Value();
+        }
+
+    case e_ExprKind::SIZEOF:
+        {
+            Expected<e_StaticType, t_ErrorInfo> operand =
+            CheckExpression(As<t_SizeofExpr>(expr)->operand.get());
+            if (!operand)
+            {
+                return operand;
+            }
+            return e_StaticType::NUMBER;
+        }
+
+    case e_ExprKind::TYPEOF:
+        // Not produced by the parser yet
+        break;
+    }
+
+    return e_StaticType::UNKNOWN;
+}
+
+Expected<e_StaticType, t_ErrorInfo> TypeChecker::CheckIncrement
+(
+    t_Expr *operand,
+    const char *message
+)
+{
+    Expected<e_StaticType, t_ErrorInfo> type = CheckExpression(operand);
+    if (!type)
+    {
+        return type;
+    }
+
+    // Modifying a constant is reported first, while running
+    t_VariableExpr *variable = As<t_VariableExpr>(operand);
+    if
+    (
+        variable &&
+        !variable->binding.is_const &&
+        IsKnown(type.Value()) &&
+        type.Value() != e_StaticType::NUMBER
+    )
+    {
+        return TypeError(message);
+    }
+    return e_StaticType::NUMBER;
+}
+
+Expected<e_StaticType, t_ErrorInfo> TypeChecker::CheckCall
+(
+    t_CallExpr *call
+)
+{
+    std::vector<e_StaticType> arguments;
+    arguments.reserve(call->arguments.size());
+    for (const auto &argument : call->arguments)
+    {
+        Expected<e_StaticType, t_ErrorInfo> result =
+        CheckExpression(argument.get());
+        if (!result)
+        {
+            return result;
+        }
+        arguments.push_back(result.Value());
+    }
+
+    // User functions may return anything
+    if (call->target)
+    {
+        return e_StaticType::UNKNOWN;
+    }
+
+    switch (call->builtin)
+    {
+    case e_Builtin::SUM:
+    case e_Builtin::MIN:
+    case e_Builtin::MAX:
+    case e_Builtin::DOT:
+        return e_StaticType::NUMBER;
+
+    case e_Builtin::SORT:
+    case e_Builtin::PUSH:
+        // Both yield their array argument
+        if
+        (
+            !arguments.empty() &&
+            (
+                arguments[0] == e_StaticType::ARRAY ||
+                arguments[0] == e_StaticType::STRING_ARRAY
+            )
+        )
+        {
+            return arguments[0];
+        }
+        break;
+
+    case e_Builtin::ARRAY:
+        if (arguments.size() == 2)
+        {
+            if (arguments[1] == e_StaticType::NUMBER)
+            {
+                return e_StaticType::ARRAY;
+            }
+            if (arguments[1] == e_StaticType::STRING)
+            {
+                return e_StaticType::STRING_ARRAY;
+            }
+        }
+        break;
+
+    case e_Builtin::NONE:
+    default:
+        break;
+    }
+    return e_StaticType::UNKNOWN;
+}
+
+Expected<e_StaticType, t_ErrorInfo> TypeChecker::ArithmeticType
+(
+    e_StaticType left,
+    e_TokenType op,
+    e_StaticType right
+) const
+{
+    if
+    (
+        op == e_TokenType::PLUS &&
+        (left == e_StaticType::STRING || right == e_StaticType::STRING)
+    )
+    {
+        return TypeError
+        (
+            "String concatenation with '+' is not allowed. Use comma-separated values in display statements instead."
+        );
+    }
+
+    bool left_fails = IsKnown(left) && !IsNumeric(left);
+    bool right_fails = IsKnown(right) && !IsNumeric(right);
+    // With `+`, an unknown operand that turns out to be a string
+    // changes the message, so the other side has to be known as well
+    bool is_certain = op != e_TokenType::PLUS ||
+                      (IsKnown(left) && IsKnown(right));
+    if ((left_fails || right_fails) && is_certain)
+    {
+        return TypeError("Cannot perform arithmetic operation");
+    }
+
+    if (left == e_StaticType::NUMBER && right == e_StaticType::NUMBER)
+    {
+        return e_StaticType::NUMBER;
+    }
+    if
+    (
+        IsNumeric(left) && IsNumeric(right) &&
+        (left == e_StaticType::ARRAY || right == e_StaticType::ARRAY)
+    )
+    {
+        return e_StaticType::ARRAY;
+    }
+    return e_StaticType::UNKNOWN;
+}
+
+Expected<e_StaticType, t_ErrorInfo> TypeChecker::CheckBinary
+(
+    t_BinaryExpr *binary
+)
+{
+    e_TokenType op = binary->op.type;
+    if (AssignmentOperator(op) != e_TokenType::EOF_TOKEN)
+    {
+        return CheckAssignment(binary);
+    }
+
+    Expected<e_StaticType, t_ErrorInfo> left_result =
+    CheckExpression(binary->left.get());
+    if (!left_result)
+    {
+        return left_result;
+    }
+    Expected<e_StaticType, t_ErrorInfo> right_result =
+    CheckExpression(binary->right.get());
+    if (!right_result)
+    {
+        return right_result;
+    }
+    e_StaticType left = left_result.Value();
+    e_StaticType right = right_result.Value();
+    bool both_numbers =
+    left == e_StaticType::NUMBER && right == e_StaticType::NUMBER;
+
+    if (op == e_TokenType::AND || op == e_TokenType::OR)
+    {
+        return e_StaticType::BOOLEAN;
+    }
+
+    if (IsArithmetic(op))
+    {
+        if (both_numbers)
+        {
+            binary->form = e_BinaryForm::NUMBER;
+        }
+        return ArithmeticType(left, op, right);
+    }
+
+    if (op == e_TokenType::EQUAL_EQUAL || op == e_TokenType::BANG_EQUAL)
+    {
+        if (both_numbers)
+        {
+            binary->form = e_BinaryForm::NUMBER;
+        }
+        return e_StaticType::BOOLEAN;
+    }
+
+    if (IsOrdering(op))
+    {
+        if
+        (
+            (IsKnown(left) && left != e_StaticType::NUMBER) ||
+            (IsKnown(right) && right != e_StaticType::NUMBER)
+        )
+        {
+            return TypeError("Cannot compare non-numeric values");
+        }
+        if (both_numbers)
+        {
+            binary->form = e_BinaryForm::NUMBER;
+        }
+        return e_StaticType::BOOLEAN;
+    }
+
+    return e_StaticType::UNKNOWN;
+}
+
+Expected<e_StaticType, t_ErrorInfo> TypeChecker::CheckAssignment
+(
+    t_BinaryExpr *binary
+)
+{
+    // A target that is not a variable is reported while running
+    t_VariableExpr *variable = As<t_VariableExpr>(binary->left.get());
+    e_StaticType target = e_StaticType::UNKNOWN;
+    if (variable)
+    {
+        target = VariableType(variable->binding);
+        variable->static_type = target;
+    }
+
+    Expected<e_StaticType, t_ErrorInfo> right_result =
+    CheckExpression(binary->right.get());
+    if (!right_result)
+    {
+        return right_result;
+    }
+    e_StaticType right = right_result.Value();
+
+    // Assigning to a constant is reported first, while running
+    if (!variable || variable->binding.is_const)
+    {
+        return right;
+    }
+
+    e_TokenType arithmetic = AssignmentOperator(binary->op.type);
+    e_StaticType assigned = right;
+    if (arithmetic != e_TokenType::EQUAL)
+    {
+        Expected<e_StaticType, t_ErrorInfo> result =
+        ArithmeticType(target, arithmetic, right);
+        if (!result)
+        {
+            return result;
+        }
+        assigned = result.Value();
+    }
+
+    if (!IsKnown(target))
+    {
+        return assigned;
+    }
+    if (IsKnown(assigned) && assigned != target)
+    {
+        return TypeError
+        (
+            "Type mismatch: variable '"     +
+            m_Symbols.Name(variable->name)      +
+            "' is "                         +
+            StaticTypeName(target)          +
+            ", cannot assign "              +
+            StaticTypeName(assigned)
+        );
+    }
+
+    if (target == e_StaticType::NUMBER && right == e_StaticType::NUMBER)
+    {
+        binary->form = e_BinaryForm::NUMBER;
+    }
+    // Any other value fails the check made while running
+    return target;
+}
@@ -0,0 +1,113 @@
+#include <rubberduck/Bytecode.h>
+#include <rubberduck/LoopKernel.h>
+#include <iomanip>
+#include <iostream>
+
+const char* OpCodeName(e_OpCode op)
+{
+    switch (op)
+    {
+#define RD_OPCODE_NAME(name) case e_OpCode::name: return #name;
+        RD_OPCODES(RD_OPCODE_NAME)
+#undef RD_OPCODE_NAME
+    default:
+        return "UNKNOWN";
+    }
+}
+
+static void DisassembleFunction
+(
+    const t_FunctionProto& proto,
+    const t_Program& program
+)
+{
+    std::cout << "== " << proto.name
+              << " (arity " << proto.arity
+              << ", max stack " << proto.max_stack << ") ==\n";
+
+    const t_Chunk& chunk = proto.chunk;
+    for (size_t offset = 0; offset < chunk.code.size(); ++offset)
+    {
+        e_OpCode op = DecodeOp(chunk.code[offset]);
+        uint32_t arg = DecodeArg(chunk.code[offset]);
+
+        std::cout << std::setw(5) << std::setfill('0') << offset
+                  << std::setfill(' ') << "  line "
+                  << std::setw(4) << chunk.lines[offset] << "  "
+                  << std::left << std::setw(16) << OpCodeName(op)
+                  << std::right << arg;
+
+        switch (op)
+        {
+        case e_OpCode::CONSTANT:
+        case e_OpCode::OUTPUT_TEXT:
+        case e_OpCode::RUNTIME_ERROR:
+            {
+                std::string text;
+                AppendValue(text, chunk.constants[arg]);
+                std::cout << "  '";
+                for (char c : text)
+                {
+                    if (c == '\n')
+                    {
+                        std::cout << "\\n";
+                    }
+                    else if (c == '\t')
+                    {
+                        std::cout << "\\t";
+                    }
+                    else
+                    {
+                        std::cout << c;
+                    }
+                }
+                std::cout << "'";
+            }
+            break;
+
+        case e_OpCode::GET_GLOBAL:
+        case e_OpCode::SET_GLOBAL:
+        case e_OpCode::DEFINE_GLOBAL:
+        case e_OpCode::INC_GLOBAL:
+        case e_OpCode::DEC_GLOBAL:
+        case e_OpCode::GETIN_GLOBAL:
+            std::cout << "  " << *program.global_names[arg];
+            break;
+
+        case e_OpCode::CALL:
+        case e_OpCode::TAIL_CALL:
+            std::cout << "  " << program.functions[arg].name;
+            break;
+
+        case e_OpCode::PARALLEL_FOR:
+            std::cout << "  x"
+                      << program.parallel_loops[arg].loop->trip_count;
+            break;
+
+        case e_OpCode::LOOP_KERNEL:
+            std::cout << "  "
+                      << program.loop_kernels[arg].kernel->code.size()
+                      << " kernel ops";
+            break;
+
+        case e_OpCode::BENCHMARK_BEGIN:
+            std::cout << "  x" << program.benchmarks[arg].iterations
+                      << " warmup " << program.benchmarks[arg].warmup;
+            break;
+
+        default:
+            break;
+        }
+        std::cout << "\n";
+    }
+    std::cout << "\n";
+}
+
+void Disassemble(const t_Program& program)
+{
+    DisassembleFunction(program.main, program);
+    for (const t_FunctionProto& proto : program.functions)
+    {
+        DisassembleFunction(proto, program);
+    }
+}
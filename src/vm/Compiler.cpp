@@ -0,0 +1,1400 @@
+#include <rubberduck/Compiler.h>
+#include <rubberduck/LoopKernel.h>
+#include <cmath>
+#include <string>
+
+namespace
+{
+    bool IsCompoundAssignment(e_TokenType type)
+    {
+        return type == e_TokenType::EQUAL        ||
+               type == e_TokenType::PLUS_EQUAL   ||
+               type == e_TokenType::MINUS_EQUAL  ||
+               type == e_TokenType::STAR_EQUAL   ||
+               type == e_TokenType::SLASH_EQUAL  ||
+               type == e_TokenType::MODULUS_EQUAL;
+    }
+}
+
+Compiler::Compiler(const SymbolTable& symbols)
+    : m_Symbols(symbols),
+      m_Program(nullptr),
+      m_State(nullptr),
+      m_Line(0),
+      m_Failed(false) {}
+
+Expected<int, t_ErrorInfo> Compiler::Compile
+(
+    const StmtList &statements,
+    t_Program& program
+)
+{
+    m_Program = &program;
+    m_Failed = false;
+    m_Globals.clear();
+    m_FunctionIndex.clear();
+    m_FunctionDecls.clear();
+
+    // Functions are hoisted: only top-level declarations are callable
+    // and a later declaration with the same name replaces the earlier.
+    for (const auto &statement : statements)
+    {
+        if (t_FunStmt *fun_stmt = As<t_FunStmt>(statement.get()))
+        {
+            auto it = m_FunctionIndex.find(fun_stmt->name);
+            if (it != m_FunctionIndex.end())
+            {
+                m_FunctionDecls[it->second] = fun_stmt;
+                continue;
+            }
+            m_FunctionIndex.emplace
+            (
+                fun_stmt->name,
+                static_cast<uint32_t>(m_FunctionDecls.size())
+            );
+            m_FunctionDecls.push_back(fun_stmt);
+        }
+    }
+
+    program.functions.resize(m_FunctionDecls.size());
+    for (size_t i = 0; i < m_FunctionDecls.size(); ++i)
+    {
+        program.functions[i].name = m_Symbols.Name(m_FunctionDecls[i]->name);
+        program.functions[i].arity = static_cast<uint32_t>
+        (
+            m_FunctionDecls[i]->parameters.size()
+        );
+        program.functions[i].memo_slot = m_FunctionDecls[i]->memo_slot;
+    }
+
+    t_FunctionState main_state;
+    main_state.proto = &program.main;
+    main_state.is_main = true;
+    program.main.name = "<script>";
+    m_State = &main_state;
+
+    for (const auto &statement : statements)
+    {
+        CompileStatement(statement.get());
+        if (m_Failed)
+        {
+            return m_Error;
+        }
+    }
+    Emit(e_OpCode::NIL);
+    Emit(e_OpCode::RETURN);
+
+    // Function bodies are compiled last so that every top-level
+    // declaration (and its constness) is already known.
+    for (size_t i = 0; i < m_FunctionDecls.size(); ++i)
+    {
+        CompileFunction(m_FunctionDecls[i], program.functions[i]);
+        if (m_Failed)
+        {
+            return m_Error;
+        }
+    }
+
+    m_State = nullptr;
+    return Expected<int, t_ErrorInfo>(0);
+}
+
+// ---------------------------------------------------------------------
+// Emission helpers
+// ---------------------------------------------------------------------
+
+size_t Compiler::CurrentOffset() const
+{
+    return m_State->proto->chunk.code.size();
+}
+
+size_t Compiler::Emit(e_OpCode op, uint32_t arg)
+{
+    if (arg > MAX_OPERAND)
+    {
+        Fail("Bytecode operand out of range");
+        arg = 0;
+    }
+
+    t_Chunk& chunk = m_State->proto->chunk;
+    chunk.code.push_back(EncodeInstruction(op, arg));
+    chunk.lines.push_back(m_Line);
+
+    // Track the operand stack depth so the VM can check for overflow
+    // once per call instead of once per push.
+    uint32_t& depth = m_State->stack_depth;
+    switch (op)
+    {
+    case e_OpCode::CONSTANT:
+    case e_OpCode::NIL:
+    case e_OpCode::TRUE:
+    case e_OpCode::FALSE:
+    case e_OpCode::DUP:
+    case e_OpCode::GET_LOCAL:
+    case e_OpCode::GET_GLOBAL:
+        depth++;
+        break;
+
+    case e_OpCode::POP:
+    case e_OpCode::DEFINE_GLOBAL:
+    case e_OpCode::ADD:
+    case e_OpCode::SUBTRACT:
+    case e_OpCode::MULTIPLY:
+    case e_OpCode::DIVIDE:
+    case e_OpCode::MODULO:
+    case e_OpCode::EQUAL:
+    case e_OpCode::NOT_EQUAL:
+    case e_OpCode::GREATER:
+    case e_OpCode::GREATER_EQUAL:
+    case e_OpCode::LESS:
+    case e_OpCode::LESS_EQUAL:
+    case e_OpCode::JUMP_IF_FALSE:
+    case e_OpCode::JUMP_IF_TRUE:
+    case e_OpCode::RETURN:
+    case e_OpCode::OUTPUT:
+    case e_OpCode::GET_INDEX:
+        depth--;
+        break;
+
+    case e_OpCode::PEEK_INDEX:
+        depth++;
+        break;
+
+    case e_OpCode::SET_INDEX:
+        depth -= 2;
+        break;
+
+    case e_OpCode::MAKE_ARRAY:
+        depth = depth - arg + 1;
+        break;
+
+    case e_OpCode::POPN:
+        depth -= arg;
+        break;
+
+    case e_OpCode::FORMAT:
+        depth = depth - arg + 1;
+        break;
+
+    case e_OpCode::CALL:
+    case e_OpCode::TAIL_CALL:
+        depth = depth - m_Program->functions[arg].arity + 1;
+        break;
+
+    case e_OpCode::CALL_BUILTIN:
+        depth = depth - BuiltinArity(static_cast<e_Builtin>(arg)) + 1;
+        break;
+
+    default:
+        break;
+    }
+
+    if (depth > m_State->proto->max_stack)
+    {
+        m_State->proto->max_stack = depth;
+    }
+
+    return chunk.code.size() - 1;
+}
+
+size_t Compiler::EmitJump(e_OpCode op)
+{
+    return Emit(op, 0);
+}
+
+void Compiler::PatchJump(size_t offset)
+{
+    PatchJumpTo(offset, CurrentOffset());
+}
+
+void Compiler::PatchJumpTo(size_t offset, size_t target)
+{
+    if (target > MAX_OPERAND)
+    {
+        Fail("Jump target out of range");
+        return;
+    }
+
+    t_Chunk& chunk = m_State->proto->chunk;
+    e_OpCode op = DecodeOp(chunk.code[offset]);
+    chunk.code[offset] =
+    EncodeInstruction(op, static_cast<uint32_t>(target));
+}
+
+void Compiler::EmitLoop(size_t target)
+{
+    Emit(e_OpCode::JUMP, static_cast<uint32_t>(target));
+}
+
+uint32_t Compiler::AddConstant(const t_Value& value)
+{
+    std::vector<t_Value>& constants = m_State->proto->chunk.constants;
+
+    // Reuse an existing identical constant; chunks are small enough
+    // that a linear scan is cheaper than maintaining an index.
+    for (size_t i = 0; i < constants.size(); ++i)
+    {
+        const t_Value& existing = constants[i];
+        if (existing.type != value.type)
+        {
+            continue;
+        }
+        if
+        (
+            (value.IsString() && existing.string == value.string) ||
+            (value.IsNumber() && existing.number == value.number &&
+             std::signbit(existing.number) == std::signbit(value.number))
+        )
+        {
+            return static_cast<uint32_t>(i);
+        }
+    }
+
+    constants.push_back(value);
+    return static_cast<uint32_t>(constants.size() - 1);
+}
+
+uint32_t Compiler::AddStringConstant(std::string_view text)
+{
+    return AddConstant(t_Value(m_Program->strings.Intern(text)));
+}
+
+void Compiler::EmitConstant(const t_Value& value)
+{
+    Emit(e_OpCode::CONSTANT, AddConstant(value));
+}
+
+void Compiler::EmitError(const std::string& message)
+{
+    Emit(e_OpCode::RUNTIME_ERROR, AddStringConstant(message));
+}
+
+void Compiler::AddDebugName(std::string_view name)
+{
+    t_Chunk& chunk = m_State->proto->chunk;
+    chunk.debug_names.push_back
+    (
+        t_DebugName
+        {
+            static_cast<uint32_t>(chunk.code.size() - 1),
+            m_Program->strings.Intern(name)
+        }
+    );
+}
+
+void Compiler::Fail(const std::string& message)
+{
+    if (m_Failed)
+    {
+        return;
+    }
+    m_Failed = true;
+    m_Error = t_ErrorInfo(e_ErrorType::COMPILE_ERROR, message, m_Line, 0);
+}
+
+// ---------------------------------------------------------------------
+// Scopes and name resolution
+// ---------------------------------------------------------------------
+
+void Compiler::BeginScope()
+{
+    m_State->scope_depth++;
+}
+
+void Compiler::EndScope()
+{
+    m_State->scope_depth--;
+
+    uint32_t count = 0;
+    std::vector<t_Local>& locals = m_State->locals;
+    while (!locals.empty() && locals.back().depth > m_State->scope_depth)
+    {
+        locals.pop_back();
+        count++;
+    }
+
+    if (count == 1)
+    {
+        Emit(e_OpCode::POP);
+    }
+    else if (count > 1)
+    {
+        Emit(e_OpCode::POPN, count);
+    }
+}
+
+void Compiler::PopLocalsAbove(size_t local_count)
+{
+    size_t count = m_State->locals.size() - local_count;
+    if (count > 0)
+    {
+        Emit(e_OpCode::POPN, static_cast<uint32_t>(count));
+    }
+}
+
+bool Compiler::IsDeclaredInCurrentScope(t_Symbol name) const
+{
+    const std::vector<t_Local>& locals = m_State->locals;
+    for (size_t i = locals.size(); i > 0; --i)
+    {
+        const t_Local& local = locals[i - 1];
+        if (local.depth < m_State->scope_depth)
+        {
+            break;
+        }
+        if (local.name == name)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t Compiler::GlobalSlot(t_Symbol name)
+{
+    auto it = m_Globals.find(name);
+    if (it != m_Globals.end())
+    {
+        return it->second.slot;
+    }
+
+    // The program keeps its own copy so it does not depend on the
+    // symbol table
+    uint32_t slot = static_cast<uint32_t>(m_Program->global_names.size());
+    m_Program->global_names.push_back
+    (
+        m_Program->strings.Intern(m_Symbols.Name(name))
+    );
+    m_Globals.emplace(name, t_GlobalInfo{slot, false});
+    return slot;
+}
+
+Compiler::t_Resolution Compiler::Resolve(t_Symbol name)
+{
+    const std::vector<t_Local>& locals = m_State->locals;
+    for (size_t i = locals.size(); i > 0; --i)
+    {
+        if (locals[i - 1].name == name)
+        {
+            return t_Resolution
+            {
+                true,
+                static_cast<uint32_t>(i - 1),
+                locals[i - 1].is_const
+            };
+        }
+    }
+
+    uint32_t slot = GlobalSlot(name);
+    bool is_const = m_Globals.find(name)->second.is_const;
+    return t_Resolution{false, slot, is_const};
+}
+
+void Compiler::EmitGet(const t_Resolution& resolution)
+{
+    Emit
+    (
+        resolution.is_local ? e_OpCode::GET_LOCAL : e_OpCode::GET_GLOBAL,
+        resolution.index
+    );
+}
+
+void Compiler::EmitSet(const t_Resolution& resolution, t_Symbol name)
+{
+    Emit
+    (
+        resolution.is_local ? e_OpCode::SET_LOCAL : e_OpCode::SET_GLOBAL,
+        resolution.index
+    );
+    AddDebugName(m_Symbols.Name(name));
+}
+
+// ---------------------------------------------------------------------
+// Statements
+// ---------------------------------------------------------------------
+
+void Compiler::CompileStatement(t_Stmt *stmt)
+{
+    if (!stmt || m_Failed)
+    {
+        return;
+    }
+
+    // Instructions without a line of their own report the statement's
+    if (stmt->line > 0)
+    {
+        m_Line = stmt->line;
+    }
+
+    if (t_BlockStmt *block = As<t_BlockStmt>(stmt))
+    {
+        CompileBlock(block);
+    }
+    else if (t_BreakStmt *break_stmt = As<t_BreakStmt>(stmt))
+    {
+        m_Line = break_stmt->keyword.line;
+        CompileBreak();
+    }
+    else if (t_ContinueStmt *continue_stmt = As<t_ContinueStmt>(stmt))
+    {
+        m_Line = continue_stmt->keyword.line;
+        CompileContinue();
+    }
+    else if (t_IfStmt *if_stmt = As<t_IfStmt>(stmt))
+    {
+        CompileIf(if_stmt);
+    }
+    else if (t_ForStmt *for_stmt = As<t_ForStmt>(stmt))
+    {
+        CompileFor(for_stmt);
+    }
+    else if (t_VarStmt *var_stmt = As<t_VarStmt>(stmt))
+    {
+        CompileVar(var_stmt);
+    }
+    else if (t_DisplayStmt *display_stmt = As<t_DisplayStmt>(stmt))
+    {
+        CompileDisplay(display_stmt);
+    }
+    else if (t_GetinStmt *getin_stmt = As<t_GetinStmt>(stmt))
+    {
+        m_Line = getin_stmt->keyword.line;
+        CompileGetin(getin_stmt);
+    }
+    else if (t_BenchmarkStmt *benchmark_stmt = As<t_BenchmarkStmt>(stmt))
+    {
+        CompileBenchmark(benchmark_stmt);
+    }
+    else if (t_ExpressionStmt *expr_stmt = As<t_ExpressionStmt>(stmt))
+    {
+        CompileDiscarded(expr_stmt->expression.get());
+    }
+    else if (t_ReturnStmt *return_stmt = As<t_ReturnStmt>(stmt))
+    {
+        CompileReturn(return_stmt);
+    }
+    // t_FunStmt is hoisted and t_EmptyStmt produces no code
+}
+
+void Compiler::CompileScopedStatement(t_Stmt *stmt)
+{
+    // Branch and loop bodies always get their own scope so that a
+    // declaration without braces cannot unbalance the stack.
+    BeginScope();
+    CompileStatement(stmt);
+    EndScope();
+}
+
+void Compiler::CompileBlock(t_BlockStmt *block)
+{
+    BeginScope();
+    for (const auto &statement : block->statements)
+    {
+        CompileStatement(statement.get());
+    }
+    EndScope();
+}
+
+void Compiler::CompileIf(t_IfStmt *if_stmt)
+{
+    CompileExpression(if_stmt->condition.get());
+    size_t else_jump = EmitJump(e_OpCode::JUMP_IF_FALSE);
+
+    CompileScopedStatement(if_stmt->then_branch.get());
+
+    if (if_stmt->else_branch)
+    {
+        size_t end_jump = EmitJump(e_OpCode::JUMP);
+        PatchJump(else_jump);
+        CompileScopedStatement(if_stmt->else_branch.get());
+        PatchJump(end_jump);
+    }
+    else
+    {
+        PatchJump(else_jump);
+    }
+}
+
+std::vector<t_VariableSlot> Compiler::KernelSlots
+(
+    const t_LoopKernel& kernel
+)
+{
+    std::vector<t_VariableSlot> slots;
+    for (const t_KernelVariable& variable : kernel.variables)
+    {
+        t_Resolution resolution = Resolve(variable.name);
+        slots.push_back
+        (
+            t_VariableSlot{resolution.is_local, resolution.index}
+        );
+    }
+    return slots;
+}
+
+void Compiler::CompileFor(t_ForStmt *for_stmt)
+{
+    // A `parallel for` runs as a kernel on the thread pool and any
+    // other loop that qualifies as a kernel on this thread. Either
+    // jumps over the loop below, which is only left for a failed
+    // guard or, for a sequential kernel, a runtime error.
+    size_t kernel_jump = 0;
+    bool has_kernel = false;
+    if (for_stmt->parallel)
+    {
+        t_ParallelFor parallel
+        {
+            for_stmt->parallel,
+            KernelSlots(for_stmt->parallel->kernel)
+        };
+        m_Line = for_stmt->line;
+        Emit
+        (
+            e_OpCode::PARALLEL_FOR,
+            static_cast<uint32_t>(m_Program->parallel_loops.size())
+        );
+        m_Program->parallel_loops.push_back(std::move(parallel));
+        kernel_jump = EmitJump(e_OpCode::JUMP);
+        has_kernel = true;
+    }
+    else if
+    (
+        std::unique_ptr<t_LoopKernel> kernel =
+        m_LoopCompiler.Compile(for_stmt)
+    )
+    {
+        std::vector<t_VariableSlot> slots = KernelSlots(*kernel);
+        m_Line = for_stmt->line;
+        Emit
+        (
+            e_OpCode::LOOP_KERNEL,
+            static_cast<uint32_t>(m_Program->loop_kernels.size())
+        );
+        m_Program->loop_kernels.push_back
+        (
+            t_KernelFor{std::move(kernel), std::move(slots)}
+        );
+        kernel_jump = EmitJump(e_OpCode::JUMP);
+        has_kernel = true;
+    }
+
+    BeginScope();
+
+    if (for_stmt->initializer)
+    {
+        CompileStatement(for_stmt->initializer.get());
+    }
+
+    size_t loop_start = CurrentOffset();
+    bool has_exit_jump = false;
+    size_t exit_jump = 0;
+    if (for_stmt->condition)
+    {
+        CompileExpression(for_stmt->condition.get());
+        exit_jump = EmitJump(e_OpCode::JUMP_IF_FALSE);
+        has_exit_jump = true;
+    }
+
+    m_State->loops.push_back
+    (
+        t_LoopContext
+        {
+            m_State->locals.size(),
+            m_State->benchmark_depth,
+            {},
+            {}
+        }
+    );
+
+    CompileScopedStatement(for_stmt->body.get());
+
+    // `continue` runs the increment, like in C
+    size_t continue_target = CurrentOffset();
+    for (size_t jump : m_State->loops.back().continue_jumps)
+    {
+        PatchJumpTo(jump, continue_target);
+    }
+
+    if (for_stmt->increment)
+    {
+        CompileDiscarded(for_stmt->increment.get());
+    }
+    EmitLoop(loop_start);
+
+    if (has_exit_jump)
+    {
+        PatchJump(exit_jump);
+    }
+    for (size_t jump : m_State->loops.back().break_jumps)
+    {
+        PatchJump(jump);
+    }
+    m_State->loops.pop_back();
+
+    EndScope();
+    if (has_kernel)
+    {
+        PatchJump(kernel_jump);
+    }
+}
+
+void Compiler::CompileBreak()
+{
+    if (m_State->loops.empty())
+    {
+        EmitError("'break' used outside of a loop");
+        return;
+    }
+
+    t_LoopContext& loop = m_State->loops.back();
+    uint32_t saved_depth = m_State->stack_depth;
+    for (size_t i = loop.benchmark_depth; i < m_State->benchmark_depth; ++i)
+    {
+        Emit(e_OpCode::BENCHMARK_EXIT);
+    }
+    PopLocalsAbove(loop.local_count);
+    loop.break_jumps.push_back(EmitJump(e_OpCode::JUMP));
+
+    // Code after the jump is only reachable with the locals in place
+    m_State->stack_depth = saved_depth;
+}
+
+void Compiler::CompileContinue()
+{
+    if (m_State->loops.empty())
+    {
+        EmitError("'continue' used outside of a loop");
+        return;
+    }
+
+    t_LoopContext& loop = m_State->loops.back();
+    uint32_t saved_depth = m_State->stack_depth;
+    for (size_t i = loop.benchmark_depth; i < m_State->benchmark_depth; ++i)
+    {
+        Emit(e_OpCode::BENCHMARK_EXIT);
+    }
+    PopLocalsAbove(loop.local_count);
+    loop.continue_jumps.push_back(EmitJump(e_OpCode::JUMP));
+    m_State->stack_depth = saved_depth;
+}
+
+void Compiler::CompileVar(t_VarStmt *var_stmt)
+{
+    bool is_global = m_State->is_main && m_State->scope_depth == 0;
+
+    if (!is_global && IsDeclaredInCurrentScope(var_stmt->name))
+    {
+        EmitError
+        (
+            "Variable '" + m_Symbols.Name(var_stmt->name) +
+            "' has already been declared in this scope"
+        );
+        return;
+    }
+
+    if (var_stmt->initializer)
+    {
+        CompileExpression(var_stmt->initializer.get());
+    }
+    else
+    {
+        Emit(e_OpCode::NIL);
+    }
+
+    if (is_global)
+    {
+        uint32_t slot = GlobalSlot(var_stmt->name);
+        if (var_stmt->is_const)
+        {
+            m_Globals.find(var_stmt->name)->second.is_const = true;
+        }
+        Emit(e_OpCode::DEFINE_GLOBAL, slot);
+        return;
+    }
+
+    // The initializer value stays on the stack and becomes the slot
+    m_State->locals.push_back
+    (
+        t_Local
+        {
+            var_stmt->name,
+            m_State->scope_depth,
+            var_stmt->is_const
+        }
+    );
+}
+
+void Compiler::CompileDisplay(t_DisplayStmt *display_stmt)
+{
+    bool first = true;
+    for (const auto &expr : display_stmt->expressions)
+    {
+        if (!first)
+        {
+            Emit(e_OpCode::OUTPUT_TEXT, AddStringConstant(" "));
+        }
+        first = false;
+
+        if (t_FormatStringExpr *format = As<t_FormatStringExpr>(expr.get()))
+        {
+            // Write the pieces directly instead of building a string
+            CompileFormatString(format, true);
+            continue;
+        }
+
+        t_LiteralExpr *literal = As<t_LiteralExpr>(expr.get());
+        if (literal && literal->token_type == e_TokenType::STRING)
+        {
+            Emit(e_OpCode::OUTPUT_TEXT, AddStringConstant(literal->value));
+            continue;
+        }
+
+        CompileExpression(expr.get());
+        Emit(e_OpCode::OUTPUT);
+    }
+    Emit(e_OpCode::OUTPUT_TEXT, AddStringConstant("\n"));
+}
+
+void Compiler::CompileGetin(t_GetinStmt *getin_stmt)
+{
+    for (const t_GetinTarget &target : getin_stmt->targets)
+    {
+        if (Resolve(target.name).is_const)
+        {
+            EmitError
+            (
+                "Cannot modify constant '" + m_Symbols.Name(target.name) +
+                "' with getin"
+            );
+            return;
+        }
+    }
+
+    // One line for the whole statement, then one field per target
+    Emit
+    (
+        e_OpCode::READ_INPUT,
+        static_cast<uint32_t>(getin_stmt->targets.size())
+    );
+    AddDebugName(m_Symbols.Name(getin_stmt->targets[0].name));
+
+    for (const t_GetinTarget &target : getin_stmt->targets)
+    {
+        t_Resolution resolution = Resolve(target.name);
+        Emit
+        (
+            resolution.is_local ?
+            e_OpCode::GETIN_LOCAL :
+            e_OpCode::GETIN_GLOBAL,
+            resolution.index
+        );
+        AddDebugName(m_Symbols.Name(target.name));
+    }
+}
+
+void Compiler::CompileBenchmark(t_BenchmarkStmt *benchmark_stmt)
+{
+    // The VM jumps back to the body until every run is done
+    Emit
+    (
+        e_OpCode::BENCHMARK_BEGIN,
+        static_cast<uint32_t>(m_Program->benchmarks.size())
+    );
+    m_Program->benchmarks.push_back
+    (
+        t_BenchmarkInfo
+        {
+            benchmark_stmt->iterations,
+            benchmark_stmt->warmup,
+            benchmark_stmt->line
+        }
+    );
+    m_State->benchmark_depth++;
+    CompileStatement(benchmark_stmt->body.get());
+    m_State->benchmark_depth--;
+    Emit(e_OpCode::BENCHMARK_END);
+}
+
+void Compiler::CompileReturn(t_ReturnStmt *return_stmt)
+{
+    if (return_stmt->is_tail_call)
+    {
+        // TAIL_CALL never falls through to the RETURN below
+        CompileCall
+        (
+            static_cast<t_CallExpr*>(return_stmt->value.get()),
+            true
+        );
+    }
+    else if (return_stmt->value)
+    {
+        CompileExpression(return_stmt->value.get());
+    }
+    else
+    {
+        Emit(e_OpCode::NIL);
+    }
+
+    // Close benchmarks that the return jumps out of
+    for (size_t i = 0; i < m_State->benchmark_depth; ++i)
+    {
+        Emit(e_OpCode::BENCHMARK_EXIT);
+    }
+
+    uint32_t saved_depth = m_State->stack_depth;
+    Emit(e_OpCode::RETURN);
+    m_State->stack_depth = saved_depth - 1;
+}
+
+void Compiler::CompileFunction(t_FunStmt *fun_stmt, t_FunctionProto& proto)
+{
+    t_FunctionState state;
+    state.proto = &proto;
+    state.is_main = false;
+    state.scope_depth = 1;
+    state.stack_depth = proto.arity;
+    proto.max_stack = proto.arity;
+
+    for (t_Symbol parameter : fun_stmt->parameters)
+    {
+        state.locals.push_back(t_Local{parameter, 1, false});
+    }
+
+    t_FunctionState* saved_state = m_State;
+    m_State = &state;
+
+    if (fun_stmt->body)
+    {
+        CompileStatement(fun_stmt->body.get());
+    }
+    Emit(e_OpCode::NIL);
+    Emit(e_OpCode::RETURN);
+
+    m_State = saved_state;
+}
+
+// ---------------------------------------------------------------------
+// Expressions
+// ---------------------------------------------------------------------
+
+void Compiler::CompileDiscarded(t_Expr *expr)
+{
+    // Increments used as statements do not need their value
+    if (t_PostfixExpr *postfix = As<t_PostfixExpr>(expr))
+    {
+        CompileIncrement
+        (
+            postfix->operand.get(),
+            postfix->op.type,
+            false,
+            true
+        );
+        return;
+    }
+    if (t_PrefixExpr *prefix = As<t_PrefixExpr>(expr))
+    {
+        CompileIncrement
+        (
+            prefix->operand.get(),
+            prefix->op.type,
+            true,
+            true
+        );
+        return;
+    }
+
+    CompileExpression(expr);
+    Emit(e_OpCode::POP);
+}
+
+void Compiler::CompileExpression(t_Expr *expr)
+{
+    if (m_Failed)
+    {
+        return;
+    }
+    if (!expr)
+    {
+        Emit(e_OpCode::NIL);
+        return;
+    }
+
+    if (t_LiteralExpr *literal = As<t_LiteralExpr>(expr))
+    {
+        CompileLiteral(literal);
+    }
+    else if (t_FormatStringExpr *format = As<t_FormatStringExpr>(expr))
+    {
+        CompileFormatString(format, false);
+    }
+    else if (t_GroupingExpr *grouping = As<t_GroupingExpr>(expr))
+    {
+        CompileExpression(grouping->expression.get());
+    }
+    else if (t_VariableExpr *variable = As<t_VariableExpr>(expr))
+    {
+        EmitGet(Resolve(variable->name));
+    }
+    else if (t_BinaryExpr *binary = As<t_BinaryExpr>(expr))
+    {
+        CompileBinary(binary);
+    }
+    else if (t_UnaryExpr *unary = As<t_UnaryExpr>(expr))
+    {
+        CompileUnary(unary);
+    }
+    else if (t_PrefixExpr *prefix = As<t_PrefixExpr>(expr))
+    {
+        CompileIncrement
+        (
+            prefix->operand.get(),
+            prefix->op.type,
+            true,
+            false
+        );
+    }
+    else if (t_PostfixExpr *postfix = As<t_PostfixExpr>(expr))
+    {
+        CompileIncrement
+        (
+            postfix->operand.get(),
+            postfix->op.type,
+            false,
+            false
+        );
+    }
+    else if (t_CallExpr *call = As<t_CallExpr>(expr))
+    {
+        CompileCall(call);
+    }
+    else if (t_ArrayExpr *array = As<t_ArrayExpr>(expr))
+    {
+        for (const auto &element : array->elements)
+        {
+            CompileExpression(element.get());
+        }
+        m_Line = array->line;
+        Emit
+        (
+            e_OpCode::MAKE_ARRAY,
+            static_cast<uint32_t>(array->elements.size())
+        );
+    }
+    else if (t_IndexExpr *index = As<t_IndexExpr>(expr))
+    {
+        CompileExpression(index->object.get());
+        CompileExpression(index->index.get());
+        m_Line = index->line;
+        Emit(e_OpCode::GET_INDEX);
+    }
+    else if (t_IndexAssignExpr *assign = As<t_IndexAssignExpr>(expr))
+    {
+        CompileIndexAssignment(assign);
+    }
+    else if (t_SizeofExpr *size_of = As<t_SizeofExpr>(expr))
+    {
+        CompileExpression(size_of->operand.get());
+        m_Line = size_of->line;
+        Emit(e_OpCode::SIZEOF);
+    }
+    else
+    {
+        EmitError("Unsupported expression");
+        Emit(e_OpCode::NIL);
+    }
+}
+
+void Compiler::CompileLiteral(t_LiteralExpr *literal)
+{
+    switch (literal->token_type)
+    {
+    case e_TokenType::TRUE:
+        Emit(e_OpCode::TRUE);
+        break;
+
+    case e_TokenType::FALSE:
+        Emit(e_OpCode::FALSE);
+        break;
+
+    case e_TokenType::NIL:
+        Emit(e_OpCode::NIL);
+        break;
+
+    case e_TokenType::NUMBER:
+        {
+            if (!literal->is_number)
+            {
+                Fail("Invalid number literal '" + std::string(literal->value) + "'");
+                return;
+            }
+            EmitConstant(t_Value(literal->number));
+        }
+        break;
+
+    case e_TokenType::STRING:
+    default:
+        Emit(e_OpCode::CONSTANT, AddStringConstant(literal->value));
+        break;
+    }
+}
+
+void Compiler::CompileFormatString
+(
+    t_FormatStringExpr *format,
+    bool to_output
+)
+{
+    uint32_t piece_count = 0;
+    bool only_text = true;
+
+    for (const t_FormatSegment &segment : format->segments)
+    {
+        if (!segment.expression)
+        {
+            uint32_t constant = AddStringConstant(segment.text);
+            if (to_output)
+            {
+                Emit(e_OpCode::OUTPUT_TEXT, constant);
+            }
+            else
+            {
+                Emit(e_OpCode::CONSTANT, constant);
+                piece_count++;
+            }
+            continue;
+        }
+
+        CompileExpression(segment.expression.get());
+        only_text = false;
+        if (to_output)
+        {
+            Emit(e_OpCode::OUTPUT);
+        }
+        else
+        {
+            piece_count++;
+        }
+    }
+
+    if (to_output)
+    {
+        return;
+    }
+
+    if (piece_count == 0)
+    {
+        Emit(e_OpCode::CONSTANT, AddStringConstant(""));
+    }
+    else if (piece_count > 1 || !only_text)
+    {
+        Emit(e_OpCode::FORMAT, piece_count);
+    }
+}
+
+void Compiler::CompileBinary(t_BinaryExpr *binary)
+{
+    m_Line = binary->op.line;
+
+    if (IsCompoundAssignment(binary->op.type))
+    {
+        CompileAssignment(binary);
+        return;
+    }
+
+    if
+    (
+        binary->op.type == e_TokenType::AND ||
+        binary->op.type == e_TokenType::OR
+    )
+    {
+        CompileLogical(binary);
+        return;
+    }
+
+    CompileExpression(binary->left.get());
+    CompileExpression(binary->right.get());
+    m_Line = binary->op.line;
+
+    switch (binary->op.type)
+    {
+    case e_TokenType::PLUS:
+        Emit(e_OpCode::ADD);
+        break;
+    case e_TokenType::MINUS:
+        Emit(e_OpCode::SUBTRACT);
+        break;
+    case e_TokenType::STAR:
+        Emit(e_OpCode::MULTIPLY);
+        break;
+    case e_TokenType::SLASH:
+        Emit(e_OpCode::DIVIDE);
+        break;
+    case e_TokenType::MODULUS:
+        Emit(e_OpCode::MODULO);
+        break;
+    case e_TokenType::EQUAL_EQUAL:
+        Emit(e_OpCode::EQUAL);
+        break;
+    case e_TokenType::BANG_EQUAL:
+        Emit(e_OpCode::NOT_EQUAL);
+        break;
+    case e_TokenType::GREATER:
+        Emit(e_OpCode::GREATER);
+        break;
+    case e_TokenType::GREATER_EQUAL:
+        Emit(e_OpCode::GREATER_EQUAL);
+        break;
+    case e_TokenType::LESS:
+        Emit(e_OpCode::LESS);
+        break;
+    case e_TokenType::LESS_EQUAL:
+        Emit(e_OpCode::LESS_EQUAL);
+        break;
+    default:
+        Emit(e_OpCode::POP);
+        EmitError("Unsupported binary operator");
+        break;
+    }
+}
+
+void Compiler::CompileAssignment(t_BinaryExpr *binary)
+{
+    t_VariableExpr *target = As<t_VariableExpr>(binary->left.get());
+    if (!target)
+    {
+        EmitError("Left side of assignment must be a variable");
+        Emit(e_OpCode::NIL);
+        return;
+    }
+
+    t_Resolution resolution = Resolve(target->name);
+    if (resolution.is_const)
+    {
+        EmitError
+        (
+            "Cannot assign to constant '" + m_Symbols.Name(target->name) + "'"
+        );
+        Emit(e_OpCode::NIL);
+        return;
+    }
+
+    e_TokenType op = binary->op.type;
+    if (op == e_TokenType::EQUAL)
+    {
+        CompileExpression(binary->right.get());
+        m_Line = binary->op.line;
+        EmitSet(resolution, target->name);
+        return;
+    }
+
+    EmitGet(resolution);
+    CompileExpression(binary->right.get());
+    m_Line = binary->op.line;
+    switch (op)
+    {
+    case e_TokenType::PLUS_EQUAL:
+        Emit(e_OpCode::ADD);
+        break;
+    case e_TokenType::MINUS_EQUAL:
+        Emit(e_OpCode::SUBTRACT);
+        break;
+    case e_TokenType::STAR_EQUAL:
+        Emit(e_OpCode::MULTIPLY);
+        break;
+    case e_TokenType::SLASH_EQUAL:
+        Emit(e_OpCode::DIVIDE);
+        break;
+    case e_TokenType::MODULUS_EQUAL:
+    default:
+        Emit(e_OpCode::MODULO);
+        break;
+    }
+    EmitSet(resolution, target->name);
+}
+
+void Compiler::CompileIndexAssignment(t_IndexAssignExpr *assign)
+{
+    t_IndexExpr *target = assign->target.get();
+    CompileExpression(target->object.get());
+    CompileExpression(target->index.get());
+
+    e_TokenType op = assign->op.type;
+    if (op == e_TokenType::EQUAL)
+    {
+        CompileExpression(assign->value.get());
+        m_Line = assign->op.line;
+        Emit(e_OpCode::SET_INDEX);
+        return;
+    }
+
+    m_Line = target->line;
+    Emit(e_OpCode::PEEK_INDEX);
+    CompileExpression(assign->value.get());
+    m_Line = assign->op.line;
+    switch (op)
+    {
+    case e_TokenType::PLUS_EQUAL:
+        Emit(e_OpCode::ADD);
+        break;
+    case e_TokenType::MINUS_EQUAL:
+        Emit(e_OpCode::SUBTRACT);
+        break;
+    case e_TokenType::STAR_EQUAL:
+        Emit(e_OpCode::MULTIPLY);
+        break;
+    case e_TokenType::SLASH_EQUAL:
+        Emit(e_OpCode::DIVIDE);
+        break;
+    case e_TokenType::MODULUS_EQUAL:
+    default:
+        Emit(e_OpCode::MODULO);
+        break;
+    }
+    Emit(e_OpCode::SET_INDEX);
+}
+
+void Compiler::CompileLogical(t_BinaryExpr *binary)
+{
+    // Both operators short-circuit and always produce a boolean
+    bool is_and = binary->op.type == e_TokenType::AND;
+
+    CompileExpression(binary->left.get());
+    size_t short_jump = EmitJump
+    (
+        is_and ? e_OpCode::JUMP_IF_FALSE : e_OpCode::JUMP_IF_TRUE
+    );
+
+    CompileExpression(binary->right.get());
+    Emit(e_OpCode::TO_BOOL);
+    size_t end_jump = EmitJump(e_OpCode::JUMP);
+
+    // The short-circuit path arrives here without the right operand
+    m_State->stack_depth--;
+    PatchJump(short_jump);
+    Emit(is_and ? e_OpCode::FALSE : e_OpCode::TRUE);
+    PatchJump(end_jump);
+}
+
+void Compiler::CompileUnary(t_UnaryExpr *unary)
+{
+    CompileExpression(unary->right.get());
+    m_Line = unary->op.line;
+
+    if (unary->op.type == e_TokenType::MINUS)
+    {
+        Emit(e_OpCode::NEGATE);
+    }
+    else if (unary->op.type == e_TokenType::BANG)
+    {
+        Emit(e_OpCode::NOT);
+    }
+    else
+    {
+        EmitError("Unsupported unary operator");
+    }
+}
+
+void Compiler::CompileIncrement
+(
+    t_Expr *operand,
+    e_TokenType op,
+    bool is_prefix,
+    bool discard
+)
+{
+    t_VariableExpr *variable = As<t_VariableExpr>(operand);
+    if (!variable)
+    {
+        EmitError
+        (
+            is_prefix ?
+            "Prefix increment/decrement can only be applied to variables" :
+            "Postfix increment/decrement can only be applied to variables"
+        );
+        if (!discard)
+        {
+            Emit(e_OpCode::NIL);
+        }
+        return;
+    }
+
+    t_Resolution resolution = Resolve(variable->name);
+    if (resolution.is_const)
+    {
+        EmitError
+        (
+            "Cannot modify constant '" + m_Symbols.Name(variable->name) + "'"
+        );
+        if (!discard)
+        {
+            Emit(e_OpCode::NIL);
+        }
+        return;
+    }
+
+    bool is_increment = op == e_TokenType::PLUS_PLUS;
+    if (discard)
+    {
+        e_OpCode in_place = resolution.is_local ?
+        (is_increment ? e_OpCode::INC_LOCAL : e_OpCode::DEC_LOCAL) :
+        (is_increment ? e_OpCode::INC_GLOBAL : e_OpCode::DEC_GLOBAL);
+        Emit(in_place, resolution.index);
+        return;
+    }
+
+    EmitGet(resolution);
+    if (!is_prefix)
+    {
+        // Keep the old value underneath the updated one
+        Emit(e_OpCode::DUP);
+    }
+    Emit(is_increment ? e_OpCode::INCREMENT : e_OpCode::DECREMENT);
+    EmitSet(resolution, variable->name);
+    if (!is_prefix)
+    {
+        Emit(e_OpCode::POP);
+    }
+}
+
+void Compiler::CompileCall(t_CallExpr *call, bool is_tail_call)
+{
+    m_Line = call->line;
+
+    auto it = m_FunctionIndex.find(call->callee);
+    if (it == m_FunctionIndex.end() && call->builtin != e_Builtin::NONE)
+    {
+        // The Linker already checked the number of arguments
+        for (const auto &argument : call->arguments)
+        {
+            CompileExpression(argument.get());
+        }
+        m_Line = call->line;
+        Emit(e_OpCode::CALL_BUILTIN, static_cast<uint32_t>(call->builtin));
+        return;
+    }
+    if (it == m_FunctionIndex.end())
+    {
+        EmitError("Undefined function '" + m_Symbols.Name(call->callee) + "'");
+        Emit(e_OpCode::NIL);
+        return;
+    }
+
+    const t_FunctionProto& proto = m_Program->functions[it->second];
+    if (call->arguments.size() != proto.arity)
+    {
+        EmitError
+        (
+            "Function '" + m_Symbols.Name(call->callee) +
+            "' called with wrong number of arguments"
+        );
+        Emit(e_OpCode::NIL);
+        return;
+    }
+
+    for (const auto &argument : call->arguments)
+    {
+        CompileExpression(argument.get());
+    }
+    m_Line = call->line;
+    Emit(is_tail_call ? e_OpCode::TAIL_CALL : e_OpCode::CALL, it->second);
+}
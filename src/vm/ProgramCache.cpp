@@ -0,0 +1,965 @@
+#include <rubberduck/ProgramCache.h>
+#include <rubberduck/Builtins.h>
+#include <rubberduck/LoopKernel.h>
+#include <rubberduck/SourceFile.h>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr char CACHE_MAGIC[4] = {'R', 'D', 'C', '\0'};
+
+    uint64_t Fnv1a(uint64_t hash, std::string_view bytes)
+    {
+        for (char c : bytes)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+
+    // A name next to `path` that no other save uses at the same time,
+    // by this process or by another one
+    std::string TemporaryPath(const std::string& path)
+    {
+        static std::atomic<uint64_t> counter = 0;
+#ifdef _WIN32
+        unsigned long process = GetCurrentProcessId();
+#else
+        unsigned long process = static_cast<unsigned long>(getpid());
+#endif
+        return path + "." + std::to_string(process) + "." +
+            std::to_string(counter.fetch_add(1)) + ".tmp";
+    }
+
+    // Moves `from` over `to`, replacing it if it exists. std::rename()
+    // does that on POSIX but fails on Windows when `to` exists.
+    bool ReplaceFile(const std::string& from, const std::string& to)
+    {
+#ifdef _WIN32
+        // The A form reads paths the way std::ofstream does
+        return MoveFileExA
+        (
+            from.c_str(),
+            to.c_str(),
+            MOVEFILE_REPLACE_EXISTING
+        ) != 0;
+#else
+        return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+    }
+
+    // Changes whenever an opcode is added, removed or reordered
+    uint64_t OpCodeSetHash()
+    {
+        uint64_t hash = FNV_OFFSET;
+        uint32_t count = static_cast<uint32_t>(e_OpCode::COUNT);
+        for (uint32_t op = 0; op < count; ++op)
+        {
+            hash = Fnv1a(hash, OpCodeName(static_cast<e_OpCode>(op)));
+            hash = Fnv1a(hash, std::string_view("\0", 1));
+        }
+        return hash;
+    }
+
+    // Everything a cache entry must match before its payload is read
+    struct t_CacheHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t opcodes;
+        uint32_t flags;
+        uint32_t reserved;
+        uint64_t source_hash;
+        uint64_t source_size;
+        uint64_t payload_size;
+        uint64_t payload_hash; // catches a damaged payload
+    };
+
+    t_CacheHeader MakeHeader(std::string_view source, uint32_t flags)
+    {
+        t_CacheHeader header{};
+        std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header.version = CACHE_VERSION;
+        header.opcodes = OpCodeSetHash();
+        header.flags = flags;
+        header.source_hash = Fnv1a(FNV_OFFSET, source);
+        header.source_size = source.size();
+        return header;
+    }
+
+    class CacheWriter
+    {
+    private:
+        std::string m_Bytes;
+
+    public:
+        template <typename T>
+        void Put(T value)
+        {
+            m_Bytes.append
+            (
+                reinterpret_cast<const char*>(&value),
+                sizeof(value)
+            );
+        }
+
+        template <typename T>
+        void PutArray(const std::vector<T>& values)
+        {
+            Put(static_cast<uint32_t>(values.size()));
+            m_Bytes.append
+            (
+                reinterpret_cast<const char*>(values.data()),
+                values.size() * sizeof(T)
+            );
+        }
+
+        void PutString(std::string_view text)
+        {
+            Put(static_cast<uint32_t>(text.size()));
+            m_Bytes.append(text);
+        }
+
+        const std::string& Bytes() const { return m_Bytes; }
+    };
+
+    // Bounds-checked reads from the mapping. The first short read
+    // poisons the reader; everything after it returns zeros.
+    class CacheReader
+    {
+    private:
+        const char* m_Position;
+        const char* m_End;
+        bool m_Failed = false;
+
+        size_t Remaining() const
+        {
+            return static_cast<size_t>(m_End - m_Position);
+        }
+
+        bool Take(void* out, size_t size)
+        {
+            if (m_Failed || Remaining() < size)
+            {
+                m_Failed = true;
+                std::memset(out, 0, size);
+                return false;
+            }
+            std::memcpy(out, m_Position, size);
+            m_Position += size;
+            return true;
+        }
+
+    public:
+        explicit CacheReader(std::string_view bytes)
+            : m_Position(bytes.data()),
+              m_End(bytes.data() + bytes.size())
+        {
+        }
+
+        template <typename T>
+        T Get()
+        {
+            T value;
+            Take(&value, sizeof(value));
+            return value;
+        }
+
+        template <typename T>
+        void GetArray(std::vector<T>& values)
+        {
+            uint32_t count = Get<uint32_t>();
+            if (m_Failed || Remaining() / sizeof(T) < count)
+            {
+                m_Failed = true;
+                return;
+            }
+            values.resize(count);
+            Take(values.data(), count * sizeof(T));
+        }
+
+        std::string_view GetString()
+        {
+            uint32_t size = Get<uint32_t>();
+            if (m_Failed || Remaining() < size)
+            {
+                m_Failed = true;
+                return {};
+            }
+            std::string_view text(m_Position, size);
+            m_Position += size;
+            return text;
+        }
+
+        bool Failed() const { return m_Failed; }
+        bool AtEnd() const { return m_Position == m_End; }
+    };
+
+    void WriteProto(CacheWriter& writer, const t_FunctionProto& proto)
+    {
+        writer.PutString(proto.name);
+        writer.Put(proto.arity);
+        writer.Put(proto.max_stack);
+        writer.Put(proto.memo_slot);
+
+        const t_Chunk& chunk = proto.chunk;
+        writer.PutArray(chunk.code);
+        writer.PutArray
+        (
+            std::vector<int32_t>(chunk.lines.begin(), chunk.lines.end())
+        );
+
+        writer.Put(static_cast<uint32_t>(chunk.constants.size()));
+        for (const t_Value& constant : chunk.constants)
+        {
+            writer.Put(static_cast<uint8_t>(constant.type));
+            switch (constant.type)
+            {
+            case e_ValueType::NUMBER:
+                writer.Put(constant.number);
+                break;
+            case e_ValueType::BOOLEAN:
+                writer.Put(static_cast<uint8_t>(constant.boolean));
+                break;
+            case e_ValueType::STRING:
+                writer.PutString(*constant.string);
+                break;
+            case e_ValueType::NIL:
+                break;
+            case e_ValueType::ARRAY:
+            case e_ValueType::STRING_ARRAY:
+                // Arrays are built at runtime, never folded into constants
+                break;
+            }
+        }
+
+        writer.Put(static_cast<uint32_t>(chunk.debug_names.size()));
+        for (const t_DebugName& debug_name : chunk.debug_names)
+        {
+            writer.Put(debug_name.offset);
+            writer.PutString(*debug_name.name);
+        }
+    }
+
+    bool ReadProto
+    (
+        CacheReader& reader,
+        t_FunctionProto& proto,
+        StringPool& strings
+    )
+    {
+        proto.name = reader.GetString();
+        proto.arity = reader.Get<uint32_t>();
+        proto.max_stack = reader.Get<uint32_t>();
+        proto.memo_slot = reader.Get<int32_t>();
+
+        t_Chunk& chunk = proto.chunk;
+        reader.GetArray(chunk.code);
+        std::vector<int32_t> lines;
+        reader.GetArray(lines);
+        chunk.lines.assign(lines.begin(), lines.end());
+        if (reader.Failed() || chunk.lines.size() != chunk.code.size())
+        {
+            return false;
+        }
+
+        uint32_t constant_count = reader.Get<uint32_t>();
+        for (uint32_t i = 0; i < constant_count && !reader.Failed(); ++i)
+        {
+            switch (static_cast<e_ValueType>(reader.Get<uint8_t>()))
+            {
+            case e_ValueType::NUMBER:
+                chunk.constants.push_back(t_Value(reader.Get<double>()));
+                break;
+            case e_ValueType::BOOLEAN:
+                chunk.constants.push_back
+                (
+                    t_Value(reader.Get<uint8_t>() != 0)
+                );
+                break;
+            case e_ValueType::STRING:
+                chunk.constants.push_back
+                (
+                    t_Value(strings.Intern(reader.GetString()))
+                );
+                break;
+            case e_ValueType::NIL:
+                chunk.constants.push_back(t_Value());
+                break;
+            default:
+                return false;
+            }
+        }
+
+        uint32_t debug_count = reader.Get<uint32_t>();
+        for (uint32_t i = 0; i < debug_count && !reader.Failed(); ++i)
+        {
+            uint32_t offset = reader.Get<uint32_t>();
+            chunk.debug_names.push_back
+            (
+                t_DebugName{offset, strings.Intern(reader.GetString())}
+            );
+        }
+        return !reader.Failed();
+    }
+
+    // The VM indexes constants, slots and tables with the operand of
+    // an instruction unchecked, and jumps to it, so every operand is
+    // validated against the loaded program here
+    bool ValidOperands
+    (
+        const t_FunctionProto& proto,
+        const t_Program& program
+    )
+    {
+        const t_Chunk& chunk = proto.chunk;
+        size_t code_size = chunk.code.size();
+        if
+        (
+            code_size == 0 ||
+            DecodeOp(chunk.code.back()) != e_OpCode::RETURN ||
+            proto.arity > proto.max_stack
+        )
+        {
+            return false;
+        }
+
+        for (size_t offset = 0; offset < code_size; ++offset)
+        {
+            e_OpCode op = DecodeOp(chunk.code[offset]);
+            uint32_t arg = DecodeArg(chunk.code[offset]);
+            bool valid = true;
+            switch (op)
+            {
+            case e_OpCode::CONSTANT:
+                valid = arg < chunk.constants.size();
+                break;
+            case e_OpCode::OUTPUT_TEXT:
+            case e_OpCode::RUNTIME_ERROR:
+                valid =
+                arg < chunk.constants.size() &&
+                chunk.constants[arg].type == e_ValueType::STRING;
+                break;
+            case e_OpCode::GET_LOCAL:
+            case e_OpCode::SET_LOCAL:
+            case e_OpCode::INC_LOCAL:
+            case e_OpCode::DEC_LOCAL:
+            case e_OpCode::GETIN_LOCAL:
+                valid = arg < proto.max_stack;
+                break;
+            case e_OpCode::GET_GLOBAL:
+            case e_OpCode::SET_GLOBAL:
+            case e_OpCode::DEFINE_GLOBAL:
+            case e_OpCode::INC_GLOBAL:
+            case e_OpCode::DEC_GLOBAL:
+            case e_OpCode::GETIN_GLOBAL:
+                valid = arg < program.global_names.size();
+                break;
+            case e_OpCode::JUMP:
+            case e_OpCode::JUMP_IF_FALSE:
+            case e_OpCode::JUMP_IF_TRUE:
+                valid = arg < code_size;
+                break;
+            case e_OpCode::PARALLEL_FOR:
+            case e_OpCode::LOOP_KERNEL:
+                // Skips the JUMP after it when it falls back
+                valid =
+                arg <
+                (
+                    op == e_OpCode::PARALLEL_FOR
+                        ? program.parallel_loops.size()
+                        : program.loop_kernels.size()
+                ) &&
+                offset + 1 < code_size &&
+                DecodeOp(chunk.code[offset + 1]) == e_OpCode::JUMP;
+                break;
+            case e_OpCode::CALL:
+            case e_OpCode::TAIL_CALL:
+                valid = arg < program.functions.size();
+                break;
+            case e_OpCode::CALL_BUILTIN:
+                valid =
+                arg != static_cast<uint32_t>(e_Builtin::NONE) &&
+                arg <= static_cast<uint32_t>(e_Builtin::PUSH);
+                break;
+            case e_OpCode::BENCHMARK_BEGIN:
+                valid = arg < program.benchmarks.size();
+                break;
+            default:
+                valid = op < e_OpCode::COUNT;
+                break;
+            }
+            if (!valid)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void WriteVectorLoop(CacheWriter& writer, const t_VectorLoop& loop)
+    {
+        writer.Put(static_cast<uint8_t>(loop.exit_op));
+        writer.Put(loop.counter);
+        writer.Put(loop.bound);
+        writer.Put(loop.step);
+        writer.Put(static_cast<uint8_t>(loop.step_negated));
+        writer.Put(static_cast<uint8_t>(loop.is_closed_form));
+        writer.Put(static_cast<uint8_t>(loop.has_division));
+        writer.Put(static_cast<uint32_t>(loop.body.size()));
+        for (const t_KernelInstr& instr : loop.body)
+        {
+            writer.Put(static_cast<uint8_t>(instr.op));
+            writer.Put(instr.a);
+            writer.Put(instr.b);
+            writer.Put(instr.c);
+        }
+        writer.PutArray(loop.lane_regs);
+        writer.Put(loop.counter_lane);
+        writer.Put(static_cast<uint32_t>(loop.reductions.size()));
+        for (const t_VectorReduction& reduction : loop.reductions)
+        {
+            writer.Put(reduction.lane);
+            writer.Put(static_cast<uint8_t>(reduction.op));
+        }
+    }
+
+    // Lanes are indexed unchecked as well
+    bool ReadVectorLoop
+    (
+        CacheReader& reader,
+        t_VectorLoop& loop,
+        size_t register_count
+    )
+    {
+        loop.exit_op = static_cast<e_KernelOp>(reader.Get<uint8_t>());
+        loop.counter = reader.Get<uint32_t>();
+        loop.bound = reader.Get<uint32_t>();
+        loop.step = reader.Get<uint32_t>();
+        loop.step_negated = reader.Get<uint8_t>() != 0;
+        loop.is_closed_form = reader.Get<uint8_t>() != 0;
+        loop.has_division = reader.Get<uint8_t>() != 0;
+        uint32_t body_size = reader.Get<uint32_t>();
+        for (uint32_t i = 0; i < body_size && !reader.Failed(); ++i)
+        {
+            t_KernelInstr instr;
+            instr.op = static_cast<e_KernelOp>(reader.Get<uint8_t>());
+            instr.a = reader.Get<uint32_t>();
+            instr.b = reader.Get<uint32_t>();
+            instr.c = reader.Get<uint32_t>();
+            if (instr.op > e_KernelOp::NEGATE)
+            {
+                return false;
+            }
+            loop.body.push_back(instr);
+        }
+        reader.GetArray(loop.lane_regs);
+        loop.counter_lane = reader.Get<uint32_t>();
+        uint32_t reduction_count = reader.Get<uint32_t>();
+        for (uint32_t i = 0; i < reduction_count && !reader.Failed(); ++i)
+        {
+            t_VectorReduction reduction;
+            reduction.lane = reader.Get<uint32_t>();
+            reduction.op = static_cast<e_KernelOp>(reader.Get<uint8_t>());
+            if
+            (
+                reduction.op != e_KernelOp::ADD &&
+                reduction.op != e_KernelOp::MULTIPLY
+            )
+            {
+                return false;
+            }
+            loop.reductions.push_back(reduction);
+        }
+
+        size_t lane_count = loop.lane_regs.size();
+        if
+        (
+            reader.Failed() ||
+            loop.exit_op < e_KernelOp::JUMP_NLT ||
+            loop.exit_op > e_KernelOp::JUMP_NGE ||
+            loop.counter >= register_count ||
+            loop.bound >= register_count ||
+            loop.step >= register_count ||
+            lane_count > t_VectorLoop::MAX_LANES ||
+            loop.counter_lane >= lane_count
+        )
+        {
+            return false;
+        }
+        for (uint32_t reg : loop.lane_regs)
+        {
+            if (reg >= register_count)
+            {
+                return false;
+            }
+        }
+        for (const t_KernelInstr& instr : loop.body)
+        {
+            if
+            (
+                instr.a >= lane_count ||
+                instr.b >= lane_count ||
+                instr.c >= lane_count
+            )
+            {
+                return false;
+            }
+        }
+        for (const t_VectorReduction& reduction : loop.reductions)
+        {
+            if (reduction.lane >= lane_count)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void WriteKernel
+    (
+        CacheWriter& writer,
+        const t_LoopKernel& kernel,
+        const std::vector<t_VariableSlot>& slots
+    )
+    {
+        writer.Put(static_cast<uint32_t>(kernel.code.size()));
+        for (const t_KernelInstr& instr : kernel.code)
+        {
+            writer.Put(static_cast<uint8_t>(instr.op));
+            writer.Put(instr.a);
+            writer.Put(instr.b);
+            writer.Put(instr.c);
+        }
+        writer.PutArray(kernel.registers);
+        writer.Put(static_cast<uint32_t>(kernel.vector_loops.size()));
+        for (const t_VectorLoop& vector_loop : kernel.vector_loops)
+        {
+            WriteVectorLoop(writer, vector_loop);
+        }
+
+        // Bindings and names are for the tree-walker; the VM has slots
+        writer.Put(static_cast<uint32_t>(kernel.variables.size()));
+        for (size_t i = 0; i < kernel.variables.size(); ++i)
+        {
+            writer.Put(kernel.variables[i].reg);
+            writer.Put(static_cast<uint8_t>(kernel.variables[i].is_written));
+            writer.Put(static_cast<uint8_t>(slots[i].is_local));
+            writer.Put(slots[i].index);
+        }
+    }
+
+    // The kernel indexes its registers unchecked, so every operand is
+    // validated here
+    bool ReadKernel
+    (
+        CacheReader& reader,
+        t_LoopKernel& kernel,
+        std::vector<t_VariableSlot>& slots,
+        size_t global_count
+    )
+    {
+        uint32_t code_size = reader.Get<uint32_t>();
+        for (uint32_t i = 0; i < code_size && !reader.Failed(); ++i)
+        {
+            t_KernelInstr instr;
+            instr.op = static_cast<e_KernelOp>(reader.Get<uint8_t>());
+            instr.a = reader.Get<uint32_t>();
+            instr.b = reader.Get<uint32_t>();
+            instr.c = reader.Get<uint32_t>();
+            if (instr.op > e_KernelOp::HALT)
+            {
+                return false;
+            }
+            kernel.code.push_back(instr);
+        }
+        reader.GetArray(kernel.registers);
+        uint32_t vector_loop_count = reader.Get<uint32_t>();
+        for
+        (
+            uint32_t i = 0;
+            i < vector_loop_count && !reader.Failed();
+            ++i
+        )
+        {
+            kernel.vector_loops.emplace_back();
+            if
+            (
+                !ReadVectorLoop
+                (
+                    reader,
+                    kernel.vector_loops.back(),
+                    kernel.registers.size()
+                )
+            )
+            {
+                return false;
+            }
+        }
+
+        uint32_t variable_count = reader.Get<uint32_t>();
+        for (uint32_t i = 0; i < variable_count && !reader.Failed(); ++i)
+        {
+            t_KernelVariable variable{};
+            variable.reg = reader.Get<uint32_t>();
+            variable.is_written = reader.Get<uint8_t>() != 0;
+            t_VariableSlot slot;
+            slot.is_local = reader.Get<uint8_t>() != 0;
+            slot.index = reader.Get<uint32_t>();
+            if (!slot.is_local && slot.index >= global_count)
+            {
+                return false;
+            }
+            kernel.variables.push_back(variable);
+            slots.push_back(slot);
+        }
+        if
+        (
+            reader.Failed() ||
+            kernel.code.empty() ||
+            kernel.code.back().op != e_KernelOp::HALT
+        )
+        {
+            return false;
+        }
+
+        size_t register_count = kernel.registers.size();
+        for (const t_KernelInstr& instr : kernel.code)
+        {
+            bool is_jump =
+            instr.op >= e_KernelOp::JUMP &&
+            instr.op <= e_KernelOp::JUMP_NGE;
+            uint32_t target_limit = is_jump
+                ? code_size
+                : static_cast<uint32_t>(register_count);
+            if (instr.op == e_KernelOp::VECTOR_LOOP)
+            {
+                target_limit =
+                static_cast<uint32_t>(kernel.vector_loops.size());
+            }
+            if
+            (
+                instr.a >= target_limit ||
+                instr.b >= register_count ||
+                instr.c >= register_count
+            )
+            {
+                return false;
+            }
+        }
+        for (const t_KernelVariable& variable : kernel.variables)
+        {
+            if (variable.reg >= register_count)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void WriteParallelFor
+    (
+        CacheWriter& writer,
+        const t_ParallelFor& parallel
+    )
+    {
+        const t_ParallelLoop& loop = *parallel.loop;
+        WriteKernel(writer, loop.kernel, parallel.slots);
+        writer.Put(loop.start_reg);
+        writer.Put(loop.end_reg);
+        writer.Put(loop.first);
+        writer.Put(loop.step);
+        writer.Put(loop.trip_count);
+        writer.Put(static_cast<uint32_t>(loop.reductions.size()));
+        for (const t_KernelReduction& reduction : loop.reductions)
+        {
+            writer.Put(reduction.variable);
+            writer.Put(static_cast<uint8_t>(reduction.op));
+        }
+    }
+
+    bool ReadParallelFor
+    (
+        CacheReader& reader,
+        t_ParallelFor& parallel,
+        size_t global_count
+    )
+    {
+        std::shared_ptr<t_ParallelLoop> loop =
+        std::make_shared<t_ParallelLoop>();
+        t_LoopKernel& kernel = loop->kernel;
+        if (!ReadKernel(reader, kernel, parallel.slots, global_count))
+        {
+            return false;
+        }
+
+        loop->start_reg = reader.Get<uint32_t>();
+        loop->end_reg = reader.Get<uint32_t>();
+        loop->first = reader.Get<double>();
+        loop->step = reader.Get<double>();
+        loop->trip_count = reader.Get<uint64_t>();
+        uint32_t reduction_count = reader.Get<uint32_t>();
+        for (uint32_t i = 0; i < reduction_count && !reader.Failed(); ++i)
+        {
+            t_KernelReduction reduction;
+            reduction.variable = reader.Get<uint32_t>();
+            reduction.op = static_cast<e_KernelOp>(reader.Get<uint8_t>());
+            if (reduction.variable >= kernel.variables.size())
+            {
+                return false;
+            }
+            loop->reductions.push_back(reduction);
+        }
+        if
+        (
+            reader.Failed() ||
+            loop->start_reg >= kernel.registers.size() ||
+            loop->end_reg >= kernel.registers.size()
+        )
+        {
+            return false;
+        }
+
+        parallel.loop = std::move(loop);
+        return true;
+    }
+
+    bool ReadKernelFor
+    (
+        CacheReader& reader,
+        t_KernelFor& kernel_for,
+        size_t global_count
+    )
+    {
+        std::shared_ptr<t_LoopKernel> kernel =
+        std::make_shared<t_LoopKernel>();
+        if (!ReadKernel(reader, *kernel, kernel_for.slots, global_count))
+        {
+            return false;
+        }
+        kernel_for.kernel = std::move(kernel);
+        return true;
+    }
+}
+
+uint32_t CacheFlags(const t_CompileOptions& options)
+{
+    return (options.optimize ? 1u : 0u) | (options.strict_fp ? 2u : 0u);
+}
+
+std::string CachePath(const std::string& script_path)
+{
+    return script_path + "c";
+}
+
+bool LoadCachedProgram
+(
+    const std::string& path,
+    std::string_view source,
+    uint32_t flags,
+    t_Program& program
+)
+{
+    SourceFile file;
+    if (!file.Open(path))
+    {
+        return false;
+    }
+
+    std::string_view bytes = file.Text();
+    t_CacheHeader expected = MakeHeader(source, flags);
+    t_CacheHeader header;
+    if (bytes.size() < sizeof(header))
+    {
+        return false;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    std::string_view payload = bytes.substr(sizeof(header));
+    expected.payload_size = payload.size();
+    expected.payload_hash = Fnv1a(FNV_OFFSET, payload);
+    if (std::memcmp(&header, &expected, sizeof(header)) != 0)
+    {
+        return false;
+    }
+
+    CacheReader reader(payload);
+
+    uint32_t global_count = reader.Get<uint32_t>();
+    for (uint32_t i = 0; i < global_count && !reader.Failed(); ++i)
+    {
+        program.global_names.push_back
+        (
+            program.strings.Intern(reader.GetString())
+        );
+    }
+
+    uint32_t benchmark_count = reader.Get<uint32_t>();
+    for (uint32_t i = 0; i < benchmark_count && !reader.Failed(); ++i)
+    {
+        t_BenchmarkInfo benchmark;
+        benchmark.iterations = reader.Get<uint32_t>();
+        benchmark.warmup = reader.Get<uint32_t>();
+        benchmark.line = reader.Get<int32_t>();
+        program.benchmarks.push_back(benchmark);
+    }
+
+    if (!ReadProto(reader, program.main, program.strings))
+    {
+        return false;
+    }
+
+    uint32_t function_count = reader.Get<uint32_t>();
+    if (reader.Failed())
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < function_count; ++i)
+    {
+        program.functions.emplace_back();
+        if (!ReadProto(reader, program.functions.back(), program.strings))
+        {
+            return false;
+        }
+        // The VM counts memoized calls by slot
+        int32_t memo_slot = program.functions.back().memo_slot;
+        if
+        (
+            memo_slot < -1 ||
+            memo_slot >= static_cast<int32_t>(function_count)
+        )
+        {
+            return false;
+        }
+    }
+
+    uint32_t parallel_count = reader.Get<uint32_t>();
+    for (uint32_t i = 0; i < parallel_count && !reader.Failed(); ++i)
+    {
+        program.parallel_loops.emplace_back();
+        if
+        (
+            !ReadParallelFor
+            (
+                reader,
+                program.parallel_loops.back(),
+                program.global_names.size()
+            )
+        )
+        {
+            return false;
+        }
+    }
+
+    uint32_t kernel_count = reader.Get<uint32_t>();
+    for (uint32_t i = 0; i < kernel_count && !reader.Failed(); ++i)
+    {
+        program.loop_kernels.emplace_back();
+        if
+        (
+            !ReadKernelFor
+            (
+                reader,
+                program.loop_kernels.back(),
+                program.global_names.size()
+            )
+        )
+        {
+            return false;
+        }
+    }
+    if (reader.Failed() || !reader.AtEnd())
+    {
+        return false;
+    }
+
+    // Operands may refer to any table, so they are checked last
+    if (!ValidOperands(program.main, program))
+    {
+        return false;
+    }
+    for (const t_FunctionProto& proto : program.functions)
+    {
+        if (!ValidOperands(proto, program))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SaveCachedProgram
+(
+    const std::string& path,
+    std::string_view source,
+    uint32_t flags,
+    const t_Program& program
+)
+{
+    CacheWriter writer;
+
+    writer.Put(static_cast<uint32_t>(program.global_names.size()));
+    for (const std::string* name : program.global_names)
+    {
+        writer.PutString(*name);
+    }
+
+    writer.Put(static_cast<uint32_t>(program.benchmarks.size()));
+    for (const t_BenchmarkInfo& benchmark : program.benchmarks)
+    {
+        writer.Put(benchmark.iterations);
+        writer.Put(benchmark.warmup);
+        writer.Put(static_cast<int32_t>(benchmark.line));
+    }
+
+    WriteProto(writer, program.main);
+    writer.Put(static_cast<uint32_t>(program.functions.size()));
+    for (const t_FunctionProto& proto : program.functions)
+    {
+        WriteProto(writer, proto);
+    }
+
+    writer.Put(static_cast<uint32_t>(program.parallel_loops.size()));
+    for (const t_ParallelFor& parallel : program.parallel_loops)
+    {
+        WriteParallelFor(writer, parallel);
+    }
+
+    writer.Put(static_cast<uint32_t>(program.loop_kernels.size()));
+    for (const t_KernelFor& kernel_for : program.loop_kernels)
+    {
+        WriteKernel(writer, *kernel_for.kernel, kernel_for.slots);
+    }
+
+    t_CacheHeader header = MakeHeader(source, flags);
+    header.payload_size = writer.Bytes().size();
+    header.payload_hash = Fnv1a(FNV_OFFSET, writer.Bytes());
+
+    // Written in full under a name of its own first, so neither a
+    // reader nor a concurrent save ever sees half a file
+    std::string temporary = TemporaryPath(path);
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(writer.Bytes().data(), writer.Bytes().size());
+    out.close();
+    if (!out || !ReplaceFile(temporary, path))
+    {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,1051 @@
+#include <rubberduck/VM.h>
+#include <rubberduck/ArrayOps.h>
+#include <rubberduck/Input.h>
+#include <rubberduck/ParallelLoop.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Computed goto dispatch is a GNU extension; everything else falls
+// back to an ordinary switch inside a loop.
+#if defined(__GNUC__) || defined(__clang__)
+#define RD_COMPUTED_GOTO 1
+#else
+#define RD_COMPUTED_GOTO 0
+#endif
+
+namespace
+{
+    const std::string UNKNOWN_NAME = "<unknown>";
+}
+
+VM::VM() 
+    : m_Program(nullptr),
+      m_Input(&StandardInput())
+{
+    m_Stack.resize(STACK_SIZE);
+    m_Frames.reserve(DEFAULT_MAX_CALL_DEPTH + 1);
+}
+
+void VM::SetMemoCache(MemoCache* memo)
+{
+    m_Memo = memo;
+}
+
+void VM::SetStats(t_RunStats* stats)
+{
+    m_Stats = stats;
+}
+
+void VM::SetMaxCallDepth(size_t depth)
+{
+    m_MaxCallDepth = depth;
+    m_Stack.resize(std::max(STACK_SIZE, depth * SLOTS_PER_CALL));
+}
+
+InterpretationResult VM::Run(const t_Program& program)
+{
+    m_Program = &program;
+    // Nothing holds a value of an earlier run any more
+    m_Strings.Clear();
+    m_Arrays.Clear();
+    m_Globals.assign(program.global_names.size(), t_Value());
+    m_GlobalDefined.assign(program.global_names.size(), 0);
+    m_Frames.clear();
+    m_Benchmarks.clear();
+    m_MemoKeys.clear();
+    if (m_Memo)
+    {
+        std::vector<std::string> names;
+        for (const t_FunctionProto& proto : program.functions)
+        {
+            if (proto.memo_slot >= 0)
+            {
+                size_t slot = static_cast<size_t>(proto.memo_slot);
+                names.resize(std::max(names.size(), slot + 1));
+                names[slot] = proto.name;
+            }
+        }
+        m_Memo->Reset(std::move(names));
+    }
+    if (m_Stats)
+    {
+        m_Stats->max_call_depth = 0;
+        m_Stats->max_stack_slots = program.main.max_stack;
+    }
+
+    if (program.main.max_stack > STACK_SIZE)
+    {
+        return t_ErrorInfo(e_ErrorType::RUNTIME_ERROR, "Stack overflow");
+    }
+
+    m_Frames.push_back
+    (
+        t_CallFrame
+        {
+            &program.main,
+            program.main.chunk.code.data(),
+            m_Stack.data()
+        }
+    );
+
+    InterpretationResult result = Execute();
+    // An error may have left a benchmark running
+    m_Output.SetHeld(false);
+    m_Output.Flush();
+    return result;
+}
+
+void VM::SetFlushPolicy(e_FlushPolicy policy)
+{
+    m_Output.SetPolicy(policy);
+}
+
+void VM::SetOutput(std::ostream& stream)
+{
+    m_Output.SetStream(stream);
+}
+
+void VM::SetInput(InputReader& input)
+{
+    m_Input = &input;
+}
+
+void VM::SetBenchmarkFormat(e_BenchmarkFormat format)
+{
+    m_Reporter.SetFormat(format);
+}
+
+void VM::Collect(const t_Value* top)
+{
+    size_t stack_size = static_cast<size_t>(top - m_Stack.data());
+    m_Strings.Mark(m_Globals.data(), m_Globals.size());
+    m_Arrays.Mark(m_Globals.data(), m_Globals.size(), m_Strings);
+    m_Strings.Mark(m_Stack.data(), stack_size);
+    m_Arrays.Mark(m_Stack.data(), stack_size, m_Strings);
+    for (const t_MemoKey& key : m_MemoKeys)
+    {
+        m_Strings.Mark(key.arguments, key.count);
+    }
+    if (m_Memo)
+    {
+        m_Memo->Mark(m_Strings);
+    }
+    m_Strings.Sweep(0);
+    m_Arrays.Sweep(ArrayPool::t_Made());
+}
+
+bool VM::LoadKernelRegisters
+(
+    const t_LoopKernel& kernel,
+    const std::vector<t_VariableSlot>& kernel_slots,
+    const t_Value* slots
+)
+{
+    m_KernelRegisters = kernel.registers;
+    for (size_t i = 0; i < kernel_slots.size(); ++i)
+    {
+        const t_VariableSlot& slot = kernel_slots[i];
+        if (!slot.is_local && !m_GlobalDefined[slot.index])
+        {
+            return false;
+        }
+        const t_Value& value = 
+        slot.is_local ? slots[slot.index] : m_Globals[slot.index];
+        if (!value.IsNumber())
+        {
+            return false;
+        }
+        m_KernelRegisters[kernel.variables[i].reg] = value.number;
+    }
+    return true;
+}
+
+Expected<bool, t_ErrorInfo> VM::RunParallelFor
+(
+    const t_ParallelFor& parallel,
+    t_Value* slots
+)
+{
+    const t_ParallelLoop& loop = *parallel.loop;
+    if (!LoadKernelRegisters(loop.kernel, parallel.slots, slots))
+    {
+        return Expected<bool, t_ErrorInfo>(false);
+    }
+
+    Expected<int, t_ErrorInfo> result = 
+    RunParallelLoop(loop, m_KernelRegisters.data());
+    if (!result)
+    {
+        return result.Error();
+    }
+
+    for (const t_KernelReduction& reduction : loop.reductions)
+    {
+        const t_VariableSlot& slot = parallel.slots[reduction.variable];
+        t_Value& value = 
+        slot.is_local ? slots[slot.index] : m_Globals[slot.index];
+        value.number = 
+        m_KernelRegisters[loop.kernel.variables[reduction.variable].reg];
+    }
+    return Expected<bool, t_ErrorInfo>(true);
+}
+
+bool VM::RunKernelFor(const t_KernelFor& kernel_for, t_Value* slots)
+{
+    const t_LoopKernel& kernel = *kernel_for.kernel;
+    if
+    (
+        !LoadKernelRegisters(kernel, kernel_for.slots, slots) ||
+        !RunLoopKernel(kernel, m_KernelRegisters.data())
+    )
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < kernel_for.slots.size(); ++i)
+    {
+        const t_KernelVariable& variable = kernel.variables[i];
+        if (variable.is_written)
+        {
+            const t_VariableSlot& slot = kernel_for.slots[i];
+            t_Value& value = 
+            slot.is_local ? slots[slot.index] : m_Globals[slot.index];
+            value.number = m_KernelRegisters[variable.reg];
+        }
+    }
+    return true;
+}
+
+bool VM::EndBenchmarkRun(bool is_leaving)
+{
+    std::chrono::steady_clock::time_point end_time =
+    std::chrono::steady_clock::now();
+
+    // Printing what the body displayed is not part of the timing
+    m_Output.Flush();
+
+    t_BenchmarkRun& run = m_Benchmarks.back();
+    const t_BenchmarkInfo& info = *run.info;
+
+    // A run cut short by break, continue or return is measured like
+    // any other and ends the benchmark
+    if (run.runs_done >= info.warmup || is_leaving)
+    {
+        run.samples.push_back
+        (
+            std::chrono::duration_cast<std::chrono::nanoseconds>
+            (
+                end_time - run.start
+            ).count()
+        );
+    }
+    run.runs_done++;
+
+    if (!is_leaving && run.samples.size() < info.iterations)
+    {
+        run.start = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    m_Reporter.Report
+    (
+        ComputeBenchmarkStats(run.samples, info.line, info.warmup),
+        m_Output.Stream()
+    );
+    m_Benchmarks.pop_back();
+    m_Output.SetHeld(!m_Benchmarks.empty());
+    return false;
+}
+
+t_ErrorInfo VM::MakeError
+(
+    e_ErrorType type,
+    const std::string& message,
+    const t_CallFrame& frame,
+    const uint32_t* ip
+) const
+{
+    const t_Chunk& chunk = frame.proto->chunk;
+    size_t offset = static_cast<size_t>(ip - chunk.code.data()) - 1;
+    int line = offset < chunk.lines.size() ? chunk.lines[offset] : 0;
+    return t_ErrorInfo(type, message, line, 0);
+}
+
+const std::string& VM::DebugName
+(
+    const t_FunctionProto& proto,
+    const uint32_t* ip
+) const
+{
+    const std::vector<t_DebugName>& names = proto.chunk.debug_names;
+    uint32_t offset = static_cast<uint32_t>
+    (
+        ip - proto.chunk.code.data() - 1
+    );
+
+    auto it = std::lower_bound
+    (
+        names.begin(),
+        names.end(),
+        offset,
+        [](const t_DebugName& entry, uint32_t value)
+        {
+            return entry.offset < value;
+        }
+    );
+    if (it == names.end() || it->offset != offset)
+    {
+        return UNKNOWN_NAME;
+    }
+    return *it->name;
+}
+
+bool VM::ReadInputLine(uint32_t field_count)
+{
+    // Anything displayed so far must be visible before blocking
+    m_Output.Flush();
+
+    std::string_view input_line;
+    if (!m_Input->ReadLine(input_line))
+    {
+        return false;
+    }
+    SplitInputFields(input_line, field_count, m_InputFields);
+    m_NextInputField = 0;
+    return true;
+}
+
+Expected<t_Value, t_ErrorInfo> VM::NextInputField
+(
+    const t_Value& current,
+    const std::string& name
+)
+{
+    if (m_NextInputField >= m_InputFields.size())
+    {
+        return t_ErrorInfo
+        (
+            e_ErrorType::RUNTIME_ERROR,
+            "Missing input for variable '" + name + "'"
+        );
+    }
+    return ConvertInput
+    (
+        m_InputFields[m_NextInputField++],
+        current,
+        name,
+        m_Strings
+    );
+}
+
+#if RD_COMPUTED_GOTO
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+InterpretationResult VM::Execute()
+{
+    const t_Value* stack_end = m_Stack.data() + m_Stack.size();
+
+    t_CallFrame* frame = &m_Frames.back();
+    const uint32_t* code = frame->proto->chunk.code.data();
+    const t_Value* constants = frame->proto->chunk.constants.data();
+    const uint32_t* ip = frame->ip;
+    t_Value* slots = frame->slots;
+    t_Value* sp = slots;
+    uint32_t arg = 0;
+
+// Reports an error at the instruction that is currently executing
+#define RD_FAIL(type, message)                                           \
+    do                                                                   \
+    {                                                                    \
+        frame->ip = ip;                                                  \
+        return MakeError(type, message, *frame, ip);                     \
+    } while (0)
+
+#define RD_REQUIRE_GLOBAL(slot)                                          \
+    do                                                                   \
+    {                                                                    \
+        if (!m_GlobalDefined[slot])                                      \
+        {                                                                \
+            RD_FAIL                                                      \
+            (                                                            \
+                e_ErrorType::RUNTIME_ERROR,                              \
+                "Variable '" + *m_Program->global_names[slot] +          \
+                "' must be declared with 'auto' keyword before use"      \
+            );                                                           \
+        }                                                                \
+    } while (0)
+
+// A variable keeps the type of its first non-nil value
+#define RD_CHECK_ASSIGN(target, value, name)                             \
+    do                                                                   \
+    {                                                                    \
+        if                                                               \
+        (                                                                \
+            (target).type != e_ValueType::NIL &&                         \
+            (target).type != (value).type                                \
+        )                                                                \
+        {                                                                \
+            RD_FAIL                                                      \
+            (                                                            \
+                e_ErrorType::TYPE_ERROR,                                 \
+                "Type mismatch: variable '" + (name) + "' is " +         \
+                ValueTypeName((target).type) + ", cannot assign " +      \
+                ValueTypeName((value).type)                              \
+            );                                                           \
+        }                                                                \
+    } while (0)
+
+// Anything but two numbers is either an array operation or an error
+#define RD_ARITHMETIC(op, token)                                         \
+    do                                                                   \
+    {                                                                    \
+        t_Value& left = sp[-2];                                          \
+        const t_Value& right = sp[-1];                                   \
+        if (!left.IsNumber() || !right.IsNumber())                       \
+        {                                                                \
+            CollectIfDue(sp);                                            \
+            Expected<t_Value, t_ErrorInfo> result =                      \
+            ArrayArithmetic(left, e_TokenType::token, right, m_Arrays);  \
+            if (!result)                                                 \
+            {                                                            \
+                RD_FAIL(result.Error().type, result.Error().message);    \
+            }                                                            \
+            left = result.Value();                                       \
+        }                                                                \
+        else                                                             \
+        {                                                                \
+            left.number = left.number op right.number;                   \
+        }                                                                \
+        --sp;                                                            \
+    } while (0)
+
+// Runs an ArrayOps call and fails with its error
+#define RD_ARRAY_OP(target, call)                                        \
+    do                                                                   \
+    {                                                                    \
+        Expected<t_Value, t_ErrorInfo> array_result = (call);            \
+        if (!array_result)                                               \
+        {                                                                \
+            RD_FAIL                                                      \
+            (                                                            \
+                array_result.Error().type,                               \
+                array_result.Error().message                             \
+            );                                                           \
+        }                                                                \
+        (target) = array_result.Value();                                 \
+    } while (0)
+
+#define RD_COMPARE(op)                                                   \
+    do                                                                   \
+    {                                                                    \
+        t_Value& left = sp[-2];                                          \
+        const t_Value& right = sp[-1];                                   \
+        if (!left.IsNumber() || !right.IsNumber())                       \
+        {                                                                \
+            RD_FAIL                                                      \
+            (                                                            \
+                e_ErrorType::RUNTIME_ERROR,                              \
+                "Cannot compare non-numeric values"                      \
+            );                                                           \
+        }                                                                \
+        left = t_Value(left.number op right.number);                     \
+        --sp;                                                            \
+    } while (0)
+
+#if RD_COMPUTED_GOTO
+    static void* const dispatch_table[] =
+    {
+#define RD_OPCODE_LABEL(name) &&op_##name,
+        RD_OPCODES(RD_OPCODE_LABEL)
+#undef RD_OPCODE_LABEL
+    };
+
+#define RD_CASE(name) op_##name:
+#define RD_DISPATCH()                                                    \
+    do                                                                   \
+    {                                                                    \
+        uint32_t instruction = *ip++;                                    \
+        arg = DecodeArg(instruction);                                    \
+        goto *dispatch_table[instruction & 0xFF];                        \
+    } while (0)
+
+    RD_DISPATCH();
+    {
+#else
+#define RD_CASE(name) case e_OpCode::name:
+#define RD_DISPATCH() continue
+
+    for (;;)
+    {
+        uint32_t instruction = *ip++;
+        arg = DecodeArg(instruction);
+        switch (DecodeOp(instruction))
+        {
+#endif
+
+    RD_CASE(CONSTANT)
+        *sp++ = constants[arg];
+        RD_DISPATCH();
+
+    RD_CASE(NIL)
+        *sp++ = t_Value();
+        RD_DISPATCH();
+
+    RD_CASE(TRUE)
+        *sp++ = t_Value(true);
+        RD_DISPATCH();
+
+    RD_CASE(FALSE)
+        *sp++ = t_Value(false);
+        RD_DISPATCH();
+
+    RD_CASE(POP)
+        --sp;
+        RD_DISPATCH();
+
+    RD_CASE(POPN)
+        sp -= arg;
+        RD_DISPATCH();
+
+    RD_CASE(DUP)
+        *sp = sp[-1];
+        ++sp;
+        RD_DISPATCH();
+
+    RD_CASE(GET_LOCAL)
+        *sp++ = slots[arg];
+        RD_DISPATCH();
+
+    RD_CASE(SET_LOCAL)
+        RD_CHECK_ASSIGN(slots[arg], sp[-1], DebugName(*frame->proto, ip));
+        slots[arg] = sp[-1];
+        RD_DISPATCH();
+
+    RD_CASE(GET_GLOBAL)
+        RD_REQUIRE_GLOBAL(arg);
+        *sp++ = m_Globals[arg];
+        RD_DISPATCH();
+
+    RD_CASE(SET_GLOBAL)
+        RD_REQUIRE_GLOBAL(arg);
+        RD_CHECK_ASSIGN
+        (
+            m_Globals[arg],
+            sp[-1],
+            *m_Program->global_names[arg]
+        );
+        m_Globals[arg] = sp[-1];
+        RD_DISPATCH();
+
+    RD_CASE(DEFINE_GLOBAL)
+        if (m_GlobalDefined[arg])
+        {
+            RD_FAIL
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Variable '" + *m_Program->global_names[arg] +
+                "' has already been declared in this scope"
+            );
+        }
+        m_Globals[arg] = *--sp;
+        m_GlobalDefined[arg] = 1;
+        RD_DISPATCH();
+
+    RD_CASE(INC_LOCAL)
+        if (!slots[arg].IsNumber())
+        {
+            RD_FAIL
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Cannot perform increment/decrement on non-numeric value"
+            );
+        }
+        slots[arg].number += 1.0;
+        RD_DISPATCH();
+
+    RD_CASE(DEC_LOCAL)
+        if (!slots[arg].IsNumber())
+        {
+            RD_FAIL
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Cannot perform increment/decrement on non-numeric value"
+            );
+        }
+        slots[arg].number -= 1.0;
+        RD_DISPATCH();
+
+    RD_CASE(INC_GLOBAL)
+        RD_REQUIRE_GLOBAL(arg);
+        if (!m_Globals[arg].IsNumber())
+        {
+            RD_FAIL
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Cannot perform increment/decrement on non-numeric value"
+            );
+        }
+        m_Globals[arg].number += 1.0;
+        RD_DISPATCH();
+
+    RD_CASE(DEC_GLOBAL)
+        RD_REQUIRE_GLOBAL(arg);
+        if (!m_Globals[arg].IsNumber())
+        {
+            RD_FAIL
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Cannot perform increment/decrement on non-numeric value"
+            );
+        }
+        m_Globals[arg].number -= 1.0;
+        RD_DISPATCH();
+
+    RD_CASE(INCREMENT)
+        if (!sp[-1].IsNumber())
+        {
+            RD_FAIL
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Cannot perform increment/decrement on non-numeric value"
+            );
+        }
+        sp[-1].number += 1.0;
+        RD_DISPATCH();
+
+    RD_CASE(DECREMENT)
+        if (!sp[-1].IsNumber())
+        {
+            RD_FAIL
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Cannot perform increment/decrement on non-numeric value"
+            );
+        }
+        sp[-1].number -= 1.0;
+        RD_DISPATCH();
+
+    RD_CASE(ADD)
+        if (sp[-2].IsString() || sp[-1].IsString())
+        {
+            RD_FAIL
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "String concatenation with '+' is not allowed. "
+                "Use comma-separated values in display statements instead."
+            );
+        }
+        RD_ARITHMETIC(+, PLUS);
+        RD_DISPATCH();
+
+    RD_CASE(SUBTRACT)
+        RD_ARITHMETIC(-, MINUS);
+        RD_DISPATCH();
+
+    RD_CASE(MULTIPLY)
+        RD_ARITHMETIC(*, STAR);
+        RD_DISPATCH();
+
+    RD_CASE(DIVIDE)
+        if (sp[-1].IsNumber() && sp[-1].number == 0.0)
+        {
+            RD_FAIL(e_ErrorType::RUNTIME_ERROR, "Division by zero");
+        }
+        RD_ARITHMETIC(/, SLASH);
+        RD_DISPATCH();
+
+    RD_CASE(MODULO)
+        if (!sp[-2].IsNumber() || !sp[-1].IsNumber())
+        {
+            CollectIfDue(sp);
+            RD_ARRAY_OP
+            (
+                sp[-2],
+                ArrayArithmetic
+                (
+                    sp[-2],
+                    e_TokenType::MODULUS,
+                    sp[-1],
+                    m_Arrays
+                )
+            );
+            --sp;
+            RD_DISPATCH();
+        }
+        if (sp[-1].number == 0.0)
+        {
+            RD_FAIL(e_ErrorType::RUNTIME_ERROR, "Modulus by zero");
+        }
+        sp[-2].number = std::fmod(sp[-2].number, sp[-1].number);
+        --sp;
+        RD_DISPATCH();
+
+    RD_CASE(EQUAL)
+        sp[-2] = t_Value(ValuesEqual(sp[-2], sp[-1]));
+        --sp;
+        RD_DISPATCH();
+
+    RD_CASE(NOT_EQUAL)
+        sp[-2] = t_Value(!ValuesEqual(sp[-2], sp[-1]));
+        --sp;
+        RD_DISPATCH();
+
+    RD_CASE(GREATER)
+        RD_COMPARE(>);
+        RD_DISPATCH();
+
+    RD_CASE(GREATER_EQUAL)
+        RD_COMPARE(>=);
+        RD_DISPATCH();
+
+    RD_CASE(LESS)
+        RD_COMPARE(<);
+        RD_DISPATCH();
+
+    RD_CASE(LESS_EQUAL)
+        RD_COMPARE(<=);
+        RD_DISPATCH();
+
+    RD_CASE(NEGATE)
+        if (!sp[-1].IsNumber())
+        {
+            RD_FAIL
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                "Cannot negate non-numeric value"
+            );
+        }
+        sp[-1].number = -sp[-1].number;
+        RD_DISPATCH();
+
+    RD_CASE(NOT)
+        {
+            // `!` treats 0 as false as well, like the tree walker
+            const t_Value& operand = sp[-1];
+            bool is_false =
+            operand.IsNil() ||
+            (operand.IsBoolean() && !operand.boolean) ||
+            (operand.IsNumber() && operand.number == 0.0);
+            sp[-1] = t_Value(is_false);
+        }
+        RD_DISPATCH();
+
+    RD_CASE(TO_BOOL)
+        sp[-1] = t_Value(IsTruthy(sp[-1]));
+        RD_DISPATCH();
+
+    RD_CASE(MAKE_ARRAY)
+        CollectIfDue(sp);
+        {
+            t_Value array;
+            RD_ARRAY_OP(array, MakeArray(sp - arg, arg, m_Arrays));
+            sp -= arg;
+            *sp++ = array;
+        }
+        RD_DISPATCH();
+
+    RD_CASE(GET_INDEX)
+        RD_ARRAY_OP(sp[-2], GetElement(sp[-2], sp[-1]));
+        --sp;
+        RD_DISPATCH();
+
+    RD_CASE(PEEK_INDEX)
+        RD_ARRAY_OP(*sp, GetElement(sp[-2], sp[-1]));
+        ++sp;
+        RD_DISPATCH();
+
+    RD_CASE(SET_INDEX)
+        RD_ARRAY_OP(sp[-3], SetElement(sp[-3], sp[-2], sp[-1]));
+        sp -= 2;
+        RD_DISPATCH();
+
+    RD_CASE(SIZEOF)
+        RD_ARRAY_OP(sp[-1], SizeOf(sp[-1]));
+        RD_DISPATCH();
+
+    RD_CASE(JUMP)
+        ip = code + arg;
+        RD_DISPATCH();
+
+    RD_CASE(JUMP_IF_FALSE)
+        if (!IsTruthy(*--sp))
+        {
+            ip = code + arg;
+        }
+        RD_DISPATCH();
+
+    RD_CASE(JUMP_IF_TRUE)
+        if (IsTruthy(*--sp))
+        {
+            ip = code + arg;
+        }
+        RD_DISPATCH();
+
+    RD_CASE(PARALLEL_FOR)
+        {
+            Expected<bool, t_ErrorInfo> result = 
+            RunParallelFor(m_Program->parallel_loops[arg], slots);
+            if (!result)
+            {
+                RD_FAIL(result.Error().type, result.Error().message);
+            }
+            // The JUMP over the sequential loop is next
+            if (!result.Value())
+            {
+                ip++;
+            }
+            else if (m_Stats)
+            {
+                m_Stats->parallel_loops++;
+            }
+        }
+        RD_DISPATCH();
+
+    RD_CASE(LOOP_KERNEL)
+        // The JUMP over the bytecode loop is next
+        if (!RunKernelFor(m_Program->loop_kernels[arg], slots))
+        {
+            ip++;
+        }
+        else if (m_Stats)
+        {
+            CountKernelLoop(*m_Program->loop_kernels[arg].kernel, *m_Stats);
+        }
+        RD_DISPATCH();
+
+    RD_CASE(CALL)
+        {
+            const t_FunctionProto& callee = m_Program->functions[arg];
+            t_Value* callee_slots = sp - callee.arity;
+            // The script itself has the bottom frame
+            if (m_Frames.size() > m_MaxCallDepth)
+            {
+                RD_FAIL
+                (
+                    e_ErrorType::RUNTIME_ERROR,
+                    "Stack overflow: more than " + 
+                    std::to_string(m_MaxCallDepth) + " nested calls"
+                );
+            }
+            if (callee_slots + callee.max_stack > stack_end)
+            {
+                RD_FAIL(e_ErrorType::RUNTIME_ERROR, "Stack overflow");
+            }
+            if (m_Stats)
+            {
+                CountCall(m_Frames.size(), callee_slots + callee.max_stack);
+            }
+
+            // A pure function called with arguments it has seen before
+            bool is_memoized = false;
+            if (m_Memo && callee.memo_slot >= 0)
+            {
+                t_MemoKey key;
+                if
+                (
+                    MemoCache::MakeKey
+                    (
+                        callee.memo_slot, callee_slots, callee.arity, key
+                    )
+                )
+                {
+                    if (const t_Value* cached = m_Memo->Find(key))
+                    {
+                        sp = callee_slots;
+                        *sp++ = *cached;
+                        RD_DISPATCH();
+                    }
+                    m_MemoKeys.push_back(key);
+                    is_memoized = true;
+                }
+            }
+
+            frame->ip = ip;
+            m_Frames.push_back
+            (
+                t_CallFrame
+                {
+                    &callee, callee.chunk.code.data(), callee_slots,
+                    is_memoized
+                }
+            );
+            frame = &m_Frames.back();
+            code = callee.chunk.code.data();
+            constants = callee.chunk.constants.data();
+            ip = code;
+            slots = callee_slots;
+        }
+        RD_DISPATCH();
+
+    RD_CASE(TAIL_CALL)
+        {
+            // The arguments take the place of the running frame, which
+            // nothing needs once the call returns
+            const t_FunctionProto& callee = m_Program->functions[arg];
+            if (slots + callee.max_stack > stack_end)
+            {
+                RD_FAIL(e_ErrorType::RUNTIME_ERROR, "Stack overflow");
+            }
+
+            if (m_Stats)
+            {
+                CountCall(m_Frames.size() - 1, slots + callee.max_stack);
+            }
+
+            std::copy(sp - callee.arity, sp, slots);
+            sp = slots + callee.arity;
+            frame->proto = &callee;
+            code = callee.chunk.code.data();
+            constants = callee.chunk.constants.data();
+            ip = code;
+        }
+        RD_DISPATCH();
+
+    RD_CASE(CALL_BUILTIN)
+        CollectIfDue(sp);
+        {
+            e_Builtin builtin = static_cast<e_Builtin>(arg);
+            uint32_t arity = BuiltinArity(builtin);
+            t_Value result;
+            RD_ARRAY_OP(result, CallBuiltin(builtin, sp - arity, m_Arrays));
+            sp -= arity;
+            *sp++ = result;
+        }
+        RD_DISPATCH();
+
+    RD_CASE(RETURN)
+        {
+            t_Value result = *--sp;
+            sp = slots;
+            if (frame->is_memoized)
+            {
+                m_Memo->Store(m_MemoKeys.back(), result);
+                m_MemoKeys.pop_back();
+            }
+            m_Frames.pop_back();
+            if (m_Frames.empty())
+            {
+                return Expected<int, t_ErrorInfo>(0);
+            }
+
+            frame = &m_Frames.back();
+            code = frame->proto->chunk.code.data();
+            constants = frame->proto->chunk.constants.data();
+            ip = frame->ip;
+            slots = frame->slots;
+            *sp++ = result;
+        }
+        RD_DISPATCH();
+
+    RD_CASE(OUTPUT)
+        AppendValue(m_Output.Text(), *--sp);
+        m_Output.Commit();
+        RD_DISPATCH();
+
+    RD_CASE(OUTPUT_TEXT)
+        m_Output.Write(*constants[arg].string);
+        RD_DISPATCH();
+
+    RD_CASE(FORMAT)
+        CollectIfDue(sp);
+        {
+            std::string& text = *m_Strings.Make();
+            for (uint32_t i = 0; i < arg; ++i)
+            {
+                AppendValue(text, sp[static_cast<ptrdiff_t>(i) - arg]);
+            }
+            sp -= arg;
+            *sp++ = t_Value(&text);
+        }
+        RD_DISPATCH();
+
+    RD_CASE(READ_INPUT)
+        if (!ReadInputLine(arg))
+        {
+            RD_FAIL
+            (
+                e_ErrorType::RUNTIME_ERROR,
+                ReadFailureMessage(*m_Input, DebugName(*frame->proto, ip))
+            );
+        }
+        RD_DISPATCH();
+
+    RD_CASE(GETIN_LOCAL)
+        CollectIfDue(sp);
+        {
+            Expected<t_Value, t_ErrorInfo> input =
+            NextInputField(slots[arg], DebugName(*frame->proto, ip));
+            if (!input)
+            {
+                RD_FAIL(input.Error().type, input.Error().message);
+            }
+            slots[arg] = input.Value();
+        }
+        RD_DISPATCH();
+
+    RD_CASE(GETIN_GLOBAL)
+        RD_REQUIRE_GLOBAL(arg);
+        CollectIfDue(sp);
+        {
+            Expected<t_Value, t_ErrorInfo> input =
+            NextInputField(m_Globals[arg], *m_Program->global_names[arg]);
+            if (!input)
+            {
+                RD_FAIL(input.Error().type, input.Error().message);
+            }
+            m_Globals[arg] = input.Value();
+        }
+        RD_DISPATCH();
+
+    RD_CASE(BENCHMARK_BEGIN)
+        {
+            const t_BenchmarkInfo& info = m_Program->benchmarks[arg];
+            m_Benchmarks.push_back
+            (
+                t_BenchmarkRun{&info, ip, 0, {}, {}}
+            );
+            m_Benchmarks.back().samples.reserve(info.iterations);
+            m_Output.SetHeld(true);
+            m_Benchmarks.back().start = std::chrono::steady_clock::now();
+        }
+        RD_DISPATCH();
+
+    RD_CASE(BENCHMARK_END)
+        if (EndBenchmarkRun(false))
+        {
+            ip = m_Benchmarks.back().body;
+        }
+        RD_DISPATCH();
+
+    RD_CASE(BENCHMARK_EXIT)
+        EndBenchmarkRun(true);
+        RD_DISPATCH();
+
+    RD_CASE(RUNTIME_ERROR)
+        RD_FAIL(e_ErrorType::RUNTIME_ERROR, *constants[arg].string);
+
+#if RD_COMPUTED_GOTO
+    }
+#else
+        default:
+            RD_FAIL(e_ErrorType::RUNTIME_ERROR, "Invalid instruction");
+        }
+    }
+#endif
+
+#undef RD_CASE
+#undef RD_DISPATCH
+#undef RD_COMPARE
+#undef RD_ARRAY_OP
+#undef RD_ARITHMETIC
+#undef RD_CHECK_ASSIGN
+#undef RD_REQUIRE_GLOBAL
+#undef RD_FAIL
+}
+
+#if RD_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#endif